@@ -0,0 +1,135 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file SampleSummary.cpp
+
+**********************************************************************/
+#include "SampleSummary.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// SSE2 is in every x86-64 processor, so no test at run time is needed
+#if defined(__SSE2__) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SUMMARY_USE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Same conversions as CopySamples does, with the division by a power of two
+// exactly replaced by multiplication
+constexpr float Scale16 = 1.0f / (1 << 15);
+constexpr float Scale24 = 1.0f / (1 << 23);
+
+inline float ToFloat(float sample) { return sample; }
+inline float ToFloat(short sample) { return sample * Scale16; }
+//! int24Sample is stored in int
+inline float ToFloat(int sample) { return sample * Scale24; }
+
+#ifdef SUMMARY_USE_SSE
+inline __m128 Load4(const float *p)
+{
+   return _mm_loadu_ps(p);
+}
+
+inline __m128 Load4(const short *p)
+{
+   // Sign-extend four shorts to ints by shifting down from the high halves
+   const auto x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+   return _mm_mul_ps(
+      _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)),
+      _mm_set1_ps(Scale16));
+}
+
+inline __m128 Load4(const int *p)
+{
+   return _mm_mul_ps(
+      _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))),
+      _mm_set1_ps(Scale24));
+}
+#endif
+
+//! @pre len > 0
+template<typename Sample>
+SampleStats Summarize(const Sample *samples, size_t len)
+{
+   const auto first = ToFloat(samples[0]);
+   SampleStats stats{ first, first, first * first };
+   size_t ii = 1;
+
+#ifdef SUMMARY_USE_SSE
+   if (len >= 8) {
+      auto vMin = Load4(samples);
+      auto vMax = vMin;
+      auto vSum = _mm_mul_ps(vMin, vMin);
+      for (ii = 4; ii + 4 <= len; ii += 4) {
+         const auto x = Load4(samples + ii);
+         vMin = _mm_min_ps(vMin, x);
+         vMax = _mm_max_ps(vMax, x);
+         vSum = _mm_add_ps(vSum, _mm_mul_ps(x, x));
+      }
+      float laneMin[4], laneMax[4], laneSum[4];
+      _mm_storeu_ps(laneMin, vMin);
+      _mm_storeu_ps(laneMax, vMax);
+      _mm_storeu_ps(laneSum, vSum);
+      stats = { laneMin[0], laneMax[0], laneSum[0] };
+      for (int lane = 1; lane < 4; ++lane) {
+         stats.min = std::min(stats.min, laneMin[lane]);
+         stats.max = std::max(stats.max, laneMax[lane]);
+         stats.sumsq += laneSum[lane];
+      }
+   }
+#endif
+
+   for (; ii < len; ++ii) {
+      const auto x = ToFloat(samples[ii]);
+      stats.min = std::min(stats.min, x);
+      stats.max = std::max(stats.max, x);
+      stats.sumsq += x * x;
+   }
+   return stats;
+}
+
+SampleStats Summarize(constSamplePtr src, sampleFormat format, size_t len)
+{
+   switch (format) {
+   case int16Sample:
+      return Summarize(reinterpret_cast<const short*>(src), len);
+   case int24Sample:
+      return Summarize(reinterpret_cast<const int*>(src), len);
+   default:
+      return Summarize(reinterpret_cast<const float*>(src), len);
+   }
+}
+
+}
+
+SampleStats GetSampleStats(
+   constSamplePtr src, sampleFormat format, size_t len)
+{
+   if (len == 0)
+      return { FLT_MAX, -FLT_MAX, 0.0f };
+   return Summarize(src, format, len);
+}
+
+double SummarizeSamples(constSamplePtr src, sampleFormat format,
+   size_t len, size_t runLength, float *summary)
+{
+   const auto size = SAMPLE_SIZE(format);
+   double totalSquares = 0.0;
+   for (size_t start = 0; start < len; start += runLength, summary += 3) {
+      const auto count = std::min(runLength, len - start);
+      const auto stats = Summarize(src + start * size, format, count);
+      totalSquares += stats.sumsq;
+      summary[0] = stats.min;
+      summary[1] = stats.max;
+      // The rms is correct, but this may be for less than runLength samples
+      // in the last run
+      summary[2] = (float) sqrt(stats.sumsq / count);
+   }
+   return totalSquares;
+}
@@ -0,0 +1,40 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file SampleSummary.h
+  @brief Minimum, maximum and sum of squares of runs of samples
+
+**********************************************************************/
+#ifndef __TENACITY_SAMPLE_SUMMARY__
+#define __TENACITY_SAMPLE_SUMMARY__
+
+#include "SampleFormat.h"
+
+//! Statistics of some samples, as floats
+struct SampleStats
+{
+   float min;
+   float max;
+   float sumsq;
+};
+
+//! Statistics of len samples of any format, converting them as it goes
+/*!
+ Uses SIMD instructions where the target has them.
+ If len is zero, min is FLT_MAX, max is -FLT_MAX and sumsq is zero.
+ */
+MATH_API SampleStats GetSampleStats(
+   constSamplePtr src, sampleFormat format, size_t len);
+
+//! Summarize each run of runLength samples, the last run possibly shorter
+/*!
+ Writes the minimum, maximum and root mean square of each run to successive
+ triples in summary, which must have room for all of the runs.
+ @pre runLength > 0
+ @return the sum of squares of all the samples
+ */
+MATH_API double SummarizeSamples(constSamplePtr src, sampleFormat format,
+   size_t len, size_t runLength, float *summary);
+
+#endif
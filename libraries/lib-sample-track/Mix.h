@@ -99,20 +99,23 @@ class SAMPLE_TRACK_API Mixer {
    //
    // Processing
    //
+   // Process(), Restart(), Reposition(), MixGetCurrentTime() and GetBuffer()
+   // are virtual, so that a subclass may produce the same samples some other
+   // way
 
    /// Process a maximum of 'maxSamples' samples and put them into
    /// a buffer which can be retrieved by calling GetBuffer().
    /// Returns number of output samples, or 0, if there are no
    /// more samples that must be processed.
-   size_t Process(size_t maxSamples);
+   virtual size_t Process(size_t maxSamples);
 
    /// Restart processing at beginning of buffer next time
    /// Process() is called.
-   void Restart();
+   virtual void Restart();
 
    /// Reposition processing to absolute time next time
    /// Process() is called.
-   void Reposition(double t, bool bSkipping = false);
+   virtual void Reposition(double t, bool bSkipping = false);
 
    // Used in scrubbing.
    void SetTimesAndSpeed(double t0, double t1, double speed);
@@ -121,13 +124,13 @@ class SAMPLE_TRACK_API Mixer {
 
    /// Current time in seconds (unwarped, i.e. always between startTime and stopTime)
    /// This value is not accurate, it's useful for progress bars and indicators, but nothing else.
-   double MixGetCurrentTime();
+   virtual double MixGetCurrentTime();
 
    /// Retrieve the main buffer or the interleaved buffer
-   constSamplePtr GetBuffer();
+   virtual constSamplePtr GetBuffer();
 
    /// Retrieve one of the non-interleaved buffers
-   constSamplePtr GetBuffer(int channel);
+   virtual constSamplePtr GetBuffer(int channel);
 
  private:
 
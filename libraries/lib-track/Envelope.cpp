@@ -335,23 +335,30 @@ XMLTagHandler *Envelope::HandleXMLChild(const std::string_view& tag)
    return &mEnv.back();
 }
 
+// Names written for every clip and control point are interned
+static const XMLName EnvelopeTag{ "envelope" };
+static const XMLName NumPointsAttr{ "numpoints" };
+static const XMLName ControlPointTag{ "controlpoint" };
+static const XMLName TimeAttr{ "t" };
+static const XMLName ValueAttr{ "val" };
+
 void Envelope::WriteXML(XMLWriter &xmlFile) const
 // may throw
 {
    unsigned int ctrlPt;
 
-   xmlFile.StartTag(wxT("envelope"));
-   xmlFile.WriteAttr(wxT("numpoints"), mEnv.size());
+   xmlFile.StartTag(EnvelopeTag);
+   xmlFile.WriteAttr(NumPointsAttr, mEnv.size());
 
    for (ctrlPt = 0; ctrlPt < mEnv.size(); ctrlPt++) {
       const EnvPoint &point = mEnv[ctrlPt];
-      xmlFile.StartTag(wxT("controlpoint"));
-      xmlFile.WriteAttr(wxT("t"), point.GetT(), 12);
-      xmlFile.WriteAttr(wxT("val"), point.GetVal(), 12);
-      xmlFile.EndTag(wxT("controlpoint"));
+      xmlFile.StartTag(ControlPointTag);
+      xmlFile.WriteAttr(TimeAttr, point.GetT(), 12);
+      xmlFile.WriteAttr(ValueAttr, point.GetVal(), 12);
+      xmlFile.EndTag(ControlPointTag);
    }
 
-   xmlFile.EndTag(wxT("envelope"));
+   xmlFile.EndTag(EnvelopeTag);
 }
 
 void Envelope::Delete( int point )
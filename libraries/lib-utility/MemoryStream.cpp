@@ -16,9 +16,29 @@ void MemoryStream::Clear()
 {
    mChunks = {};
    mLinearData = {};
+   mSpareChunks = {};
    mDataSize = 0;
 }
 
+void MemoryStream::Reset()
+{
+   for (auto& chunk : mChunks)
+      chunk.BytesUsed = 0;
+
+   mSpareChunks.splice(mSpareChunks.end(), mChunks);
+   // The linear copy is as large as the data; don't keep its capacity
+   mLinearData = {};
+   mDataSize = 0;
+}
+
+void MemoryStream::AddChunk()
+{
+   if (mSpareChunks.empty())
+      mChunks.emplace_back();
+   else
+      mChunks.splice(mChunks.end(), mSpareChunks, mSpareChunks.begin());
+}
+
 void MemoryStream::AppendByte(char data)
 {
    AppendData(&data, 1);
@@ -27,12 +47,12 @@ void MemoryStream::AppendByte(char data)
 void MemoryStream::AppendData(const void* data, const size_t length)
 {
    if (mChunks.empty())
-      mChunks.emplace_back();
+      AddChunk();
 
    StreamChunk dataView = { data, length };
 
    while (mChunks.back().Append(dataView) > 0)
-      mChunks.emplace_back();
+      AddChunk();
 
    mDataSize += length;
 }
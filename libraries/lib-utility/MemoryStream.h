@@ -57,9 +57,13 @@ public:
 
    MemoryStream() = default;
    MemoryStream(MemoryStream&&) = default;
+   MemoryStream& operator=(MemoryStream&&) = default;
 
    void Clear();
 
+   //! Make the stream empty, but keep its chunks for reuse by later appends
+   void Reset();
+
    void AppendByte(char data);
    void AppendData(const void* data, const size_t length);
 
@@ -98,9 +102,14 @@ public:
    Iterator end() const;
 
 private:
+   void AddChunk();
+
    // This structures are lazily updated by get data
    mutable ChunksList mChunks;
    mutable StreamData mLinearData;
 
+   // Emptied chunks left by Reset()
+   ChunksList mSpareChunks;
+
    size_t mDataSize { 0 };
 };
@@ -0,0 +1,144 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file ThreadPool.cpp
+
+**********************************************************************/
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+ThreadPool &ThreadPool::Get()
+{
+   static ThreadPool instance{
+      std::max(1u, std::thread::hardware_concurrency()) - 1 };
+   return instance;
+}
+
+ThreadPool &ThreadPool::GetLongRunning()
+{
+   static ThreadPool instance{ Get().GetNumThreads() + 1 };
+   return instance;
+}
+
+ThreadPool::ThreadPool(size_t nThreads)
+{
+   mThreads.reserve(nThreads);
+   for (size_t ii = 0; ii < nThreads; ++ii)
+      mThreads.emplace_back([this]{ Run(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mStopping = true;
+      mTasks.clear();
+   }
+   mCondition.notify_all();
+   for (auto &thread : mThreads)
+      thread.join();
+}
+
+void ThreadPool::Post(Task task)
+{
+   if (mThreads.empty()) {
+      // A single core; there is no better time than now
+      task();
+      return;
+   }
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mTasks.push_back(std::move(task));
+   }
+   mCondition.notify_one();
+}
+
+void ThreadPool::Run()
+{
+   while (true) {
+      Task task;
+      {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mCondition.wait(lock, [this]{ return mStopping || !mTasks.empty(); });
+         if (mStopping)
+            return;
+         task = std::move(mTasks.front());
+         mTasks.pop_front();
+      }
+      task();
+   }
+}
+
+void ThreadPool::ParallelFor(size_t begin, size_t end,
+   const std::function<void(size_t)> &body)
+{
+   if (begin >= end)
+      return;
+
+   // State shared with the helpers, which may outlive this call if they
+   // are dequeued only after all the work was done by others
+   struct Shared {
+      std::atomic<size_t> next;
+      size_t end;
+      std::atomic<bool> failed{ false };
+      std::exception_ptr exception;
+      std::mutex mutex;
+      std::condition_variable condition;
+      size_t active{ 0 };
+   };
+   auto pShared = std::make_shared<Shared>();
+   pShared->next = begin;
+   pShared->end = end;
+
+   // body is borrowed by the helpers only while active is nonzero, and this
+   // function does not return until it drops back to zero
+   auto work = [pBody = &body](Shared &shared){
+      size_t ii;
+      while (!shared.failed &&
+             (ii = shared.next.fetch_add(1)) < shared.end) {
+         try {
+            (*pBody)(ii);
+         }
+         catch (...) {
+            std::lock_guard<std::mutex> lock{ shared.mutex };
+            if (!shared.failed.exchange(true))
+               shared.exception = std::current_exception();
+         }
+      }
+   };
+
+   const auto nHelpers = std::min(GetNumThreads(), end - begin - 1);
+   for (size_t ii = 0; ii < nHelpers; ++ii)
+      Post([pShared, work]{
+         auto &shared = *pShared;
+         {
+            std::lock_guard<std::mutex> lock{ shared.mutex };
+            if (shared.next >= shared.end || shared.failed)
+               // Too late to help, and body may be gone
+               return;
+            ++shared.active;
+         }
+         work(shared);
+         {
+            std::lock_guard<std::mutex> lock{ shared.mutex };
+            --shared.active;
+         }
+         shared.condition.notify_all();
+      });
+
+   work(*pShared);
+
+   // All indices are taken; wait for the helpers still busy with some
+   {
+      std::unique_lock<std::mutex> lock{ pShared->mutex };
+      pShared->condition.wait(lock, [&]{ return pShared->active == 0; });
+   }
+
+   if (pShared->exception)
+      std::rethrow_exception(pShared->exception);
+}
@@ -0,0 +1,73 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file ThreadPool.h
+  @brief A fixed set of worker threads, shared by background computations
+
+**********************************************************************/
+#ifndef __TENACITY_THREAD_POOL__
+#define __TENACITY_THREAD_POOL__
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! A fixed set of worker threads, taking tasks from one queue
+/*!
+ Tasks must not throw; ParallelFor takes care of exceptions in its body.
+ Tasks that are still queued when the pool is destroyed are discarded,
+ but tasks in progress are finished.
+ */
+class UTILITY_API ThreadPool final
+{
+public:
+   using Task = std::function<void()>;
+
+   //! The pool shared by all the application, with one thread per core
+   /*! (less one for the calling thread) */
+   static ThreadPool &Get();
+
+   //! A pool for tasks that spend their time waiting on tasks of Get()
+   /*! Such a task, as the producer or the consumer of a pipeline, must not
+    occupy a thread of Get() that its partner could need.  This pool has one
+    more thread than that one, so that every task running there or in the
+    main thread may have a partner running here.  The threads live as long
+    as the program, so they also reuse what is prepared for each thread, as
+    are statements of database connections. */
+   static ThreadPool &GetLongRunning();
+
+   explicit ThreadPool(size_t nThreads);
+   ThreadPool(const ThreadPool&) = delete;
+   ThreadPool &operator=(const ThreadPool&) = delete;
+   ~ThreadPool();
+
+   size_t GetNumThreads() const { return mThreads.size(); }
+
+   //! Run the task on some worker thread, later
+   void Post(Task task);
+
+   //! Call body(ii) for each ii in [begin, end), and return when all are done
+   /*!
+    The calling thread also participates, so this is safe to call from a
+    task of the same pool.  If any call throws, remaining indices are
+    skipped, and the first exception is rethrown here.
+    */
+   void ParallelFor(size_t begin, size_t end,
+      const std::function<void(size_t)> &body);
+
+private:
+   void Run();
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::deque<Task> mTasks;
+   bool mStopping{ false };
+   std::vector<std::thread> mThreads;
+};
+
+#endif
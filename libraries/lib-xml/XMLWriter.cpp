@@ -20,6 +20,7 @@ the general functionality for creating XML in UTF8 encoding.
 #include <wx/ffile.h>
 #include <wx/intl.h>
 
+#include <atomic>
 #include <cstring>
 
 #include "ToChars.h"
@@ -53,6 +54,33 @@ static int charXMLCompatiblity[] =
 #define NONCHARACTER_FFFF static_cast<wxUChar>(0xFFFF)
 
 
+namespace {
+std::atomic<size_t> &NameCounter()
+{
+   // Function-local, so it is ready for names defined in other translation
+   // units, whatever the order of their static initialization
+   static std::atomic<size_t> counter{ 0 };
+   return counter;
+}
+
+wxString ToWxString(const XMLName &name)
+{
+   return wxString::FromUTF8(name.Get(), name.Length());
+}
+}
+
+XMLName::XMLName(const char *name) noexcept
+   : mName{ name }
+   , mLength{ strlen(name) }
+   , mSerial{ NameCounter()++ }
+{
+}
+
+size_t XMLName::Count() noexcept
+{
+   return NameCounter();
+}
+
 ///
 /// XMLWriter base class
 ///
@@ -190,6 +218,66 @@ void XMLWriter::WriteAttr(const wxString &name, double value, int digits)
       Internat::ToString(value, digits)));
 }
 
+void XMLWriter::StartTag(const XMLName &name)
+// may throw
+{
+   StartTag(ToWxString(name));
+}
+
+void XMLWriter::EndTag(const XMLName &name)
+// may throw
+{
+   EndTag(ToWxString(name));
+}
+
+void XMLWriter::WriteAttr(const XMLName &name, const wxString &value)
+// may throw from Write()
+{
+   WriteAttr(ToWxString(name), value);
+}
+
+void XMLWriter::WriteAttr(const XMLName &name, int value)
+// may throw from Write()
+{
+   WriteAttr(ToWxString(name), value);
+}
+
+void XMLWriter::WriteAttr(const XMLName &name, bool value)
+// may throw from Write()
+{
+   WriteAttr(ToWxString(name), value);
+}
+
+void XMLWriter::WriteAttr(const XMLName &name, long value)
+// may throw from Write()
+{
+   WriteAttr(ToWxString(name), value);
+}
+
+void XMLWriter::WriteAttr(const XMLName &name, long long value)
+// may throw from Write()
+{
+   WriteAttr(ToWxString(name), value);
+}
+
+void XMLWriter::WriteAttr(const XMLName &name, size_t value)
+// may throw from Write()
+{
+   WriteAttr(ToWxString(name), value);
+}
+
+void XMLWriter::WriteAttr(const XMLName &name, float value, int digits)
+// may throw from Write()
+{
+   WriteAttr(ToWxString(name), value, digits);
+}
+
+void XMLWriter::WriteAttr(const XMLName &name, double value, int digits)
+// may throw from Write()
+{
+   WriteAttr(ToWxString(name), value, digits);
+}
+
 void XMLWriter::WriteData(const wxString &value)
 // may throw from Write()
 {
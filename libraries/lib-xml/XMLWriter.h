@@ -20,6 +20,31 @@
 
 #include "Identifier.h"
 
+//! A tag or attribute name, interned once for the run of the program
+/*!
+ Construct these only with static storage duration, from string literals.
+ Each is given a dense serial number, so that a writer that keeps a
+ dictionary of names, like ProjectSerializer, can find its entry by indexing
+ an array, instead of constructing and hashing a string at each use.
+ */
+class XML_API XMLName final
+{
+public:
+   explicit XMLName(const char *name) noexcept;
+
+   const char *Get() const noexcept { return mName; }
+   size_t Length() const noexcept { return mLength; }
+   size_t GetSerial() const noexcept { return mSerial; }
+
+   //! @return how many names were interned so far
+   static size_t Count() noexcept;
+
+private:
+   const char *const mName;
+   const size_t mLength;
+   const size_t mSerial;
+};
+
 ///
 /// XMLWriter
 ///
@@ -50,6 +75,20 @@ class XML_API XMLWriter /* not final */ {
    virtual void WriteAttr(const wxString &name, float value, int digits = -1);
    virtual void WriteAttr(const wxString &name, double value, int digits = -1);
 
+   // Overloads for interned names; the defaults just convert the name
+   virtual void StartTag(const XMLName &name);
+   virtual void EndTag(const XMLName &name);
+
+   virtual void WriteAttr(const XMLName &name, const wxString &value);
+
+   virtual void WriteAttr(const XMLName &name, int value);
+   virtual void WriteAttr(const XMLName &name, bool value);
+   virtual void WriteAttr(const XMLName &name, long value);
+   virtual void WriteAttr(const XMLName &name, long long value);
+   virtual void WriteAttr(const XMLName &name, size_t value);
+   virtual void WriteAttr(const XMLName &name, float value, int digits = -1);
+   virtual void WriteAttr(const XMLName &name, double value, int digits = -1);
+
    virtual void WriteData(const wxString &value);
 
    virtual void WriteSubTree(const wxString &value);
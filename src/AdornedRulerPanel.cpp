@@ -175,6 +175,7 @@ public:
 private:
    unsigned SequenceNumber() const override;
    std::pair<wxRect, bool> DoGetRectangle(wxSize size) override;
+   wxRect DoGetNextRectangle(wxSize size) override;
    void Draw(OverlayPanel &panel, wxDC &dc) override;
 
    TenacityProject *mProject;
@@ -326,6 +327,13 @@ AdornedRulerPanel::QuickPlayIndicatorOverlay::DoGetRectangle(wxSize size)
    );
 }
 
+wxRect
+AdornedRulerPanel::QuickPlayIndicatorOverlay::DoGetNextRectangle(wxSize size)
+{
+   const auto x = mPartner->mNewQPIndicatorPos;
+   return x >= 0 ? wxRect(x, 0, 1, size.GetHeight()) : wxRect();
+}
+
 void AdornedRulerPanel::QuickPlayIndicatorOverlay::Draw(
    OverlayPanel &panel, wxDC &dc)
 {
@@ -1726,7 +1726,8 @@ void AudioIO::DrainRecordBuffers()
                   size_t size = floor( correction * mRate * mFactor);
                   SampleBuffer temp(size, trackFormat);
                   ClearSamples(temp.ptr(), trackFormat, 0, size);
-                  mCaptureTracks[i]->Append(temp.ptr(), trackFormat, size, 1);
+                  mCaptureTracks[i]->AppendRecorded(
+                     temp.ptr(), trackFormat, size, 1);
                }
                else {
                   // Leftward shift
@@ -1826,7 +1827,8 @@ void AudioIO::DrainRecordBuffers()
 
             // Now append
             // see comment in second handler about guarantee
-            newBlocks = mCaptureTracks[i]->Append(temp.ptr(), format, size, 1)
+            newBlocks = mCaptureTracks[i]->AppendRecorded(
+               temp.ptr(), format, size, 1)
                || newBlocks;
          } // end loop over capture channels
 
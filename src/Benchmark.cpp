@@ -43,6 +43,7 @@ of sample block storage.
 #include "WaveTrack.h"
 #include "Sequence.h"
 #include "ProjectRate.h"
+#include "ProjectSerializer.h"
 #include "ViewInfo.h"
 
 #include "SelectFile.h"
@@ -519,6 +520,35 @@ void BenchmarkDialog::OnRun( wxCommandEvent & /* event */)
    FlushPrint();
    wxTheApp->Yield();
 
+   {
+      // Serialize a synthetic project of many copies of the track, as an
+      // autosave would, and repeat so that later passes reuse the buffers
+      // that the first one allocated
+      const int nTracks = 1000;
+      const int nPasses = 3;
+      Printf( XO("Serializing %d tracks...\n").Format( nTracks ) );
+      FlushPrint();
+      wxTheApp->Yield();
+
+      for (int pass = 1; pass <= nPasses; ++pass) {
+         timer.Start();
+         size_t size = 0;
+         {
+            ProjectSerializer doc;
+            doc.StartTag(wxT("project"));
+            for (int i = 0; i < nTracks; ++i)
+               t->WriteXML(doc);
+            doc.EndTag(wxT("project"));
+            size = doc.GetData().GetSize();
+         }
+         elapsed = timer.Time();
+         Printf( XO("Time to serialize (pass %d): %ld ms, %lld bytes\n")
+            .Format( pass, elapsed, (long long) size ) );
+      }
+      FlushPrint();
+      wxTheApp->Yield();
+   }
+
 
 #if 0
    Printf( XO("Checking file pointer leaks:\n") );
@@ -1071,7 +1071,7 @@ namespace {
 // Private, recursive implementation function of Visit
 void CellularPanel::Visit(
    const wxRect &rect, const std::shared_ptr<TrackPanelNode> &node,
-   Visitor &visitor )
+   Visitor &visitor, const wxRect *pClip )
 {
    if (auto pCell = dynamic_cast<TrackPanelCell*>(node.get()))
       visitor.VisitCell( rect, *pCell );
@@ -1079,13 +1079,16 @@ void CellularPanel::Visit(
       visitor.BeginGroup( rect, *pGroup );
 
       // Recur on children
-      const auto results = pGroup->Children( rect );
+      const auto results = pClip
+         ? pGroup->VisibleChildren( rect, *pClip )
+         : pGroup->Children( rect );
       const bool divideX = results.first == TrackPanelGroup::Axis::X;
       const auto &children = results.second;
       const auto begin = children.begin(), end = children.end();
       for (auto iter = begin; iter != end; ++iter)
          Visit(
-            Subdivide(rect, divideX, children, iter), iter->second, visitor );
+            Subdivide(rect, divideX, children, iter), iter->second, visitor,
+            pClip );
 
       visitor.EndGroup( rect, *pGroup );
    }
@@ -1102,8 +1105,9 @@ auto CellularPanel::FindCell(int mouseX, int mouseY) -> FoundCell
          // Found the bottom of the hierarchy
          return { pCell, rect };
       else if ( auto pGroup = dynamic_cast< TrackPanelGroup* >( node.get() ) ) {
-         // Ask node for its subdivision
-         const auto results = pGroup->Children( rect );
+         // Ask node for its subdivision, near the mouse only
+         const auto results =
+            pGroup->VisibleChildren( rect, { mouseX, mouseY, 1, 1 } );
          const bool divideX = results.first == TrackPanelGroup::Axis::X;
          const auto &children = results.second;
 
@@ -1193,19 +1197,27 @@ std::shared_ptr<TrackPanelCell> CellularPanel::LastCell() const
    return state.mLastCell.lock();
 }
 
-void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses )
+size_t CellularPanel::Draw( TrackPanelDrawingContext &context,
+   unsigned nPasses, const wxRect *pDamage )
 {
    const auto panelRect = GetClientRect();
+   auto damageRect = panelRect;
+   if (pDamage)
+      damageRect.Intersect(*pDamage);
    auto lastCell = LastCell();
+   size_t nDrawn = 0;
    for ( unsigned iPass = 0; iPass < nPasses; ++iPass ) {
 
-      VisitPostorder( [&]( const wxRect &rect, TrackPanelNode &node ) {
+      // Like VisitPostorder, but skipping what is far from the damage
+      Adaptor adaptor{ [&]( const wxRect &rect, TrackPanelNode &node ) {
 
          // Draw the node
          const auto newRect = node.DrawingArea(
             context, rect, panelRect, iPass );
-         if ( newRect.Intersects( panelRect ) )
+         if ( newRect.Intersects( damageRect ) ) {
             node.Draw( context, newRect, iPass );
+            ++nDrawn;
+         }
 
          // Draw the current handle if it is associated with the node
          if ( &node == lastCell.get() ) {
@@ -1213,12 +1225,17 @@ void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses )
             if ( target ) {
                const auto targetRect =
                   target->DrawingArea( context, rect, panelRect, iPass );
-               if ( targetRect.Intersects( panelRect ) )
+               if ( targetRect.Intersects( damageRect ) ) {
                   target->Draw( context, targetRect, iPass );
+                  ++nDrawn;
+               }
             }
          }
 
-      } ); // nodes
+      }, false }; // nodes
+      Visit( panelRect, Root(), adaptor, &damageRect );
 
    } // passes
+
+   return nDrawn;
 }
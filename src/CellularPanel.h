@@ -114,7 +114,11 @@ public:
    // and of handles associated with such cells,
    // and of all groups of cells,
    // repeatedly with a pass count from 0 to nPasses - 1
-   void Draw( TrackPanelDrawingContext &context, unsigned nPasses );
+   // If pDamage is not null, visit only those whose drawing areas intersect
+   // it too
+   // Returns the number of Draw calls made
+   size_t Draw( TrackPanelDrawingContext &context, unsigned nPasses,
+      const wxRect *pDamage = nullptr );
    
 protected:
    bool HasEscape();
@@ -123,9 +127,10 @@ protected:
    void ClearTargets();
    
 private:
+   // If pClip is not null, groups may skip children wholly outside of it
    void Visit(
       const wxRect &rect, const std::shared_ptr<TrackPanelNode> &node,
-      Visitor &visitor );
+      Visitor &visitor, const wxRect *pClip = nullptr );
 
    bool HasRotation();
    bool ChangeTarget(bool forward, bool cycle);
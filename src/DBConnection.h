@@ -83,6 +83,11 @@ public:
    };
    sqlite3_stmt *Prepare(enum StatementID id, const char *sql);
 
+   //! Hold this while stepping a statement and then querying state of the
+   //! connection that another thread could change, such as
+   //! sqlite3_last_insert_rowid()
+   std::mutex &GetInsertMutex() { return mInsertMutex; }
+
    void SetBypass( bool bypass );
    bool ShouldBypass();
 
@@ -121,6 +126,8 @@ private:
    using StatementIndex = std::pair<enum StatementID, std::thread::id>;
    std::map<StatementIndex, sqlite3_stmt *> mStatements;
 
+   std::mutex mInsertMutex;
+
    std::shared_ptr<DBConnectionErrors> mpErrors;
    CheckpointFailureCallback mCallback;
 
@@ -147,11 +147,14 @@ auto LabelTrack::GetIntervals() -> Intervals
 
 void LabelTrack::SetLabel( size_t iLabel, const LabelStruct &newLabel )
 {
+   InvalidateTimeIndex();
    if( iLabel >= mLabels.size() ) {
       wxASSERT( false );
       mLabels.resize( iLabel + 1 );
    }
    mLabels[ iLabel ] = newLabel;
+   // The title may have changed
+   mLabels[ iLabel ].widthFont = 0;
 }
 
 LabelTrack::~LabelTrack()
@@ -160,12 +163,14 @@ LabelTrack::~LabelTrack()
 
 void LabelTrack::SetOffset(double dOffset)
 {
+   InvalidateTimeIndex();
    for (auto &labelStruct: mLabels)
       labelStruct.selectedRegion.move(dOffset);
 }
 
 void LabelTrack::Clear(double b, double e)
 {
+   InvalidateTimeIndex();
    // May DELETE labels, so use subscripts to iterate
    for (size_t i = 0; i < mLabels.size(); ++i) {
       auto &labelStruct = mLabels[i];
@@ -215,6 +220,7 @@ bool LabelTrack::SplitDelete(double b, double e)
 
 void LabelTrack::ShiftLabelsOnInsert(double length, double pt)
 {
+   InvalidateTimeIndex();
    for (auto &labelStruct: mLabels) {
       LabelStruct::TimeRelations relation =
                         labelStruct.RegionRelation(pt, pt, this);
@@ -228,6 +234,7 @@ void LabelTrack::ShiftLabelsOnInsert(double length, double pt)
 
 void LabelTrack::ChangeLabelsOnReverse(double b, double e)
 {
+   InvalidateTimeIndex();
    for (auto &labelStruct: mLabels) {
       if (labelStruct.RegionRelation(b, e, this) ==
                                     LabelStruct::SURROUNDS_LABEL)
@@ -243,6 +250,7 @@ void LabelTrack::ChangeLabelsOnReverse(double b, double e)
 
 void LabelTrack::ScaleLabels(double b, double e, double change)
 {
+   InvalidateTimeIndex();
    for (auto &labelStruct: mLabels) {
       labelStruct.selectedRegion.setTimes(
          AdjustTimeStampOnScale(labelStruct.getT0(), b, e, change),
@@ -270,6 +278,7 @@ double LabelTrack::AdjustTimeStampOnScale(double t, double b, double e, double c
 // (If necessary this could be optimised by ignoring labels that occur before a
 // specified time, as in most cases they don't need to move.)
 void LabelTrack::WarpLabels(const TimeWarper &warper) {
+   InvalidateTimeIndex();
    for (auto &labelStruct: mLabels) {
       labelStruct.selectedRegion.setTimes(
          warper.Warp(labelStruct.getT0()),
@@ -559,6 +568,7 @@ void LabelTrack::Export(wxTextFile & f) const
 /// Import labels, handling files with or without end-times.
 void LabelTrack::Import(wxTextFile & in)
 {
+   InvalidateTimeIndex();
    int lines = in.GetLineCount();
 
    mLabels.clear();
@@ -583,6 +593,7 @@ void LabelTrack::Import(wxTextFile & in)
 
 bool LabelTrack::HandleXMLTag(const std::string_view& tag, const AttributesList &attrs)
 {
+   InvalidateTimeIndex();
    if (tag == "label") {
 
       SelectedRegion selectedRegion;
@@ -747,6 +758,7 @@ Track::Holder LabelTrack::Copy(double t0, double t1, bool) const
 
 bool LabelTrack::PasteOver(double t, const Track * src)
 {
+   InvalidateTimeIndex();
    auto result = src->TypeSwitch< bool >( [&](const LabelTrack *sl) {
       int len = mLabels.size();
       int pos = 0;
@@ -793,6 +805,7 @@ void LabelTrack::Paste(double t, const Track *src)
 // This repeats the labels in a time interval a specified number of times.
 bool LabelTrack::Repeat(double t0, double t1, int n)
 {
+   InvalidateTimeIndex();
    // Sanity-check the arguments
    if (n < 0 || t1 < t0)
       return false;
@@ -863,6 +876,7 @@ void LabelTrack::SyncLockAdjust(double oldT1, double newT1)
 
 void LabelTrack::Silence(double t0, double t1)
 {
+   InvalidateTimeIndex();
    int len = mLabels.size();
 
    // mLabels may resize as we iterate, so use subscripting
@@ -909,6 +923,7 @@ void LabelTrack::Silence(double t0, double t1)
 
 void LabelTrack::InsertSilence(double t, double len)
 {
+   InvalidateTimeIndex();
    for (auto &labelStruct: mLabels) {
       double t0 = labelStruct.getT0();
       double t1 = labelStruct.getT1();
@@ -934,6 +949,7 @@ const LabelStruct *LabelTrack::GetLabel(int index) const
 int LabelTrack::AddLabel(const SelectedRegion &selectedRegion,
                          const wxString &title)
 {
+   InvalidateTimeIndex();
    LabelStruct l { selectedRegion, title };
 
    int len = mLabels.size();
@@ -954,6 +970,7 @@ int LabelTrack::AddLabel(const SelectedRegion &selectedRegion,
 
 void LabelTrack::DeleteLabel(int index)
 {
+   InvalidateTimeIndex();
    wxASSERT((index < (int)mLabels.size()));
    auto iter = mLabels.begin() + index;
    const auto title = iter->title;
@@ -971,6 +988,7 @@ void LabelTrack::DeleteLabel(int index)
 /// sort (with a linear search) is a reasonable choice.
 void LabelTrack::SortLabels()
 {
+   InvalidateTimeIndex();
    const auto begin = mLabels.begin();
    const auto nn = (int)mLabels.size();
    int i = 1;
@@ -1009,7 +1027,9 @@ wxString LabelTrack::GetTextOfLabels(double t0, double t1) const
    bool firstLabel = true;
    wxString retVal;
 
-   for (auto &labelStruct: mLabels) {
+   const auto range = FindLabelsIntersecting(t0, t1);
+   for (auto ii = range.first; ii < range.second; ++ii) {
+      const auto &labelStruct = mLabels[ii];
       if (labelStruct.getT0() >= t0 &&
           labelStruct.getT1() <= t1)
       {
@@ -1023,6 +1043,52 @@ wxString LabelTrack::GetTextOfLabels(double t0, double t1) const
    return retVal;
 }
 
+auto LabelTrack::GetTimeIndex() const -> const TimeIndex &
+{
+   if (!mTimeIndex) {
+      TimeIndex index;
+      index.latestEnds.reserve(mLabels.size());
+      double latestEnd = -DBL_MAX;
+      for (size_t ii = 0, nn = mLabels.size(); ii < nn; ++ii) {
+         const auto &label = mLabels[ii];
+         if (ii > 0 && mLabels[ii - 1].getT0() > label.getT0())
+            index.sorted = false;
+         latestEnd = std::max(latestEnd, label.getT1());
+         index.latestEnds.push_back(latestEnd);
+      }
+      mTimeIndex.emplace(std::move(index));
+   }
+   return *mTimeIndex;
+}
+
+std::pair<size_t, size_t>
+LabelTrack::FindLabelsIntersecting(double t0, double t1) const
+{
+   const auto &index = GetTimeIndex();
+   if (!index.sorted)
+      return { 0, mLabels.size() };
+
+   // Labels before first end before t0; labels from last on start after t1
+   const auto &ends = index.latestEnds;
+   const size_t first =
+      std::lower_bound(ends.begin(), ends.end(), t0) - ends.begin();
+   const size_t last = std::upper_bound(mLabels.begin(), mLabels.end(), t1,
+      [](double t, const LabelStruct &label){ return t < label.getT0(); }
+   ) - mLabels.begin();
+   return { first, std::max(first, last) };
+}
+
+std::optional<size_t> LabelTrack::FindLatestEndingBefore(size_t index) const
+{
+   const auto &ends = GetTimeIndex().latestEnds;
+   index = std::min(index, ends.size());
+   if (index == 0)
+      return {};
+   // The first label attaining the maximum
+   return std::lower_bound(ends.begin(), ends.begin() + index, ends[index - 1])
+      - ends.begin();
+}
+
 int LabelTrack::FindNextLabel(const SelectedRegion& currentRegion)
 {
    int i = -1;
@@ -18,6 +18,9 @@
 
 #include <wx/event.h> // to inherit
 
+#include <optional>
+#include <utility>
+
 class wxTextFile;
 
 class TenacityProject;
@@ -71,6 +74,7 @@ public:
    SelectedRegion selectedRegion;
    wxString title; /// Text of the label.
    mutable int width{}; /// width of the text in pixels.
+   mutable unsigned widthFont{}; /// which font measured width; 0 for none
 
 // Working storage for on-screen layout.
    mutable int x{};     /// Pixel position of left hand glyph
@@ -156,6 +160,14 @@ public:
    // Returns tab-separated text of all labels completely within given region
    wxString GetTextOfLabels(double t0, double t1) const;
 
+   //! Range of indices of the labels that may intersect [t0, t1]
+   /*! Labels outside the range surely do not; some inside might not either.
+    All labels are in the range while they are not sorted. */
+   std::pair<size_t, size_t> FindLabelsIntersecting(double t0, double t1) const;
+
+   //! Index of the label ending latest among those before index, if any
+   std::optional<size_t> FindLatestEndingBefore(size_t index) const;
+
    int FindNextLabel(const SelectedRegion& currentSelection);
    int FindPrevLabel(const SelectedRegion& currentSelection);
 
@@ -177,7 +189,17 @@ public:
    void SortLabels();
 
  private:
+   //! Computed from the label times when first needed after any change
+   struct TimeIndex {
+      bool sorted{ true };
+      //! Greatest end time of labels [0, i], for each i
+      std::vector<double> latestEnds;
+   };
+   const TimeIndex &GetTimeIndex() const;
+   void InvalidateTimeIndex() { mTimeIndex.reset(); }
+
    LabelArray mLabels;
+   mutable std::optional<TimeIndex> mTimeIndex;
 
    // Set in copied label tracks
    double mClipLen;
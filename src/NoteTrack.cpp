@@ -180,13 +180,10 @@ Track::Holder NoteTrack::Clone() const
       SonifyEndSerialize();
    }
    else if (mSerializationBuffer) {
-      // Copy already serialized data.
+      // Share already serialized data.
       wxASSERT(!mSeq);
       duplicate->mSerializationLength = this->mSerializationLength;
-      duplicate->mSerializationBuffer.reset
-         ( safenew char[ this->mSerializationLength ] );
-      memcpy( duplicate->mSerializationBuffer.get(),
-              this->mSerializationBuffer.get(), this->mSerializationLength );
+      duplicate->mSerializationBuffer = this->mSerializationBuffer;
    }
    else {
       // We are duplicating a default-constructed NoteTrack, and that's okay
@@ -918,6 +915,7 @@ bool NoteTrack::HandleXMLTag(const std::string_view& tag, const AttributesList &
 
          long nValue;
          double dblValue;
+         std::string_view strValue;
          if (this->Track::HandleCommonXMLAttribute(attr, value))
             ;
          else if (this->NoteTrackBase::HandleXMLAttribute(attr, value))
@@ -938,9 +936,9 @@ bool NoteTrack::HandleXMLTag(const std::string_view& tag, const AttributesList &
             SetBottomNote(nValue);
          else if (attr == "topnote" && value.TryGet(nValue))
             SetTopNote(nValue);
-         else if (attr == "data") {
-             std::string s(value.ToWString());
-             std::istringstream data(s);
+         else if (attr == "data" && value.TryGet(strValue)) {
+             // Copy the UTF-8 text once, not through a wide string
+             std::istringstream data{ std::string{ strValue } };
              mSeq = std::make_unique<Alg_seq>(data, false);
          }
       } // while
@@ -203,7 +203,8 @@ public:
    // At most one of the two pointers is not null at any time.
    // Both are null in a newly constructed NoteTrack.
    mutable std::unique_ptr<Alg_seq> mSeq;
-   mutable std::unique_ptr<char[]> mSerializationBuffer;
+   // The serialized form is never modified, so duplicates may share it
+   mutable std::shared_ptr<char[]> mSerializationBuffer;
    mutable long mSerializationLength;
 
 #ifdef EXPERIMENTAL_MIDI_OUT
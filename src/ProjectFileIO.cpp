@@ -168,6 +168,21 @@ static const char *ProjectFileSchema =
    "  samples              BLOB"
    ");";
 
+// CREATE SQL undostates
+// undostates holds states of the undo history that were moved out of
+// memory, in the same binary representation as project and autosave.
+// Many instances.  id is chosen by the UndoManager.
+// The table is created only when first needed.  Undo history does not
+// outlive the session, so it is dropped when the history is cleared, or
+// when a project is opened after a crash.
+static const char *UndoStatesSchema =
+   "CREATE TABLE IF NOT EXISTS <schema>.undostates"
+   "("
+   "  id                   INTEGER PRIMARY KEY,"
+   "  dict                 BLOB,"
+   "  doc                  BLOB"
+   ");";
+
 // This singleton handles initialization/shutdown of the SQLite library.
 // It is needed because our local SQLite is built with SQLITE_OMIT_AUTOINIT
 // defined.
@@ -1182,6 +1197,20 @@ bool ProjectFileIO::CopyTo(const FilePath &destpath,
          }
       }
 
+      // The undo history is retained when not pruning, including any of its
+      // states that were moved out of memory
+      if (!prune)
+      {
+         if (!InstallUndoStatesSchema("main") ||
+             !InstallUndoStatesSchema("outbound") ||
+             !Query("INSERT INTO outbound.undostates"
+                    "  SELECT * FROM main.undostates;",
+                    [](auto...) { return 0; }))
+         {
+            return false;
+         }
+      }
+
       // Write the doc.
       //
       // If we're compacting a temporary project (user initiated from the File
@@ -1860,20 +1889,46 @@ bool ProjectFileIO::WriteDoc(const char *table,
                              const ProjectSerializer &autosave,
                              const char *schema /* = "main" */)
 {
-   auto db = DB();
-
    TransactionScope transaction(mProject, "UpdateProject");
 
-   int rc;
-
    // For now, we always use an ID of 1. This will replace the previously
    // written row every time.
+   if (!WriteDocRow(schema, table, 1, autosave))
+      return false;
+
+   const auto requiredVersion =
+      ProjectFormatExtensionsRegistry::Get().GetRequiredVersion(mProject);
+
+   const wxString setVersionSql =
+      wxString::Format("PRAGMA user_version = %u", requiredVersion.GetPacked());
+
+   if (!Query(setVersionSql.c_str(), [](auto...) { return 0; }))
+   {
+      // DV: Very unlikely case.
+      // Since we need to improve the error messages in the future, let's use
+      // the generic message for now, so no new strings are needed
+      SetDBError(
+         XO("Failed to update the project file.\nThe following command failed:\n\n%s")
+            .Format(setVersionSql));
+      return false;
+   }
+
+   return transaction.Commit();
+}
+
+bool ProjectFileIO::WriteDocRow(const char *schema, const char *table,
+   int64_t id, const ProjectSerializer &autosave)
+{
+   auto db = DB();
+
+   int rc;
+
    char sql[256];
    sqlite3_snprintf(
       sizeof(sql), sql,
-      "INSERT INTO %s.%s(id, dict, doc) VALUES(1, ?1, ?2)"
+      "INSERT INTO %s.%s(id, dict, doc) VALUES(%lld, ?1, ?2)"
       "       ON CONFLICT(id) DO UPDATE SET dict = ?1, doc = ?2;",
-      schema, table);
+      schema, table, (sqlite3_int64) id);
 
    sqlite3_stmt *stmt = nullptr;
    auto cleanup = finally([&]
@@ -1933,8 +1988,8 @@ bool ProjectFileIO::WriteDoc(const char *table,
 
    int64_t rowID = 0;
 
-   const wxString rowIDSql =
-      wxString::Format("SELECT ROWID FROM %s.%s WHERE id = 1;", schema, table);
+   const wxString rowIDSql = wxString::Format(
+      "SELECT ROWID FROM %s.%s WHERE id = %lld;", schema, table, (long long)id);
 
    if (!GetValue(rowIDSql, rowID, true))
    {
@@ -1978,24 +2033,51 @@ bool ProjectFileIO::WriteDoc(const char *table,
    if (!writeStream("doc", data))
       return false;
 
-   const auto requiredVersion =
-      ProjectFormatExtensionsRegistry::Get().GetRequiredVersion(mProject);
+   return true;
+}
 
-   const wxString setVersionSql =
-      wxString::Format("PRAGMA user_version = %u", requiredVersion.GetPacked());
+bool ProjectFileIO::InstallUndoStatesSchema(const char *schema)
+{
+   wxString sql{ UndoStatesSchema };
+   sql.Replace("<schema>", schema);
+   return Query(sql, [](auto...) { return 0; });
+}
 
-   if (!Query(setVersionSql.c_str(), [](auto...) { return 0; }))
-   {
-      // DV: Very unlikely case.
-      // Since we need to improve the error messages in the future, let's use
-      // the generic message for now, so no new strings are needed
-      reportError(setVersionSql);
+bool ProjectFileIO::WriteUndoState(int64_t id, const ProjectSerializer &doc)
+{
+   if (!InstallUndoStatesSchema())
+      return false;
+
+   TransactionScope transaction(mProject, "UpdateUndoState");
+
+   if (!WriteDocRow("main", "undostates", id, doc))
       return false;
-   }
 
    return transaction.Commit();
 }
 
+bool ProjectFileIO::ReadUndoState(int64_t id, XMLTagHandler *handler)
+{
+   // id is an INTEGER PRIMARY KEY, so it is also the ROWID
+   BufferedProjectBlobStream stream(DB(), "main", "undostates", id);
+   return ProjectSerializer::Decode(stream, handler);
+}
+
+void ProjectFileIO::DeleteUndoState(int64_t id)
+{
+   char sql[256];
+   sqlite3_snprintf(sizeof(sql), sql,
+      "DELETE FROM main.undostates WHERE id = %lld;", (sqlite3_int64) id);
+   // The table might not exist
+   Exec(sql, [](auto...) { return 0; }, true);
+}
+
+void ProjectFileIO::DeleteUndoStates()
+{
+   Exec("DROP TABLE IF EXISTS main.undostates;",
+      [](auto...) { return 0; }, true);
+}
+
 bool ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
 {
    auto now = std::chrono::high_resolution_clock::now();
@@ -2045,11 +2127,20 @@ bool ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
    }
    else
    {
-      // Load 'er up
-      BufferedProjectBlobStream stream(
-         DB(), "main", useAutosave ? "autosave" : "project", rowId);
+      // Fetch the metadata of all sample blocks with one query, overlapping
+      // the decoding of the document, instead of one query per block
+      auto &blockFactory = *WaveTrackFactory::Get( mProject )
+         .GetSampleBlockFactory();
+      blockFactory.BeginBulkLoad();
+      {
+         auto endBulkLoad = finally([&]{ blockFactory.EndBulkLoad(); });
+
+         // Load 'er up
+         BufferedProjectBlobStream stream(
+            DB(), "main", useAutosave ? "autosave" : "project", rowId);
 
-      success = ProjectSerializer::Decode(stream, this);
+         success = ProjectSerializer::Decode(stream, this);
+      }
 
       if (!success)
       {
@@ -2073,6 +2164,10 @@ bool ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
          }
       }
    
+      // Undo history left over from a session that did not end normally
+      // can't be used
+      DeleteUndoStates();
+
       // Remember if we used autosave or not
       if (useAutosave)
       {
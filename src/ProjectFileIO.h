@@ -103,6 +103,14 @@ public:
    bool SaveProject(const FilePath &fileName, const TrackList *lastSaved);
    bool SaveCopy(const FilePath& fileName);
 
+   //! Store a state of the undo history that is moved out of memory
+   bool WriteUndoState(int64_t id, const ProjectSerializer &doc);
+   //! Decode a state written by WriteUndoState
+   bool ReadUndoState(int64_t id, XMLTagHandler *handler);
+   void DeleteUndoState(int64_t id);
+   //! Discard all states written by WriteUndoState
+   void DeleteUndoStates();
+
    wxLongLong GetFreeDiskSpace() const;
 
    // Returns the bytes used for the given sample block
@@ -251,6 +259,11 @@ private:
 
    // Write project or autosave XML (binary) documents
    bool WriteDoc(const char *table, const ProjectSerializer &autosave, const char *schema = "main");
+   // Write one row of a table of documents, without a transaction
+   bool WriteDocRow(const char *schema, const char *table,
+      int64_t id, const ProjectSerializer &autosave);
+
+   bool InstallUndoStatesSchema(const char *schema = "main");
 
    // Application defined function to verify blockid exists is in set of blockids
    static void InSet(sqlite3_context *context, int argc, sqlite3_value **argv);
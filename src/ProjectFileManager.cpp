@@ -19,11 +19,13 @@ Paul Licameli split from TenacityProject.cpp
 #include <wx/frame.h>
 #include <wx/log.h>
 
+#include <algorithm>
 #include <optional>
 
 // Tenacity libraries
 #include <lib-basic-ui/BasicUI.h>
 #include <lib-string-utils/CodeConversions.h>
+#include <lib-utility/ThreadPool.h>
 #include <lib-xml/XMLFileReader.h>
 
 #include "Legacy.h"
@@ -41,6 +43,7 @@ Paul Licameli split from TenacityProject.cpp
 #include "SelectUtilities.h"
 #include "SelectionState.h"
 #include "Tags.h"
+#include "TaskBatch.h"
 #include "TempDirectory.h"
 #include "TrackPanelAx.h"
 #include "TrackPanel.h"
@@ -49,12 +52,16 @@ Paul Licameli split from TenacityProject.cpp
 #include "WaveTrack.h"
 #include "WaveClip.h"
 #include "wxFileNameWrapper.h"
+#include "FileFormats.h"
+#include "SampleBlock.h"
 #include "export/Export.h"
 #include "import/Import.h"
+#include "import/ImportPlugin.h"
 #include "import/ImportMIDI.h"
 #include "toolbars/SettingsBar.h"
 #include "widgets/AudacityMessageBox.h"
 #include "widgets/FileHistory.h"
+#include "widgets/ProgressDialog.h"
 #include "widgets/UnwritableLocationErrorDialog.h"
 #include "widgets/Warning.h"
 #include "widgets/wxPanelWrapper.h"
@@ -270,6 +277,71 @@ private:
 };
 #endif
 
+bool ProjectFileManager::CopyReferencedAudio()
+{
+   auto &project = mProject;
+   auto &tracks = TrackList::Get(project);
+   auto &undoManager = UndoManager::Get(project);
+
+   // Find such blocks in the tracks and in all states of the undo history,
+   // which would bring them back.  Those states are never spilled.
+   std::vector<SampleBlock *> references;
+   {
+      SampleBlockIDSet seen;
+      const auto visit = [&](TrackList &list){
+         VisitBlocks(list, [&](SampleBlock &block){
+            if (block.IsReference())
+               references.push_back(&block);
+         }, &seen);
+      };
+      visit(tracks);
+      undoManager.VisitStates([&](const UndoStackElem &elem){
+         if (elem.state.tracks)
+            visit(*elem.state.tracks);
+      }, true);
+   }
+   if (references.empty())
+      return true;
+
+   const auto choice = FileFormatsSaveWithDependenciesSetting.Read();
+   if (choice == wxT("never"))
+      return true;
+   if (choice != wxT("copy")) {
+      if (!mCopyReferencedAudio) {
+         int result = AudacityMessageBox(
+            XO(
+"This project reads audio from other files, which must not be moved, renamed or changed.\n\nCopy that audio into the project, so that it does not depend on those files?"),
+            XO("Save Project"),
+            wxYES_NO | wxCANCEL | wxICON_QUESTION,
+            &GetProjectFrame(project));
+         if (result == wxCANCEL)
+            return false;
+         mCopyReferencedAudio = (result == wxYES);
+      }
+      if (!*mCopyReferencedAudio)
+         return true;
+   }
+
+   /* i18n-hint: This title appears on a dialog that indicates the progress
+      in doing something.*/
+   ProgressDialog progress(XO("Progress"),
+      XO("Copying audio into the project"), pdlgHideStopButton);
+   auto updateResult = ProgressResult::Success;
+   {
+      // Whatever was copied before a cancellation or an exception has new
+      // ids, which the undo history must know
+      auto cleanup = finally([&]{ undoManager.UpdateBlockIds(); });
+      const auto count = references.size();
+      for (size_t done = 0;
+           updateResult == ProgressResult::Success && done < count;) {
+         references[done]->Materialize();
+         updateResult = progress.Update(
+            (wxULongLong_t) ++done, (wxULongLong_t) count);
+      }
+   }
+   return updateResult == ProgressResult::Success;
+}
+
 // Assumes ProjectFileIO::mFileName has been set to the desired path.
 bool ProjectFileManager::DoSave(const FilePath & fileName, const bool fromSaveAs)
 {
@@ -323,6 +395,9 @@ bool ProjectFileManager::DoSave(const FilePath & fileName, const bool fromSaveAs
             return false;
          }
       }
+
+      if (!CopyReferencedAudio())
+         return false;
    }
    // End of confirmations
 
@@ -1346,6 +1421,137 @@ bool ProjectFileManager::Import(
    return true;
 }
 
+namespace {
+using ProgressResult = GenericUI::ProgressResult;
+
+// One of several files imported at once
+struct ImportJob
+{
+   FilePath fileName;
+   // Null if the file must be given to ProjectFileManager::Import()
+   std::unique_ptr<ImportFileHandle> pHandle;
+   // Number of the task in the batch, if there is a handle
+   size_t task{};
+   std::shared_ptr<Tags> pTags;
+   TrackHolders tracks;
+   LabelHolders labels;
+};
+}
+
+void ProjectFileManager::Import(
+   const FilePaths &fileNames, bool addToHistory /* = true */)
+{
+   auto &project = mProject;
+   auto &pool = ThreadPool::Get();
+   const auto nFiles = fileNames.size();
+   const size_t maxJobs = pool.GetNumThreads();
+   if (nFiles < 2 || maxJobs == 0 || !ConcurrentImport.Read()) {
+      for (const auto &fileName : fileNames)
+         Import(fileName, addToHistory);
+      return;
+   }
+
+   auto busy = valueRestorer( project.mbBusyImporting, true );
+   auto *const trackFactory = &WaveTrackFactory::Get( project );
+
+   // Jobs in [attach, next) are started and not yet added to the project.
+   // Workers use them only until they are done.  The batch is destroyed
+   // first, and whether returning or throwing, it waits for the workers.
+   std::vector<std::unique_ptr<ImportJob>> jobs(nFiles);
+   TaskBatch batch;
+   size_t next = 0, attach = 0;
+   const auto isDone = [&]( size_t ii ){
+      return ii < next &&
+         (!jobs[ii]->pHandle || batch.IsDone(jobs[ii]->task));
+   };
+
+   // Add the results of a finished job to the project, as Import() does
+   const auto finish = [&]( ImportJob &job ){
+      if (!job.pHandle) {
+         if (batch.GetVerdict() == ProgressResult::Success)
+            Import(job.fileName, addToHistory);
+         return;
+      }
+      const auto result = batch.GetResult(job.task);
+      // Close the file
+      job.pHandle.reset();
+      if (result != ProgressResult::Success &&
+          result != ProgressResult::Stopped)
+         return;
+
+      auto &tracks = job.tracks;
+      tracks.erase( std::remove_if( tracks.begin(), tracks.end(),
+            std::mem_fn( &TrackHolders::value_type::empty ) ),
+         tracks.end() );
+      if (tracks.empty()) {
+         // Let Importer try the other plugins
+         Import(job.fileName, addToHistory);
+         return;
+      }
+
+      auto newTags = Tags::Get( project ).Duplicate();
+      newTags->Merge( *job.pTags );
+      Tags::Set( project, newTags );
+
+      if (addToHistory)
+         FileHistory::Global().Append(job.fileName);
+
+      // PRL: Undo history is incremented inside this:
+      AddImportedTracks(
+         job.fileName, std::move(tracks), std::move(job.labels));
+   };
+
+   ProgressDialog dialog{
+      XO("Importing %d Files").Format( static_cast<int>(nFiles) ) };
+   while (attach < nFiles) {
+      const bool going = (batch.GetVerdict() == ProgressResult::Success);
+      if (!going && attach == next)
+         break;
+
+      // Start more, but not past a file that needs the main thread
+      while (going && next < nFiles && next - attach < maxJobs &&
+             (next == attach || jobs[next - 1]->pHandle)) {
+         auto pJob = std::make_unique<ImportJob>();
+         auto &job = *pJob;
+         job.fileName = fileNames[next];
+         if (!job.fileName.AfterLast('.').IsSameAs(wxT("aup3"), false))
+            job.pHandle =
+               Importer::Get().OpenForConcurrentImport(project, job.fileName);
+         if (job.pHandle) {
+            // Collect only what the file has, to merge into the project's
+            // tags when its turn comes
+            job.pTags = Tags::Get( project ).Duplicate();
+            job.pTags->Clear();
+            job.task = batch.Post(
+               [&job = job, trackFactory](TaskProgress &progress){
+                  job.pHandle->SetProgress(progress);
+                  return job.pHandle->Import(
+                     trackFactory, job.tracks, job.pTags.get(), job.labels);
+               });
+         }
+         jobs[next++] = std::move(pJob);
+      }
+
+      // Add finished files to the project in the given order
+      while (attach < next && isDone(attach)) {
+         finish(*jobs[attach]);
+         jobs[attach++].reset();
+      }
+
+      double fraction = attach;
+      for (auto ii = attach; ii < next; ++ii)
+         if (jobs[ii]->pHandle)
+            fraction += batch.GetFraction(jobs[ii]->task);
+      const auto result = dialog.Update( fraction / nFiles,
+         Verbatim( wxFileName{ fileNames[std::min(attach, nFiles - 1)] }
+            .GetFullName() ) );
+      if (result != ProgressResult::Success && going)
+         batch.SetVerdict(result);
+
+      batch.Wait(attach < next ? jobs[attach]->task : TaskBatch::NoTask);
+   }
+}
+
 #include "Clipboard.h"
 #include "shuttle/ShuttleGui.h"
 #include "widgets/HelpSystem.h"
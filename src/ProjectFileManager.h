@@ -13,6 +13,7 @@ Paul Licameli split from TenacityProject.h
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "ClientData.h" // to inherit
@@ -102,6 +103,14 @@ public:
    bool Import(const FilePath &fileName,
                bool addToHistory = true);
 
+   //! Import files in the given order, decoding several at once if possible
+   /*! Files whose import plugins allow it are decoded on worker threads,
+    with one progress dialog for all; their tracks are still added, and undo
+    history pushed, one file at a time in the given order.  Other files are
+    given to Import() in turn. */
+   void Import(const FilePaths &fileNames,
+               bool addToHistory = true);
+
    void Compact();
 
    void AddImportedTracks(const FilePath &fileName,
@@ -131,12 +140,21 @@ private:
 
    bool DoSave(const FilePath & fileName, bool fromSaveAs);
 
+   //! Copy into the project the audio that its blocks read from other files,
+   //! if the user prefers that; return false if the user cancels the save
+   /*! May throw, if a file is missing or changed */
+   bool CopyReferencedAudio();
+
    TenacityProject &mProject;
 
    std::shared_ptr<TrackList> mLastSavedTracks;
    
    // Are we currently closing as the result of a menu command?
    bool mMenuClose{ false };
+
+   // Answer of the user, when asked whether to copy audio that the project
+   // reads from other files; not asked again for this project
+   std::optional<bool> mCopyReferencedAudio;
 };
 
 #endif
@@ -241,14 +241,24 @@ public:
             ProjectWindow::Get( *mProject ).HandleResize(); // Adjust scrollers for NEW track sizes.
          } );
 
+         // Import runs of audio files together, so that they may be
+         // decoded concurrently
+         FilePaths batch;
+         const auto importBatch = [&]{
+            ProjectFileManager::Get( *mProject ).Import(batch);
+            batch.clear();
+         };
          for (const auto &name : sortednames) {
 #ifdef USE_MIDI
-            if (FileNames::IsMidi(name))
+            if (FileNames::IsMidi(name)) {
+               importBatch();
                DoImportMIDI( *mProject, name );
+            }
             else
 #endif
-               ProjectFileManager::Get( *mProject ).Import(name);
+               batch.push_back(name);
          }
+         importBatch();
 
          auto &window = ProjectWindow::Get( *mProject );
          window.ZoomAfterImport(nullptr);
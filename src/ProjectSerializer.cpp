@@ -86,6 +86,7 @@ enum FieldTypes
 
 NameMap ProjectSerializer::mNames;
 MemoryStream ProjectSerializer::mDict;
+std::vector<int> ProjectSerializer::mInternedIds;
 
 TranslatableString ProjectSerializer::FailureMessage( const FilePath &/*filePath*/ )
 {
@@ -228,14 +229,25 @@ public:
       mHandlers.pop_back();
    }
 
-   void WriteAttr(const std::string_view& name, std::string value)
+   //! Storage for a decoded string, reusing the capacity of strings of
+   //! earlier tags; it remains valid until the next tag is emitted
+   std::string& NewString()
+   {
+      if (mStringsUsed == mStringsCache.size())
+         mStringsCache.emplace_back();
+
+      return mStringsCache[mStringsUsed++];
+   }
+
+   //! @pre value was given by NewString()
+   void WriteAttr(const std::string_view& name, const std::string& value)
    {
       assert(mInTag);
 
       if (!mInTag)
          return;
 
-      mAttributes.emplace_back(name, CacheString(std::move(value)));
+      mAttributes.emplace_back(name, XMLAttributeValueView(std::string_view(value)));
    }
 
    template <typename T> void WriteAttr(const std::string_view& name, T value)
@@ -248,21 +260,14 @@ public:
       mAttributes.emplace_back(name, XMLAttributeValueView(value));
    }
 
-   void WriteData(std::string value)
+   //! @pre value was given by NewString()
+   void WriteData(const std::string& value)
    {
       if (mInTag)
          EmitStartTag();
 
       if (XMLTagHandler* const handler = mHandlers.back())
-         handler->HandleXMLContent(CacheString(std::move(value)));
-   }
-
-   void WriteRaw(std::string)
-   {
-      // This method is intentionally left empty.
-      // The only data that is serialized by FT_Raw
-      // is the boilerplate code like <?xml > and <!DOCTYPE>
-      // which are ignored
+         handler->HandleXMLContent(value);
    }
 
    bool Finalize()
@@ -302,29 +307,57 @@ private:
          }
       }
 
-      mStringsCache.clear();
+      mStringsUsed = 0;
       mAttributes.clear();
       mInTag = false;
    }
 
-   std::string_view CacheString(std::string string)
-   {
-      mStringsCache.emplace_back(std::move(string));
-      return mStringsCache.back();
-   }
-
    XMLTagHandler* mBaseHandler;
 
    std::vector<XMLTagHandler*> mHandlers;
 
    std::string_view mCurrentTagName;
 
+   // A deque, so that growing it does not move the strings that attribute
+   // views point into
    std::deque<std::string> mStringsCache;
+   size_t mStringsUsed { 0 };
    AttributesList mAttributes;
 
    bool mInTag { false };
 };
 
+// Data buffers of destroyed serializers.  The next document, typically the
+// next autosave, reuses their chunks instead of allocating them again.
+// Buffers of large documents are freed instead, so that the pool never holds
+// more than a few megabytes for the rest of the session.
+std::mutex sBufferPoolMutex;
+std::vector<MemoryStream> sBufferPool;
+constexpr size_t MaxPooledBuffers = 2;
+constexpr size_t MaxPooledBufferSize = 8 * 1024 * 1024;
+
+MemoryStream AcquireBuffer()
+{
+   std::lock_guard<std::mutex> lock(sBufferPoolMutex);
+   if (sBufferPool.empty())
+      return {};
+
+   auto result = std::move(sBufferPool.back());
+   sBufferPool.pop_back();
+   return result;
+}
+
+void ReleaseBuffer(MemoryStream buffer)
+{
+   if (buffer.GetSize() > MaxPooledBufferSize)
+      return;
+   buffer.Reset();
+
+   std::lock_guard<std::mutex> lock(sBufferPoolMutex);
+   if (sBufferPool.size() < MaxPooledBuffers)
+      sBufferPool.push_back(std::move(buffer));
+}
+
 // template<typename BaseCharType>
 // std::string FastStringConvertFromAscii(const BaseCharType* begin, const BaseCharType* end)
 // {
@@ -332,7 +365,7 @@ private:
 // }
 
 template<typename BaseCharType>
-std::string FastStringConvert(const void* bytes, int bytesCount)
+void FastStringConvert(const void* bytes, int bytesCount, std::string& result)
 {
    constexpr int charSize = sizeof(BaseCharType);
 
@@ -346,15 +379,17 @@ std::string FastStringConvert(const void* bytes, int bytesCount)
       [](BaseCharType c)
       { return static_cast<std::make_unsigned_t<BaseCharType>>(c) < 0x7f; });
 
+   // Assignment reuses the capacity of the result
    if (isAscii)
-      return std::string(begin, end);
-   
-   return std::wstring_convert<std::codecvt_utf8<BaseCharType>, BaseCharType>()
-      .to_bytes(begin, end);
+      result.assign(begin, end);
+   else
+      result = std::wstring_convert<
+         std::codecvt_utf8<BaseCharType>, BaseCharType>().to_bytes(begin, end);
 }
 } // namespace
 
 ProjectSerializer::ProjectSerializer(size_t allocSize)
+   : mBuffer{ AcquireBuffer() }
 {
    static std::once_flag flag;
    std::call_once(flag, []{
@@ -372,6 +407,7 @@ ProjectSerializer::ProjectSerializer(size_t allocSize)
 
 ProjectSerializer::~ProjectSerializer()
 {
+   ReleaseBuffer(std::move(mBuffer));
 }
 
 void ProjectSerializer::StartTag(const wxString & name)
@@ -386,12 +422,20 @@ void ProjectSerializer::EndTag(const wxString & name)
    WriteName(name);
 }
 
-void ProjectSerializer::WriteAttr(const wxString & name, const wxChar *value)
+void ProjectSerializer::StartTag(const XMLName & name)
 {
-   WriteAttr(name, wxString(value));
+   mBuffer.AppendByte(FT_StartTag);
+   WriteName(name);
 }
 
-void ProjectSerializer::WriteAttr(const wxString & name, const wxString & value)
+void ProjectSerializer::EndTag(const XMLName & name)
+{
+   mBuffer.AppendByte(FT_EndTag);
+   WriteName(name);
+}
+
+template<typename Name>
+void ProjectSerializer::DoWriteAttr(const Name & name, const wxString & value)
 {
    mBuffer.AppendByte(FT_String);
    WriteName(name);
@@ -401,7 +445,8 @@ void ProjectSerializer::WriteAttr(const wxString & name, const wxString & value)
    mBuffer.AppendData(value.wx_str(), len);
 }
 
-void ProjectSerializer::WriteAttr(const wxString & name, int value)
+template<typename Name>
+void ProjectSerializer::DoWriteAttr(const Name & name, int value)
 {
    mBuffer.AppendByte(FT_Int);
    WriteName(name);
@@ -409,7 +454,8 @@ void ProjectSerializer::WriteAttr(const wxString & name, int value)
    WriteInt( mBuffer, value );
 }
 
-void ProjectSerializer::WriteAttr(const wxString & name, bool value)
+template<typename Name>
+void ProjectSerializer::DoWriteAttr(const Name & name, bool value)
 {
    mBuffer.AppendByte(FT_Bool);
    WriteName(name);
@@ -417,7 +463,8 @@ void ProjectSerializer::WriteAttr(const wxString & name, bool value)
    mBuffer.AppendByte(value);
 }
 
-void ProjectSerializer::WriteAttr(const wxString & name, long value)
+template<typename Name>
+void ProjectSerializer::DoWriteAttr(const Name & name, long value)
 {
    mBuffer.AppendByte(FT_Long);
    WriteName(name);
@@ -425,7 +472,8 @@ void ProjectSerializer::WriteAttr(const wxString & name, long value)
    WriteLong( mBuffer, value );
 }
 
-void ProjectSerializer::WriteAttr(const wxString & name, long long value)
+template<typename Name>
+void ProjectSerializer::DoWriteAttr(const Name & name, long long value)
 {
    mBuffer.AppendByte(FT_LongLong);
    WriteName(name);
@@ -433,7 +481,8 @@ void ProjectSerializer::WriteAttr(const wxString & name, long long value)
    WriteLongLong( mBuffer, value );
 }
 
-void ProjectSerializer::WriteAttr(const wxString & name, size_t value)
+template<typename Name>
+void ProjectSerializer::DoWriteAttr(const Name & name, size_t value)
 {
    mBuffer.AppendByte(FT_SizeT);
    WriteName(name);
@@ -441,7 +490,8 @@ void ProjectSerializer::WriteAttr(const wxString & name, size_t value)
    WriteULong( mBuffer, value );
 }
 
-void ProjectSerializer::WriteAttr(const wxString & name, float value, int digits)
+template<typename Name>
+void ProjectSerializer::DoWriteAttr(const Name & name, float value, int digits)
 {
    mBuffer.AppendByte(FT_Float);
    WriteName(name);
@@ -450,7 +500,8 @@ void ProjectSerializer::WriteAttr(const wxString & name, float value, int digits
    WriteDigits( mBuffer, digits );
 }
 
-void ProjectSerializer::WriteAttr(const wxString & name, double value, int digits)
+template<typename Name>
+void ProjectSerializer::DoWriteAttr(const Name & name, double value, int digits)
 {
    mBuffer.AppendByte(FT_Double);
    WriteName(name);
@@ -459,6 +510,91 @@ void ProjectSerializer::WriteAttr(const wxString & name, double value, int digit
    WriteDigits( mBuffer, digits );
 }
 
+void ProjectSerializer::WriteAttr(const wxString & name, const wxChar *value)
+{
+   WriteAttr(name, wxString(value));
+}
+
+void ProjectSerializer::WriteAttr(const wxString & name, const wxString & value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const wxString & name, int value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const wxString & name, bool value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const wxString & name, long value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const wxString & name, long long value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const wxString & name, size_t value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const wxString & name, float value, int digits)
+{
+   DoWriteAttr(name, value, digits);
+}
+
+void ProjectSerializer::WriteAttr(const wxString & name, double value, int digits)
+{
+   DoWriteAttr(name, value, digits);
+}
+
+void ProjectSerializer::WriteAttr(const XMLName & name, const wxString & value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const XMLName & name, int value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const XMLName & name, bool value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const XMLName & name, long value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const XMLName & name, long long value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const XMLName & name, size_t value)
+{
+   DoWriteAttr(name, value);
+}
+
+void ProjectSerializer::WriteAttr(const XMLName & name, float value, int digits)
+{
+   DoWriteAttr(name, value, digits);
+}
+
+void ProjectSerializer::WriteAttr(const XMLName & name, double value, int digits)
+{
+   DoWriteAttr(name, value, digits);
+}
+
 void ProjectSerializer::WriteData(const wxString & value)
 {
    mBuffer.AppendByte(FT_Data);
@@ -476,7 +612,7 @@ void ProjectSerializer::Write(const wxString & value)
    mBuffer.AppendData(value.wx_str(), len);
 }
 
-void ProjectSerializer::WriteName(const wxString & name)
+unsigned short ProjectSerializer::GetNameId(const wxString & name)
 {
    wxASSERT(name.length() * sizeof(wxStringCharType) <= SHRT_MAX);
    UShort id;
@@ -503,6 +639,26 @@ void ProjectSerializer::WriteName(const wxString & name)
       mDictChanged = true;
    }
 
+   return id;
+}
+
+void ProjectSerializer::WriteName(const wxString & name)
+{
+   WriteUShort( mBuffer, GetNameId(name) );
+}
+
+void ProjectSerializer::WriteName(const XMLName & name)
+{
+   const auto serial = name.GetSerial();
+   if (serial >= mInternedIds.size())
+      mInternedIds.resize(XMLName::Count(), -1);
+
+   auto &id = mInternedIds[serial];
+   if (id < 0)
+      // First use of the name in this run.  It may have been written by
+      // another overload already, so share the dictionary entry
+      id = GetNameId(wxString::FromUTF8(name.Get(), name.Length()));
+
    WriteUShort( mBuffer, id );
 }
 
@@ -556,9 +712,11 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
    int64_t stringsCount = 0;
    int64_t stringsLength = 0;
 
-   auto ReadString = [&mCharSize, &in, &bytes, &stringsCount, &stringsLength](int len) -> std::string
+   // Strings are decoded into storage reused from earlier strings, so that
+   // the steady state of decoding does not allocate for each attribute
+   auto ReadString = [&mCharSize, &in, &bytes, &stringsCount, &stringsLength](int len, std::string& result)
    {
-      bytes.reserve( len );
+      bytes.resize( len );
       auto data = bytes.data();
       in.Read( data, len );
 
@@ -568,22 +726,27 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
       switch (mCharSize)
       {
          case 1:
-            return std::string(bytes.data(), len);
+            result.assign(bytes.data(), len);
+            return;
 
          case 2:
-            return FastStringConvert<char16_t>(bytes.data(), len);
+            FastStringConvert<char16_t>(bytes.data(), len, result);
+            return;
 
          case 4:
-            return FastStringConvert<char32_t>(bytes.data(), len);
+            FastStringConvert<char32_t>(bytes.data(), len, result);
+            return;
 
          default:
             wxASSERT_MSG(false, wxT("Characters size not 1, 2, or 4"));
          break;
       }
 
-      return {};
+      result.clear();
    };
 
+   std::string raw;
+
    try
    {
       while (!in.Eof())
@@ -610,7 +773,7 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             {
                id = ReadUShort( in );
                auto len = ReadUShort( in );
-               mIds[id] = ReadString(len);
+               ReadString(len, mIds[id]);
             }
             break;
 
@@ -634,8 +797,10 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             {
                id = ReadUShort( in );
                int len = ReadLength( in );
-               
-               adapter.WriteAttr(Lookup(id), ReadString(len));
+
+               auto& value = adapter.NewString();
+               ReadString(len, value);
+               adapter.WriteAttr(Lookup(id), value);
             }
             break;
 
@@ -712,14 +877,20 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
             case FT_Data:
             {
                int len = ReadLength( in );
-               adapter.WriteData(ReadString(len));
+
+               auto& value = adapter.NewString();
+               ReadString(len, value);
+               adapter.WriteData(value);
             }
             break;
 
             case FT_Raw:
             {
+               // The only data that is serialized by FT_Raw
+               // is the boilerplate code like <?xml > and <!DOCTYPE>
+               // which are ignored
                int len = ReadLength( in );
-               adapter.WriteRaw(ReadString(len));
+               ReadString(len, raw);
             }
             break;
 
@@ -20,6 +20,7 @@
 
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 
 #include "SampleBlock.h"
 
@@ -55,6 +56,19 @@ public:
    void WriteAttr(const wxString & name, float value, int digits = -1) override;
    void WriteAttr(const wxString & name, double value, int digits = -1) override;
 
+   void StartTag(const XMLName & name) override;
+   void EndTag(const XMLName & name) override;
+
+   void WriteAttr(const XMLName & name, const wxString &value) override;
+
+   void WriteAttr(const XMLName & name, int value) override;
+   void WriteAttr(const XMLName & name, bool value) override;
+   void WriteAttr(const XMLName & name, long value) override;
+   void WriteAttr(const XMLName & name, long long value) override;
+   void WriteAttr(const XMLName & name, size_t value) override;
+   void WriteAttr(const XMLName & name, float value, int digits = -1) override;
+   void WriteAttr(const XMLName & name, double value, int digits = -1) override;
+
    void WriteData(const wxString & value) override;
    void Write(const wxString & data) override;
 
@@ -68,7 +82,18 @@ public:
    static bool Decode(BufferedStreamReader& in, XMLTagHandler* handler);
 
 private:
+   template<typename Name> void DoWriteAttr(const Name& name, const wxString &value);
+   template<typename Name> void DoWriteAttr(const Name& name, int value);
+   template<typename Name> void DoWriteAttr(const Name& name, bool value);
+   template<typename Name> void DoWriteAttr(const Name& name, long value);
+   template<typename Name> void DoWriteAttr(const Name& name, long long value);
+   template<typename Name> void DoWriteAttr(const Name& name, size_t value);
+   template<typename Name> void DoWriteAttr(const Name& name, float value, int digits);
+   template<typename Name> void DoWriteAttr(const Name& name, double value, int digits);
+
+   unsigned short GetNameId(const wxString& name);
    void WriteName(const wxString& name);
+   void WriteName(const XMLName& name);
 
 private:
    MemoryStream mBuffer;
@@ -76,6 +101,10 @@ private:
 
    static NameMap mNames;
    static MemoryStream mDict;
+
+   // Dictionary ids of interned names, indexed by XMLName::GetSerial(),
+   // or -1 for those not yet used
+   static std::vector<int> mInternedIds;
 };
 
 #endif
@@ -0,0 +1,195 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file ReferencedAudioFile.cpp
+
+**********************************************************************/
+#include "ReferencedAudioFile.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <wx/file.h>
+#include <wx/filefn.h>
+#include <wx/log.h>
+
+// Tenacity libraries
+#include <lib-exceptions/TenacityException.h>
+#include <lib-math/Dither.h>
+
+namespace {
+
+// Enough to tell apart most files that were rewritten with the same size
+constexpr size_t HashedBytes = 64 * 1024;
+
+// Bound the buffer for reading files of many channels
+constexpr size_t FramesPerRead = 64 * 1024;
+
+// Formats whose frames libsndfile can find without decoding from the start
+bool IsSeekable(const SF_INFO &info)
+{
+   if (!info.seekable)
+      return false;
+   switch (info.format & SF_FORMAT_TYPEMASK) {
+   case SF_FORMAT_WAV:
+   case SF_FORMAT_WAVEX:
+   case SF_FORMAT_RF64:
+   case SF_FORMAT_W64:
+   case SF_FORMAT_AIFF:
+   case SF_FORMAT_CAF:
+   case SF_FORMAT_AU:
+   case SF_FORMAT_FLAC:
+      return true;
+   default:
+      return false;
+   }
+}
+
+[[noreturn]] void ThrowMissing(const FilePath &path)
+{
+   throw SimpleMessageBoxException{
+      ExceptionType::BadEnvironment,
+      XO("The audio file\n%s\nwhich this project reads is missing or has changed.")
+         .Format(path),
+      XO("Warning")
+   };
+}
+
+[[noreturn]] void ThrowReadFailure(const FilePath &path)
+{
+   throw SimpleMessageBoxException{
+      ExceptionType::BadEnvironment,
+      XO("Could not read from the audio file\n%s").Format(path),
+      XO("Warning")
+   };
+}
+
+}
+
+std::shared_ptr<ReferencedAudioFile>
+ReferencedAudioFile::Open(const FilePath &path)
+{
+   Identity identity;
+   if (!Examine(path, identity))
+      return nullptr;
+
+   auto result = std::make_shared<ReferencedAudioFile>(std::move(identity));
+   try {
+      std::lock_guard<std::mutex> lock{ result->mMutex };
+      result->Verify();
+      if (!IsSeekable(result->mInfo))
+         return nullptr;
+   }
+   catch (const TenacityException &) {
+      return nullptr;
+   }
+   return result;
+}
+
+ReferencedAudioFile::ReferencedAudioFile(Identity identity)
+   : mIdentity{ std::move(identity) }
+{
+}
+
+ReferencedAudioFile::~ReferencedAudioFile() = default;
+
+bool ReferencedAudioFile::Examine(const FilePath &path, Identity &identity)
+{
+   wxFile file;
+   if (!wxFile::Exists(path) || !file.Open(path))
+      return false;
+
+   identity.path = path;
+   identity.size = file.Length();
+   identity.modified = wxFileModificationTime(path);
+
+   std::vector<unsigned char> bytes(HashedBytes);
+   const auto count = file.Read(bytes.data(), bytes.size());
+   if (count == wxInvalidOffset)
+      return false;
+
+   // FNV-1a
+   unsigned long long hash = 14695981039346656037ULL;
+   for (ssize_t ii = 0; ii < count; ++ii) {
+      hash ^= bytes[ii];
+      hash *= 1099511628211ULL;
+   }
+   identity.hash = static_cast<long long>(hash);
+   return true;
+}
+
+void ReferencedAudioFile::Verify()
+{
+   if (mVerified)
+      return;
+
+   // Don't examine a missing or changed file again at every read
+   if (!mFailed) {
+      Identity found;
+      if (Examine(mIdentity.path, found) &&
+          found.size == mIdentity.size &&
+          found.modified == mIdentity.modified &&
+          found.hash == mIdentity.hash) {
+         wxFile f;
+         // As in PCMImportPlugin::Open, use a descriptor, because wxWidgets
+         // can open a file with a Unicode name and libsndfile can't
+         if (f.Open(mIdentity.path))
+            mFile.reset(
+               SFCall<SNDFILE*>(sf_open_fd, f.fd(), SFM_READ, &mInfo, TRUE));
+         // The descriptor now belongs to mFile, if anything
+         f.Detach();
+         mVerified = mFile && mInfo.channels > 0;
+      }
+      if (!mVerified) {
+         wxLogDebug(wxT("Referenced audio file %s is missing or changed"),
+            mIdentity.path);
+         mFile.reset();
+         mFailed = true;
+      }
+   }
+   if (mFailed)
+      ThrowMissing(mIdentity.path);
+}
+
+void ReferencedAudioFile::Read(unsigned channel, sampleCount start,
+   samplePtr dest, sampleFormat format, size_t len)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   Verify();
+
+   const auto nChannels = static_cast<unsigned>(mInfo.channels);
+   if (channel >= nChannels || start < 0 ||
+       start + len > sampleCount{ mInfo.frames })
+      ThrowReadFailure(mIdentity.path);
+   if (len == 0)
+      return;
+
+   if (SFCall<sf_count_t>(sf_seek, mFile.get(),
+         start.as_long_long(), SEEK_SET) < 0)
+      ThrowReadFailure(mIdentity.path);
+
+   // Read 16 bit samples as such, and all others as float, as
+   // PCMImportFileHandle does
+   const auto readFormat =
+      (format == int16Sample) ? int16Sample : floatSample;
+   const auto frames = std::min(len, FramesPerRead);
+   SampleBuffer buffer{ frames * nChannels, readFormat };
+   const auto size = SAMPLE_SIZE(readFormat);
+   while (len > 0) {
+      const auto block = std::min(len, frames);
+      const auto got = (readFormat == int16Sample)
+         ? SFCall<sf_count_t>(sf_readf_short, mFile.get(),
+            reinterpret_cast<short *>(buffer.ptr()), block)
+         : SFCall<sf_count_t>(sf_readf_float, mFile.get(),
+            reinterpret_cast<float *>(buffer.ptr()), block);
+      if (got != static_cast<sf_count_t>(block))
+         ThrowReadFailure(mIdentity.path);
+
+      // Deinterleave
+      CopySamples(buffer.ptr() + channel * size, readFormat,
+         dest, format, block, DitherType::none, nChannels);
+      dest += block * SAMPLE_SIZE(format);
+      len -= block;
+   }
+}
@@ -0,0 +1,73 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file ReferencedAudioFile.h
+  @brief An audio file outside the project, from which sample blocks read
+
+**********************************************************************/
+#ifndef __TENACITY_REFERENCED_AUDIO_FILE__
+#define __TENACITY_REFERENCED_AUDIO_FILE__
+
+#include <memory>
+#include <mutex>
+
+// Tenacity libraries
+#include <lib-math/SampleCount.h>
+
+#include "FileFormats.h"
+
+//! An audio file that sample blocks read on demand, instead of copying it
+/*!
+ The file is identified by its path, and must still have the size, the
+ modification time and the hash of its beginning that it had when first
+ referenced; otherwise reading fails, as it also does if the file is missing.
+ The check happens only once, at the first read.
+
+ Reading uses libsndfile and may happen in any thread.
+ */
+class TENACITY_DLL_API ReferencedAudioFile final
+{
+public:
+   struct Identity {
+      FilePath path;
+      long long size{ 0 };
+      long long modified{ 0 };
+      long long hash{ 0 };
+   };
+
+   //! Examine a file now, for new references to it
+   /*! @return null if the file can't be read, or libsndfile can't seek in
+    it quickly */
+   static std::shared_ptr<ReferencedAudioFile> Open(const FilePath &path);
+
+   //! For references restored from a project, to be verified when first read
+   explicit ReferencedAudioFile(Identity identity);
+   ~ReferencedAudioFile();
+
+   const Identity &GetIdentity() const { return mIdentity; }
+
+   //! Meaningful only for a file returned by Open()
+   unsigned GetChannels() const { return mInfo.channels; }
+   //! Meaningful only for a file returned by Open()
+   sampleCount GetFrames() const { return mInfo.frames; }
+
+   //! Read len frames of one channel, converting to format; may throw
+   void Read(unsigned channel, sampleCount start,
+      samplePtr dest, sampleFormat format, size_t len);
+
+private:
+   static bool Examine(const FilePath &path, Identity &identity);
+   //! Open mFile, if mIdentity still describes the file; may throw
+   void Verify();
+
+   const Identity mIdentity;
+
+   std::mutex mMutex;
+   SFFile mFile;
+   SF_INFO mInfo{};
+   bool mVerified{ false };
+   bool mFailed{ false };
+};
+
+#endif
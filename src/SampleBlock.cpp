@@ -8,6 +8,7 @@ SampleBlock.cpp
 
 // Tenacity libraries
 #include <lib-exceptions/InconsistencyException.h>
+#include <lib-math/SampleCount.h>
 #include <lib-math/SampleFormat.h>
 
 #include "SampleBlock.h"
@@ -54,8 +55,41 @@ SampleBlockPtr SampleBlockFactory::CreateFromXML(
    return result;
 }
 
+SampleBlockPtr SampleBlockFactory::CreateReference(
+   const std::shared_ptr<ReferencedAudioFile> &, unsigned,
+   sampleCount, size_t, sampleFormat)
+{
+   return nullptr;
+}
+
+void SampleBlockFactory::BeginBulkLoad()
+{
+}
+
+void SampleBlockFactory::EndBulkLoad()
+{
+}
+
+bool SampleBlockFactory::RetainBlocks(const std::vector<SampleBlockID> &)
+{
+   return false;
+}
+
+void SampleBlockFactory::ReleaseBlocks(const std::vector<SampleBlockID> &)
+{
+}
+
 SampleBlock::~SampleBlock() = default;
 
+bool SampleBlock::IsReference() const
+{
+   return false;
+}
+
+void SampleBlock::Materialize()
+{
+}
+
 size_t SampleBlock::GetSamples(samplePtr dest,
                    sampleFormat destformat,
                    size_t sampleoffset,
@@ -16,11 +16,14 @@ SampleBlock.h
 #include <functional>
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "XMLTagHandler.h"
 
 class TenacityProject;
 class ProjectFileIO;
+class ReferencedAudioFile;
+class sampleCount;
 class XMLWriter;
 
 class SampleBlock;
@@ -81,6 +84,15 @@ public:
 
    virtual void SaveXML(XMLWriter &xmlFile) = 0;
 
+   //! Whether the samples are read from a file outside the project
+   /*! The default is false */
+   virtual bool IsReference() const;
+
+   //! Copy samples that are read from elsewhere into the project
+   /*! Afterward IsReference() is false, and the block id may differ.  The
+    default does nothing.  May throw. */
+   virtual void Materialize();
+
 protected:
    virtual size_t DoGetSamples(samplePtr dest,
                      sampleFormat destformat,
@@ -125,6 +137,15 @@ public:
       size_t numsamples,
       sampleFormat srcformat);
 
+   //! Make a block that reads one channel of a range of an outside file
+   /*! It reads the file only when its samples or summaries are needed, and
+    until Materialize() is called, that file must not change.
+    Returns null if the factory does not support this; the default does not.
+    */
+   virtual SampleBlockPtr CreateReference(
+      const std::shared_ptr<ReferencedAudioFile> &pFile, unsigned channel,
+      sampleCount start, size_t numsamples, sampleFormat format);
+
    // Returns a non-null pointer or else throws an exception
    SampleBlockPtr CreateFromXML(
       sampleFormat srcformat,
@@ -141,6 +162,26 @@ public:
    virtual BlockDeletionCallback SetBlockDeletionCallback(
       BlockDeletionCallback callback ) = 0;
 
+   //! Hint that many blocks are about to be made by CreateFromXML
+   /*! An implementation may use this to fetch the metadata of all stored
+    blocks at once, rather than one block at a time.  The default does
+    nothing. */
+   virtual void BeginBulkLoad();
+
+   //! Withdraw the hint given by BeginBulkLoad() and release what it cached
+   virtual void EndBulkLoad();
+
+   //! Keep the stored samples of blocks after their objects are destroyed
+   /*! So that states of the undo history need not stay in memory to keep
+    their blocks.  Retention of an id lasts until as many calls of
+    ReleaseBlocks() with it.
+    @return false if the factory can't do this, as the default can't */
+   virtual bool RetainBlocks(const std::vector<SampleBlockID> &ids);
+
+   //! Withdraw RetainBlocks(), deleting the stored samples of each block no
+   //! longer retained, unless an object of the block still exists
+   virtual void ReleaseBlocks(const std::vector<SampleBlockID> &ids);
+
 protected:
    // The override should throw more informative exceptions on error than the
    // default InconsistencyException thrown by Create
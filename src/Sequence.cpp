@@ -68,13 +68,27 @@ Sequence::Sequence(
    mMinSamples(orig.mMinSamples),
    mMaxSamples(orig.mMaxSamples)
 {
-   Paste(0, &orig);
+   if (pFactory == orig.mpFactory) {
+      // Share the array of blocks; either sequence copies it only when next
+      // modified.  This makes duplication of tracks for the undo history cheap.
+      mpBlocks = orig.mpBlocks;
+      mNumSamples = orig.mNumSamples;
+   }
+   else
+      Paste(0, &orig);
 }
 
 Sequence::~Sequence()
 {
 }
 
+BlockArray &Sequence::MutableBlocks()
+{
+   if (mpBlocks.use_count() > 1)
+      mpBlocks = std::make_shared<BlockArray>(*mpBlocks);
+   return *mpBlocks;
+}
+
 size_t Sequence::GetMaxBlockSize() const
 {
    return mMaxSamples;
@@ -87,8 +101,9 @@ size_t Sequence::GetIdealBlockSize() const
 
 bool Sequence::CloseLock()
 {
-   for (unsigned int i = 0; i < mBlock.size(); i++)
-      mBlock[i].sb->CloseLock();
+   const auto &blocks = Blocks();
+   for (unsigned int i = 0; i < blocks.size(); i++)
+      blocks[i].sb->CloseLock();
 
    return true;
 }
@@ -101,7 +116,7 @@ sampleFormat Sequence::GetSampleFormat() const
 /*
 bool Sequence::SetSampleFormat(sampleFormat format)
 {
-   if (mBlock.size() > 0 || mNumSamples > 0)
+   if (Blocks().size() > 0 || mNumSamples > 0)
       return false;
 
    mSampleFormat = format;
@@ -138,11 +153,12 @@ namespace {
 bool Sequence::ConvertToSampleFormat(sampleFormat format,
    const std::function<void(size_t)> & progressReport)
 {
+   const auto &blocks = Blocks();
    if (format == mSampleFormat)
       // no change
       return false;
 
-   if (mBlock.size() == 0)
+   if (blocks.size() == 0)
    {
       mSampleFormat = format;
       return true;
@@ -170,7 +186,7 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
    // Use the ratio of old to NEW mMaxSamples to make a reasonable guess
    // at allocation.
    newBlockArray.reserve
-      (1 + mBlock.size() * ((float)oldMaxSamples / (float)mMaxSamples));
+      (1 + blocks.size() * ((float)oldMaxSamples / (float)mMaxSamples));
 
    {
       size_t oldSize = oldMaxSamples;
@@ -178,9 +194,9 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
       size_t newSize = oldMaxSamples;
       SampleBuffer bufferNew(newSize, format);
 
-      for (size_t i = 0, nn = mBlock.size(); i < nn; i++)
+      for (size_t i = 0, nn = blocks.size(); i < nn; i++)
       {
-         SeqBlock &oldSeqBlock = mBlock[i];
+         const SeqBlock &oldSeqBlock = blocks[i];
          const auto &oldBlockFile = oldSeqBlock.sb;
          const auto len = oldBlockFile->GetSampleCount();
          ensureSampleBufferSize(bufferOld, oldFormat, oldSize, len);
@@ -224,7 +240,8 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
 std::pair<float, float> Sequence::GetMinMax(
    sampleCount start, sampleCount len, bool mayThrow) const
 {
-   if (len == 0 || mBlock.size() == 0) {
+   const auto &blocks = Blocks();
+   if (len == 0 || blocks.size() == 0) {
       return {
          0.f,
          // FLT_MAX?  So it doesn't look like a spurious '0' to a caller?
@@ -245,7 +262,7 @@ std::pair<float, float> Sequence::GetMinMax(
    // already in memory.
 
    for (unsigned b = block0 + 1; b < block1; ++b) {
-      auto results = mBlock[b].sb->GetMinMaxRMS(mayThrow);
+      auto results = blocks[b].sb->GetMinMaxRMS(mayThrow);
 
       if (results.min < min)
          min = results.min;
@@ -258,7 +275,7 @@ std::pair<float, float> Sequence::GetMinMax(
    // of either of these blocks is within min...max, then we can ignore them.
    // If not, we need read some samples and summaries from disk.
    {
-      const SeqBlock &theBlock = mBlock[block0];
+      const SeqBlock &theBlock = blocks[block0];
       const auto &theFile = theBlock.sb;
       auto results = theFile->GetMinMaxRMS(mayThrow);
 
@@ -282,7 +299,7 @@ std::pair<float, float> Sequence::GetMinMax(
 
    if (block1 > block0)
    {
-      const SeqBlock &theBlock = mBlock[block1];
+      const SeqBlock &theBlock = blocks[block1];
       const auto &theFile = theBlock.sb;
       auto results = theFile->GetMinMaxRMS(mayThrow);
 
@@ -305,9 +322,10 @@ std::pair<float, float> Sequence::GetMinMax(
 
 float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
 {
+   const auto &blocks = Blocks();
    // len is the number of samples that we want the rms of.
    // it may be longer than a block, and the code is carefully set up to handle that.
-   if (len == 0 || mBlock.size() == 0)
+   if (len == 0 || blocks.size() == 0)
       return 0.f;
 
    double sumsq = 0.0;
@@ -320,7 +338,7 @@ float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
    // this is very fast because we have the rms of every entire block
    // already in memory.
    for (unsigned b = block0 + 1; b < block1; b++) {
-      const SeqBlock &theBlock = mBlock[b];
+      const SeqBlock &theBlock = blocks[b];
       const auto &sb = theBlock.sb;
       auto results = sb->GetMinMaxRMS(mayThrow);
 
@@ -334,7 +352,7 @@ float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
    // selection may only partly overlap these blocks.
    // If not, we need read some samples and summaries from disk.
    {
-      const SeqBlock &theBlock = mBlock[block0];
+      const SeqBlock &theBlock = blocks[block0];
       const auto &sb = theBlock.sb;
       // start lies within theBlock
       auto s0 = ( start - theBlock.start ).as_size_t();
@@ -351,7 +369,7 @@ float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
    }
 
    if (block1 > block0) {
-      const SeqBlock &theBlock = mBlock[block1];
+      const SeqBlock &theBlock = blocks[block1];
       const auto &sb = theBlock.sb;
 
       // start + len - 1 lies within theBlock
@@ -375,6 +393,7 @@ float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
 std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
    sampleCount s0, sampleCount s1) const
 {
+   const auto &blocks = Blocks();
    // Make a new Sequence object for the specified factory:
    auto dest = std::make_unique<Sequence>(pFactory, mSampleFormat);
    if (s0 >= s1 || s0 >= mNumSamples || s1 < 0) {
@@ -385,7 +404,7 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
    // contents are used -- must copy if factories are different:
    auto pUseFactory = (pFactory == mpFactory) ? nullptr : pFactory.get();
 
-   [[maybe_unused]] int numBlocks = mBlock.size();
+   [[maybe_unused]] int numBlocks = blocks.size();
 
    int b0 = FindBlock(s0);
    const int b1 = FindBlock(s1 - 1);
@@ -394,7 +413,7 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
    wxASSERT(b1 < numBlocks);
    wxASSERT(b0 <= b1);
 
-   dest->mBlock.reserve(b1 - b0 + 1);
+   dest->MutableBlocks().reserve(b1 - b0 + 1);
 
    auto bufferSize = mMaxSamples;
    SampleBuffer buffer(bufferSize, mSampleFormat);
@@ -403,7 +422,7 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
 
    // Do any initial partial block
 
-   const SeqBlock &block0 = mBlock[b0];
+   const SeqBlock &block0 = blocks[b0];
    if (s0 != block0.start) {
       const auto &sb = block0.sb;
       // Nonnegative result is length of block0 or less:
@@ -421,13 +440,13 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
    // If there are blocks in the middle, use the blocks whole
    for (int bb = b0 + 1; bb < b1; ++bb)
       AppendBlock(pUseFactory, mSampleFormat,
-         dest->mBlock, dest->mNumSamples, mBlock[bb]);
+         dest->MutableBlocks(), dest->mNumSamples, blocks[bb]);
       // Increase ref count or duplicate file
 
    // Do the last block
    if (b1 > b0) {
       // Probable case of a partial block
-      const SeqBlock &block = mBlock[b1];
+      const SeqBlock &block = blocks[b1];
       const auto &sb = block.sb;
       // s1 is within block:
       blocklen = (s1 - block.start).as_size_t();
@@ -440,7 +459,7 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
       else
          // Special case of a whole block
          AppendBlock(pUseFactory, mSampleFormat,
-            dest->mBlock, dest->mNumSamples, block);
+            dest->MutableBlocks(), dest->mNumSamples, block);
          // Increase ref count or duplicate file
    }
 
@@ -475,6 +494,7 @@ namespace {
 /*! @excsafety{Strong} */
 void Sequence::Paste(sampleCount s, const Sequence *src)
 {
+   const auto &blocks = Blocks();
    if ((s < 0) || (s > mNumSamples))
    {
       wxLogError(
@@ -505,7 +525,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       THROW_INCONSISTENCY_EXCEPTION;
    }
 
-   const BlockArray &srcBlock = src->mBlock;
+   const BlockArray &srcBlock = src->Blocks();
    auto addedLen = src->mNumSamples;
    const unsigned int srcNumBlocks = srcBlock.size();
    auto sampleSize = SAMPLE_SIZE(mSampleFormat);
@@ -513,7 +533,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
    if (addedLen == 0 || srcNumBlocks == 0)
       return;
 
-   const size_t numBlocks = mBlock.size();
+   const size_t numBlocks = blocks.size();
 
    // Decide whether to share sample blocks or make new copies, when whole block
    // contents are used -- must copy if factories are different:
@@ -521,13 +541,13 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       (src->mpFactory == mpFactory) ? nullptr : mpFactory.get();
 
    if (numBlocks == 0 ||
-       (s == mNumSamples && mBlock.back().sb->GetSampleCount() >= mMinSamples)) {
+       (s == mNumSamples && blocks.back().sb->GetSampleCount() >= mMinSamples)) {
       // Special case: this track is currently empty, or it's safe to append
       // onto the end because the current last block is longer than the
       // minimum size
 
       // Build and swap a copy so there is a strong exception safety guarantee
-      BlockArray newBlock{ mBlock };
+      BlockArray newBlock{ blocks };
       sampleCount samples = mNumSamples;
       for (unsigned int i = 0; i < srcNumBlocks; i++)
          // AppendBlock may throw for limited disk space, if pasting from
@@ -540,9 +560,9 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       return;
    }
 
-   const int b = (s == mNumSamples) ? mBlock.size() - 1 : FindBlock(s);
+   const int b = (s == mNumSamples) ? blocks.size() - 1 : FindBlock(s);
    wxASSERT((b >= 0) && (b < (int)numBlocks));
-   SeqBlock *const pBlock = &mBlock[b];
+   const SeqBlock *const pBlock = &blocks[b];
    const auto length = pBlock->sb->GetSampleCount();
    const auto largerBlockLen = addedLen + length;
    // PRL: when insertion point is the first sample of a block,
@@ -552,7 +572,10 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       // Special case: we can fit all of the NEW samples inside of
       // one block!
 
-      SeqBlock &block = *pBlock;
+      // The array may be shared with an undo state; copy it before
+      // modifying one block in place
+      auto &newBlocks = MutableBlocks();
+      SeqBlock &block = newBlocks[b];
       // largerBlockLen is not more than mMaxSamples...
       SampleBuffer buffer(largerBlockLen.as_size_t(), mSampleFormat);
 
@@ -578,7 +601,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
 
       // use No-fail-guarantee in remaining steps
       for (unsigned int i = b + 1; i < numBlocks; i++)
-         mBlock[i].start += addedLen;
+         newBlocks[i].start += addedLen;
 
       mNumSamples += addedLen;
 
@@ -594,9 +617,9 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
    // then resplit it all
    BlockArray newBlock;
    newBlock.reserve(numBlocks + srcNumBlocks + 2);
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b);
+   newBlock.insert(newBlock.end(), blocks.begin(), blocks.begin() + b);
 
-   SeqBlock &splitBlock = mBlock[b];
+   const SeqBlock &splitBlock = blocks[b];
    auto splitLen = splitBlock.sb->GetSampleCount();
    // s lies within splitBlock
    auto splitPoint = ( s - splitBlock.start ).as_size_t();
@@ -667,7 +690,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
    // Copy remaining blocks to NEW block array and
    // swap the NEW block array in for the old
    for (i = b + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(addedLen));
+      newBlock.push_back(blocks[i].Plus(addedLen));
 
    CommitChangesIfConsistent
       (newBlock, mNumSamples + addedLen, wxT("Paste branch three"));
@@ -703,14 +726,14 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
    // Could nBlocks overflow a size_t?  Not very likely.  You need perhaps
    // 2 ^ 52 samples which is over 3000 years at 44.1 kHz.
    auto nBlocks = (len + idealSamples - 1) / idealSamples;
-   sTrack.mBlock.reserve(nBlocks.as_size_t());
+   sTrack.MutableBlocks().reserve(nBlocks.as_size_t());
 
    if (len >= idealSamples) {
       auto silentFile = factory.CreateSilent(
          idealSamples,
          mSampleFormat);
       while (len >= idealSamples) {
-         sTrack.mBlock.push_back(SeqBlock(silentFile, pos));
+         sTrack.MutableBlocks().push_back(SeqBlock(silentFile, pos));
 
          pos += idealSamples;
          len -= idealSamples;
@@ -718,7 +741,7 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
    }
    if (len != 0) {
       // len is not more than idealSamples:
-      sTrack.mBlock.push_back(SeqBlock(
+      sTrack.MutableBlocks().push_back(SeqBlock(
          factory.CreateSilent(len.as_size_t(), mSampleFormat), pos));
       pos += len;
    }
@@ -750,12 +773,14 @@ void Sequence::AppendBlock( SampleBlockFactory *pFactory, sampleFormat format,
 
 sampleCount Sequence::GetBlockStart(sampleCount position) const
 {
+   const auto &blocks = Blocks();
    int b = FindBlock(position);
-   return mBlock[b].start;
+   return blocks[b].start;
 }
 
 size_t Sequence::GetBestBlockSize(sampleCount start) const
 {
+   const auto &blocks = Blocks();
    // This method returns a nice number of samples you should try to grab in
    // one big chunk in order to land on a block boundary, based on the starting
    // sample.  The value returned will always be nonzero and will be no larger
@@ -765,15 +790,15 @@ size_t Sequence::GetBestBlockSize(sampleCount start) const
       return mMaxSamples;
 
    int b = FindBlock(start);
-   int numBlocks = mBlock.size();
+   int numBlocks = blocks.size();
 
-   const SeqBlock &block = mBlock[b];
+   const SeqBlock &block = blocks[b];
    // start is in block:
    auto result = (block.start + block.sb->GetSampleCount() - start).as_size_t();
 
    decltype(result) length;
    while(result < mMinSamples && b+1<numBlocks &&
-         ((length = mBlock[b+1].sb->GetSampleCount()) + result) <= mMaxSamples) {
+         ((length = blocks[b+1].sb->GetSampleCount()) + result) <= mMaxSamples) {
       b++;
       result += length;
    }
@@ -821,7 +846,7 @@ bool Sequence::HandleXMLTag(const std::string_view& tag, const AttributesList &a
          }
       }
 
-      mBlock.push_back(wb);
+      MutableBlocks().push_back(wb);
 
       return true;
    }
@@ -895,13 +920,15 @@ void Sequence::HandleXMLEndTag(const std::string_view& tag)
       return;
    }
 
+   auto &blocks = MutableBlocks();
+
    // Make sure that the sequence is valid.
 
    // Make sure that start times and lengths are consistent
    sampleCount numSamples = 0;
-   for (unsigned b = 0, nn = mBlock.size(); b < nn;  b++)
+   for (unsigned b = 0, nn = blocks.size(); b < nn;  b++)
    {
-      SeqBlock &block = mBlock[b];
+      SeqBlock &block = blocks[b];
       if (block.start != numSamples)
       {
          wxLogWarning(
@@ -940,20 +967,29 @@ XMLTagHandler *Sequence::HandleXMLChild(const std::string_view& tag)
    return nullptr;
 }
 
+// Names written for every clip and block of every track are interned
+static const XMLName SequenceTag{ "sequence" };
+static const XMLName MaxSamplesAttr{ "maxsamples" };
+static const XMLName SampleFormatAttr{ "sampleformat" };
+static const XMLName NumSamplesAttr{ "numsamples" };
+static const XMLName WaveBlockTag{ "waveblock" };
+static const XMLName StartAttr{ "start" };
+
 // Throws exceptions rather than reporting errors.
 void Sequence::WriteXML(XMLWriter &xmlFile) const
 // may throw
 {
+   const auto &blocks = Blocks();
    unsigned int b;
 
-   xmlFile.StartTag(wxT("sequence"));
+   xmlFile.StartTag(SequenceTag);
 
-   xmlFile.WriteAttr(wxT("maxsamples"), mMaxSamples);
-   xmlFile.WriteAttr(wxT("sampleformat"), (size_t)mSampleFormat);
-   xmlFile.WriteAttr(wxT("numsamples"), mNumSamples.as_long_long() );
+   xmlFile.WriteAttr(MaxSamplesAttr, mMaxSamples);
+   xmlFile.WriteAttr(SampleFormatAttr, (size_t)mSampleFormat);
+   xmlFile.WriteAttr(NumSamplesAttr, mNumSamples.as_long_long() );
 
-   for (b = 0; b < mBlock.size(); b++) {
-      const SeqBlock &bb = mBlock[b];
+   for (b = 0; b < blocks.size(); b++) {
+      const SeqBlock &bb = blocks[b];
 
       // See http://bugzilla.audacityteam.org/show_bug.cgi?id=451.
       if (bb.sb->GetSampleCount() > mMaxSamples)
@@ -977,25 +1013,26 @@ void Sequence::WriteXML(XMLWriter &xmlFile) const
 //         bb.sb->SetLength(mMaxSamples);
       }
 
-      xmlFile.StartTag(wxT("waveblock"));
-      xmlFile.WriteAttr(wxT("start"), bb.start.as_long_long() );
+      xmlFile.StartTag(WaveBlockTag);
+      xmlFile.WriteAttr(StartAttr, bb.start.as_long_long() );
 
       bb.sb->SaveXML(xmlFile);
 
-      xmlFile.EndTag(wxT("waveblock"));
+      xmlFile.EndTag(WaveBlockTag);
    }
 
-   xmlFile.EndTag(wxT("sequence"));
+   xmlFile.EndTag(SequenceTag);
 }
 
 int Sequence::FindBlock(sampleCount pos) const
 {
+   const auto &blocks = Blocks();
    wxASSERT(pos >= 0 && pos < mNumSamples);
 
    if (pos == 0)
       return 0;
 
-   int numBlocks = mBlock.size();
+   int numBlocks = blocks.size();
 
    size_t lo = 0, hi = numBlocks, guess;
    sampleCount loSamples = 0, hiSamples = mNumSamples;
@@ -1007,7 +1044,7 @@ int Sequence::FindBlock(sampleCount pos) const
       const double frac = (pos - loSamples).as_double() /
          (hiSamples - loSamples).as_double();
       guess = std::min(hi - 1, lo + size_t(frac * (hi - lo)));
-      const SeqBlock &block = mBlock[guess];
+      const SeqBlock &block = blocks[guess];
 
       wxASSERT(block.sb->GetSampleCount() > 0);
       wxASSERT(lo <= guess && guess < hi && lo < hi);
@@ -1031,8 +1068,8 @@ int Sequence::FindBlock(sampleCount pos) const
 
    const int rval = guess;
    wxASSERT(rval >= 0 && rval < numBlocks &&
-            pos >= mBlock[rval].start &&
-            pos < mBlock[rval].start + mBlock[rval].sb->GetSampleCount());
+            pos >= blocks[rval].start &&
+            pos < blocks[rval].start + blocks[rval].sb->GetSampleCount());
 
    return rval;
 }
@@ -1080,9 +1117,10 @@ bool Sequence::Get(samplePtr buffer, sampleFormat format,
 bool Sequence::Get(int b, samplePtr buffer, sampleFormat format,
    sampleCount start, size_t len, bool mayThrow) const
 {
+   const auto &blocks = Blocks();
    bool result = true;
    while (len) {
-      const SeqBlock &block = mBlock[b];
+      const SeqBlock &block = blocks[b];
       // start is in block
       const auto bstart = (start - block.start).as_size_t();
       // bstart is not more than block length
@@ -1104,9 +1142,10 @@ bool Sequence::Get(int b, samplePtr buffer, sampleFormat format,
 void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
                    sampleCount start, sampleCount len)
 {
+   const auto &blocks = Blocks();
    auto &factory = *mpFactory;
 
-   const auto size = mBlock.size();
+   const auto size = blocks.size();
 
    if (start < 0 || start + len > mNumSamples)
       THROW_INCONSISTENCY_EXCEPTION;
@@ -1122,7 +1161,7 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
 
    int b = FindBlock(start);
    BlockArray newBlock;
-   std::copy( mBlock.begin(), mBlock.begin() + b, std::back_inserter(newBlock) );
+   std::copy( blocks.begin(), blocks.begin() + b, std::back_inserter(newBlock) );
 
    while (len > 0
       // Redundant termination condition,
@@ -1131,7 +1170,7 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       // that cause the loop to make no progress because blen == 0
       && b < (int)size
    ) {
-      newBlock.push_back( mBlock[b] );
+      newBlock.push_back( blocks[b] );
       SeqBlock &block = newBlock.back();
       // start is within block
       const auto bstart = ( start - block.start ).as_size_t();
@@ -1206,20 +1245,21 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       b++;
    }
 
-   std::copy( mBlock.begin() + b, mBlock.end(), std::back_inserter(newBlock) );
+   std::copy( blocks.begin() + b, blocks.end(), std::back_inserter(newBlock) );
 
    CommitChangesIfConsistent( newBlock, mNumSamples, wxT("SetSamples") );
 }
 
 size_t Sequence::GetIdealAppendLen() const
 {
-   int numBlocks = mBlock.size();
+   const auto &blocks = Blocks();
+   int numBlocks = blocks.size();
    const auto max = GetMaxBlockSize();
 
    if (numBlocks == 0)
       return max;
 
-   const auto lastBlockLen = mBlock.back().sb->GetSampleCount();
+   const auto lastBlockLen = blocks.back().sb->GetSampleCount();
    if (lastBlockLen >= max)
       return max;
    else
@@ -1267,6 +1307,7 @@ void Sequence::Append(constSamplePtr buffer, sampleFormat format, size_t len)
 SeqBlock::SampleBlockPtr Sequence::DoAppend(
    constSamplePtr buffer, sampleFormat format, size_t len, bool coalesce)
 {
+   const auto &blocks = Blocks();
    SeqBlock::SampleBlockPtr result;
 
    if (len == 0)
@@ -1282,8 +1323,8 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
    sampleCount newNumSamples = mNumSamples;
 
    // If the last block is not full, we need to add samples to it
-   int numBlocks = mBlock.size();
-   SeqBlock *pLastBlock;
+   int numBlocks = blocks.size();
+   const SeqBlock *pLastBlock;
    decltype(pLastBlock->sb->GetSampleCount()) length;
    size_t bufferSize = mMaxSamples;
    SampleBuffer buffer2(bufferSize, mSampleFormat);
@@ -1291,7 +1332,7 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
    if (coalesce &&
        numBlocks > 0 &&
        (length =
-        (pLastBlock = &mBlock.back())->sb->GetSampleCount()) < mMinSamples) {
+        (pLastBlock = &blocks.back())->sb->GetSampleCount()) < mMinSamples) {
       // Enlarge a sub-minimum block at the end
       const SeqBlock &lastBlock = *pLastBlock;
       const auto addLen = std::min(mMaxSamples - length, len);
@@ -1384,6 +1425,7 @@ void Sequence::Blockify(SampleBlockFactory &factory,
 /*! @excsafety{Strong} */
 void Sequence::Delete(sampleCount start, sampleCount len)
 {
+   const auto &blocks = Blocks();
    if (len == 0)
       return;
 
@@ -1392,14 +1434,14 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
    auto &factory = *mpFactory;
 
-   const unsigned int numBlocks = mBlock.size();
+   const unsigned int numBlocks = blocks.size();
 
    const unsigned int b0 = FindBlock(start);
    unsigned int b1 = FindBlock(start + len - 1);
 
    auto sampleSize = SAMPLE_SIZE(mSampleFormat);
 
-   SeqBlock *pBlock;
+   const SeqBlock *pBlock;
    decltype(pBlock->sb->GetSampleCount()) length;
 
    // One buffer for reuse in various branches here
@@ -1411,8 +1453,11 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    // block and the resulting length is not too small, perform the
    // deletion within this block:
    if (b0 == b1 &&
-       (length = (pBlock = &mBlock[b0])->sb->GetSampleCount()) - len >= mMinSamples) {
-      SeqBlock &b = *pBlock;
+       (length = (pBlock = &blocks[b0])->sb->GetSampleCount()) - len >= mMinSamples) {
+      // The array may be shared with an undo state; copy it before
+      // modifying one block in place
+      auto &newBlocks = MutableBlocks();
+      SeqBlock &b = newBlocks[b0];
       // start is within block
       auto pos = ( start - b.start ).as_size_t();
 
@@ -1441,7 +1486,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
       // use No-fail-guarantee in remaining steps
 
       for (unsigned int j = b0 + 1; j < numBlocks; j++)
-         mBlock[j].start -= len;
+         newBlocks[j].start -= len;
 
       mNumSamples -= len;
 
@@ -1457,7 +1502,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
    // Copy the blocks before the deletion point over to
    // the NEW array
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b0);
+   newBlock.insert(newBlock.end(), blocks.begin(), blocks.begin() + b0);
    unsigned int i;
 
    // First grab the samples in block b0 before the deletion point
@@ -1465,7 +1510,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    // or if this would be the first block in the array, write it out.
    // Otherwise combine it with the previous block (splitting them
    // 50/50 if necessary).
-   const SeqBlock &preBlock = mBlock[b0];
+   const SeqBlock &preBlock = blocks[b0];
    // start is within preBlock
    auto preBufferLen = ( start - preBlock.start ).as_size_t();
    if (preBufferLen) {
@@ -1479,7 +1524,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
          newBlock.push_back(SeqBlock(pFile, preBlock.start));
       } else {
-         const SeqBlock &prepreBlock = mBlock[b0 - 1];
+         const SeqBlock &prepreBlock = blocks[b0 - 1];
          const auto prepreLen = prepreBlock.sb->GetSampleCount();
          const auto sum = prepreLen + preBufferLen;
 
@@ -1507,7 +1552,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    // for its own block, or if this would be the last block in
    // the array, write it out.  Otherwise combine it with the
    // subsequent block (splitting them 50/50 if necessary).
-   const SeqBlock &postBlock = mBlock[b1];
+   const SeqBlock &postBlock = blocks[b1];
    // start + len - 1 lies within postBlock
    const auto postBufferLen = (
        (postBlock.start + postBlock.sb->GetSampleCount()) - (start + len)
@@ -1525,7 +1570,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
          newBlock.push_back(SeqBlock(file, start));
       } else {
-         SeqBlock &postpostBlock = mBlock[b1 + 1];
+         const SeqBlock &postpostBlock = blocks[b1 + 1];
          const auto postpostLen = postpostBlock.sb->GetSampleCount();
          const auto sum = postpostLen + postBufferLen;
 
@@ -1550,7 +1595,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
    // Copy the remaining blocks over from the old array
    for (i = b1 + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(-len));
+      newBlock.push_back(blocks[i].Plus(-len));
 
    CommitChangesIfConsistent
       (newBlock, mNumSamples - len, wxT("Delete - branch two"));
@@ -1558,7 +1603,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
 void Sequence::ConsistencyCheck(const wxChar *whereStr, bool mayThrow) const
 {
-   ConsistencyCheck(mBlock, mMaxSamples, 0, mNumSamples, whereStr, mayThrow);
+   ConsistencyCheck(Blocks(), mMaxSamples, 0, mNumSamples, whereStr, mayThrow);
 }
 
 void Sequence::ConsistencyCheck
@@ -1617,10 +1662,14 @@ void Sequence::CommitChangesIfConsistent
 {
    ConsistencyCheck( newBlock, mMaxSamples, 0, numSamples, whereStr ); // may throw
 
+   // Replace, not overwrite, the array, which other copies may share
+   auto pBlocks = std::make_shared<BlockArray>(); // may throw
+
    // now commit
    // use No-fail-guarantee
 
-   mBlock.swap(newBlock);
+   pBlocks->swap(newBlock);
+   mpBlocks = std::move(pBlocks);
    mNumSamples = numSamples;
 }
 
@@ -1628,6 +1677,7 @@ void Sequence::AppendBlocksIfConsistent
 (BlockArray &additionalBlocks, bool replaceLast,
  sampleCount numSamples, const wxChar *whereStr)
 {
+   auto &blocks = MutableBlocks();
    // Any additional blocks are meant to be appended,
    // replacing the final block if there was one.
 
@@ -1637,28 +1687,28 @@ void Sequence::AppendBlocksIfConsistent
    bool tmpValid = false;
    SeqBlock tmp;
 
-   if ( replaceLast && ! mBlock.empty() ) {
-      tmp = mBlock.back(), tmpValid = true;
-      mBlock.pop_back();
+   if ( replaceLast && ! blocks.empty() ) {
+      tmp = blocks.back(), tmpValid = true;
+      blocks.pop_back();
    }
 
-   auto prevSize = mBlock.size();
+   auto prevSize = blocks.size();
 
    bool consistent = false;
    auto cleanup = finally( [&] {
       if ( !consistent ) {
-         mBlock.resize( prevSize );
+         blocks.resize( prevSize );
          if ( tmpValid )
-            mBlock.push_back( tmp );
+            blocks.push_back( tmp );
       }
    } );
 
    std::copy( additionalBlocks.begin(), additionalBlocks.end(),
-              std::back_inserter( mBlock ) );
+              std::back_inserter( blocks ) );
 
    // Check consistency only of the blocks that were added,
    // avoiding quadratic time for repeated checking of repeating appends
-   ConsistencyCheck( mBlock, mMaxSamples, prevSize, numSamples, whereStr ); // may throw
+   ConsistencyCheck( blocks, mMaxSamples, prevSize, numSamples, whereStr ); // may throw
 
    // now commit
    // use No-fail-guarantee
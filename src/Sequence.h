@@ -14,6 +14,7 @@
 
 #include <vector>
 #include <functional>
+#include <memory>
 
 // Tenacity libraries
 #include <lib-math/SampleCount.h>
@@ -118,7 +119,7 @@ class PROFILE_DLL_API Sequence final : public XMLTagHandler{
    void SetSilence(sampleCount s0, sampleCount len);
    void InsertSilence(sampleCount s0, sampleCount len);
 
-   const SampleBlockFactoryPtr &GetFactory() { return mpFactory; }
+   const SampleBlockFactoryPtr &GetFactory() const { return mpFactory; }
 
    //
    // XMLTagHandler callback methods for loading and saving
@@ -173,8 +174,8 @@ class PROFILE_DLL_API Sequence final : public XMLTagHandler{
    // you're doing!
    //
 
-   BlockArray &GetBlockArray() { return mBlock; }
-   const BlockArray &GetBlockArray() const { return mBlock; }
+   BlockArray &GetBlockArray() { return MutableBlocks(); }
+   const BlockArray &GetBlockArray() const { return Blocks(); }
 
  private:
 
@@ -190,7 +191,9 @@ class PROFILE_DLL_API Sequence final : public XMLTagHandler{
 
    SampleBlockFactoryPtr mpFactory;
 
-   BlockArray    mBlock;
+   //! Copy-on-write:  shared with copies of this sequence made for the same
+   //! factory, until one of them is modified
+   std::shared_ptr<BlockArray> mpBlocks{ std::make_shared<BlockArray>() };
    sampleFormat  mSampleFormat;
 
    // Not size_t!  May need to be large:
@@ -205,6 +208,10 @@ class PROFILE_DLL_API Sequence final : public XMLTagHandler{
    // Private methods
    //
 
+   const BlockArray &Blocks() const { return *mpBlocks; }
+   //! Get the array for modification, first copying it if it is shared
+   BlockArray &MutableBlocks();
+
    SeqBlock::SampleBlockPtr DoAppend(
       constSamplePtr buffer, sampleFormat format, size_t len, bool coalesce);
 
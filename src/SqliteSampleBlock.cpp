@@ -8,14 +8,22 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 
 **********************************************************************/
 
+#include <algorithm>
 #include <cfloat>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <sqlite3.h>
+#include <string>
+#include <unordered_map>
 
 #include "DBConnection.h"
 #include "ProjectFileIO.h"
+#include "ReferencedAudioFile.h"
 
 // Tenacity libraries
 #include <lib-math/SampleFormat.h>
+#include <lib-math/SampleSummary.h>
 #include <lib-xml/XMLTagHandler.h>
 
 #include "SampleBlock.h" // to inherit
@@ -24,6 +32,16 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 
 class SqliteSampleBlockFactory;
 
+//! Columns of one row of the sampleblocks table, other than the blobs
+struct SqliteBlockMetadata
+{
+   sampleFormat format;
+   double sumMin;
+   double sumMax;
+   double sumRms;
+   size_t sampleBytes;
+};
+
 ///\brief Implementation of @ref SampleBlock using Sqlite database
 class SqliteSampleBlock final : public SampleBlock
 {
@@ -71,6 +89,7 @@ public:
 private:
    bool IsSilent() const { return mBlockID <= 0; }
    void Load(SampleBlockID sbid);
+   void Load(SampleBlockID sbid, const SqliteBlockMetadata &metadata);
    bool GetSummary(float *dest,
                    size_t frameoffset,
                    size_t numframes,
@@ -153,12 +172,35 @@ public:
       sampleFormat srcformat,
       const AttributesList &attrs) override;
 
+   SampleBlockPtr CreateReference(
+      const std::shared_ptr<ReferencedAudioFile> &pFile, unsigned channel,
+      sampleCount start, size_t numsamples, sampleFormat format) override;
+
    BlockDeletionCallback SetBlockDeletionCallback(
       BlockDeletionCallback callback ) override;
 
+   void BeginBulkLoad() override;
+   void EndBulkLoad() override;
+
+   bool RetainBlocks(const std::vector<SampleBlockID> &ids) override;
+   void ReleaseBlocks(const std::vector<SampleBlockID> &ids) override;
+
 private:
    friend SqliteSampleBlock;
 
+   bool IsRetained(SampleBlockID sbid);
+
+   //! Make a reference block described by the attributes, or return null
+   SampleBlockPtr CreateReferenceFromXML(
+      sampleFormat srcformat, const AttributesList &attrs);
+
+   using BlockMetadataMap =
+      std::unordered_map< SampleBlockID, SqliteBlockMetadata >;
+   static BlockMetadataMap ReadAllBlockMetadata(const std::string &fileName);
+
+   //! @return null if there was no bulk load, or the id was not found
+   const SqliteBlockMetadata *FindBlockMetadata(SampleBlockID sbid);
+
    const std::shared_ptr<ConnectionPtr> mppConnection;
 
    // Track all blocks that this factory has created, but don't control
@@ -168,8 +210,91 @@ private:
    using AllBlocksMap =
       std::map< SampleBlockID, std::weak_ptr< SqliteSampleBlock > >;
    AllBlocksMap mAllBlocks;
+   // Blocks may be created in several threads at once, as by concurrent
+   // imports
+   std::mutex mAllBlocksMutex;
+
+   // Counts of RetainBlocks() for ids, also guarded by mAllBlocksMutex
+   std::unordered_map< SampleBlockID, size_t > mRetained;
+
+   // Reference blocks have no rows, but they need ids distinct from each
+   // other and from those of silent blocks, which encode lengths
+   SampleBlockID mNextReferenceID{ -(SampleBlockID{ 1 } << 48) };
+   // So that reference blocks restored from a project share open files
+   std::map< FilePath, std::weak_ptr< ReferencedAudioFile > > mReferencedFiles;
 
    BlockDeletionCallback mCallback;
+
+   // Result of the query started by BeginBulkLoad(), not yet collected
+   std::future< BlockMetadataMap > mPendingMetadata;
+   // Collected when the first block needs it; discarded by EndBulkLoad()
+   std::optional< BlockMetadataMap > mBlockMetadata;
+};
+
+///\brief Implementation of @ref SampleBlock that reads one channel of a range
+/// of an audio file outside the project, until it is materialized
+/*! Such a block has no row in the database until Materialize() makes a
+ SqliteSampleBlock to which it then delegates everything.
+ Summaries of the whole block are computed when first needed and then kept,
+ but 256 sample summaries are computed again at each request from only the
+ samples requested, because for long recordings they would take much memory.
+ */
+class ReferenceSampleBlock final : public SampleBlock
+{
+public:
+   ReferenceSampleBlock(
+      const std::shared_ptr<SqliteSampleBlockFactory> &pFactory,
+      SampleBlockID id, std::shared_ptr<ReferencedAudioFile> pFile,
+      unsigned channel, sampleCount start, size_t numsamples,
+      sampleFormat format);
+
+   void CloseLock() override;
+
+   SampleBlockID GetBlockID() const override;
+
+   size_t DoGetSamples(samplePtr dest,
+                       sampleFormat destformat,
+                       size_t sampleoffset,
+                       size_t numsamples) override;
+   size_t GetSampleCount() const override;
+
+   bool GetSummary256(float *dest, size_t frameoffset, size_t numframes) override;
+   bool GetSummary64k(float *dest, size_t frameoffset, size_t numframes) override;
+
+   MinMaxRMS DoGetMinMaxRMS(size_t start, size_t len) override;
+   MinMaxRMS DoGetMinMaxRMS() const override;
+
+   size_t GetSpaceUsage() const override;
+   void SaveXML(XMLWriter &xmlFile) override;
+
+   bool IsReference() const override;
+   void Materialize() override;
+
+private:
+   //! The block that replaced the reference, or null
+   SampleBlockPtr Materialized() const;
+
+   //! Read samples in the format of the block; may throw
+   void Read(samplePtr dest, size_t offset, size_t len) const;
+
+   //! Compute the 64k summaries and totals if not yet done; may throw
+   /*! @pre mMutex is locked */
+   void Summarize() const;
+
+   const std::shared_ptr<SqliteSampleBlockFactory> mpFactory;
+   const SampleBlockID mBlockID;
+   const std::shared_ptr<ReferencedAudioFile> mpFile;
+   const unsigned mChannel;
+   const sampleCount mStart;
+   const size_t mSampleCount;
+   const sampleFormat mSampleFormat;
+
+   // Blocks may be drawn, played and exported from several threads
+   mutable std::mutex mMutex;
+   mutable Floats mSummary64k;
+   mutable MinMaxRMS mTotals;
+   SampleBlockPtr mpMaterialized;
+   bool mLocked{ false };
 };
 
 SqliteSampleBlockFactory::SqliteSampleBlockFactory( TenacityProject &project )
@@ -186,6 +311,7 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreate(
    auto sb = std::make_shared<SqliteSampleBlock>(shared_from_this());
    sb->SetSamples(src, numsamples, srcformat);
    // block id has now been assigned
+   std::lock_guard<std::mutex> lock{ mAllBlocksMutex };
    mAllBlocks[ sb->GetBlockID() ] = sb;
    return sb;
 }
@@ -193,6 +319,7 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreate(
 auto SqliteSampleBlockFactory::GetActiveBlockIDs() -> SampleBlockIDs
 {
    SampleBlockIDs result;
+   std::lock_guard<std::mutex> lock{ mAllBlocksMutex };
    for (auto end = mAllBlocks.end(), it = mAllBlocks.begin(); it != end;) {
       if (it->second.expired())
          // Tighten up the map
@@ -226,6 +353,10 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateSilent(
 SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromXML(
    sampleFormat srcformat, const AttributesList &attrs )
 {
+   // Blocks that read outside files have no block id
+   if (auto sb = CreateReferenceFromXML(srcformat, attrs))
+      return sb;
+
    std::shared_ptr<SampleBlock> sb;
 
    int found = 0;
@@ -244,6 +375,7 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromXML(
             sb = DoCreateSilent( -nValue, floatSample );
          }
          else {
+            std::lock_guard<std::mutex> lock{ mAllBlocksMutex };
             // First see if this block id was previously loaded
             auto &wb = mAllBlocks[ nValue ];
             auto pb = wb.lock();
@@ -257,9 +389,13 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromXML(
                wb = ssb;
                sb = ssb;
                ssb->mSampleFormat = srcformat;
-               // This may throw database errors
-               // It initializes the rest of the fields
-               ssb->Load((SampleBlockID) nValue);
+               if (auto pMetadata = FindBlockMetadata(nValue))
+                  // Already fetched, with all the others
+                  ssb->Load((SampleBlockID) nValue, *pMetadata);
+               else
+                  // This may throw database errors
+                  // It initializes the rest of the fields
+                  ssb->Load((SampleBlockID) nValue);
             }
          }
          found++;
@@ -275,6 +411,66 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromXML(
    return sb;
 }
 
+SampleBlockPtr SqliteSampleBlockFactory::CreateReference(
+   const std::shared_ptr<ReferencedAudioFile> &pFile, unsigned channel,
+   sampleCount start, size_t numsamples, sampleFormat format)
+{
+   SampleBlockID id;
+   {
+      std::lock_guard<std::mutex> lock{ mAllBlocksMutex };
+      id = mNextReferenceID--;
+      mReferencedFiles[ pFile->GetIdentity().path ] = pFile;
+   }
+   return std::make_shared<ReferenceSampleBlock>(shared_from_this(),
+      id, pFile, channel, start, numsamples, format);
+}
+
+SampleBlockPtr SqliteSampleBlockFactory::CreateReferenceFromXML(
+   sampleFormat srcformat, const AttributesList &attrs)
+{
+   ReferencedAudioFile::Identity identity;
+   long long start = -1, len = -1, channel = -1;
+   int found = 0;
+
+   for (auto pair : attrs)
+   {
+      auto attr = pair.first;
+      auto value = pair.second;
+
+      if (attr == "aliasfile") {
+         identity.path = value.ToWString();
+         found++;
+      }
+      else if ((attr == "aliasstart" && value.TryGet(start)) ||
+               (attr == "aliaslen" && value.TryGet(len)) ||
+               (attr == "aliaschannel" && value.TryGet(channel)) ||
+               (attr == "aliassize" && value.TryGet(identity.size)) ||
+               (attr == "aliasmtime" && value.TryGet(identity.modified)) ||
+               (attr == "aliashash" && value.TryGet(identity.hash)))
+         found++;
+   }
+
+   if (found != 7 || identity.path.empty() ||
+       start < 0 || len <= 0 || channel < 0)
+      return nullptr;
+
+   std::shared_ptr<ReferencedAudioFile> pFile;
+   {
+      std::lock_guard<std::mutex> lock{ mAllBlocksMutex };
+      auto &wFile = mReferencedFiles[ identity.path ];
+      pFile = wFile.lock();
+      if (!pFile || pFile->GetIdentity().size != identity.size ||
+          pFile->GetIdentity().modified != identity.modified ||
+          pFile->GetIdentity().hash != identity.hash) {
+         // The file is verified later, at the first read
+         pFile = std::make_shared<ReferencedAudioFile>(identity);
+         wFile = pFile;
+      }
+   }
+   return CreateReference(pFile, static_cast<unsigned>(channel),
+      start, static_cast<size_t>(len), srcformat);
+}
+
 auto SqliteSampleBlockFactory::SetBlockDeletionCallback(
    BlockDeletionCallback callback ) -> BlockDeletionCallback
 {
@@ -283,6 +479,130 @@ auto SqliteSampleBlockFactory::SetBlockDeletionCallback(
    return result;
 }
 
+void SqliteSampleBlockFactory::BeginBulkLoad()
+{
+   EndBulkLoad();
+
+   auto &pConnection = mppConnection->mpConnection;
+   if (!pConnection)
+      return;
+
+   // A temporary or in-memory database has no file name, and can't be
+   // shared with another connection
+   auto fileName = sqlite3_db_filename(pConnection->DB(), "main");
+   if (!fileName || !*fileName)
+      return;
+
+   // Run the query in a worker thread, while the caller goes on decoding
+   // the project document, until the first block needs the results
+   mPendingMetadata = std::async(std::launch::async,
+      ReadAllBlockMetadata, std::string{ fileName });
+}
+
+void SqliteSampleBlockFactory::EndBulkLoad()
+{
+   if (mPendingMetadata.valid())
+      mPendingMetadata.wait();
+   mPendingMetadata = {};
+   mBlockMetadata.reset();
+}
+
+bool SqliteSampleBlockFactory::RetainBlocks(
+   const std::vector<SampleBlockID> &ids)
+{
+   std::lock_guard<std::mutex> lock{ mAllBlocksMutex };
+   for (auto id : ids)
+      ++mRetained[id];
+   return true;
+}
+
+void SqliteSampleBlockFactory::ReleaseBlocks(
+   const std::vector<SampleBlockID> &ids)
+{
+   std::vector<SampleBlockID> unused;
+   {
+      std::lock_guard<std::mutex> lock{ mAllBlocksMutex };
+      for (auto id : ids) {
+         auto iter = mRetained.find(id);
+         if (iter == mRetained.end() || --iter->second > 0)
+            continue;
+         mRetained.erase(iter);
+         auto found = mAllBlocks.find(id);
+         if (found == mAllBlocks.end() || found->second.expired())
+            unused.push_back(id);
+      }
+   }
+
+   // Destroying a block object deletes its row, and informs the deletion
+   // callback, as for any other block; no need to load it first
+   const auto self = shared_from_this();
+   for (auto id : unused) {
+      SqliteSampleBlock block{ self };
+      block.mBlockID = id;
+   }
+}
+
+bool SqliteSampleBlockFactory::IsRetained(SampleBlockID sbid)
+{
+   std::lock_guard<std::mutex> lock{ mAllBlocksMutex };
+   return mRetained.find(sbid) != mRetained.end();
+}
+
+auto SqliteSampleBlockFactory::FindBlockMetadata(SampleBlockID sbid)
+   -> const SqliteBlockMetadata *
+{
+   if (mPendingMetadata.valid())
+      mBlockMetadata = mPendingMetadata.get();
+
+   if (mBlockMetadata) {
+      auto iter = mBlockMetadata->find(sbid);
+      if (iter != mBlockMetadata->end())
+         return &iter->second;
+   }
+   return nullptr;
+}
+
+// This runs in a worker thread, so it uses its own read-only connection and
+// does not report errors; an empty result just means that each block will
+// be loaded by its own query after all
+auto SqliteSampleBlockFactory::ReadAllBlockMetadata(
+   const std::string &fileName) -> BlockMetadataMap
+{
+   BlockMetadataMap result;
+
+   sqlite3 *db = nullptr;
+   auto closeDB = finally([&]{ sqlite3_close(db); });
+   if (sqlite3_open_v2(fileName.c_str(), &db, SQLITE_OPEN_READONLY, nullptr)
+       != SQLITE_OK)
+      return {};
+   sqlite3_busy_timeout(db, 5000);
+
+   sqlite3_stmt *stmt = nullptr;
+   auto finalize = finally([&]{ sqlite3_finalize(stmt); });
+   if (sqlite3_prepare_v2(db,
+      "SELECT blockid, sampleformat, summin, summax, sumrms,"
+      "       length(samples)"
+      "  FROM sampleblocks;", -1, &stmt, nullptr) != SQLITE_OK)
+      return {};
+
+   int rc;
+   while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+   {
+      result.emplace(sqlite3_column_int64(stmt, 0), SqliteBlockMetadata{
+         (sampleFormat) sqlite3_column_int(stmt, 1),
+         sqlite3_column_double(stmt, 2),
+         sqlite3_column_double(stmt, 3),
+         sqlite3_column_double(stmt, 4),
+         (size_t) sqlite3_column_int(stmt, 5)
+      });
+   }
+
+   if (rc != SQLITE_DONE)
+      return {};
+
+   return result;
+}
+
 SqliteSampleBlock::SqliteSampleBlock(
    const std::shared_ptr<SqliteSampleBlockFactory> &pFactory)
 :  mpFactory(pFactory)
@@ -298,6 +618,11 @@ SqliteSampleBlock::SqliteSampleBlock(
 
 SqliteSampleBlock::~SqliteSampleBlock()
 {
+   // The row is kept for a state of the undo history that is not in memory,
+   // and is not about to be deleted
+   if (mpFactory && !IsSilent() && mpFactory->IsRetained(mBlockID))
+      return;
+
    if (mpFactory) {
       auto &callback = mpFactory->mCallback;
       if (callback)
@@ -492,22 +817,11 @@ MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
       float *samples = (float *) blockData.ptr();
 
       size_t copied = DoGetSamples((samplePtr) samples, floatSample, start, len);
-      for (size_t i = 0; i < copied; ++i, ++samples)
-      {
-         float sample = *samples;
-
-         if (sample > max)
-         {
-            max = sample;
-         }
-
-         if (sample < min)
-         {
-            min = sample;
-         }
-
-         sumsq += (sample * sample);
-      }
+      const auto stats =
+         GetSampleStats((constSamplePtr) samples, floatSample, copied);
+      min = stats.min;
+      max = stats.max;
+      sumsq = stats.sumsq;
    }
 
    return { min, max, (float) sqrt(sumsq / len) };
@@ -690,18 +1004,34 @@ void SqliteSampleBlock::Load(SampleBlockID sbid)
    }
 
    // Retrieve returned data
-   mBlockID = sbid;
-   mSampleFormat = (sampleFormat) sqlite3_column_int(stmt, 0);
-   mSumMin = sqlite3_column_double(stmt, 1);
-   mSumMax = sqlite3_column_double(stmt, 2);
-   mSumRms = sqlite3_column_double(stmt, 3);
-   mSampleBytes = sqlite3_column_int(stmt, 4);
-   mSampleCount = mSampleBytes / SAMPLE_SIZE(mSampleFormat);
+   const SqliteBlockMetadata metadata{
+      (sampleFormat) sqlite3_column_int(stmt, 0),
+      sqlite3_column_double(stmt, 1),
+      sqlite3_column_double(stmt, 2),
+      sqlite3_column_double(stmt, 3),
+      (size_t) sqlite3_column_int(stmt, 4)
+   };
 
    // Clear statement bindings and rewind statement
    sqlite3_clear_bindings(stmt);
    sqlite3_reset(stmt);
 
+   Load(sbid, metadata);
+}
+
+void SqliteSampleBlock::Load(
+   SampleBlockID sbid, const SqliteBlockMetadata &metadata)
+{
+   wxASSERT(sbid > 0);
+
+   mBlockID = sbid;
+   mSampleFormat = metadata.format;
+   mSumMin = metadata.sumMin;
+   mSumMax = metadata.sumMax;
+   mSumRms = metadata.sumRms;
+   mSampleBytes = metadata.sampleBytes;
+   mSampleCount = mSampleBytes / SAMPLE_SIZE(mSampleFormat);
+
    mValid = true;
 }
 
@@ -733,23 +1063,28 @@ void SqliteSampleBlock::Commit(Sizes sizes)
       wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
    }
  
-   // Execute the statement
-   rc = sqlite3_step(stmt);
-   if (rc != SQLITE_DONE)
    {
-      wxLogDebug(wxT("SqliteSampleBlock::Commit - SQLITE error %s"), sqlite3_errmsg(db));
+      // Other threads may insert with the same connection
+      std::lock_guard<std::mutex> lock{ Conn()->GetInsertMutex() };
 
-      // Clear statement bindings and rewind statement
-      sqlite3_clear_bindings(stmt);
-      sqlite3_reset(stmt);
+      // Execute the statement
+      rc = sqlite3_step(stmt);
+      if (rc != SQLITE_DONE)
+      {
+         wxLogDebug(wxT("SqliteSampleBlock::Commit - SQLITE error %s"), sqlite3_errmsg(db));
 
-      // Just showing the user a simple message, not the library error too
-      // which isn't internationalized
-      Conn()->ThrowException( true );
-   }
+         // Clear statement bindings and rewind statement
+         sqlite3_clear_bindings(stmt);
+         sqlite3_reset(stmt);
 
-   // Retrieve returned data
-   mBlockID = sqlite3_last_insert_rowid(db);
+         // Just showing the user a simple message, not the library error too
+         // which isn't internationalized
+         Conn()->ThrowException( true );
+      }
+
+      // Retrieve returned data
+      mBlockID = sqlite3_last_insert_rowid(db);
+   }
 
    // Reset local arrays
    mSamples.reset();
@@ -802,9 +1137,11 @@ void SqliteSampleBlock::Delete()
    sqlite3_reset(stmt);
 }
 
+static const XMLName BlockIdAttr{ "blockid" };
+
 void SqliteSampleBlock::SaveXML(XMLWriter &xmlFile)
 {
-   xmlFile.WriteAttr(wxT("blockid"), mBlockID);
+   xmlFile.WriteAttr(BlockIdAttr, mBlockID);
 }
 
 auto SqliteSampleBlock::SetSizes(
@@ -829,21 +1166,6 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
    const auto mSummary256Bytes = sizes.first;
    const auto mSummary64kBytes = sizes.second;
 
-   Floats samplebuffer;
-   float *samples;
-
-   if (mSampleFormat == floatSample)
-   {
-      samples = (float *) mSamples.get();
-   }
-   else
-   {
-      samplebuffer.reinit((unsigned) mSampleCount);
-      SamplesToFloats(mSamples.get(), mSampleFormat,
-         samplebuffer.get(), mSampleCount);
-      samples = samplebuffer.get();
-   }
-   
    mSummary256.reinit(mSummary256Bytes);
    mSummary64k.reinit(mSummary64kBytes);
 
@@ -853,48 +1175,17 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
    float min;
    float max;
    float sumsq;
-   double totalSquares = 0.0;
    double fraction = 0.0;
 
-   // Recalc 256 summaries
+   // Recalc 256 summaries, converting samples from the block's format as
+   // they are read
    int sumLen = (mSampleCount + 255) / 256;
    int summaries = 256;
 
-   for (int i = 0; i < sumLen; ++i)
-   {
-      min = samples[i * 256];
-      max = samples[i * 256];
-      sumsq = min * min;
-
-      int jcount = 256;
-      if (jcount > mSampleCount - i * 256)
-      {
-         jcount = mSampleCount - i * 256;
-         fraction = 1.0 - (jcount / 256.0);
-      }
-
-      for (int j = 1; j < jcount; ++j)
-      {
-         float f1 = samples[i * 256 + j];
-         sumsq += f1 * f1;
-
-         if (f1 < min)
-         {
-            min = f1;
-         }
-         else if (f1 > max)
-         {
-            max = f1;
-         }
-      }
-
-      totalSquares += sumsq;
-
-      summary256[i * fields] = min;
-      summary256[i * fields + 1] = max;
-      // The rms is correct, but this may be for less than 256 samples in last loop.
-      summary256[i * fields + 2] = (float) sqrt(sumsq / jcount);
-   }
+   const double totalSquares = SummarizeSamples(
+      mSamples.get(), mSampleFormat, mSampleCount, 256, summary256);
+   if (mSampleCount % 256)
+      fraction = 1.0 - ((mSampleCount % 256) / 256.0);
 
    for (int i = sumLen, frames256 = mSummary256Bytes / bytesPerFrame;
         i < frames256; ++i)
@@ -977,6 +1268,234 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
    mSumMax = max;
 }
 
+ReferenceSampleBlock::ReferenceSampleBlock(
+   const std::shared_ptr<SqliteSampleBlockFactory> &pFactory,
+   SampleBlockID id, std::shared_ptr<ReferencedAudioFile> pFile,
+   unsigned channel, sampleCount start, size_t numsamples,
+   sampleFormat format)
+   : mpFactory{ pFactory }
+   , mBlockID{ id }
+   , mpFile{ std::move(pFile) }
+   , mChannel{ channel }
+   , mStart{ start }
+   , mSampleCount{ numsamples }
+   , mSampleFormat{ format }
+{
+}
+
+SampleBlockPtr ReferenceSampleBlock::Materialized() const
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return mpMaterialized;
+}
+
+void ReferenceSampleBlock::Read(
+   samplePtr dest, size_t offset, size_t len) const
+{
+   mpFile->Read(mChannel, mStart + offset, dest, mSampleFormat, len);
+}
+
+void ReferenceSampleBlock::CloseLock()
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   mLocked = true;
+   if (mpMaterialized)
+      mpMaterialized->CloseLock();
+}
+
+SampleBlockID ReferenceSampleBlock::GetBlockID() const
+{
+   // A materialized block must answer its own id, so that the row is not
+   // deleted as unused
+   if (auto pBlock = Materialized())
+      return pBlock->GetBlockID();
+   return mBlockID;
+}
+
+size_t ReferenceSampleBlock::GetSampleCount() const
+{
+   return mSampleCount;
+}
+
+size_t ReferenceSampleBlock::DoGetSamples(samplePtr dest,
+   sampleFormat destformat, size_t sampleoffset, size_t numsamples)
+{
+   if (auto pBlock = Materialized())
+      return pBlock->GetSamples(dest, destformat, sampleoffset, numsamples);
+
+   sampleoffset = std::min(sampleoffset, mSampleCount);
+   const auto len = std::min(numsamples, mSampleCount - sampleoffset);
+   // Conversion by libsndfile to another format is the same as would be
+   // done after reading in the block's format
+   mpFile->Read(mChannel, mStart + sampleoffset, dest, destformat, len);
+   if (numsamples > len)
+      ClearSamples(dest, destformat, len, numsamples - len);
+   return len;
+}
+
+bool ReferenceSampleBlock::GetSummary256(float *dest,
+   size_t frameoffset, size_t numframes)
+{
+   if (auto pBlock = Materialized())
+      return pBlock->GetSummary256(dest, frameoffset, numframes);
+
+   // Non-throwing, it returns true for success
+   try {
+      const auto start = std::min(frameoffset * 256, mSampleCount);
+      const auto len = std::min(numframes * 256, mSampleCount - start);
+      SampleBuffer samples{ len, mSampleFormat };
+      Read(samples.ptr(), start, len);
+      SummarizeSamples(samples.ptr(), mSampleFormat, len, 256, dest);
+      // Pad as SqliteSampleBlock::CalcSummary does
+      for (auto i = (len + 255) / 256; i < numframes; ++i) {
+         dest[i * 3] = FLT_MAX;
+         dest[i * 3 + 1] = -FLT_MAX;
+         dest[i * 3 + 2] = 0.0f;
+      }
+      return true;
+   }
+   catch ( const TenacityException & ) {
+   }
+   memset(dest, 0, 3 * numframes * sizeof( float ));
+   return false;
+}
+
+bool ReferenceSampleBlock::GetSummary64k(float *dest,
+   size_t frameoffset, size_t numframes)
+{
+   std::unique_lock<std::mutex> lock{ mMutex };
+   if (auto pBlock = mpMaterialized) {
+      lock.unlock();
+      return pBlock->GetSummary64k(dest, frameoffset, numframes);
+   }
+
+   // Non-throwing, it returns true for success
+   try {
+      Summarize();
+      const auto frames64k = (mSampleCount + 65535) / 65536;
+      const auto first = std::min(frameoffset, frames64k);
+      const auto count = std::min(numframes, frames64k - first);
+      std::copy(mSummary64k.get() + 3 * first,
+         mSummary64k.get() + 3 * (first + count), dest);
+      memset(dest + 3 * count, 0, 3 * (numframes - count) * sizeof( float ));
+      return true;
+   }
+   catch ( const TenacityException & ) {
+   }
+   memset(dest, 0, 3 * numframes * sizeof( float ));
+   return false;
+}
+
+void ReferenceSampleBlock::Summarize() const
+{
+   if (mSummary64k)
+      return;
+
+   SampleBuffer samples{ mSampleCount, mSampleFormat };
+   Read(samples.ptr(), 0, mSampleCount);
+
+   const auto frames64k = (mSampleCount + 65535) / 65536;
+   Floats summary{ 3 * frames64k };
+   const auto totalSquares = SummarizeSamples(
+      samples.ptr(), mSampleFormat, mSampleCount, 65536, summary.get());
+
+   MinMaxRMS totals;
+   if (frames64k > 0) {
+      totals = { FLT_MAX, -FLT_MAX,
+         (float) sqrt(totalSquares / mSampleCount) };
+      for (size_t i = 0; i < frames64k; ++i) {
+         totals.min = std::min(totals.min, summary[i * 3]);
+         totals.max = std::max(totals.max, summary[i * 3 + 1]);
+      }
+   }
+   mTotals = totals;
+   mSummary64k = std::move(summary);
+}
+
+MinMaxRMS ReferenceSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
+{
+   if (auto pBlock = Materialized())
+      return pBlock->GetMinMaxRMS(start, len);
+
+   SampleStats stats{ FLT_MAX, -FLT_MAX, 0.0f };
+   if (start < mSampleCount)
+   {
+      const auto count = std::min(len, mSampleCount - start);
+      SampleBuffer samples{ count, mSampleFormat };
+      Read(samples.ptr(), start, count);
+      stats = GetSampleStats(samples.ptr(), mSampleFormat, count);
+   }
+
+   return { stats.min, stats.max, (float) sqrt(stats.sumsq / len) };
+}
+
+MinMaxRMS ReferenceSampleBlock::DoGetMinMaxRMS() const
+{
+   std::unique_lock<std::mutex> lock{ mMutex };
+   if (auto pBlock = mpMaterialized) {
+      lock.unlock();
+      return pBlock->GetMinMaxRMS();
+   }
+
+   Summarize();
+   return mTotals;
+}
+
+size_t ReferenceSampleBlock::GetSpaceUsage() const
+{
+   if (auto pBlock = Materialized())
+      return pBlock->GetSpaceUsage();
+   return 0;
+}
+
+// The names of attributes are those that Audacity 2.x wrote for
+// PCMAliasBlockFile, with more to identify the file
+static const XMLName AliasFileAttr{ "aliasfile" };
+static const XMLName AliasStartAttr{ "aliasstart" };
+static const XMLName AliasLenAttr{ "aliaslen" };
+static const XMLName AliasChannelAttr{ "aliaschannel" };
+static const XMLName AliasSizeAttr{ "aliassize" };
+static const XMLName AliasModifiedAttr{ "aliasmtime" };
+static const XMLName AliasHashAttr{ "aliashash" };
+
+void ReferenceSampleBlock::SaveXML(XMLWriter &xmlFile)
+{
+   if (auto pBlock = Materialized()) {
+      pBlock->SaveXML(xmlFile);
+      return;
+   }
+
+   const auto &identity = mpFile->GetIdentity();
+   xmlFile.WriteAttr(AliasFileAttr, identity.path);
+   xmlFile.WriteAttr(AliasStartAttr, mStart.as_long_long());
+   xmlFile.WriteAttr(AliasLenAttr, mSampleCount);
+   xmlFile.WriteAttr(AliasChannelAttr, static_cast<int>(mChannel));
+   xmlFile.WriteAttr(AliasSizeAttr, identity.size);
+   xmlFile.WriteAttr(AliasModifiedAttr, identity.modified);
+   xmlFile.WriteAttr(AliasHashAttr, identity.hash);
+}
+
+bool ReferenceSampleBlock::IsReference() const
+{
+   return !Materialized();
+}
+
+void ReferenceSampleBlock::Materialize()
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   if (mpMaterialized)
+      return;
+
+   SampleBuffer samples{ mSampleCount, mSampleFormat };
+   Read(samples.ptr(), 0, mSampleCount);
+   auto pBlock =
+      mpFactory->DoCreate(samples.ptr(), mSampleCount, mSampleFormat);
+   if (mLocked)
+      pBlock->CloseLock();
+   mpMaterialized = std::move(pBlock);
+   mSummary64k.reset();
+}
+
 // Inject our database implementation at startup
 static SampleBlockFactory::Factory::Scope scope{ []( TenacityProject &project )
 {
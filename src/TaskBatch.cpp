@@ -0,0 +1,208 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file TaskBatch.cpp
+
+**********************************************************************/
+#include "TaskBatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Tenacity libraries
+#include <lib-basic-ui/BasicUI.h>
+#include <lib-utility/ThreadPool.h>
+
+TaskProgress::~TaskProgress() = default;
+
+void TaskProgress::OnMainThread(const std::function<void()> &action)
+{
+   action();
+}
+
+// State shared by the main thread and the workers, which may still touch
+// it after their tasks are done
+struct TaskBatch::Shared
+{
+   std::mutex mutex;
+   std::condition_variable condition;
+   // Actions that workers wait for the main thread to do
+   std::vector<std::packaged_task<void()>> requests;
+   // What the user said to the progress dialog, for all tasks; each slot
+   // has its own copy, which may differ
+   std::atomic<ProgressResult> verdict{ ProgressResult::Success };
+   // ThreadPool runs tasks at once if it has no threads
+   const std::thread::id mainThread{ std::this_thread::get_id() };
+
+   // Reports the progress of one task
+   class Progress final : public TaskProgress
+   {
+   public:
+      Progress(Shared &shared, std::atomic<double> &fraction,
+         std::atomic<ProgressResult> &verdict)
+         : mShared{ shared }
+         , mFraction{ fraction }
+         , mVerdict{ verdict }
+      {}
+
+      ProgressResult Update(double fraction) override
+      {
+         mFraction = std::clamp(fraction, 0.0, 1.0);
+         return mVerdict;
+      }
+
+      void OnMainThread(const std::function<void()> &action) override
+      {
+         if (std::this_thread::get_id() == mShared.mainThread) {
+            action();
+            return;
+         }
+         std::packaged_task<void()> task{ action };
+         auto future = task.get_future();
+         {
+            std::lock_guard<std::mutex> lock{ mShared.mutex };
+            mShared.requests.push_back(std::move(task));
+         }
+         mShared.condition.notify_all();
+         future.get();
+      }
+
+   private:
+      Shared &mShared;
+      std::atomic<double> &mFraction;
+      std::atomic<ProgressResult> &mVerdict;
+   };
+
+   struct Slot {
+      explicit Slot(Shared &shared)
+         : verdict{ shared.verdict.load() }
+         , progress{ shared, fraction, verdict }
+      {}
+
+      std::atomic<double> fraction{ 0.0 };
+      std::atomic<ProgressResult> verdict;
+      // Set while holding the mutex, so that waits can't miss it
+      std::atomic<bool> done{ false };
+      // Written by the worker before done, read by the main thread after
+      ProgressResult result{ ProgressResult::Failed };
+      std::exception_ptr exception;
+      Progress progress;
+   };
+   // deque, so that growth does not move the slots that workers use
+   std::deque<Slot> slots;
+
+   void ServeRequests()
+   {
+      decltype(requests) tasks;
+      {
+         std::lock_guard<std::mutex> lock{ mutex };
+         tasks.swap(requests);
+      }
+      // packaged_task passes any exception to the waiting worker
+      for (auto &task : tasks)
+         task();
+   }
+};
+
+TaskBatch::TaskBatch()
+   : mpShared{ std::make_shared<Shared>() }
+{
+}
+
+TaskBatch::~TaskBatch()
+{
+   Finish();
+}
+
+size_t TaskBatch::Post(Work work)
+{
+   auto &slot = mpShared->slots.emplace_back(*mpShared);
+   ThreadPool::Get().Post(
+      [pShared = mpShared, &slot, work = std::move(work)]() mutable {
+         try {
+            slot.result = work(slot.progress);
+         }
+         catch (...) {
+            slot.exception = std::current_exception();
+         }
+         // Release what the work captured before the main thread goes on
+         work = nullptr;
+         {
+            std::lock_guard<std::mutex> lock{ pShared->mutex };
+            slot.done = true;
+         }
+         pShared->condition.notify_all();
+      });
+   return mpShared->slots.size() - 1;
+}
+
+bool TaskBatch::IsDone(size_t task) const
+{
+   return mpShared->slots[task].done;
+}
+
+double TaskBatch::GetFraction(size_t task) const
+{
+   return mpShared->slots[task].fraction;
+}
+
+auto TaskBatch::GetResult(size_t task) const -> ProgressResult
+{
+   auto &slot = mpShared->slots[task];
+   if (slot.exception)
+      std::rethrow_exception(slot.exception);
+   return slot.result;
+}
+
+auto TaskBatch::GetVerdict() const -> ProgressResult
+{
+   return mpShared->verdict;
+}
+
+void TaskBatch::SetVerdict(ProgressResult verdict)
+{
+   mpShared->verdict = verdict;
+   for (auto &slot : mpShared->slots)
+      slot.verdict = verdict;
+}
+
+void TaskBatch::SetVerdict(size_t task, ProgressResult verdict)
+{
+   mpShared->slots[task].verdict = verdict;
+}
+
+void TaskBatch::Wait(size_t task)
+{
+   auto &shared = *mpShared;
+   {
+      std::unique_lock<std::mutex> lock{ shared.mutex };
+      shared.condition.wait_for(lock, std::chrono::milliseconds{ 50 },
+         [&]{ return !shared.requests.empty() ||
+            (task < shared.slots.size() && shared.slots[task].done); });
+   }
+   shared.ServeRequests();
+}
+
+void TaskBatch::Finish()
+{
+   auto &shared = *mpShared;
+   SetVerdict(ProgressResult::Cancelled);
+   for (auto &slot : shared.slots)
+      while (!slot.done) {
+         {
+            std::unique_lock<std::mutex> lock{ shared.mutex };
+            shared.condition.wait(lock,
+               [&]{ return !shared.requests.empty() || slot.done; });
+         }
+         shared.ServeRequests();
+      }
+}
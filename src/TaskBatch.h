@@ -0,0 +1,100 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file TaskBatch.h
+  @brief Work on worker threads, with progress shown by the main thread
+
+**********************************************************************/
+#ifndef __TENACITY_TASK_BATCH__
+#define __TENACITY_TASK_BATCH__
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace GenericUI{ enum class ProgressResult : unsigned; }
+
+//! Where a long computation, maybe on a worker thread, reports its progress
+/*! Usually a progress dialog, but when several computations run
+ concurrently, a share of one dialog polled by the main thread */
+class TENACITY_DLL_API TaskProgress /* not final */
+{
+public:
+   using ProgressResult = GenericUI::ProgressResult;
+
+   virtual ~TaskProgress();
+
+   //! Report the fraction done, and learn whether to go on
+   virtual ProgressResult Update(double fraction) = 0;
+
+   //! Report a count done of a total, which may be of another type
+   template< typename Current, typename Total >
+   ProgressResult Update(Current current, Total total)
+   {
+      return Update( total != 0
+         ? static_cast<double>(current) / static_cast<double>(total)
+         : 1.0 );
+   }
+
+   //! Do something that is safe only in the main thread, and wait for it
+   /*! The default does it at once, in the calling thread */
+   virtual void OnMainThread(const std::function<void()> &action);
+};
+
+//! Tasks posted to ThreadPool::Get(), overseen by the main thread
+/*!
+ The main thread calls Wait() repeatedly, and between calls updates one
+ progress dialog from the fractions of the tasks, and passes what the user
+ said to SetVerdict(), for all tasks or for some.  Tasks learn their verdicts
+ from TaskProgress::Update().
+ Wait() also does what the tasks ask with TaskProgress::OnMainThread().
+
+ All member functions must be called by the main thread.  The destructor
+ cancels the tasks, and waits for them, still doing what they ask; so the
+ work may use objects that outlive the batch.
+ */
+class TENACITY_DLL_API TaskBatch final
+{
+public:
+   using ProgressResult = GenericUI::ProgressResult;
+   //! Work of one task; it may throw
+   using Work = std::function< ProgressResult(TaskProgress &progress) >;
+
+   TaskBatch();
+   TaskBatch(const TaskBatch&) = delete;
+   TaskBatch &operator=(const TaskBatch&) = delete;
+   ~TaskBatch();
+
+   //! Start work on a worker thread
+   /*! @return number of the task, counting from 0 in the order of posting */
+   size_t Post(Work work);
+
+   bool IsDone(size_t task) const;
+   //! The fraction of the task done, as last reported
+   double GetFraction(size_t task) const;
+   //! Result of the work of a task that is done, or rethrow its exception
+   ProgressResult GetResult(size_t task) const;
+
+   //! The verdict for all tasks, as last set
+   ProgressResult GetVerdict() const;
+   //! Tell all tasks, including those posted later
+   void SetVerdict(ProgressResult verdict);
+   //! Tell one task only, overriding the verdict for all until that changes
+   void SetVerdict(size_t task, ProgressResult verdict);
+
+   //! Wait until the task is done or another asks for the main thread, but
+   //! not long, so that the dialog stays responsive; then serve the requests
+   /*! task may be NoTask, to wait for requests only */
+   void Wait(size_t task);
+   static constexpr size_t NoTask = static_cast<size_t>(-1);
+
+   //! Cancel the tasks, and wait for all, serving their requests
+   void Finish();
+
+private:
+   struct Shared;
+   const std::shared_ptr<Shared> mpShared;
+};
+
+#endif
@@ -120,6 +120,8 @@ void TrackArtist::SetColours( int iColorIndex)
    }
 }
 
+BoolSetting RasterWaveform{ wxT("/GUI/RasterWaveform"), true };
+
 void TrackArtist::UpdateSelectedPrefs( int id )
 {
    if( id == ShowClippingPrefsID())
@@ -132,6 +134,7 @@ void TrackArtist::UpdatePrefs()
 {
    mdBrange = DecibelScaleCutoff.Read();
    mSampleDisplay = TracksPrefs::SampleViewChoice();
+   mRasterWaveform = RasterWaveform.Read();
 
    UpdateSelectedPrefs( ShowClippingPrefsID() );
    UpdateSelectedPrefs( ShowTrackNameInWaveformPrefsID() );
@@ -21,6 +21,7 @@
 
 
 
+#include <functional>
 #include <wx/brush.h> // member variable
 #include <wx/pen.h> // member variables
 
@@ -29,6 +30,9 @@
 
 class wxRect;
 
+//! Whether waveforms are drawn into an image, rather than line by line
+extern TENACITY_DLL_API BoolSetting RasterWaveform;
+
 class TrackList;
 class TrackPanel;
 class SelectedRegion;
@@ -78,6 +82,7 @@ public:
    bool mShowClipping;        // "/GUI/ShowClipping"
    int  mSampleDisplay;
    bool mbShowTrackNameInTrack;  // "/GUI/ShowTrackNameInWaveform"
+   bool mRasterWaveform;      // "/GUI/RasterWaveform"
 
    wxBrush blankBrush;
    wxBrush unselectedBrush;
@@ -120,6 +125,11 @@ public:
    bool bigPoints{ false };
    bool drawSliders{ false };
    bool hasSolo{ false };
+
+   //! If not empty, waveforms may be drawn first from approximate data,
+   //! while exact data are computed in the background; then this is called
+   //! in the main thread, to draw again
+   std::function<void()> onWaveformReady;
 };
 
 #endif                          // define __AUDACITY_TRACKARTIST__
@@ -89,11 +89,13 @@ is time to refresh some aspect of the screen.
 #include "../images/Cursors.h"
 
 #include <algorithm>
+#include <limits>
 
 #include <wx/dc.h>
 #include <wx/dcbuffer.h>
 #include <wx/dcclient.h>
 #include <wx/graphics.h>
+#include <wx/weakref.h>
 
 static_assert( kVerticalPadding == kTopMargin + kBottomMargin );
 
@@ -287,6 +289,10 @@ TrackPanel::TrackPanel(wxWindow * parent, wxWindowID id,
    }
 
    mTrackArtist = std::make_unique<TrackArtist>( this );
+   mTrackArtist->onWaveformReady = [pThis = wxWeakRef<TrackPanel>(this)]{
+      if (pThis)
+         pThis->Refresh(false);
+   };
 
    mTimeCount = 0;
    mTimer.parent = this;
@@ -297,6 +303,16 @@ TrackPanel::TrackPanel(wxWindow * parent, wxWindowID id,
    // Register for tracklist updates
    mTrackListScubscription =
    mTracks->Subscribe([this](const TrackListEvent &event){
+      switch (event.mType) {
+      case TrackListEvent::ADDITION:
+      case TrackListEvent::DELETION:
+      case TrackListEvent::PERMUTED:
+      case TrackListEvent::RESIZING:
+         mLeadersValid = false;
+         break;
+      default:
+         break;
+      }
       switch (event.mType) {
       case TrackListEvent::RESIZING:
       case TrackListEvent::ADDITION:
@@ -422,20 +438,20 @@ void TrackPanel::OnTimer(wxTimerEvent& )
    // Notify listeners for timer ticks
    window.GetPlaybackScroller().OnTimer();
 
-   Refresh();
-   mRuler->Refresh();
+   // Repaint only where the play head and other overlays move; the backing
+   // bitmap repairs the rest
+   RefreshOverlays();
+   mRuler->RefreshOverlays();
 
    if(IsAudioActive() && gAudioIO->GetNumCaptureChannels()) {
 
       // Periodically update the display while recording
 
-      if ((mTimeCount % 5) == 0) {
-         // Must tell OnPaint() to recreate the backing bitmap
-         // since we've not done a full refresh.
-         mRefreshBacking = true;
-         Refresh( false );
-      }
+      if ((mTimeCount % 5) == 0)
+         RefreshCapture();
    }
+   else
+      mLastRefreshedCaptureEnd.reset();
    if(mTimeCount > 1000)
       mTimeCount = 0;
 }
@@ -475,23 +491,50 @@ void TrackPanel::OnPaint(wxPaintEvent & /* event */)
       // Retrieve the damage rectangle
       wxRect box = GetUpdateRegion().GetBox();
 
+      ++mRepaintStatistics.nPaints;
+
       // Recreate the backing bitmap if we have a full refresh
       // (See TrackPanel::Refresh())
       if (mRefreshBacking || (box == GetRect()))
       {
          // Reset (should a mutex be used???)
          mRefreshBacking = false;
+         mBackingDamage = {};
 
          // Redraw the backing bitmap
          DrawTracks(&GetBackingDCForRepaint());
+         ++mRepaintStatistics.nFullRedraws;
+         const auto size = GetBackingDC().GetSize();
+         mRepaintStatistics.nPixelsRedrawn +=
+            (unsigned long long)size.x * size.y;
 
          // Copy it to the display
          DisplayBitmap(dc);
+         mRepaintStatistics.nPixelsRepaired +=
+            (unsigned long long)size.x * size.y;
       }
       else
       {
+         if (!mBackingDamage.IsEmpty()) {
+            // Redraw only the stale part of the backing bitmap, and only the
+            // cells that intersect it
+            auto damage = mBackingDamage;
+            mBackingDamage = {};
+            auto &backingDC = GetBackingDCForRepaint();
+            damage.Intersect(wxRect{ wxPoint{}, backingDC.GetSize() });
+            if (!damage.IsEmpty()) {
+               wxDCClipper clipper{ backingDC, damage };
+               DrawTracks(&backingDC, &damage);
+               ++mRepaintStatistics.nPartialRedraws;
+               mRepaintStatistics.nPixelsRedrawn +=
+                  (unsigned long long)damage.width * damage.height;
+            }
+         }
+
          // Copy full, possibly clipped, damage rectangle
          RepairBitmap(dc, box.x, box.y, box.width, box.height);
+         mRepaintStatistics.nPixelsRepaired +=
+            (unsigned long long)box.width * box.height;
       }
 
       // Done with the clipped DC
@@ -767,11 +810,60 @@ void TrackPanel::RefreshTrack(Track *trk, bool refreshbacking)
    wxRect rect(left, top, width, height);
 
    if( refreshbacking )
-      mRefreshBacking = true;
+      mBackingDamage.Union(rect);
 
    Refresh( false, &rect );
 }
 
+void TrackPanel::RefreshCapture()
+{
+   auto gAudioIO = AudioIO::Get();
+
+   // Find this panel's tracks that are recorded into, and how far
+   double captureEnd = -std::numeric_limits<double>::infinity();
+   std::vector<Track *> tracks;
+   for (const auto &pTrack : gAudioIO->mCaptureTracks) {
+      if (!pTrack)
+         continue;
+      if (auto pOwn = GetTracks()->FindById(pTrack->GetId())) {
+         captureEnd = std::max(captureEnd, pTrack->GetEndTime());
+         tracks.push_back(pOwn);
+      }
+   }
+   if (tracks.empty()) {
+      // Not recording into this project; but, as before, refresh all
+      mRefreshBacking = true;
+      Refresh( false );
+      return;
+   }
+
+   // The columns from the previous end of the recording to the present end,
+   // allowing a few pixels more for the clip edges drawn there
+   enum { Margin = 3 };
+   const auto left = mViewInfo->GetLeftOffset();
+   const wxCoord x1 =
+      mViewInfo->TimeToPosition(captureEnd, left) + Margin + 1;
+   const auto previous = mLastRefreshedCaptureEnd;
+   mLastRefreshedCaptureEnd = captureEnd;
+   const wxCoord x0 = previous
+      ? mViewInfo->TimeToPosition(*previous, left) - Margin
+      : x1;
+
+   for (auto pTrack : tracks) {
+      // All of the track the first time, or if the recording moved left
+      auto rect = FindTrackRect(pTrack);
+      if (x0 < x1) {
+         const auto right = std::min(rect.GetRight(), x1);
+         rect.x = std::max(rect.x, x0);
+         rect.width = right - rect.x + 1;
+      }
+      if (rect.width <= 0 || rect.height <= 0)
+         continue;
+      mBackingDamage.Union(rect);
+      Refresh( false, &rect );
+   }
+}
+
 /// This method overrides Refresh() of wxWindow so that the
 /// boolean play indicator can be set to false, so that an old play indicator that is
 /// no longer there won't get  XORed (to erase it), thus redrawing it on the
@@ -810,7 +902,7 @@ void TrackPanel::OnAudioIO(AudioIOEvent evt)
 /// Draw the actual track areas.  We only draw the borders
 /// and the little buttons and menues and whatnot here, the
 /// actual contents of each track are drawn by the TrackArtist.
-void TrackPanel::DrawTracks(wxDC * dc)
+void TrackPanel::DrawTracks(wxDC * dc, const wxRect *pDamage)
 {
    const SelectedRegion &sr = mViewInfo->selectedRegion;
    mTrackArtist->pSelectedRegion = &sr;
@@ -842,7 +934,8 @@ void TrackPanel::DrawTracks(wxDC * dc)
    mTrackArtist->drawSliders = sliderFlag;
    mTrackArtist->hasSolo = hasSolo;
 
-   this->CellularPanel::Draw( context, TrackArtist::NPasses );
+   mRepaintStatistics.nCellDraws +=
+      this->CellularPanel::Draw( context, TrackArtist::NPasses, pDamage );
 }
 
 void TrackPanel::SetBackgroundCell
@@ -1559,6 +1652,73 @@ struct ResizingChannelGroup final : TrackPanelGroup {
 // Stacks a dead area at top, the tracks, and the click-to-deselect area below
 struct Subgroup final : TrackPanelGroup {
    explicit Subgroup( TrackPanel &panel ) : mPanel{ panel } {}
+   Subdivision VisibleChildren( const wxRect &rect, const wxRect &clip )
+      override
+   {
+      // Find the tracks near the clip by binary search of the cumulative
+      // heights cached in the views, rather than visiting all of them
+      const auto &leaders = mPanel.GetLeaders();
+      const auto nLeaders = leaders.size();
+      if ( nLeaders == 0 )
+         return Children( rect );
+
+      const auto &viewInfo = *mPanel.GetViewInfo();
+      const wxCoord yTracks = -viewInfo.vpos + kTopMargin;
+      const wxCoord yEnd =
+         yTracks + TrackView::GetTotalHeight( *mPanel.GetTracks() );
+      const auto top = [&]( size_t ii ){
+         return ii < nLeaders
+            ? yTracks +
+               TrackView::Get( *leaders[ii] ).GetCumulativeHeightBefore()
+            : yEnd;
+      };
+      const auto upperBound = [&]( wxCoord yy ){
+         // Index of the first track starting below yy
+         size_t lo = 0, hi = nLeaders;
+         while ( lo < hi ) {
+            const auto mid = lo + ( hi - lo ) / 2;
+            if ( top( mid ) > yy )
+               hi = mid;
+            else
+               lo = mid + 1;
+         }
+         return lo;
+      };
+
+      // Drawing areas of the adornments overhang the tracks a little;
+      // see ChannelGroup::DrawingArea
+      constexpr wxCoord overhang =
+         kTrackSeparatorThickness + kBorderThickness + 3 + kShadowThickness;
+      const auto first = std::max< size_t >( 1,
+         upperBound( clip.GetTop() - overhang ) ) - 1;
+      const auto last = upperBound( clip.GetBottom() + overhang );
+
+      Refinement refinement;
+      if ( first == 0 )
+         refinement.emplace_back( -viewInfo.vpos, EmptyCell::Instance() );
+      for ( auto ii = first; ii < last; ++ii ) {
+         const auto &pLeader = leaders[ii];
+         // The caches may lag changes of the track list, whose events are
+         // queued; then do it the slow way
+         if ( !pLeader->IsLeader() ||
+              pLeader->GetOwner().get() != mPanel.GetTracks() ||
+              top( ii ) + TrackView::GetChannelGroupHeight( pLeader.get() )
+                 != top( ii + 1 ) )
+            return Children( rect );
+         refinement.emplace_back( top( ii ),
+            std::make_shared< ResizingChannelGroup >(
+               pLeader, viewInfo.GetLeftOffset() ) );
+      }
+      if ( last < nLeaders )
+         // Let the last track end where the next begins
+         refinement.emplace_back( top( last ), nullptr );
+      else
+         refinement.emplace_back(
+            std::max( 0, yEnd ), mPanel.GetBackgroundCell() );
+
+      return { Axis::Y, std::move( refinement ) };
+   }
+
    Subdivision Children( const wxRect &rect ) override
    {
       const auto &viewInfo = *mPanel.GetViewInfo();
@@ -1604,6 +1764,21 @@ struct MainGroup final : TrackPanelGroup {
 
 }
 
+auto TrackPanel::GetLeaders() -> const std::vector<std::shared_ptr<Track>> &
+{
+   // Events from the track list are queued, so also compare the count of
+   // tracks, which is updated at once
+   const auto nTracks = mTracks->size();
+   if ( !mLeadersValid || nTracks != mLeadersNumTracks ) {
+      mLeaders.clear();
+      for ( auto pLeader : mTracks->Leaders() )
+         mLeaders.push_back( pLeader->SharedPointer() );
+      mLeadersNumTracks = nTracks;
+      mLeadersValid = true;
+   }
+   return mLeaders;
+}
+
 std::shared_ptr<TrackPanelNode> TrackPanel::Root()
 {
    // Root and other subgroup objects are throwaways.
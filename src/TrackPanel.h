@@ -12,6 +12,7 @@
 #define __AUDACITY_TRACK_PANEL__
 
 
+#include <optional>
 #include <vector>
 
 #include <wx/setup.h> // for wxUSE_* macros
@@ -108,8 +109,28 @@ class TENACITY_DLL_API TrackPanel final
       (bool eraseBackground = true, const wxRect *rect = (const wxRect *) NULL)
       override;
 
+   // If refreshbacking, only the track's part of the backing bitmap is
+   // redrawn
    void RefreshTrack(Track *trk, bool refreshbacking = true);
 
+   //! Counts of the work of repainting, to verify that its cost does not
+   //! grow with the number of tracks when only a little changes
+   struct RepaintStatistics {
+      size_t nPaints{ 0 };
+      //! Paints that redrew all of the backing bitmap
+      size_t nFullRedraws{ 0 };
+      //! Paints that redrew only the stale parts of the backing bitmap
+      size_t nPartialRedraws{ 0 };
+      //! Calls to Draw of cells, groups and handles, in all passes
+      size_t nCellDraws{ 0 };
+      //! Area of the backing bitmap redrawn
+      unsigned long long nPixelsRedrawn{ 0 };
+      //! Area copied from the backing bitmap to the screen
+      unsigned long long nPixelsRepaired{ 0 };
+   };
+   const RepaintStatistics &GetRepaintStatistics() const
+   { return mRepaintStatistics; }
+
    void HandlePageUpKey();
    void HandlePageDownKey();
    TenacityProject * GetProject() const override;
@@ -173,8 +194,17 @@ public:
    TrackPanelListener * GetListener(){ return mListener;}
    AdornedRulerPanel * GetRuler(){ return mRuler;}
 
+   //! Leaders of the track list in order, cached for binary search by
+   //! vertical position
+   const std::vector<std::shared_ptr<Track>> &GetLeaders();
+
 protected:
-   void DrawTracks(wxDC * dc);
+   // If pDamage is not null, draw only the cells that intersect it
+   void DrawTracks(wxDC * dc, const wxRect *pDamage = nullptr);
+
+   // While recording, refresh only the newly recorded columns of the tracks
+   // being recorded into
+   void RefreshCapture();
 
 public:
    // Set the object that performs catch-all event handling when the pointer
@@ -216,6 +246,17 @@ protected:
    int mTimeCount;
 
    bool mRefreshBacking;
+   // Part of the backing bitmap to redraw at the next paint, if not all
+   wxRect mBackingDamage;
+   // End time of the recording, when last refreshed
+   std::optional<double> mLastRefreshedCaptureEnd;
+
+   RepaintStatistics mRepaintStatistics;
+
+   // Cache for GetLeaders()
+   std::vector<std::shared_ptr<Track>> mLeaders;
+   size_t mLeadersNumTracks{ 0 };
+   bool mLeadersValid{ false };
 
 protected:
 
@@ -30,6 +30,12 @@ TrackPanelGroup::~TrackPanelGroup()
 {
 }
 
+auto TrackPanelGroup::VisibleChildren( const wxRect &rect, const wxRect & )
+   -> Subdivision
+{
+   return Children( rect );
+}
+
 TrackPanelCell::~TrackPanelCell()
 {
 }
@@ -66,6 +66,13 @@ public:
 
    // Report a subdivision of one of the axes of the given rectangle
    virtual Subdivision Children( const wxRect &rect ) = 0;
+
+   // Like Children, but children wholly outside of clip may be left out,
+   // so long as the sub-rectangles of the others do not change (as when a
+   // null follows the last).  For groups with very many children.
+   // The default reports all children.
+   virtual Subdivision VisibleChildren(
+      const wxRect &rect, const wxRect &clip );
 };
 
 /// Abstract base class defining TrackPanel's access to specialist classes that
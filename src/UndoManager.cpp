@@ -25,17 +25,25 @@ UndoManager
 
 #include <wx/hashset.h>
 
+#include <lib-exceptions/TenacityException.h>
+#include <lib-track/Envelope.h>
+
 #include "Clipboard.h"
 #include "Diags.h"
+#include "LabelTrack.h"
 #include "Project.h"
+#include "ProjectFileIO.h"
+#include "ProjectSerializer.h"
 #include "SampleBlock.h"
 #include "Sequence.h"
 #include "WaveTrack.h"          // temp
 #include "Diags.h"
 #include "Tags.h"
 #include "TransactionScope.h"
+#include "WaveClip.h"
 #include "widgets/ProgressDialog.h"
 
+#include <algorithm>
 #include <unordered_set>
 #include <optional>
 
@@ -46,7 +54,7 @@ wxDEFINE_EVENT(EVT_UNDO_OR_REDO, wxCommandEvent);
 wxDEFINE_EVENT(EVT_UNDO_RESET, wxCommandEvent);
 wxDEFINE_EVENT(EVT_UNDO_PURGE, wxCommandEvent);
 
-using SampleBlockID = long long;
+IntSetting UndoHistoryMemoryLimit{ L"/History/MemoryLimitMB", 512 };
 
 static const TenacityProject::AttachedObjects::RegisteredFactory key{
    [](TenacityProject &project)
@@ -95,8 +103,6 @@ void UndoManager::CalculateSpaceUsage()
    space.clear();
    space.resize(stack.size(), 0);
 
-   SampleBlockIDSet seen;
-
    // After copies and pastes, a block file may be used in more than
    // one place in one undo history state, and it may be used in more than
    // one undo history state.  It might even be used in two states, but not
@@ -111,16 +117,33 @@ void UndoManager::CalculateSpaceUsage()
    // DELETE all states containing the block file.  So the block file's
    // contribution to space usage should be counted only in that latest state.
 
-   for (size_t nn = stack.size(); nn--;)
-   {
-      // Scan all tracks at current level
-      auto &tracks = *stack[nn]->state.tracks;
-      space[nn] = CalculateUsage(tracks, seen);
+   // The ids of the blocks of each state were recorded as states were
+   // pushed, so this need not visit the tracks of every state, some of which
+   // may not even be in memory.  Lists of ids shared by several states are
+   // visited once only.
+   std::unordered_set<const void *> visitedLists;
+   SampleBlockIDSet seen;
+   // Forget the sizes of blocks that no state uses any more
+   std::unordered_map<SampleBlockID, unsigned long long> blockBytes;
+   for (auto n = stack.size(); n--;) {
+      for (const auto &pIds : stack[n]->blockIds) {
+         if (!visitedLists.insert(pIds.get()).second)
+            continue;
+         for (auto id : *pIds) {
+            if (!seen.insert(id).second)
+               continue;
+            auto iter = mBlockBytes.find(id);
+            const auto bytes = (iter == mBlockBytes.end()) ? 0 : iter->second;
+            space[n] += bytes;
+            blockBytes.emplace(id, bytes);
+         }
+      }
    }
+   mBlockBytes.swap(blockBytes);
 
-   // Count the usage of the clipboard separately, using another set.  Do not
-   // multiple-count any block occurring multiple times within the clipboard.
-   seen.clear();
+   // Count the usage of the clipboard separately.  Do not multiple-count any
+   // block occurring multiple times within the clipboard.
+   SampleBlockIDSet seen;
    mClipboardSpaceUsage = CalculateUsage(
       Clipboard::Get().GetTracks(), seen);
 
@@ -157,6 +180,22 @@ void UndoManager::SetLongDescription(
    stack[n]->description = desc;
 }
 
+namespace {
+   //! Ids of the stored blocks of a state, each once, for retention by the
+   //! sample block factory
+   std::vector<SampleBlockID> StoredBlockIds(const UndoStackElem &elem)
+   {
+      std::vector<SampleBlockID> result;
+      SampleBlockIDSet seen;
+      for (const auto &pIds : elem.blockIds)
+         for (auto id : *pIds)
+            // Silent blocks have no storage
+            if (id > 0 && seen.insert(id).second)
+               result.push_back(id);
+      return result;
+   }
+}
+
 void UndoManager::RemoveStateAt(int n)
 {
    // Remove the state from the array first, and destroy it at function exit.
@@ -167,6 +206,246 @@ void UndoManager::RemoveStateAt(int n)
    auto iter = stack.begin() + n;
    auto state = std::move(*iter);
    stack.erase(iter);
+
+   RemoveIdUses(state->blockIds);
+   if (state->spilled) {
+      // Deletes the stored blocks that nothing else uses
+      WaveTrackFactory::Get(mProject).GetSampleBlockFactory()
+         ->ReleaseBlocks(StoredBlockIds(*state));
+      ProjectFileIO::Get(mProject).DeleteUndoState(state->serial);
+   }
+   else
+      RemoveArrayUses(state->blockArrays);
+}
+
+void UndoManager::AddBlockUses(UndoStackElem &elem,
+   const std::vector<const BlockArray *> &knownArrays,
+   const std::vector<UndoBlockIds> &knownIds)
+{
+   // Arrays that the state shares with knownArrays have the same blocks, so
+   // that only the arrays of changed clips are visited
+   std::unordered_map<const BlockArray *, UndoBlockIds> known;
+   for (size_t ii = 0; ii < knownArrays.size(); ++ii)
+      known.emplace(knownArrays[ii], knownIds[ii]);
+
+   elem.blockIds.clear();
+   elem.blockArrays.clear();
+   elem.memory = 0;
+   std::unordered_set<const BlockArray *> seen;
+   const auto addArray = [&](const BlockArray &blocks){
+      if (!seen.insert(&blocks).second)
+         return;
+
+      UndoBlockIds pIds;
+      if (auto iter = known.find(&blocks); iter != known.end())
+         pIds = iter->second;
+      else {
+         auto pNewIds = std::make_shared<std::vector<SampleBlockID>>();
+         pNewIds->reserve(blocks.size());
+         for (const auto &seqBlock : blocks) {
+            const auto &block = *seqBlock.sb;
+            const auto id = block.GetBlockID();
+            pNewIds->push_back(id);
+            if (mBlockBytes.find(id) == mBlockBytes.end())
+               mBlockBytes.emplace(id, block.GetSpaceUsage());
+         }
+         pIds = std::move(pNewIds);
+      }
+
+      auto &arrayUse = mArrayUses[&blocks];
+      if (arrayUse.states++ == 0)
+         arrayUse.bytes = blocks.capacity() * sizeof(SeqBlock);
+      auto &idsUse = mIdListUses[pIds.get()];
+      if (idsUse.states++ == 0)
+         idsUse.bytes = pIds->capacity() * sizeof(SampleBlockID);
+
+      elem.blockArrays.push_back(&blocks);
+      elem.blockIds.push_back(std::move(pIds));
+   };
+
+   for (auto pTrack : elem.state.tracks->Any()) {
+      elem.memory += sizeof(Track);
+      pTrack->TypeSwitch(
+         [&](const WaveTrack *pWaveTrack) {
+            for (auto pClip : pWaveTrack->GetAllClips()) {
+               elem.memory += sizeof(WaveClip);
+               if (auto pBlocks = pClip->GetSequenceBlockArray())
+                  addArray(*pBlocks);
+               if (auto pEnvelope = pClip->GetEnvelope())
+                  elem.memory +=
+                     pEnvelope->GetNumberOfPoints() * sizeof(EnvPoint);
+            }
+         },
+         [&](const LabelTrack *pLabelTrack) {
+            for (auto &label : pLabelTrack->GetLabels())
+               elem.memory += sizeof(LabelStruct) +
+                  label.title.length() * sizeof(wxChar);
+         }
+      );
+   }
+}
+
+size_t UndoManager::RemoveArrayUses(
+   const std::vector<const BlockArray *> &arrays)
+{
+   size_t result = 0;
+   for (auto pBlocks : arrays) {
+      auto iter = mArrayUses.find(pBlocks);
+      if (iter == mArrayUses.end())
+         continue;
+      if (--iter->second.states == 0) {
+         result += iter->second.bytes;
+         mArrayUses.erase(iter);
+      }
+   }
+   return result;
+}
+
+void UndoManager::RemoveIdUses(const std::vector<UndoBlockIds> &ids)
+{
+   for (const auto &pIds : ids) {
+      auto iter = mIdListUses.find(pIds.get());
+      if (iter != mIdListUses.end() && --iter->second.states == 0)
+         mIdListUses.erase(iter);
+   }
+}
+
+void UndoManager::ConstrainMemory()
+{
+   const long long limit = UndoHistoryMemoryLimit.Read();
+   if (limit <= 0)
+      return;
+   const size_t maxMemory = limit * 1024 * 1024;
+
+   // Shared arrays and lists of ids count once.  The lists remain for
+   // spilled states, but they are much smaller than the tracks.
+   size_t total = 0;
+   for (auto &pElem : stack)
+      if (!pElem->spilled)
+         total += pElem->memory;
+   for (const auto &pair : mArrayUses)
+      total += pair.second.bytes;
+   for (const auto &pair : mIdListUses)
+      total += pair.second.bytes;
+
+   // Oldest states go first; never the current or saved states, which other
+   // parts of the program may inspect
+   for (size_t ii = 0; total > maxMemory && ii < stack.size(); ++ii) {
+      auto &elem = *stack[ii];
+      if (elem.spilled ||
+          ii == static_cast<size_t>(current) ||
+          static_cast<int>(ii) == saved)
+         continue;
+      total -= std::min(total, Spill(elem));
+   }
+}
+
+size_t UndoManager::Spill(UndoStackElem &elem)
+{
+   // Blocks that read other files would be stored as references to those
+   // files, and made again with new ids; keep them all in memory instead,
+   // where saving can find and materialize them
+   bool hasReferences = false;
+   InspectBlocks(*elem.state.tracks, [&](const SampleBlock &block){
+      hasReferences = hasReferences || block.IsReference();
+   });
+   if (hasReferences)
+      return 0;
+
+   // The stored blocks must outlive their objects, which go with the tracks;
+   // if the factory can't keep them, keep the state in memory
+   auto &pFactory = WaveTrackFactory::Get(mProject).GetSampleBlockFactory();
+   const auto ids = StoredBlockIds(elem);
+   if (!pFactory->RetainBlocks(ids))
+      return 0;
+
+   ProjectSerializer doc;
+   doc.StartTag(wxT("undostate"));
+   for (auto pTrack : elem.state.tracks->Any())
+      pTrack->WriteXML(doc);
+   doc.EndTag(wxT("undostate"));
+
+   if (!ProjectFileIO::Get(mProject).WriteUndoState(elem.serial, doc)) {
+      // Not fatal; just keep the state in memory
+      wxLogDebug(wxT("Could not move undo state %llu out of memory"),
+         elem.serial);
+      pFactory->ReleaseBlocks(ids);
+      return 0;
+   }
+
+   // Only the ids of the blocks stay in memory; the factory makes the blocks
+   // again from the stored rows when the state is restored
+   const auto freed = elem.memory + RemoveArrayUses(elem.blockArrays);
+   elem.blockArrays.clear();
+   elem.state.tracks.reset();
+   elem.spilled = true;
+   mSpilled = true;
+   return freed;
+}
+
+namespace {
+// Reads the document written by UndoManager::Spill, creating tracks by the
+// same registry as for loading of projects
+struct UndoStateReader final : XMLTagHandler {
+   explicit UndoStateReader(TenacityProject &project)
+      : mProject{ project }
+   {}
+
+   bool HandleXMLTag(const std::string_view& tag, const AttributesList &)
+      override
+   {
+      return tag == "undostate";
+   }
+
+   XMLTagHandler *HandleXMLChild(const std::string_view& tag) override
+   {
+      return ProjectFileIORegistry::Get().CallObjectAccessor(tag, mProject);
+   }
+
+   TenacityProject &mProject;
+};
+}
+
+void UndoManager::EnsureResident(size_t n)
+{
+   auto &elem = *stack[n];
+   if (!elem.spilled)
+      return;
+
+   // The registered readers add new tracks to the project's list; so
+   // set its contents aside while reading, and restore them in any case
+   auto &tracks = TrackList::Get(mProject);
+   auto stash = TrackList::Create(nullptr);
+   auto loaded = TrackList::Create(nullptr);
+   {
+      stash->Swap(tracks);
+      auto cleanup = finally([&]{
+         loaded->Swap(tracks);
+         tracks.Swap(*stash);
+      });
+
+      UndoStateReader reader{ mProject };
+      if (!ProjectFileIO::Get(mProject).ReadUndoState(elem.serial, &reader))
+         throw SimpleMessageBoxException{
+            ExceptionType::Internal,
+            XO("Failed to restore a state of the undo history"),
+            XO("Warning")
+         };
+   }
+
+   for (auto pTrack : loaded->Any())
+      pTrack->LinkConsistencyCheck();
+
+   // No-fail from here
+   const auto ids = StoredBlockIds(elem);
+   elem.state.tracks = std::move(loaded);
+   elem.spilled = false;
+   RemoveIdUses(elem.blockIds);
+   AddBlockUses(elem, {}, {});
+   // The restored blocks now keep their rows
+   WaveTrackFactory::Get(mProject).GetSampleBlockFactory()
+      ->ReleaseBlocks(ids);
+   ProjectFileIO::Get(mProject).DeleteUndoState(elem.serial);
 }
 
 
@@ -180,7 +459,8 @@ size_t UndoManager::EstimateRemovedBlocks(size_t begin, size_t end)
    // Collect ids that survive
    SampleBlockIDSet wontDelete;
    auto f = [&](const auto &p){
-      InspectBlocks(*p->state.tracks, {}, &wontDelete);
+      for (const auto &pIds : p->blockIds)
+         wontDelete.insert(pIds->begin(), pIds->end());
    };
    auto first = stack.begin(), last = stack.end();
    std::for_each( first, first + begin, f );
@@ -190,15 +470,12 @@ size_t UndoManager::EstimateRemovedBlocks(size_t begin, size_t end)
    InspectBlocks(TrackList::Get(mProject), {}, &wontDelete);
 
    // Collect ids that won't survive (and are not negative pseudo ids)
-   SampleBlockIDSet seen, mayDelete;
+   SampleBlockIDSet mayDelete;
    std::for_each( first + begin, first + end, [&](const auto &p){
-      auto &tracks = *p->state.tracks;
-      InspectBlocks(tracks, [&]( const SampleBlock &block ){
-         auto id = block.GetBlockID();
-         if ( id > 0 && !wontDelete.count( id ) )
-            mayDelete.insert( id );
-      },
-      &seen);
+      for (const auto &pIds : p->blockIds)
+         for (auto id : *pIds)
+            if ( id > 0 && !wontDelete.count( id ) )
+               mayDelete.insert( id );
    } );
    return mayDelete.size();
 }
@@ -245,11 +522,65 @@ void UndoManager::RemoveStates(size_t begin, size_t end)
       nDeleted == nToDelete, "Block count was misestimated");
 }
 
+void UndoManager::UpdateBlockIds()
+{
+   // States sharing an array share its list of ids, and a changed list is
+   // replaced for all of them
+   std::unordered_map<const BlockArray *, UndoBlockIds> lists;
+   for (auto &pElem : stack) {
+      auto &elem = *pElem;
+      for (size_t ii = 0; ii < elem.blockArrays.size(); ++ii) {
+         const auto pBlocks = elem.blockArrays[ii];
+         auto &pIds = elem.blockIds[ii];
+         auto [iter, inserted] = lists.try_emplace(pBlocks, pIds);
+         if (inserted) {
+            const auto &blocks = *pBlocks;
+            const auto &ids = *pIds;
+            const auto changed = [&](size_t jj){
+               return blocks[jj].sb->GetBlockID() != ids[jj]; };
+            size_t jj = 0;
+            while (jj < blocks.size() && !changed(jj))
+               ++jj;
+            if (jj == blocks.size())
+               continue;
+            auto pNewIds = std::make_shared<std::vector<SampleBlockID>>(ids);
+            for (; jj < blocks.size(); ++jj) {
+               const auto &block = *blocks[jj].sb;
+               const auto id = block.GetBlockID();
+               if (id != ids[jj] &&
+                   mBlockBytes.find(id) == mBlockBytes.end())
+                  mBlockBytes.emplace(id, block.GetSpaceUsage());
+               (*pNewIds)[jj] = id;
+            }
+            iter->second = std::move(pNewIds);
+         }
+         if (iter->second == pIds)
+            continue;
+         RemoveIdUses({ pIds });
+         pIds = iter->second;
+         auto &idsUse = mIdListUses[pIds.get()];
+         if (idsUse.states++ == 0)
+            idsUse.bytes = pIds->capacity() * sizeof(SampleBlockID);
+      }
+   }
+   // Sizes for the old ids are forgotten by CalculateSpaceUsage()
+}
+
 void UndoManager::ClearStates()
 {
    RemoveStates(0, stack.size());
    current = -1;
    saved = -1;
+   mArrayUses.clear();
+   mIdListUses.clear();
+   mBlockBytes.clear();
+
+   if (mSpilled) {
+      auto &projectFileIO = ProjectFileIO::Get(mProject);
+      if (projectFileIO.HasConnection())
+         projectFileIO.DeleteUndoStates();
+      mSpilled = false;
+   }
 }
 
 unsigned int UndoManager::GetNumStates()
@@ -281,8 +612,7 @@ void UndoManager::ModifyState(const TrackList * l,
    }
 
 //   SonifyBeginModifyState();
-   // Delete current -- not necessary, but let's reclaim space early
-   stack[current]->state.tracks.reset();
+   auto &elem = *stack[current];
 
    // Duplicate
    auto tracksCopy = TrackList::Create( nullptr );
@@ -293,13 +623,23 @@ void UndoManager::ModifyState(const TrackList * l,
       tracksCopy->Add(t->Duplicate());
    }
 
-   // Replace
-   stack[current]->state.tracks = std::move(tracksCopy);
-   stack[current]->state.tags = tags;
-
-   stack[current]->state.selectedRegion = selectedRegion;
+   // Replace, but keep the old tracks until the new ones have taken the ids of
+   // the arrays they share with them
+   auto oldTracks = std::move(elem.state.tracks);
+   auto oldArrays = std::move(elem.blockArrays);
+   auto oldIds = std::move(elem.blockIds);
+   elem.state.tracks = std::move(tracksCopy);
+   elem.state.tags = tags;
+
+   elem.state.selectedRegion = selectedRegion;
+   AddBlockUses(elem, oldArrays, oldIds);
+   RemoveArrayUses(oldArrays);
+   RemoveIdUses(oldIds);
+   oldTracks.reset();
 //   SonifyEndModifyState();
 
+   ConstrainMemory();
+
    // wxWidgets will own the event object
    mProject.QueueEvent( safenew wxCommandEvent{ EVT_UNDO_MODIFIED } );
 }
@@ -360,6 +700,18 @@ void UndoManager::PushState(const TrackList * l,
 
    current++;
 
+   auto &elem = *stack.back();
+   elem.serial = mNextSerial++;
+   // Only the clips changed since the previous state, which is resident
+   // because it was the current one, have new block arrays
+   if (current > 0) {
+      const auto &previous = *stack[current - 1];
+      AddBlockUses(elem, previous.blockArrays, previous.blockIds);
+   }
+   else
+      AddBlockUses(elem, {}, {});
+   ConstrainMemory();
+
    lastAction = longDescription;
 
    // wxWidgets will own the event object
@@ -378,6 +730,8 @@ void UndoManager::SetStateTo(unsigned int n, const Consumer &consumer)
 {
    wxASSERT(n < stack.size());
 
+   EnsureResident(n);
+
    current = n;
 
    lastAction = {};
@@ -393,6 +747,8 @@ void UndoManager::Undo(const Consumer &consumer)
 {
    wxASSERT(UndoAvailable());
 
+   EnsureResident(current - 1);
+
    current--;
 
    lastAction = {};
@@ -408,6 +764,8 @@ void UndoManager::Redo(const Consumer &consumer)
 {
    wxASSERT(RedoAvailable());
 
+   EnsureResident(current + 1);
+
    current++;
 
    /*
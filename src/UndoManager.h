@@ -49,8 +49,11 @@
 #ifndef __AUDACITY_UNDOMANAGER__
 #define __AUDACITY_UNDOMANAGER__
 
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include <wx/event.h> // to declare custom event types
+#include <lib-preferences/Prefs.h>
 #include "ClientData.h"
 #include "SelectedRegion.h"
 
@@ -77,11 +80,21 @@ wxDECLARE_EXPORTED_EVENT(TENACITY_DLL_API, EVT_UNDO_RESET, wxCommandEvent);
 // Undo or redo states discarded
 wxDECLARE_EXPORTED_EVENT(TENACITY_DLL_API, EVT_UNDO_PURGE, wxCommandEvent);
 
+class BlockArray;
+class SampleBlock;
 class TenacityProject;
 class Tags;
 class Track;
 class TrackList;
 
+using SampleBlockID = long long;
+//! Ids of the blocks of one block array, shared by the states sharing it
+using UndoBlockIds = std::shared_ptr<const std::vector<SampleBlockID>>;
+
+//! Megabytes of memory that the track copies of undo states may use
+/*! Older states are then moved into the project database.  0 for no limit */
+extern TENACITY_DLL_API IntSetting UndoHistoryMemoryLimit;
+
 struct UndoState {
    UndoState(std::shared_ptr<TrackList> &&tracks_,
       const std::shared_ptr<Tags> &tags_,
@@ -110,6 +123,26 @@ struct UndoStackElem {
    UndoState state;
    TranslatableString description;
    TranslatableString shortDescription;
+
+   //! Identifies the state for the accounting of blocks, and in the database
+   /*! Increases from the bottom of the stack to the top */
+   unsigned long long serial{};
+   //! Ids of the sample blocks of each block array used by the state
+   /*! An id may occur in more than one list.  The lists remain when the
+    state is spilled */
+   std::vector<UndoBlockIds> blockIds;
+   //! The arrays that blockIds describe, while the state is in memory
+   std::vector<const BlockArray *> blockArrays;
+   //! Rough estimate of the memory used by state.tracks, except for block
+   //! arrays, which states may share, and which UndoManager counts once
+   size_t memory{};
+
+   //! Whether state.tracks was moved into the project database
+   /*! If so, state.tracks is null, except while the state is being used by
+    a consumer passed to UndoManager.  The sample block factory retains the
+    stored blocks of the state.  States with blocks that read from other
+    files stay in memory. */
+   bool spilled{ false };
 };
 
 using UndoStack = std::vector <std::unique_ptr<UndoStackElem>>;
@@ -183,6 +216,8 @@ class TENACITY_DLL_API UndoManager final
    void Redo(const Consumer &consumer);
 
    //! Give read-only access to all states
+   /*! state.tracks may be null, for states moved out of memory;
+    but never for the current or the saved state */
    void VisitStates( const Consumer &consumer, bool newestFirst );
    //! Visit a specified range of states
    /*! end is exclusive; visit newer states first if end < begin */
@@ -204,6 +239,12 @@ class TENACITY_DLL_API UndoManager final
 
    void CalculateSpaceUsage();
 
+   //! Account for the new ids of blocks of resident states, after
+   //! SampleBlock::Materialize()
+   /*! States with blocks that read other files are never spilled, so that
+    all of those blocks can be found in the tracks of the states */
+   void UpdateBlockIds();
+
    // void Debug(); // currently unused
 
  private:
@@ -211,6 +252,24 @@ class TENACITY_DLL_API UndoManager final
 
    void RemoveStateAt(int n);
 
+   //! Account for the blocks and memory of elem, which must be resident
+   /*! Arrays among knownArrays are not visited again, but take their ids
+    from the corresponding lists of knownIds */
+   void AddBlockUses(UndoStackElem &elem,
+      const std::vector<const BlockArray *> &knownArrays,
+      const std::vector<UndoBlockIds> &knownIds);
+   //! @return the bytes of the arrays no longer used by any resident state
+   size_t RemoveArrayUses(const std::vector<const BlockArray *> &arrays);
+   void RemoveIdUses(const std::vector<UndoBlockIds> &ids);
+
+   //! Move old states out of memory, until the limit is respected
+   void ConstrainMemory();
+   //! @return estimated bytes of memory freed, 0 if the state stays
+   size_t Spill(UndoStackElem &elem);
+   //! Bring stack[n] back into memory if it was spilled
+   /*! @excsafety{Strong} */
+   void EnsureResident(size_t n);
+
    TenacityProject &mProject;
  
    int current;
@@ -222,6 +281,21 @@ class TENACITY_DLL_API UndoManager final
 
    SpaceArray space;
    unsigned long long mClipboardSpaceUsage {};
+
+   // Shared block arrays, and lists of their ids, with the counts of the
+   // states using each, so that the memory of each is counted once
+   struct SharedUse {
+      size_t states{};
+      size_t bytes{};
+   };
+   std::unordered_map<const BlockArray *, SharedUse> mArrayUses;
+   std::unordered_map<const void *, SharedUse> mIdListUses;
+   //! Disk space of each block, measured only once, because that may query
+   //! the database
+   std::unordered_map<SampleBlockID, unsigned long long> mBlockBytes;
+   unsigned long long mNextSerial{ 1 };
+   //! Whether any state was ever spilled since the history was cleared
+   bool mSpilled{ false };
 };
 
 #endif
@@ -42,6 +42,16 @@ WaveClipListener::~WaveClipListener()
 {
 }
 
+void WaveClipListener::MarkAppended(sampleCount,
+   constSamplePtr, sampleFormat, size_t, unsigned int)
+{
+   MarkChanged();
+}
+
+void WaveClipListener::MarkFlushed()
+{
+}
+
 WaveClip::WaveClip(const SampleBlockFactoryPtr &factory,
                    sampleFormat format, int rate, int colourIndex)
 {
@@ -221,6 +231,9 @@ std::shared_ptr<SampleBlock> WaveClip::AppendNewBlock(
 void WaveClip::AppendSharedBlock(const std::shared_ptr<SampleBlock> &pBlock)
 {
    mSequence->AppendSharedBlock( pBlock );
+   // use No-fail-guarantee
+   UpdateEnvelopeTrackLen();
+   MarkChanged();
 }
 
 /*! @excsafety{Partial}
@@ -228,6 +241,19 @@ void WaveClip::AppendSharedBlock(const std::shared_ptr<SampleBlock> &pBlock)
 and no content already flushed to disk is lost. */
 bool WaveClip::Append(constSamplePtr buffer, sampleFormat format,
                       size_t len, unsigned int stride)
+{
+   return DoAppend(buffer, format, len, stride, false);
+}
+
+/*! @excsafety{Partial} */
+bool WaveClip::AppendRecorded(constSamplePtr buffer, sampleFormat format,
+                      size_t len, unsigned int stride)
+{
+   return DoAppend(buffer, format, len, stride, true);
+}
+
+bool WaveClip::DoAppend(constSamplePtr buffer, sampleFormat format,
+                      size_t len, unsigned int stride, bool recorded)
 {
    //wxLogDebug(wxT("Append: len=%lli"), (long long) len);
    bool result = false;
@@ -239,10 +265,21 @@ bool WaveClip::Append(constSamplePtr buffer, sampleFormat format,
    if (!mAppendBuffer.ptr())
       mAppendBuffer.Allocate(maxBlockSize, seqFormat);
 
+   const auto start = mSequence->GetNumSamples() + mAppendBufferLen;
+   const auto origBuffer = buffer;
+   const auto origLen = len;
    auto cleanup = finally( [&] {
       // use No-fail-guarantee
       UpdateEnvelopeTrackLen();
-      MarkChanged();
+      if (recorded)
+         // Tell caches what was appended, so that they might update
+         // incrementally; len counts what was not
+         Caches::ForEach( [&]( WaveClipListener &listener ){
+            listener.MarkAppended(
+               start, origBuffer, format, origLen - len, stride );
+         } );
+      else
+         MarkChanged();
    } );
 
    for(;;) {
@@ -293,6 +330,12 @@ void WaveClip::Flush()
    //wxLogDebug(wxT("   mAppendBufferLen=%lli"), (long long) mAppendBufferLen);
    //wxLogDebug(wxT("   previous sample count %lli"), (long long) mSequence->GetNumSamples());
 
+   // Even if nothing remains to flush, caches may drop what they kept of
+   // the appends, as for drawing while recording
+   auto flushed = finally( [&] {
+      Caches::ForEach( std::mem_fn( &WaveClipListener::MarkFlushed ) );
+   } );
+
    if (mAppendBufferLen > 0) {
 
       auto cleanup = finally( [&] {
@@ -383,15 +426,23 @@ XMLTagHandler *WaveClip::HandleXMLChild(const std::string_view& tag)
       return NULL;
 }
 
+// Names written for every clip of every track are interned
+static const XMLName WaveClipTag{ "waveclip" };
+static const XMLName OffsetAttr{ "offset" };
+static const XMLName TrimLeftAttr{ "trimLeft" };
+static const XMLName TrimRightAttr{ "trimRight" };
+static const XMLName NameAttr{ "name" };
+static const XMLName ColorIndexAttr{ "colorindex" };
+
 void WaveClip::WriteXML(XMLWriter &xmlFile) const
 // may throw
 {
-   xmlFile.StartTag(wxT("waveclip"));
-   xmlFile.WriteAttr(wxT("offset"), mSequenceOffset, 8);
-   xmlFile.WriteAttr(wxT("trimLeft"), mTrimLeft, 8);
-   xmlFile.WriteAttr(wxT("trimRight"), mTrimRight, 8);
-   xmlFile.WriteAttr(wxT("name"), mName);
-   xmlFile.WriteAttr(wxT("colorindex"), mColourIndex );
+   xmlFile.StartTag(WaveClipTag);
+   xmlFile.WriteAttr(OffsetAttr, mSequenceOffset, 8);
+   xmlFile.WriteAttr(TrimLeftAttr, mTrimLeft, 8);
+   xmlFile.WriteAttr(TrimRightAttr, mTrimRight, 8);
+   xmlFile.WriteAttr(NameAttr, mName);
+   xmlFile.WriteAttr(ColorIndexAttr, mColourIndex );
 
    mSequence->WriteXML(xmlFile);
    mEnvelope->WriteXML(xmlFile);
@@ -399,7 +450,7 @@ void WaveClip::WriteXML(XMLWriter &xmlFile) const
    for (const auto &clip: mCutLines)
       clip->WriteXML(xmlFile);
 
-   xmlFile.EndTag(wxT("waveclip"));
+   xmlFile.EndTag(WaveClipTag);
 }
 
 /*! @excsafety{Strong} */
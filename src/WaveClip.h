@@ -88,12 +88,29 @@ struct TENACITY_DLL_API WaveClipListener
    virtual ~WaveClipListener() = 0;
    virtual void MarkChanged() = 0;
    virtual void Invalidate() = 0;
+
+   //! Samples were recorded at the end of the clip, and nothing else changed
+   /*! Called by WaveClip::AppendRecorded(), in the recording thread; other
+    appends call MarkChanged().
+    @param start number of samples in the clip before the append
+    Default implementation calls MarkChanged() */
+   virtual void MarkAppended(sampleCount start,
+      constSamplePtr buffer, sampleFormat format, size_t len,
+      unsigned int stride);
+
+   //! The clip was flushed, so appending is over, whether or not anything
+   //! remained to flush
+   /*! Default implementation does nothing */
+   virtual void MarkFlushed();
 };
 
 class TENACITY_DLL_API WaveClip final : public XMLTagHandler
    , public ClientData::Site< WaveClip, WaveClipListener >
 {
 private:
+   bool DoAppend(constSamplePtr buffer, sampleFormat format,
+               size_t len, unsigned int stride, bool recorded);
+
    // It is an error to copy a WaveClip without specifying the
    // sample block factory.
 
@@ -235,6 +252,11 @@ public:
    /// @return true if at least one complete block was created
    bool Append(constSamplePtr buffer, sampleFormat format,
                size_t len, unsigned int stride);
+   //! Append as Append() does, telling the caches what was appended
+   /*! For recording, so that the display may update incrementally; other
+    appends only mark the caches changed */
+   bool AppendRecorded(constSamplePtr buffer, sampleFormat format,
+               size_t len, unsigned int stride);
    /// Flush must be called after last Append
    void Flush();
 
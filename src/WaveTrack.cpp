@@ -1775,6 +1775,12 @@ bool WaveTrack::Append(constSamplePtr buffer, sampleFormat format,
    return RightmostOrNewClip()->Append(buffer, format, len, stride);
 }
 
+bool WaveTrack::AppendRecorded(constSamplePtr buffer, sampleFormat format,
+                       size_t len, unsigned int stride /* = 1 */)
+{
+   return RightmostOrNewClip()->AppendRecorded(buffer, format, len, stride);
+}
+
 sampleCount WaveTrack::GetBlockStart(sampleCount s) const
 {
    for (const auto &clip : mClips)
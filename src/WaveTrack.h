@@ -244,6 +244,9 @@ private:
     */
    bool Append(constSamplePtr buffer, sampleFormat format,
                size_t len, unsigned int stride=1) override;
+   //! Append recorded samples, as WaveClip::AppendRecorded() does
+   bool AppendRecorded(constSamplePtr buffer, sampleFormat format,
+               size_t len, unsigned int stride=1);
    void Flush() override;
 
    ///
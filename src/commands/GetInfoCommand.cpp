@@ -17,6 +17,7 @@ This class now lists
 - Clips
 - Labels
 - Boxes
+- Repaints
 
 *//*******************************************************************/
 
@@ -70,6 +71,7 @@ enum {
    kEnvelopes,
    kLabels,
    kBoxes,
+   kRepaints,
    nTypes
 };
 
@@ -84,6 +86,7 @@ static const EnumValueSymbol kTypes[nTypes] =
    { XO("Envelopes") },
    { XO("Labels") },
    { XO("Boxes") },
+   { XO("Repaints") },
 };
 
 enum {
@@ -164,6 +167,7 @@ bool GetInfoCommand::ApplyInner(const CommandContext &context)
       case kEnvelopes    : return SendEnvelopes( context );
       case kLabels       : return SendLabels( context );
       case kBoxes        : return SendBoxes( context );
+      case kRepaints     : return SendRepaints( context );
       default:
          context.Status( "Command options not recognised" );
    }
@@ -464,6 +468,25 @@ bool GetInfoCommand::SendBoxes(const CommandContext &context)
    return true;
 }
 
+bool GetInfoCommand::SendRepaints(const CommandContext &context)
+{
+   // Cumulative counts; compare before and after some playback to find the
+   // cost of each repaint
+   auto &trackPanel = TrackPanel::Get( context.project );
+   const auto &stats = trackPanel.GetRepaintStatistics();
+   context.StartStruct();
+   context.AddItem( (double)stats.nPaints, "paints" );
+   context.AddItem( (double)stats.nFullRedraws, "fullRedraws" );
+   context.AddItem( (double)stats.nPartialRedraws, "partialRedraws" );
+   context.AddItem( (double)stats.nCellDraws, "cellDraws" );
+   context.AddItem( (double)stats.nPixelsRedrawn, "pixelsRedrawn" );
+   context.AddItem( (double)stats.nPixelsRepaired, "pixelsRepaired" );
+   context.AddItem( (double)TrackList::Get( context.project ).Leaders().size(),
+      "tracks" );
+   context.EndStruct();
+   return true;
+}
+
 bool GetInfoCommand::SendTracks(const CommandContext & context)
 {
    auto &tracks = TrackList::Get( context.project );
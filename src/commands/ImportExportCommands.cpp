@@ -25,6 +25,7 @@
 #include "../ProjectFileManager.h"
 #include "ViewInfo.h"
 #include "../export/Export.h"
+#include "../export/ExportCL.h"
 #include "../SelectUtilities.h"
 #include "../shuttle/Shuttle.h"
 #include "../shuttle/ShuttleGui.h"
@@ -72,6 +73,7 @@ bool ExportCommand::DefineParams( ShuttleParams & S ){
    fn.SetName("exported.wav");
    S.Define(mFileName, wxT("Filename"), fn.GetFullPath());
    S.Define( mnChannels, wxT("NumChannels"),  1 );
+   S.Define( mDescriptor, wxT("Descriptor"), -1, -1, 100000 );
    return true;
 }
 
@@ -88,6 +90,7 @@ void ExportCommand::PopulateOrExchange(ShuttleGui & S)
    {
       S.TieTextBox(XXO("File Name:"),mFileName);
       S.TieTextBox(XXO("Number of Channels:"),mnChannels);
+      S.TieTextBox(XXO("File Descriptor:"),mDescriptor);
    }
    S.EndMultiColumn();
 }
@@ -99,6 +102,26 @@ bool ExportCommand::Apply(const CommandContext & context)
    t0 = selectedRegion.t0();
    t1 = selectedRegion.t1();
 
+   // Stream a WAV file, as to an external program, for a shell pipeline
+   if (mDescriptor >= 0)
+   {
+      if (mnChannels < 1)
+      {
+         context.Error(wxT("Export to a descriptor needs at least one channel!"));
+         return false;
+      }
+      if (ExportToDescriptor(context.project, mDescriptor, mnChannels,
+            true, t0, t1))
+      {
+         context.Status(wxString::Format(wxT("Exported to descriptor %d"),
+            mDescriptor));
+         return true;
+      }
+      context.Error(wxString::Format(wxT("Could not export to descriptor %d!"),
+         mDescriptor));
+      return false;
+   }
+
    // Find the extension and check it's valid
    int splitAt = mFileName.Find(wxUniChar('.'), true);
    if (splitAt < 0)
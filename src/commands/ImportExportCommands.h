@@ -58,4 +58,6 @@ public:
 public:
    wxString mFileName;
    int mnChannels;
+   //! If not negative, stream to this open file descriptor instead
+   int mDescriptor;
 };
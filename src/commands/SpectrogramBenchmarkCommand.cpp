@@ -0,0 +1,98 @@
+/**********************************************************************
+
+   Tenacity
+
+   SpectrogramBenchmarkCommand.cpp
+
+******************************************************************//**
+
+\file SpectrogramBenchmarkCommand.cpp
+\brief Definitions for SpectrogramBenchmarkCommand class
+
+*//*******************************************************************/
+
+
+#include "SpectrogramBenchmarkCommand.h"
+
+#include <chrono>
+
+#include "LoadCommands.h"
+#include "CommandContext.h"
+#include "SampleTrackCache.h"
+#include "ViewInfo.h"
+#include "../WaveClip.h"
+#include "../WaveTrack.h"
+#include "../shuttle/Shuttle.h"
+#include "../shuttle/ShuttleGui.h"
+#include "../tracks/playabletrack/wavetrack/ui/SpectrumCache.h"
+
+const ComponentInterfaceSymbol SpectrogramBenchmarkCommand::Symbol
+{ XO("Spectrogram Benchmark") };
+
+namespace{ BuiltinCommandsModule::Registration< SpectrogramBenchmarkCommand > reg; }
+
+bool SpectrogramBenchmarkCommand::DefineParams( ShuttleParams & S ){
+   S.Define( mPixelsPerSecond, wxT("PixelsPerSecond"), 100.0, 0.001, 1000000.0 );
+   S.Define( mWidth, wxT("Width"), 1000, 1, 100000 );
+   S.Define( mRepeat, wxT("Repeat"), 10, 1, 10000 );
+   return true;
+}
+
+void SpectrogramBenchmarkCommand::PopulateOrExchange(ShuttleGui & S)
+{
+   S.AddSpace(0, 5);
+
+   S.StartMultiColumn(2, wxALIGN_CENTER);
+   {
+      S.TieNumericTextBox(XXO("Pixels per second:"), mPixelsPerSecond);
+      S.TieNumericTextBox(XXO("Width:"), mWidth);
+      S.TieNumericTextBox(XXO("Repeat:"), mRepeat);
+   }
+   S.EndMultiColumn();
+}
+
+bool SpectrogramBenchmarkCommand::Apply(const CommandContext & context)
+{
+   // Use the clip of the first selected wave track at the selection start,
+   // with that track's spectrogram settings
+   auto &project = context.project;
+   const double t0 = ViewInfo::Get( project ).selectedRegion.t0();
+   auto pTrack = *TrackList::Get( project ).Selected< WaveTrack >().first;
+   if (!pTrack) {
+      context.Error(wxT("No wave track selected."));
+      return false;
+   }
+   const auto pClip = pTrack->GetClipAtTime(t0);
+   if (!pClip) {
+      context.Error(wxT("No clip at the selection start."));
+      return false;
+   }
+
+   SampleTrackCache sampleCache{ pTrack->SharedPointer<const WaveTrack>() };
+   auto &specCache = WaveClipSpectrumCache::Get( *pClip );
+   const double clipT0 = std::max(0.0, t0 - pClip->GetPlayStartTime());
+
+   using Clock = std::chrono::steady_clock;
+   Clock::duration total{};
+   for (int ii = 0; ii < mRepeat; ++ii) {
+      // Make every repetition compute all columns
+      specCache.Invalidate();
+      const float *spectrogram{};
+      const sampleCount *where{};
+      const auto start = Clock::now();
+      specCache.GetSpectrogram( *pClip, sampleCache, spectrogram, where,
+         mWidth, clipT0, mPixelsPerSecond );
+      total += Clock::now() - start;
+      context.Progress( double(ii + 1) / mRepeat );
+   }
+   // Leave the cache for the next drawing to compute, at the zoom it wants
+   specCache.Invalidate();
+
+   const double ms =
+      std::chrono::duration<double, std::milli>(total).count() / mRepeat;
+   context.Status(wxString::Format(wxT("%.3f"), ms));
+   context.Status(wxString::Format(
+      wxT("Computed %d columns of spectrogram in %.3f ms, average of %d."),
+      mWidth, ms, mRepeat));
+   return true;
+}
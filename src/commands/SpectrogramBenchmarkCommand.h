@@ -0,0 +1,42 @@
+/**********************************************************************
+
+   Tenacity
+
+   SpectrogramBenchmarkCommand.h
+
+******************************************************************//**
+
+\class SpectrogramBenchmarkCommand
+\brief Command to time the computation of a spectrogram, without drawing
+
+*//*******************************************************************/
+
+#ifndef __SPECTROGRAM_BENCHMARK_COMMAND__
+#define __SPECTROGRAM_BENCHMARK_COMMAND__
+
+#include "CommandType.h"
+#include "Command.h"
+
+class SpectrogramBenchmarkCommand final : public AudacityCommand
+{
+public:
+   static const ComponentInterfaceSymbol Symbol;
+
+   // ComponentInterface overrides
+   ComponentInterfaceSymbol GetSymbol() override {return Symbol;};
+   TranslatableString GetDescription() override
+   {return XO("Times the computation of the spectrogram of a clip.");};
+   bool DefineParams( ShuttleParams & S ) override;
+   void PopulateOrExchange(ShuttleGui & S) override;
+   bool Apply(const CommandContext & context) override;
+
+   // AudacityCommand overrides
+   ManualPageID ManualPage() override {return L"Extra_Menu:_Scriptables_II";}
+
+private:
+   double mPixelsPerSecond;
+   int mWidth;
+   int mRepeat;
+};
+
+#endif /* End of include guard: __SPECTROGRAM_BENCHMARK_COMMAND__ */
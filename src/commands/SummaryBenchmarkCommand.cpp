@@ -0,0 +1,100 @@
+/**********************************************************************
+
+   Tenacity
+
+   SummaryBenchmarkCommand.cpp
+
+******************************************************************//**
+
+\file SummaryBenchmarkCommand.cpp
+\brief Definitions for SummaryBenchmarkCommand class
+
+*//*******************************************************************/
+
+
+#include "SummaryBenchmarkCommand.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include <lib-math/SampleSummary.h>
+
+#include "LoadCommands.h"
+#include "CommandContext.h"
+#include "ViewInfo.h"
+#include "../WaveTrack.h"
+#include "../shuttle/Shuttle.h"
+#include "../shuttle/ShuttleGui.h"
+
+const ComponentInterfaceSymbol SummaryBenchmarkCommand::Symbol
+{ XO("Summary Benchmark") };
+
+namespace{ BuiltinCommandsModule::Registration< SummaryBenchmarkCommand > reg; }
+
+bool SummaryBenchmarkCommand::DefineParams( ShuttleParams & S ){
+   S.Define( mRepeat, wxT("Repeat"), 10, 1, 10000 );
+   return true;
+}
+
+void SummaryBenchmarkCommand::PopulateOrExchange(ShuttleGui & S)
+{
+   S.AddSpace(0, 5);
+
+   S.StartMultiColumn(2, wxALIGN_CENTER);
+   {
+      S.TieNumericTextBox(XXO("Repeat:"), mRepeat);
+   }
+   S.EndMultiColumn();
+}
+
+bool SummaryBenchmarkCommand::Apply(const CommandContext & context)
+{
+   // Summarize the selected samples of the first selected wave track, in
+   // that track's format, cut into blocks as the track would store them
+   auto &project = context.project;
+   const auto &selectedRegion = ViewInfo::Get( project ).selectedRegion;
+   auto pTrack = *TrackList::Get( project ).Selected< WaveTrack >().first;
+   if (!pTrack) {
+      context.Error(wxT("No wave track selected."));
+      return false;
+   }
+   const auto start = pTrack->TimeToLongSamples(selectedRegion.t0());
+   const auto end = pTrack->TimeToLongSamples(selectedRegion.t1());
+   if (end <= start) {
+      context.Error(wxT("No samples selected."));
+      return false;
+   }
+
+   const auto format = pTrack->GetSampleFormat();
+   const auto blockSize = pTrack->GetMaxBlockSize();
+   const auto len = limitSampleBufferSize(
+      std::numeric_limits<size_t>::max() / SAMPLE_SIZE(format),
+      end - start );
+   SampleBuffer samples{ len, format };
+   pTrack->Get(samples.ptr(), format, start, len);
+   // As SqliteSampleBlock lays out its 256 sample summaries
+   Floats summary{ 3 * ((blockSize + 255) / 256) };
+
+   using Clock = std::chrono::steady_clock;
+   Clock::duration total{};
+   double totalSquares = 0;
+   for (int ii = 0; ii < mRepeat; ++ii) {
+      const auto begin = Clock::now();
+      for (size_t offset = 0; offset < len; offset += blockSize)
+         totalSquares += SummarizeSamples(
+            samples.ptr() + offset * SAMPLE_SIZE(format), format,
+            std::min(blockSize, len - offset), 256, summary.get());
+      total += Clock::now() - begin;
+      context.Progress( double(ii + 1) / mRepeat );
+   }
+
+   const double ms =
+      std::chrono::duration<double, std::milli>(total).count() / mRepeat;
+   context.Status(wxString::Format(wxT("%.3f"), ms));
+   // Report the sum, so that the computation can't be optimized away
+   context.Status(wxString::Format(
+      wxT("Summarized %lld samples in %.3f ms, average of %d (sum of squares %g)."),
+      (long long)len, ms, mRepeat, totalSquares / mRepeat));
+   return true;
+}
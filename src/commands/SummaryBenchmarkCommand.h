@@ -0,0 +1,40 @@
+/**********************************************************************
+
+   Tenacity
+
+   SummaryBenchmarkCommand.h
+
+******************************************************************//**
+
+\class SummaryBenchmarkCommand
+\brief Command to time the computation of sample block summaries
+
+*//*******************************************************************/
+
+#ifndef __SUMMARY_BENCHMARK_COMMAND__
+#define __SUMMARY_BENCHMARK_COMMAND__
+
+#include "CommandType.h"
+#include "Command.h"
+
+class SummaryBenchmarkCommand final : public AudacityCommand
+{
+public:
+   static const ComponentInterfaceSymbol Symbol;
+
+   // ComponentInterface overrides
+   ComponentInterfaceSymbol GetSymbol() override {return Symbol;};
+   TranslatableString GetDescription() override
+   {return XO("Times the computation of block summaries of the selected audio.");};
+   bool DefineParams( ShuttleParams & S ) override;
+   void PopulateOrExchange(ShuttleGui & S) override;
+   bool Apply(const CommandContext & context) override;
+
+   // AudacityCommand overrides
+   ManualPageID ManualPage() override {return L"Extra_Menu:_Scriptables_II";}
+
+private:
+   int mRepeat;
+};
+
+#endif /* End of include guard: __SUMMARY_BENCHMARK_COMMAND__ */
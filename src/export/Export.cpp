@@ -48,6 +48,7 @@
 #include <wx/dcmemory.h>
 #include <wx/window.h>
 
+
 #include "sndfile.h"
 
 // Tenacity libraries
@@ -55,6 +56,7 @@
 #include <lib-files/FileNames.h>
 #include <lib-files/wxFileNameWrapper.h>
 #include <lib-preferences/Prefs.h>
+#include <lib-utility/ThreadPool.h>
 
 #include "ExportDialog.h"
 #include "../theme/AllThemeResources.h"
@@ -1344,4 +1346,8 @@ void ShowDiskFullExportErrorDialog(const wxFileNameWrapper &fileName)
    );
 }
 
+//----------------------------------------------------------------------------
+// Settings shared by exporters
+//----------------------------------------------------------------------------
 
+BoolSetting ChunkedEncoding{ L"/FileFormats/ChunkedEncoding", false };
@@ -22,9 +22,11 @@
 #include <lib-strings/Identifier.h>
 
 #include "ExportPlugin.h"
+#include "ThreadedMixer.h"
 #include "../widgets/wxPanelWrapper.h" // to inherit
 
 class wxArrayString;
+class BoolSetting;
 class FileDialogWrapper;
 class wxFileCtrlEvent;
 class wxMemoryDC;
@@ -205,6 +207,12 @@ private:
    void OnSize( wxSizeEvent &event );
 };
 
+//! Whether FLAC and constant bit rate MP3 export may cut a long file into
+//! chunks, and encode several of them at once on worker threads
+/*! Off by default:  MP3 so made has no bit reservoir and no LAME info tag,
+ and FLAC no MD5 signature */
+extern TENACITY_DLL_API BoolSetting ChunkedEncoding;
+
 TENACITY_DLL_API TranslatableString AudacityExportCaptionStr();
 TENACITY_DLL_API TranslatableString AudacityExportMessageStr();
 
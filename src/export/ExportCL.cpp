@@ -11,6 +11,7 @@
 
 **********************************************************************/
 
+#include "ExportCL.h"
 #include "Export.h"
 
 #include "ProjectRate.h"
@@ -23,10 +24,24 @@
 #include <wx/process.h>
 #include <wx/sizer.h>
 #include <wx/textctrl.h>
+#include <wx/file.h>
 #if defined(__WXMSW__)
 #include <wx/msw/registry.h> // for wxRegKey
 #endif
 
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <thread>
+
+#if !defined(__WXMSW__)
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 // Tenacity libraries
 #include <lib-files/FileNames.h>
 #include <lib-files/wxFileNameWrapper.h>
@@ -208,6 +223,110 @@ void ExportCLOptions::OnBrowse(wxCommandEvent& /* event */)
    return;
 }
 
+//----------------------------------------------------------------------------
+// AsyncPipeWriter
+//----------------------------------------------------------------------------
+
+// Don't write too much at once...pipes may not be able to handle it
+constexpr size_t MaxPipeWrite = 64 * 1024;
+
+AsyncPipeWriter::AsyncPipeWriter(Sink sink, size_t capacity)
+   : mSink{ std::move(sink) }
+   , mBuffer(std::max<size_t>(capacity, 1))
+{
+   mThread = std::thread{ [this]{ Run(); } };
+}
+
+AsyncPipeWriter::~AsyncPipeWriter()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mStopping = true;
+   }
+   mFilled.notify_one();
+   mThread.join();
+}
+
+size_t AsyncPipeWriter::Write(const void *bytes, size_t count,
+   std::chrono::milliseconds timeout)
+{
+   const auto deadline = std::chrono::steady_clock::now() + timeout;
+   const auto capacity = mBuffer.size();
+   auto source = static_cast<const char *>(bytes);
+   size_t taken = 0;
+   std::unique_lock<std::mutex> lock{ mMutex };
+   while (taken < count) {
+      if (!mEmptied.wait_until(lock, deadline,
+            [&]{ return mFailed || mSize < capacity; }) ||
+          mFailed)
+         break;
+      const auto end = (mStart + mSize) % capacity;
+      const auto len = std::min({ count - taken, capacity - mSize,
+         capacity - end });
+      // The writer thread reads only the bytes before end, so copy without
+      // holding the lock
+      lock.unlock();
+      memcpy(mBuffer.data() + end, source + taken, len);
+      lock.lock();
+      mSize += len;
+      taken += len;
+      mFilled.notify_one();
+   }
+   return taken;
+}
+
+bool AsyncPipeWriter::WaitUntilWritten(std::chrono::milliseconds timeout)
+{
+   std::unique_lock<std::mutex> lock{ mMutex };
+   mEmptied.wait_for(lock, timeout, [this]{ return mFailed || mSize == 0; });
+   return !mFailed && mSize == 0;
+}
+
+bool AsyncPipeWriter::HasFailed() const
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return mFailed;
+}
+
+void AsyncPipeWriter::Run()
+{
+   // Turn off logging to prevent broken pipe messages
+   wxLogNull nolog;
+
+   const auto capacity = mBuffer.size();
+   std::unique_lock<std::mutex> lock{ mMutex };
+   while (true) {
+      mFilled.wait(lock, [this]{ return mStopping || mSize > 0; });
+      if (mStopping)
+         break;
+
+      // The bytes up to the end of the buffer, or up to the first free byte
+      const auto bytes = mBuffer.data() + mStart;
+      const auto count =
+         std::min({ mSize, capacity - mStart, MaxPipeWrite });
+      lock.unlock();
+      long long written = -1;
+      try {
+         written = mSink(bytes, count);
+      }
+      catch (...) {
+      }
+      lock.lock();
+
+      if (written < 0 || written > static_cast<long long>(count)) {
+         mFailed = true;
+         mEmptied.notify_all();
+         break;
+      }
+      if (written == 0)
+         // The sink waited for the pipe; try again, unless stopped first
+         continue;
+      mStart = (mStart + written) % capacity;
+      mSize -= written;
+      mEmptied.notify_all();
+   }
+}
+
 //----------------------------------------------------------------------------
 // ExportCLProcess
 //----------------------------------------------------------------------------
@@ -291,9 +410,23 @@ public:
    // Optional   
    bool CheckFileName(wxFileName &filename, int format = 0) override;
 
+   bool ExportToDescriptor(TenacityProject &project, int fd,
+      unsigned channels, bool selectionOnly, double t0, double t1);
+
 private:
    void GetSettings();
 
+   //! Mix, and write a WAV stream of 32 bit floats through the writer
+   /*!
+    @param poll called often, also while the writer's buffer is full; it
+    returns false to stop, when the reader is gone
+    */
+   ProgressResult StreamWAV(AsyncPipeWriter &writer,
+      TenacityProject *project, unsigned channels,
+      bool selectionOnly, double t0, double t1, MixerSpec *mixerSpec,
+      const Tags *metadata, ProgressDialog &progress,
+      const std::function<bool()> &poll);
+
    std::vector<char> GetMetaChunk(const Tags *metadata);
    wxString mCmd;
    bool mShow;
@@ -392,14 +525,96 @@ ProgressResult ExportCL::Export(TenacityProject *project,
    // Turn off logging to prevent broken pipe messages
    wxLogNull nolog;
 
+   wxOutputStream *os = process.GetOutputStream();
+   auto updateResult = ProgressResult::Success;
+
+   {
+      auto closeIt = finally ( [&] {
+         // Should make the process die, before propagating any exception
+         process.CloseOutput();
+      } );
+
+      // Destroyed before the output closes
+      AsyncPipeWriter writer{ [os](const char *bytes, size_t count){
+         // The pipe doesn't block, and takes nothing when it is full; the
+         // stream gives no way to wait for it, so pause a little
+         os->Write(bytes, count);
+         if (!os->IsOk())
+            return -1LL;
+         const auto written = static_cast<long long>(os->LastWrite());
+         if (written == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+         return written;
+      } };
+
+      // Prepare the progress display
+      InitProgress( pDialog, XO("Export"),
+         selectionOnly
+            ? XO("Exporting the selected audio using command-line encoder")
+            : XO("Exporting the audio using command-line encoder") );
+      auto &progress = *pDialog;
+
+      updateResult = StreamWAV(writer, project, channels,
+         selectionOnly, t0, t1, mixerSpec, metadata, progress, [&]{
+            // Capture any stdout and stderr from the command
+            Drain(process.GetInputStream(), &output);
+            Drain(process.GetErrorStream(), &output);
+            return process.IsActive();
+         });
+      // Done with the progress display
+   }
+
+   // Wait for process to terminate
+   while (process.IsActive()) {
+      wxMilliSleep(10);
+      wxTheApp->Yield();
+   }
+
+   // Display output on error or if the user wants to see it
+   if (process.GetStatus() != 0 || mShow) {
+      // TODO use ShowInfoDialog() instead.
+      wxDialogWrapper dlg(nullptr,
+                   wxID_ANY,
+                   XO("Command Output"),
+                   wxDefaultPosition,
+                   wxSize(600, 400),
+                   wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER);
+      dlg.SetName();
+
+      ShuttleGui S(&dlg, eIsCreating);
+      S
+         .Style( wxTE_MULTILINE | wxTE_READONLY | wxTE_RICH )
+         .AddTextWindow(mCmd + wxT("\n\n") + output);
+      S.StartHorizontalLay(wxALIGN_CENTER, false);
+      {
+         S.Id(wxID_OK).AddButton(XXO("&OK"), wxALIGN_CENTER, true);
+      }
+      dlg.GetSizer()->AddSpacer(5);
+      dlg.Layout();
+      dlg.SetMinSize(dlg.GetSize());
+      dlg.Center();
+
+      dlg.ShowModal();
+
+      if (process.GetStatus() != 0)
+         updateResult = ProgressResult::Failed;
+   }
+
+   return updateResult;
+}
+
+ProgressResult ExportCL::StreamWAV(AsyncPipeWriter &writer,
+   TenacityProject *project, unsigned channels,
+   bool selectionOnly, double t0, double t1, MixerSpec *mixerSpec,
+   const Tags *metadata, ProgressDialog &progress,
+   const std::function<bool()> &poll)
+{
    // establish parameters
    int rate = lrint( ProjectRate::Get( *project ).GetRate());
    const size_t maxBlockLen = 44100 * 5;
    unsigned long totalSamples = lrint((t1 - t0) * rate);
    unsigned long sampleBytes = totalSamples * channels * SAMPLE_SIZE(floatSample);
 
-   wxOutputStream *os = process.GetOutputStream();
-
    // RIFF header
    struct {
       char riffID[4];            // "RIFF"
@@ -479,14 +694,39 @@ ProgressResult ExportCL::Export(TenacityProject *project,
    data.dataID[3] = 'a';
    data.dataLen   = wxUINT32_SWAP_ON_BE(sampleBytes);
 
+   auto updateResult = ProgressResult::Success;
+   double mixTime = t0;
+   // Copy into the writer's buffer; while it is full, keep the progress
+   // display and the poll going
+   const auto put = [&](const void *bytes, size_t count){
+      auto source = static_cast<const char *>(bytes);
+      while (count > 0) {
+         const auto taken =
+            writer.Write(source, count, std::chrono::milliseconds{ 50 });
+         source += taken;
+         count -= taken;
+         if (writer.HasFailed()) {
+            updateResult = ProgressResult::Cancelled;
+            return false;
+         }
+         if (!poll())
+            return false;
+         if (count > 0) {
+            updateResult = progress.Update(mixTime - t0, t1 - t0);
+            if (updateResult != ProgressResult::Success)
+               return false;
+         }
+      }
+      return true;
+   };
+
    // write the headers and metadata
-   os->Write(&riff, sizeof(riff));
-   os->Write(&fmt, sizeof(fmt));
-   if (metachunk.size()) {
-      os->Write(&id3, sizeof(id3));
-      os->Write(metachunk.data(), metachunk.size());
+   bool going = put(&riff, sizeof(riff)) && put(&fmt, sizeof(fmt));
+   if (going && metachunk.size()) {
+      going = put(&id3, sizeof(id3)) &&
+         put(metachunk.data(), metachunk.size());
    }
-   os->Write(&data, sizeof(data));
+   going = going && put(&data, sizeof(data));
 
    // Mix 'em up
    const auto &tracks = TrackList::Get( *project );
@@ -502,107 +742,126 @@ ProgressResult ExportCL::Export(TenacityProject *project,
                             floatSample,
                             mixerSpec);
 
-   size_t numBytes = 0;
-   constSamplePtr mixed = NULL;
-   auto updateResult = ProgressResult::Success;
-
-   {
-      auto closeIt = finally ( [&] {
-         // Should make the process die, before propagating any exception
-         process.CloseOutput();
-      } );
-
-      // Prepare the progress display
-      InitProgress( pDialog, XO("Export"),
-         selectionOnly
-            ? XO("Exporting the selected audio using command-line encoder")
-            : XO("Exporting the audio using command-line encoder") );
-      auto &progress = *pDialog;
-
-      // Start piping the mixed data to the command
-      while (updateResult == ProgressResult::Success && process.IsActive() && os->IsOk()) {
-         // Capture any stdout and stderr from the command
-         Drain(process.GetInputStream(), &output);
-         Drain(process.GetErrorStream(), &output);
-
-         // Need to mix another block
-         if (numBytes == 0) {
-            auto numSamples = mixer->Process(maxBlockLen);
-            if (numSamples == 0) {
-               break;
-            }
+   // Mixing goes on while the writer's thread waits for the pipe
+   while (going && updateResult == ProgressResult::Success) {
+      auto numSamples = mixer->Process(maxBlockLen);
+      if (numSamples == 0) {
+         break;
+      }
 
-            mixed = mixer->GetBuffer();
-            numBytes = numSamples * channels;
+      auto mixed = mixer->GetBuffer();
+      size_t numBytes = numSamples * channels;
 
-            // Byte-swapping is necessary on big-endian machines, since
-            // WAV files are little-endian
+      // Byte-swapping is necessary on big-endian machines, since
+      // WAV files are little-endian
 #if wxBYTE_ORDER == wxBIG_ENDIAN
-            auto buffer = (const float *) mixed;
-            for (int i = 0; i < numBytes; i++) {
-               buffer[i] = wxUINT32_SWAP_ON_BE(buffer[i]);
-            }
+      auto buffer = (const float *) mixed;
+      for (int i = 0; i < numBytes; i++) {
+         buffer[i] = wxUINT32_SWAP_ON_BE(buffer[i]);
+      }
 #endif
-            numBytes *= SAMPLE_SIZE(floatSample);
-         }
-
-         // Don't write too much at once...pipes may not be able to handle it
-         size_t bytes = std::min<size_t>(numBytes, 4096);
-         numBytes -= bytes;
+      numBytes *= SAMPLE_SIZE(floatSample);
 
-         while (bytes > 0) {
-            os->Write(mixed, bytes);
-            if (!os->IsOk()) {
-               updateResult = ProgressResult::Cancelled;
-               break;
-            }
-            bytes -= os->LastWrite();
-            mixed += os->LastWrite();
-         }
+      going = put(mixed, numBytes);
 
-         // Update the progress display
-         updateResult = progress.Update(mixer->MixGetCurrentTime() - t0, t1 - t0);
-      }
-      // Done with the progress display
+      // Update the progress display
+      mixTime = mixer->MixGetCurrentTime();
+      if (going)
+         updateResult = progress.Update(mixTime - t0, t1 - t0);
    }
 
-   // Wait for process to terminate
-   while (process.IsActive()) {
-      wxMilliSleep(10);
-      wxTheApp->Yield();
+   // Let the reader have everything before the pipe closes
+   while (going &&
+          (updateResult == ProgressResult::Success ||
+           updateResult == ProgressResult::Stopped) &&
+          !writer.WaitUntilWritten(std::chrono::milliseconds{ 50 })) {
+      if (writer.HasFailed())
+         updateResult = ProgressResult::Cancelled;
+      else if (!(going = poll()))
+         break;
+      else if (updateResult == ProgressResult::Success)
+         updateResult = progress.Update(mixTime - t0, t1 - t0);
    }
 
-   // Display output on error or if the user wants to see it
-   if (process.GetStatus() != 0 || mShow) {
-      // TODO use ShowInfoDialog() instead.
-      wxDialogWrapper dlg(nullptr,
-                   wxID_ANY,
-                   XO("Command Output"),
-                   wxDefaultPosition,
-                   wxSize(600, 400),
-                   wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER);
-      dlg.SetName();
+   return updateResult;
+}
 
-      ShuttleGui S(&dlg, eIsCreating);
-      S
-         .Style( wxTE_MULTILINE | wxTE_READONLY | wxTE_RICH )
-         .AddTextWindow(mCmd + wxT("\n\n") + output);
-      S.StartHorizontalLay(wxALIGN_CENTER, false);
-      {
-         S.Id(wxID_OK).AddButton(XXO("&OK"), wxALIGN_CENTER, true);
-      }
-      dlg.GetSizer()->AddSpacer(5);
-      dlg.Layout();
-      dlg.SetMinSize(dlg.GetSize());
-      dlg.Center();
+bool ExportCL::ExportToDescriptor(TenacityProject &project, int fd,
+   unsigned channels, bool selectionOnly, double t0, double t1)
+{
+#if !defined(__WXMSW__)
+   // Something to stream to, not a regular file, which is better exported
+   // by name, nor a closed or mistyped descriptor
+   struct stat status;
+   if (fstat(fd, &status) != 0 ||
+       !(S_ISFIFO(status.st_mode) || S_ISSOCK(status.st_mode) ||
+         S_ISCHR(status.st_mode)))
+      return false;
 
-      dlg.ShowModal();
+   // Don't crash on broken pipe, when the reader quits early
+   const auto oldHandler = signal(SIGPIPE, SIG_IGN);
+   auto restoreHandler = finally( [&] { signal(SIGPIPE, oldHandler); } );
+
+   // Don't block in write(), so that the writer can stop when the user
+   // cancels, however long the reader takes.  The flags belong to whatever
+   // else shares the descriptor, such as the shell, so restore them.
+   const auto oldFlags = fcntl(fd, F_GETFL);
+   if (oldFlags == -1 ||
+       (!(oldFlags & O_NONBLOCK) &&
+        fcntl(fd, F_SETFL, oldFlags | O_NONBLOCK) == -1))
+      return false;
+   auto restoreFlags = finally( [&] { fcntl(fd, F_SETFL, oldFlags); } );
+
+   auto sink = [fd](const char *bytes, size_t count) -> long long {
+      const auto written = write(fd, bytes, count);
+      if (written >= 0)
+         return written;
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+         return -1;
+      // Wait for the reader, but not so long that the writer is slow to stop
+      pollfd request{ fd, POLLOUT, 0 };
+      if (poll(&request, 1, 100) < 0 && errno != EINTR)
+         return -1;
+      return 0;
+   };
+#else
+   // No waiting for pipes here:  write() blocks, and a cancelled export waits
+   // for the reader to take the pending bytes, or to quit
+   wxFile file{ fd };
+   // The descriptor is not ours to close
+   auto detach = finally( [&] { file.Detach(); } );
+   auto sink = [&file](const char *bytes, size_t count){
+      const auto written = file.Write(bytes, count);
+      return written > 0 ? static_cast<long long>(written) : -1;
+   };
+#endif
 
-      if (process.GetStatus() != 0)
-         updateResult = ProgressResult::Failed;
+   wxLogNull nolog;
+   auto updateResult = ProgressResult::Success;
+   {
+      // Destroyed before the descriptor's settings are restored
+      AsyncPipeWriter writer{ sink };
+
+      std::unique_ptr<ProgressDialog> pDialog;
+      InitProgress( pDialog, XO("Export"),
+         selectionOnly
+            ? XO("Streaming the selected audio")
+            : XO("Streaming the audio") );
+
+      updateResult = StreamWAV(writer, &project, channels, selectionOnly,
+         t0, t1, nullptr, nullptr, *pDialog, []{ return true; });
    }
 
-   return updateResult;
+   return updateResult == ProgressResult::Success ||
+      updateResult == ProgressResult::Stopped;
+}
+
+bool ExportToDescriptor(TenacityProject &project, int fd,
+   unsigned channels, bool selectedOnly, double t0, double t1)
+{
+   ExportCL exporter;
+   return exporter.ExportToDescriptor(
+      project, fd, channels, selectedOnly, t0, t1);
 }
 
 std::vector<char> ExportCL::GetMetaChunk(const Tags *tags)
@@ -0,0 +1,97 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file ExportCL.h
+  @brief Streaming of exported audio to pipes, without temporary files
+
+**********************************************************************/
+#ifndef __TENACITY_EXPORT_CL__
+#define __TENACITY_EXPORT_CL__
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TenacityProject;
+
+//! Writes to a pipe on a thread of its own, through a large buffer
+/*!
+ The producer, on one other thread, copies bytes into the buffer, and waits
+ only when the buffer is full, so that a slow reader at the other end of the
+ pipe holds back the producer without making it block on every write.
+
+ Destroying the writer stops it, discarding what it did not yet write.
+ */
+class TENACITY_DLL_API AsyncPipeWriter final
+{
+public:
+   //! Write some of the bytes, and return how many
+   /*!
+    Called on the writer's thread.  It may return zero, if the pipe is full
+    and does not block; but it should first wait a little for the reader, as
+    with poll(), because it is called again at once, unless the writer is
+    stopping.  Return a negative number for a failure, after which the
+    writer stops.
+    */
+   using Sink = std::function<long long(const char *bytes, size_t count)>;
+
+   static constexpr size_t DefaultCapacity = 8 * 1024 * 1024;
+
+   explicit AsyncPipeWriter(Sink sink, size_t capacity = DefaultCapacity);
+   AsyncPipeWriter(const AsyncPipeWriter&) = delete;
+   AsyncPipeWriter &operator=(const AsyncPipeWriter&) = delete;
+   ~AsyncPipeWriter();
+
+   //! Copy bytes into the buffer, waiting no longer than timeout while it is full
+   /*!
+    @return how many bytes were taken, fewer than count if the wait timed out
+    or writing failed
+    */
+   size_t Write(const void *bytes, size_t count,
+      std::chrono::milliseconds timeout);
+
+   //! Wait no longer than timeout for the sink to take all bytes given so far
+   /*! @return whether it did */
+   bool WaitUntilWritten(std::chrono::milliseconds timeout);
+
+   bool HasFailed() const;
+
+private:
+   void Run();
+
+   const Sink mSink;
+   std::vector<char> mBuffer;
+
+   mutable std::mutex mMutex;
+   //! Notified when bytes are added, and when stopping
+   std::condition_variable mFilled;
+   //! Notified when bytes are written, and when writing fails
+   std::condition_variable mEmptied;
+   //! Where the unwritten bytes begin in mBuffer, wrapping around
+   size_t mStart{ 0 };
+   size_t mSize{ 0 };
+   bool mStopping{ false };
+   bool mFailed{ false };
+
+   std::thread mThread;
+};
+
+//! Export as a WAV stream of 32 bit floats to an open file descriptor
+/*!
+ As the external program exporter writes to the standard input of the
+ program, but to a descriptor inherited from whatever started this
+ application, such as 1 for standard output, so that shell pipelines can
+ take the mix without a file in between.  It is not closed.
+
+ @return whether all was written, or the user stopped the export; false also
+ if the descriptor is not a pipe, socket or character device
+ */
+TENACITY_DLL_API bool ExportToDescriptor(TenacityProject &project, int fd,
+   unsigned channels, bool selectedOnly, double t0, double t1);
+
+#endif
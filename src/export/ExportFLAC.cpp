@@ -28,6 +28,11 @@ and libvorbis examples, Monty <monty@xiph.org>
 #include <wx/ffile.h>
 #include <wx/log.h>
 
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
 #include "FLAC++/encoder.h"
 
 // Tenacity libraries
@@ -36,6 +41,7 @@ and libvorbis examples, Monty <monty@xiph.org>
 #include <lib-preferences/Prefs.h>
 #include <lib-project-rate/ProjectRate.h>
 #include <lib-sample-track/Mix.h>
+#include <lib-utility/ThreadPool.h>
 
 #include "../shuttle/ShuttleGui.h"
 
@@ -204,6 +210,230 @@ using FLAC__StreamMetadataHandle = std::unique_ptr<
    FLAC__StreamMetadata, FLAC__StreamMetadataDeleter
 >;
 
+namespace {
+
+//! What the preferences say about every encoder of one export
+struct FLACSettings
+{
+   unsigned numChannels{ 0 };
+   long rate{ 0 };
+   unsigned bitsPerSample{ 16 };
+   long level{ 5 };
+};
+
+bool ConfigureEncoder(FLAC::Encoder::Stream &encoder,
+   const FLACSettings &settings)
+{
+   const auto &level = flacLevels[settings.level];
+   // Duplicate the flac command line compression levels
+   return
+      encoder.set_channels(settings.numChannels) &&
+      encoder.set_sample_rate(settings.rate) &&
+      encoder.set_bits_per_sample(settings.bitsPerSample) &&
+      encoder.set_do_exhaustive_model_search(level.do_exhaustive_model_search) &&
+      encoder.set_do_escape_coding(level.do_escape_coding) &&
+      encoder.set_do_mid_side_stereo(
+         settings.numChannels == 2 && level.do_mid_side_stereo) &&
+      encoder.set_loose_mid_side_stereo(
+         settings.numChannels == 2 && level.loose_mid_side_stereo) &&
+      encoder.set_qlp_coeff_precision(level.qlp_coeff_precision) &&
+      encoder.set_min_residual_partition_order(level.min_residual_partition_order) &&
+      encoder.set_max_residual_partition_order(level.max_residual_partition_order) &&
+      encoder.set_rice_parameter_search_dist(level.rice_parameter_search_dist) &&
+      encoder.set_max_lpc_order(level.max_lpc_order);
+}
+
+//----------------------------------------------------------------------------
+// Chunked encoding
+//
+// Each FLAC frame is independent of the others, except for its number in the
+// stream, which is in its header.  So a long export is cut into chunks of a
+// whole number of frames, several encoders make frames from several chunks at
+// once, each numbering from zero, and the frames are renumbered and written in
+// order.  A separate encoder makes the stream header, which is patched at the
+// end with the total length and the frame sizes that it could not know.
+//----------------------------------------------------------------------------
+
+// Frames in each chunk but the last
+constexpr size_t FramesPerChunk = 64;
+
+// The "fLaC" marker, the header of the STREAMINFO block, and that block
+constexpr size_t StreamInfoOffset = 8;
+constexpr size_t StreamInfoEnd = StreamInfoOffset + 34;
+
+//! Keeps in memory what it encodes, frames apart from the stream header
+class FLACMemoryEncoder final : public FLAC::Encoder::Stream
+{
+public:
+   std::vector<FLAC__byte> header;
+   std::vector<FLAC__byte> frames;
+   //! Where each frame starts in frames
+   std::vector<size_t> offsets;
+
+protected:
+   ::FLAC__StreamEncoderWriteStatus write_callback(const FLAC__byte buffer[],
+      size_t bytes, uint32_t samples, uint32_t) override
+   {
+      // libFLAC writes each frame whole, and only the header without samples
+      try {
+         auto &dest = samples ? frames : header;
+         if (samples)
+            offsets.push_back(frames.size());
+         dest.insert(dest.end(), buffer, buffer + bytes);
+      }
+      catch (...) {
+         // Don't throw through the C library
+         return FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+      }
+      return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+   }
+};
+
+//! Samples for one encoder, and the frames that it made of them
+struct FLACChunk
+{
+   ArraysOf<FLAC__int32> samples;
+   size_t len{ 0 };
+   std::vector<FLAC__byte> bytes;
+   size_t minFrameSize{ 0 };
+   size_t maxFrameSize{ 0 };
+   bool ok{ false };
+};
+
+const std::array<FLAC__uint8, 256> &CRC8Table()
+{
+   static const auto table = []{
+      std::array<FLAC__uint8, 256> result{};
+      for (unsigned ii = 0; ii < 256; ++ii) {
+         unsigned crc = ii;
+         for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+         result[ii] = crc & 0xFF;
+      }
+      return result;
+   }();
+   return table;
+}
+
+const std::array<FLAC__uint16, 256> &CRC16Table()
+{
+   static const auto table = []{
+      std::array<FLAC__uint16, 256> result{};
+      for (unsigned ii = 0; ii < 256; ++ii) {
+         unsigned crc = ii << 8;
+         for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x8005 : (crc << 1);
+         result[ii] = crc & 0xFFFF;
+      }
+      return result;
+   }();
+   return table;
+}
+
+//! Append a frame, numbered anew, and with its checksums computed again
+/*!
+ @return false if the frame is not as libFLAC makes them with a fixed block
+ size
+ */
+bool AppendRenumberedFrame(std::vector<FLAC__byte> &dest,
+   const FLAC__byte *frame, size_t size, unsigned long long number)
+{
+   // Sync code, then the codes of block size, sample rate, channels and
+   // sample size, then the number in UTF-8 like coding
+   constexpr size_t numberOffset = 4;
+   if (size < numberOffset + 4 || (frame[1] & 0x01))
+      return false;
+   size_t numberLen = 1;
+   if (frame[numberOffset] & 0x80) {
+      numberLen = 0;
+      while (numberLen < 8 && (frame[numberOffset] & (0x80 >> numberLen)))
+         ++numberLen;
+      if (numberLen < 2 || numberLen > 7)
+         return false;
+   }
+   // Block size and sample rate may need more bytes than their codes
+   const auto blockCode = frame[2] >> 4;
+   const auto rateCode = frame[2] & 0x0F;
+   const size_t extraLen =
+      (blockCode == 6 ? 1 : blockCode == 7 ? 2 : 0) +
+      (rateCode == 12 ? 1 : (rateCode == 13 || rateCode == 14) ? 2 : 0);
+   // The body follows the CRC-8 of the header, and precedes the CRC-16 of
+   // all the rest
+   const auto bodyOffset = numberOffset + numberLen + extraLen + 1;
+   if (size < bodyOffset + 2)
+      return false;
+
+   const auto start = dest.size();
+   dest.insert(dest.end(), frame, frame + numberOffset);
+   if (number < 0x80)
+      dest.push_back(static_cast<FLAC__byte>(number));
+   else {
+      // n bytes hold 5 n + 1 bits
+      size_t len = 2;
+      while (len < 7 && number >= (1ULL << (5 * len + 1)))
+         ++len;
+      dest.push_back(static_cast<FLAC__byte>(
+         ((0xFF00 >> len) & 0xFF) | (number >> (6 * (len - 1)))));
+      for (auto shift = 6 * (len - 1); shift > 0;) {
+         shift -= 6;
+         dest.push_back(static_cast<FLAC__byte>(0x80 | ((number >> shift) & 0x3F)));
+      }
+   }
+   const auto extra = frame + numberOffset + numberLen;
+   dest.insert(dest.end(), extra, extra + extraLen);
+
+   auto &crc8Table = CRC8Table();
+   FLAC__uint8 crc8 = 0;
+   for (auto ii = start, end = dest.size(); ii < end; ++ii)
+      crc8 = crc8Table[crc8 ^ dest[ii]];
+   dest.push_back(crc8);
+
+   dest.insert(dest.end(), frame + bodyOffset, frame + size - 2);
+
+   auto &crc16Table = CRC16Table();
+   FLAC__uint16 crc16 = 0;
+   for (auto ii = start, end = dest.size(); ii < end; ++ii)
+      crc16 = (crc16 << 8) ^ crc16Table[(crc16 >> 8) ^ dest[ii]];
+   dest.push_back(crc16 >> 8);
+   dest.push_back(crc16 & 0xFF);
+   return true;
+}
+
+//! Encode the samples of the chunk, which may happen on any thread
+void EncodeChunk(FLACChunk &chunk, const FLACSettings &settings,
+   unsigned long long firstFrame)
+{
+   chunk.ok = false;
+   chunk.bytes.clear();
+   FLACMemoryEncoder encoder;
+   if (!ConfigureEncoder(encoder, settings) ||
+       encoder.init() != FLAC__STREAM_ENCODER_INIT_STATUS_OK ||
+       !encoder.process(
+          reinterpret_cast<FLAC__int32**>( chunk.samples.get() ), chunk.len) ||
+       !encoder.finish())
+      return;
+
+   const auto &frames = encoder.frames;
+   const auto &offsets = encoder.offsets;
+   chunk.bytes.reserve(frames.size() + offsets.size() * 8);
+   chunk.minFrameSize = std::numeric_limits<size_t>::max();
+   chunk.maxFrameSize = 0;
+   for (size_t ii = 0, nFrames = offsets.size(); ii < nFrames; ++ii) {
+      const auto begin = offsets[ii];
+      const auto end = (ii + 1 < nFrames) ? offsets[ii + 1] : frames.size();
+      const auto before = chunk.bytes.size();
+      if (!AppendRenumberedFrame(chunk.bytes,
+            frames.data() + begin, end - begin, firstFrame + ii))
+         return;
+      const auto frameSize = chunk.bytes.size() - before;
+      chunk.minFrameSize = std::min(chunk.minFrameSize, frameSize);
+      chunk.maxFrameSize = std::max(chunk.maxFrameSize, frameSize);
+   }
+   chunk.ok = true;
+}
+
+}
+
 class ExportFLAC final : public ExportPlugin
 {
 public:
@@ -223,12 +453,23 @@ public:
                MixerSpec *mixerSpec = NULL,
                const Tags *metadata = NULL,
                int subformat = 0) override;
+   bool SupportsConcurrentExport(int) override { return true; }
+   std::unique_ptr<ExportJob> PrepareExport(TenacityProject *project,
+               unsigned channels,
+               const wxFileNameWrapper &fName,
+               bool selectedOnly,
+               double t0,
+               double t1,
+               MixerSpec *mixerSpec,
+               const Tags *metadata,
+               int subformat,
+               ProgressResult &result) override;
 
 private:
 
    bool GetMetadata(TenacityProject *project, const Tags *tags);
 
-   // Should this be a stack variable instead in Export?
+   // Should this be a stack variable instead in PrepareExport?
    FLAC__StreamMetadataHandle mMetadata;
 };
 
@@ -245,6 +486,39 @@ ExportFLAC::ExportFLAC()
    SetDescription(XO("FLAC Files"),0);
 }
 
+//! The part of ExportFLAC::Export() that may run in a worker thread
+class FLACExportJob final : public ExportJob
+{
+public:
+   FLACExportJob(const wxFileNameWrapper &fName, TranslatableString message)
+      : ExportJob{ Verbatim( fName.GetName() ), std::move(message) }
+      , mFileName{ fName }
+   {}
+
+   ProgressResult Run(ExportProgress &progress) override;
+
+   const wxFileNameWrapper mFileName;
+   // Once initialized, it owns the file, and closes it when destroyed if
+   // not finished sooner
+   FLAC::Encoder::File mEncoder;
+   FLACSettings mSettings;
+
+   // When not empty, the stream header, and Run() encodes in chunks
+   // instead of with mEncoder, writing to mFile
+   std::vector<FLAC__byte> mHeader;
+   unsigned mBlockSize{ 0 };
+   wxFFile mFile;
+
+   unsigned mNumChannels{ 0 };
+   sampleFormat mFormat{ int16Sample };
+   double mT0{ 0 };
+   double mT1{ 0 };
+   std::unique_ptr<Mixer> mMixer;
+
+private:
+   ProgressResult RunChunked(ExportProgress &progress, ThreadedMixer &mixer);
+};
+
 ProgressResult ExportFLAC::Export(TenacityProject *project,
                         std::unique_ptr<ProgressDialog> &pDialog,
                         unsigned numChannels,
@@ -254,35 +528,73 @@ ProgressResult ExportFLAC::Export(TenacityProject *project,
                         double t1,
                         MixerSpec *mixerSpec,
                         const Tags *metadata,
-                        int /* subformat */)
+                        int subformat)
+{
+   return ExportByJob(project, pDialog, numChannels, fName, selectionOnly,
+      t0, t1, mixerSpec, metadata, subformat);
+}
+
+std::unique_ptr<ExportJob> ExportFLAC::PrepareExport(TenacityProject *project,
+                        unsigned numChannels,
+                        const wxFileNameWrapper &fName,
+                        bool selectionOnly,
+                        double t0,
+                        double t1,
+                        MixerSpec *mixerSpec,
+                        const Tags *metadata,
+                        int /* subformat */,
+                        ProgressResult &result)
 {
    double    rate    = ProjectRate::Get(*project).GetRate();
    const auto &tracks = TrackList::Get( *project );
 
    wxLogNull logNo;            // temporarily disable wxWidgets error messages
-   auto updateResult = ProgressResult::Success;
+   result = ProgressResult::Cancelled;
 
    long levelPref;
    FLACLevel.Read().ToLong( &levelPref );
 
    auto bitDepthPref = FLACBitDepth.Read();
 
-   FLAC::Encoder::File encoder;
+   auto pJob = std::make_unique<FLACExportJob>( fName,
+      selectionOnly
+         ? XO("Exporting the selected audio as FLAC")
+         : XO("Exporting the audio as FLAC") );
+   auto &encoder = pJob->mEncoder;
+   pJob->mNumChannels = numChannels;
+   pJob->mT0 = t0;
+   pJob->mT1 = t1;
+
+   sampleFormat format;
+   auto &settings = pJob->mSettings;
+   settings.numChannels = numChannels;
+   settings.rate = lrint(rate);
+   if (bitDepthPref == wxT("24")) {
+      format = int24Sample;
+      settings.bitsPerSample = 24;
+   } else { //convert float to 16 bits
+      format = int16Sample;
+      settings.bitsPerSample = 16;
+   }
+   pJob->mFormat = format;
+   if (levelPref < 0 || levelPref > 8) {
+      levelPref = 5;
+   }
+   settings.level = levelPref;
 
-   bool success = encoder.set_channels(numChannels) &&
-                  encoder.set_sample_rate(lrint(rate));
+   bool success = ConfigureEncoder(encoder, settings);
 
    // See note in GetMetadata() about a bug in libflac++ 1.1.2
    if (success && !GetMetadata(project, metadata)) {
       // TODO: more precise message
       ShowExportErrorDialog("FLAC:283");
-      return ProgressResult::Cancelled;
+      return nullptr;
    }
 
+   // set_metadata expects an array of pointers to metadata and a size.
+   // The size is 1.
+   FLAC__StreamMetadata *p = mMetadata.get();
    if (success && mMetadata) {
-      // set_metadata expects an array of pointers to metadata and a size.
-      // The size is 1.
-      FLAC__StreamMetadata *p = mMetadata.get();
       success = encoder.set_metadata(&p, 1);
    }
 
@@ -290,97 +602,89 @@ ProgressResult ExportFLAC::Export(TenacityProject *project,
       mMetadata.reset(); // need this?
    } );
 
-   sampleFormat format;
-   if (bitDepthPref == wxT("24")) {
-      format = int24Sample;
-      success = success && encoder.set_bits_per_sample(24);
-   } else { //convert float to 16 bits
-      format = int16Sample;
-      success = success && encoder.set_bits_per_sample(16);
-   }
-
-
-   // Duplicate the flac command line compression levels
-   if (levelPref < 0 || levelPref > 8) {
-      levelPref = 5;
-   }
-   success = success &&
-   encoder.set_do_exhaustive_model_search(flacLevels[levelPref].do_exhaustive_model_search) &&
-   encoder.set_do_escape_coding(flacLevels[levelPref].do_escape_coding);
-
-   if (numChannels != 2) {
-      success = success &&
-      encoder.set_do_mid_side_stereo(false) &&
-      encoder.set_loose_mid_side_stereo(false);
-   }
-   else {
-      success = success &&
-      encoder.set_do_mid_side_stereo(flacLevels[levelPref].do_mid_side_stereo) &&
-      encoder.set_loose_mid_side_stereo(flacLevels[levelPref].loose_mid_side_stereo);
-   }
-
-   success = success &&
-   encoder.set_qlp_coeff_precision(flacLevels[levelPref].qlp_coeff_precision) &&
-   encoder.set_min_residual_partition_order(flacLevels[levelPref].min_residual_partition_order) &&
-   encoder.set_max_residual_partition_order(flacLevels[levelPref].max_residual_partition_order) &&
-   encoder.set_rice_parameter_search_dist(flacLevels[levelPref].rice_parameter_search_dist) &&
-   encoder.set_max_lpc_order(flacLevels[levelPref].max_lpc_order);
-
    if (!success) {
       // TODO: more precise message
       ShowExportErrorDialog("FLAC:336");
-      return ProgressResult::Cancelled;
+      return nullptr;
    }
 
    wxFFile f;     // will be closed when it goes out of scope
    const auto path = fName.GetFullPath();
    if (!f.Open(path, wxT("w+b"))) {
       AudacityMessageBox( XO("FLAC export couldn't open %s").Format( path ) );
-      return ProgressResult::Cancelled;
+      return nullptr;
    }
 
-   // Even though there is an init() method that takes a filename, use the one that
-   // takes a file handle because wxWidgets can open a file with a Unicode name and
-   // libflac can't (under Windows).
-   int status = encoder.init(f.fp());
-   if (status != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
-      AudacityMessageBox(
-         XO("FLAC encoder failed to initialize\nStatus: %d")
-            .Format( status ) );
-      return ProgressResult::Cancelled;
+   if (ChunkedEncoding.Read() && ThreadPool::Get().GetNumThreads() > 0) {
+      // Make the stream header now, with the metadata; the block size that
+      // libFLAC chooses is known only after initializing
+      FLACMemoryEncoder header;
+      if (ConfigureEncoder(header, settings) &&
+          (!mMetadata || header.set_metadata(&p, 1)) &&
+          header.init() == FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+         const auto blockSize = header.get_blocksize();
+         // Not worth it for an export too short to make two chunks
+         if (header.finish() &&
+             header.header.size() >= StreamInfoEnd &&
+             (header.header[4] & 0x7F) == FLAC__METADATA_TYPE_STREAMINFO &&
+             blockSize > 0 &&
+             (t1 - t0) * rate >= 2.0 * blockSize * FramesPerChunk) {
+            pJob->mHeader = std::move(header.header);
+            pJob->mBlockSize = blockSize;
+            pJob->mFile.Attach(f.fp(), path);
+            f.Detach();
+         }
+      }
    }
 
-   mMetadata.reset();
-
-   auto cleanup2 = finally( [&] {
-      if (!(updateResult == ProgressResult::Success ||
-            updateResult == ProgressResult::Stopped)) {
-         f.Detach(); // libflac closes the file
-         encoder.finish();
+   if (pJob->mHeader.empty()) {
+      // Even though there is an init() method that takes a filename, use the one that
+      // takes a file handle because wxWidgets can open a file with a Unicode name and
+      // libflac can't (under Windows).
+      int status = encoder.init(f.fp());
+      if (status != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+         AudacityMessageBox(
+            XO("FLAC encoder failed to initialize\nStatus: %d")
+               .Format( status ) );
+         return nullptr;
       }
-   } );
+      f.Detach(); // libflac closes the file
+   }
+
+   mMetadata.reset();
 
-   auto mixer = CreateMixer(tracks, selectionOnly,
+   pJob->mMixer = CreateMixer(tracks, selectionOnly,
                             t0, t1,
                             numChannels, SAMPLES_PER_RUN, false,
                             rate, format, mixerSpec);
 
+   result = ProgressResult::Success;
+   return pJob;
+}
+
+auto FLACExportJob::Run(ExportProgress &progress) -> ProgressResult
+{
+   const auto numChannels = mNumChannels;
+   const auto format = mFormat;
+   auto updateResult = ProgressResult::Success;
+
    ArraysOf<FLAC__int32> tmpsmplbuf{ numChannels, SAMPLES_PER_RUN, true };
 
-   InitProgress( pDialog, fName,
-      selectionOnly
-         ? XO("Exporting the selected audio as FLAC")
-         : XO("Exporting the audio as FLAC") );
-   auto &progress = *pDialog;
+   // Mix the next block while this one is encoded
+   ThreadedMixer mixer{ std::move(mMixer),
+      numChannels, SAMPLES_PER_RUN, false, format };
+
+   if (!mHeader.empty())
+      return RunChunked(progress, mixer);
 
    while (updateResult == ProgressResult::Success) {
-      auto samplesThisRun = mixer->Process(SAMPLES_PER_RUN);
+      auto samplesThisRun = mixer.Process();
       if (samplesThisRun == 0) { //stop encoding
          break;
       }
       else {
          for (size_t i = 0; i < numChannels; i++) {
-            auto mixed = mixer->GetBuffer(i);
+            auto mixed = mixer.GetBuffer(i);
             if (format == int24Sample) {
                for (decltype(samplesThisRun) j = 0; j < samplesThisRun; j++) {
                   tmpsmplbuf[i][j] = ((const int *)mixed)[j];
@@ -392,28 +696,157 @@ ProgressResult ExportFLAC::Export(TenacityProject *project,
                }
             }
          }
-         if (! encoder.process(
+         if (! mEncoder.process(
                reinterpret_cast<FLAC__int32**>( tmpsmplbuf.get() ),
                samplesThisRun) ) {
             // TODO: more precise message
-            ShowDiskFullExportErrorDialog(fName);
+            const auto &fName = mFileName;
+            progress.OnMainThread([&fName]{
+               ShowDiskFullExportErrorDialog(fName); });
             updateResult = ProgressResult::Cancelled;
             break;
          }
          if (updateResult == ProgressResult::Success)
             updateResult =
-               progress.Update(mixer->MixGetCurrentTime() - t0, t1 - t0);
+               progress.Update(mixer.MixGetCurrentTime() - mT0, mT1 - mT0);
       }
    }
 
    if (updateResult == ProgressResult::Success ||
        updateResult == ProgressResult::Stopped) {
-      f.Detach(); // libflac closes the file
-      if (!encoder.finish())
-         // Do not reassign updateResult, see cleanup2
+      if (!mEncoder.finish())
          return ProgressResult::Failed;
    }
 
+   // Otherwise the encoder finishes when destroyed, closing the file
+   return updateResult;
+}
+
+auto FLACExportJob::RunChunked(ExportProgress &progress, ThreadedMixer &mixer)
+   -> ProgressResult
+{
+   auto &pool = ThreadPool::Get();
+   const auto numChannels = mNumChannels;
+   const auto format = mFormat;
+   const size_t chunkLen = mBlockSize * FramesPerChunk;
+
+   // One chunk for each worker thread, and one for this thread, which
+   // ParallelFor also uses
+   std::vector<FLACChunk> chunks(pool.GetNumThreads() + 1);
+   for (auto &chunk : chunks)
+      chunk.samples.reinit(numChannels, chunkLen);
+   size_t nFilled = 0;
+
+   const auto &fName = mFileName;
+   const auto write = [this](const std::vector<FLAC__byte> &bytes){
+      return mFile.Write(bytes.data(), bytes.size()) == bytes.size();
+   };
+   const auto diskFull = [&]{
+      progress.OnMainThread([&fName]{ ShowDiskFullExportErrorDialog(fName); });
+      return ProgressResult::Cancelled;
+   };
+
+   // The header is written again at the end, with the totals
+   if (!write(mHeader))
+      return diskFull();
+
+   unsigned long long nextFrame = 0;
+   unsigned long long totalSamples = 0;
+   size_t minFrameSize = std::numeric_limits<size_t>::max();
+   size_t maxFrameSize = 0;
+
+   // Encode the filled chunks at once, then write them in order
+   const auto encode = [&]{
+      const auto firstFrame = nextFrame;
+      pool.ParallelFor(0, nFilled, [&](size_t ii){
+         EncodeChunk(chunks[ii], mSettings, firstFrame + ii * FramesPerChunk);
+      });
+      for (size_t ii = 0; ii < nFilled; ++ii) {
+         auto &chunk = chunks[ii];
+         if (!chunk.ok) {
+            progress.OnMainThread([]{ AudacityMessageBox(
+               XO("FLAC encoder failed to encode a chunk of the audio")); });
+            return ProgressResult::Failed;
+         }
+         if (!write(chunk.bytes))
+            return diskFull();
+         minFrameSize = std::min(minFrameSize, chunk.minFrameSize);
+         maxFrameSize = std::max(maxFrameSize, chunk.maxFrameSize);
+         totalSamples += chunk.len;
+         chunk.len = 0;
+      }
+      nextFrame += nFilled * FramesPerChunk;
+      nFilled = 0;
+      return ProgressResult::Success;
+   };
+
+   auto updateResult = ProgressResult::Success;
+   while (updateResult == ProgressResult::Success) {
+      const auto samplesThisRun = mixer.Process();
+      if (samplesThisRun == 0) //stop encoding
+         break;
+      // A buffer of the mixer may straddle chunks
+      for (size_t offset = 0; offset < samplesThisRun;) {
+         auto &chunk = chunks[nFilled];
+         const auto count =
+            std::min(samplesThisRun - offset, chunkLen - chunk.len);
+         for (size_t i = 0; i < numChannels; i++) {
+            auto mixed = mixer.GetBuffer(i);
+            auto dest = &chunk.samples[i][chunk.len];
+            if (format == int24Sample) {
+               for (size_t j = 0; j < count; j++)
+                  dest[j] = ((const int *)mixed)[offset + j];
+            }
+            else {
+               for (size_t j = 0; j < count; j++)
+                  dest[j] = ((const short *)mixed)[offset + j];
+            }
+         }
+         chunk.len += count;
+         offset += count;
+         if (chunk.len == chunkLen && ++nFilled == chunks.size()) {
+            const auto result = encode();
+            if (result != ProgressResult::Success)
+               return result;
+         }
+      }
+      updateResult =
+         progress.Update(mixer.MixGetCurrentTime() - mT0, mT1 - mT0);
+   }
+
+   if (updateResult != ProgressResult::Success &&
+       updateResult != ProgressResult::Stopped)
+      return updateResult;
+
+   // The last chunk may be short, with a short last frame
+   if (chunks[nFilled].len > 0)
+      ++nFilled;
+   if (nFilled > 0) {
+      const auto result = encode();
+      if (result != ProgressResult::Success)
+         return result;
+   }
+
+   // Complete the STREAMINFO block.  Its MD5 signature of the samples stays
+   // zero, which decoders take to mean that it was not computed
+   if (maxFrameSize == 0)
+      minFrameSize = 0;
+   const auto info = &mHeader[StreamInfoOffset];
+   info[4] = (minFrameSize >> 16) & 0xFF;
+   info[5] = (minFrameSize >> 8) & 0xFF;
+   info[6] = minFrameSize & 0xFF;
+   info[7] = (maxFrameSize >> 16) & 0xFF;
+   info[8] = (maxFrameSize >> 8) & 0xFF;
+   info[9] = maxFrameSize & 0xFF;
+   // 36 bits of total samples, after the sample rate, channels and size
+   info[13] = (info[13] & 0xF0) | ((totalSamples >> 32) & 0x0F);
+   info[14] = (totalSamples >> 24) & 0xFF;
+   info[15] = (totalSamples >> 16) & 0xFF;
+   info[16] = (totalSamples >> 8) & 0xFF;
+   info[17] = totalSamples & 0xFF;
+   if (!mFile.Seek(0) || !write(mHeader) || !mFile.Close())
+      return diskFull();
+
    return updateResult;
 }
 
@@ -67,6 +67,9 @@
 #include <wx/utils.h>
 #include <wx/window.h>
 
+#include <algorithm>
+#include <vector>
+
 // Tenacity libraries
 #include <lib-files/FileNames.h>
 #include <lib-files/wxFileNameWrapper.h>
@@ -74,6 +77,7 @@
 #include <lib-preferences/Prefs.h>
 #include <lib-project-rate/ProjectRate.h>
 #include <lib-sample-track/Mix.h>
+#include <lib-utility/ThreadPool.h>
 
 #include "../ProjectSettings.h"
 #include "../ProjectWindow.h"
@@ -586,6 +590,9 @@ public:
    void SetBitrate(int rate);
    void SetQuality(int q/*, int r*/);
    void SetChannel(int mode);
+   /* For a segment of a longer stream, encoded apart from the rest:  frames
+      don't borrow bits from earlier frames, and there is no info tag */
+   void SetSegmented(bool segmented);
 
    /* Virtual methods that must be supplied by library interfaces */
 
@@ -599,6 +606,9 @@ public:
    /* In bytes. must be called AFTER InitializeStream */
    int GetOutBufferSize();
 
+   /* Samples PER CHANNEL in each frame. must be called AFTER InitializeStream */
+   int GetFrameSize();
+
    /* returns the number of bytes written. input is interleaved if stereo*/
    int EncodeBuffer(float inbuffer[], unsigned char outbuffer[]);
    int EncodeRemainder(float inbuffer[], int nSamples,
@@ -622,6 +632,7 @@ private:
    int mQuality;
    //int mRoutine;
    int mChannel;
+   bool mSegmented;
 
    lame_global_flags *mGlobalFlags;
 
@@ -646,6 +657,7 @@ MP3Exporter::MP3Exporter()
    mChannel = CHANNEL_STEREO;
    mMode = MODE_CBR;
    //mRoutine = ROUTINE_FAST;
+   mSegmented = false;
 
    InitLibrary();
 }
@@ -676,6 +688,11 @@ void MP3Exporter::SetChannel(int mode)
    mChannel = mode;
 }
 
+void MP3Exporter::SetSegmented(bool segmented)
+{
+   mSegmented = segmented;
+}
+
 bool MP3Exporter::InitLibrary()
 {
    mGlobalFlags = lame_init();
@@ -707,10 +724,10 @@ int MP3Exporter::InitializeStream(unsigned channels, int sampleRate)
    lame_set_num_channels(mGlobalFlags, channels);
    lame_set_in_samplerate(mGlobalFlags, sampleRate);
    lame_set_out_samplerate(mGlobalFlags, sampleRate);
-   lame_set_disable_reservoir(mGlobalFlags, false);
+   lame_set_disable_reservoir(mGlobalFlags, mSegmented);
    // Add the VbrTag for all types.  For ABR/VBR, a Xing tag will be created.
-   // For CBR, it will be a Lame Info tag.
-   lame_set_bWriteVbrTag(mGlobalFlags, true);
+   // For CBR, it will be a Lame Info tag.  But not in the middle of a stream.
+   lame_set_bWriteVbrTag(mGlobalFlags, !mSegmented);
 
    // Set the VBR quality or ABR/CBR bitrate
    switch (mMode) {
@@ -786,6 +803,14 @@ int MP3Exporter::GetOutBufferSize()
    return mOutBufferSize;
 }
 
+int MP3Exporter::GetFrameSize()
+{
+   if (!mEncoding)
+      return -1;
+
+   return lame_get_framesize(mGlobalFlags);
+}
+
 int MP3Exporter::EncodeBuffer(float inbuffer[], unsigned char outbuffer[])
 {
    if (!mEncoding) {
@@ -869,6 +894,230 @@ bool MP3Exporter::PutInfoTag(wxFFile & f, wxFileOffset off)
    return true;
 }
 
+//----------------------------------------------------------------------------
+// Segmented encoding
+//
+// A constant bit rate stream, without the bit reservoir, is a sequence of
+// frames that decode independently, except that each overlaps the samples of
+// its neighbours.  So a long export is cut into segments of a whole number of
+// frames, each encoded by its own encoder, several at once, and the frames
+// are written in order.  Each encoder begins some frames before its segment
+// and ends some frames after it, so that the frames kept are made from the
+// same samples as in one continuous encoding, and the frames of each encoder
+// at the segment boundaries are thrown away.
+//----------------------------------------------------------------------------
+
+namespace {
+
+using ProgressResult = GenericUI::ProgressResult;
+
+// Frames in each segment but the last
+constexpr size_t FramesPerSegment = 128;
+// Frames encoded and discarded at either end of a segment; enough to cover
+// the encoder's delay and the look-ahead of its psychoacoustic model
+constexpr size_t PrerollFrames = 3;
+constexpr size_t PostrollFrames = 2;
+
+//! Length of the MPEG audio layer III frame beginning at bytes, or zero
+size_t MP3FrameLength(const unsigned char *bytes, size_t size)
+{
+   if (size < 4 || bytes[0] != 0xFF || (bytes[1] & 0xE0) != 0xE0)
+      return 0;
+   // 3 for MPEG-1, 2 for MPEG-2, 0 for MPEG-2.5
+   const auto version = (bytes[1] >> 3) & 0x03;
+   // 1 for layer III
+   const auto layer = (bytes[1] >> 1) & 0x03;
+   const auto bitrateIndex = bytes[2] >> 4;
+   const auto rateIndex = (bytes[2] >> 2) & 0x03;
+   const auto padding = (bytes[2] >> 1) & 0x01;
+   if (version == 1 || layer != 1 ||
+       bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3)
+      return 0;
+
+   static const int bitrates[2][15] = {
+      { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 },
+      { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+   };
+   static const int rates[3] = { 44100, 48000, 32000 };
+   const bool mpeg1 = (version == 3);
+   const int rate = rates[rateIndex] >> (mpeg1 ? 0 : version == 2 ? 1 : 2);
+   const int kbps = bitrates[mpeg1 ? 0 : 1][bitrateIndex];
+   return (mpeg1 ? 144000 : 72000) * kbps / rate + padding;
+}
+
+//! Samples for one encoder, and the frames kept from it
+struct MP3Segment
+{
+   // Of the whole stream
+   size_t start{ 0 };
+   size_t end{ 0 };
+   // Of this encoder's frames; all to the end if endFrame is zero
+   size_t firstFrame{ 0 };
+   size_t endFrame{ 0 };
+
+   std::vector<unsigned char> bytes;
+   bool ok{ false };
+};
+
+/*!
+ @param configure sets an exporter as for the whole stream
+ @param samples interleaved if two channels, beginning at segment.start
+ */
+void EncodeSegment(MP3Segment &segment,
+   const std::function<void(MP3Exporter&)> &configure,
+   unsigned channels, int rate, float *samples)
+{
+   segment.ok = false;
+   segment.bytes.clear();
+
+   MP3Exporter exporter;
+   configure(exporter);
+   exporter.SetSegmented(true);
+   const auto inSamples = exporter.InitializeStream(channels, rate);
+   const auto bufferSize = exporter.GetOutBufferSize();
+   if (inSamples <= 0 || bufferSize <= 0)
+      return;
+   ArrayOf<unsigned char> buffer{ static_cast<size_t>(bufferSize) };
+
+   std::vector<unsigned char> frames;
+   const auto len = segment.end - segment.start;
+   for (size_t done = 0; done < len;) {
+      const auto blockLen =
+         std::min(len - done, static_cast<size_t>(inSamples));
+      const auto mixed = samples + done * channels;
+      const auto bytes = (channels > 1)
+         ? exporter.EncodeRemainder(mixed, blockLen, buffer.get())
+         : exporter.EncodeRemainderMono(mixed, blockLen, buffer.get());
+      if (bytes < 0)
+         return;
+      frames.insert(frames.end(), buffer.get(), buffer.get() + bytes);
+      done += blockLen;
+   }
+   const auto bytes = exporter.FinishStream(buffer.get());
+   if (bytes < 0)
+      return;
+   frames.insert(frames.end(), buffer.get(), buffer.get() + bytes);
+
+   size_t iFrame = 0;
+   for (size_t offset = 0; offset < frames.size(); ++iFrame) {
+      if (segment.endFrame > 0 && iFrame == segment.endFrame)
+         break;
+      const auto frameLen =
+         MP3FrameLength(frames.data() + offset, frames.size() - offset);
+      if (frameLen == 0 || frameLen > frames.size() - offset)
+         return;
+      if (iFrame >= segment.firstFrame)
+         segment.bytes.insert(segment.bytes.end(),
+            frames.begin() + offset, frames.begin() + offset + frameLen);
+      offset += frameLen;
+   }
+   segment.ok = (segment.endFrame == 0 || iFrame == segment.endFrame);
+}
+
+//! Encode what the mixer gives in segments, on several threads at once
+ProgressResult EncodeSegments(ThreadedMixer &mixer,
+   const std::function<void(MP3Exporter&)> &configure,
+   unsigned channels, int rate, size_t frameSize,
+   wxFFile &outFile, const wxFileNameWrapper &fName,
+   ProgressDialog &progress, double t0, double t1)
+{
+   auto &pool = ThreadPool::Get();
+   const auto segmentLen = frameSize * FramesPerSegment;
+   const auto preroll = frameSize * PrerollFrames;
+   const auto postroll = frameSize * PostrollFrames;
+   // One segment for each worker thread, and one for this thread, which
+   // ParallelFor also uses
+   const auto batchSize = pool.GetNumThreads() + 1;
+   std::vector<MP3Segment> segments(batchSize);
+
+   // Mixed samples, interleaved, from pendingStart
+   std::vector<float> pending;
+   size_t pendingStart = 0;
+   size_t mixedEnd = 0;
+   size_t nextSegment = 0;
+
+   // Encode some segments at once, then write them in order
+   const auto encode = [&](size_t nSegments, bool atEnd){
+      for (size_t ii = 0; ii < nSegments; ++ii) {
+         auto &segment = segments[ii];
+         const auto position = (nextSegment + ii) * segmentLen;
+         const bool last = atEnd && position + segmentLen >= mixedEnd;
+         segment.start = (position > preroll) ? position - preroll : 0;
+         segment.end = last
+            ? mixedEnd
+            : std::min(mixedEnd, position + segmentLen + postroll);
+         segment.firstFrame = (position - segment.start) / frameSize;
+         segment.endFrame = last
+            ? 0
+            : (position + segmentLen - segment.start) / frameSize;
+      }
+      pool.ParallelFor(0, nSegments, [&](size_t ii){
+         auto &segment = segments[ii];
+         EncodeSegment(segment, configure, channels, rate,
+            pending.data() + (segment.start - pendingStart) * channels);
+      });
+      for (size_t ii = 0; ii < nSegments; ++ii) {
+         auto &segment = segments[ii];
+         if (!segment.ok) {
+            AudacityMessageBox(
+               XO("MP3 encoder failed to encode a segment of the audio"));
+            return ProgressResult::Cancelled;
+         }
+         if (segment.bytes.size() >
+             outFile.Write(segment.bytes.data(), segment.bytes.size())) {
+            ShowDiskFullExportErrorDialog(fName);
+            return ProgressResult::Cancelled;
+         }
+      }
+      nextSegment += nSegments;
+
+      // Keep only what later segments need
+      const auto position = nextSegment * segmentLen;
+      const auto newStart = (position > preroll) ? position - preroll : 0;
+      const auto discard =
+         std::min(newStart - pendingStart, mixedEnd - pendingStart);
+      pending.erase(pending.begin(), pending.begin() + discard * channels);
+      pendingStart += discard;
+      return ProgressResult::Success;
+   };
+
+   auto updateResult = ProgressResult::Success;
+   while (updateResult == ProgressResult::Success) {
+      const auto blockLen = mixer.Process();
+      if (blockLen == 0)
+         break;
+
+      const auto mixed = (const float *)mixer.GetBuffer();
+      pending.insert(pending.end(), mixed, mixed + blockLen * channels);
+      mixedEnd += blockLen;
+
+      if (mixedEnd >= (nextSegment + batchSize) * segmentLen + postroll) {
+         const auto result = encode(batchSize, false);
+         if (result != ProgressResult::Success)
+            return result;
+      }
+
+      updateResult = progress.Update(mixer.MixGetCurrentTime() - t0, t1 - t0);
+   }
+
+   if (updateResult != ProgressResult::Success &&
+       updateResult != ProgressResult::Stopped)
+      return updateResult;
+
+   // The rest, of which the last segment may be short
+   while (nextSegment * segmentLen < mixedEnd) {
+      const auto remaining =
+         (mixedEnd - nextSegment * segmentLen + segmentLen - 1) / segmentLen;
+      const auto result = encode(std::min(remaining, batchSize), true);
+      if (result != ProgressResult::Success)
+         return result;
+   }
+
+   return updateResult;
+}
+
+}
+
 //----------------------------------------------------------------------------
 // ExportMP3
 //----------------------------------------------------------------------------
@@ -1024,6 +1273,22 @@ ProgressResult ExportMP3::Export(TenacityProject *project,
       return ProgressResult::Cancelled;
    }
 
+   // Only constant bit rate frames can be encoded apart and concatenated.
+   // Initializing the first encoder here, on the main thread, also fills the
+   // static tables of the library before other threads use it
+   const auto frameSize = std::max(0, exporter.GetFrameSize());
+   const bool segmented = rmode == MODE_CBR && frameSize > 0 &&
+      ChunkedEncoding.Read() && ThreadPool::Get().GetNumThreads() > 0 &&
+      (t1 - t0) * rate >= 2.0 * frameSize * FramesPerSegment;
+   const auto channelMode = forceMono
+      ? CHANNEL_MONO
+      : (cmode == CHANNEL_JOINT) ? CHANNEL_JOINT : CHANNEL_STEREO;
+   const auto configure = [bitrate, channelMode](MP3Exporter &segmentExporter){
+      segmentExporter.SetMode(MODE_CBR);
+      segmentExporter.SetBitrate(bitrate);
+      segmentExporter.SetChannel(channelMode);
+   };
+
    // Put ID3 tags at beginning of file
    if (metadata == NULL)
       metadata = &Tags::Get( *project );
@@ -1061,10 +1326,13 @@ ProgressResult ExportMP3::Export(TenacityProject *project,
    wxASSERT(buffer);
 
    {
-      auto mixer = CreateMixer(tracks, selectionOnly,
-         t0, t1,
-         channels, inSamples, true,
-         rate, floatSample, mixerSpec);
+      // Mix the next block while this one is encoded
+      ThreadedMixer mixer{
+         CreateMixer(tracks, selectionOnly,
+            t0, t1,
+            channels, inSamples, true,
+            rate, floatSample, mixerSpec),
+         channels, static_cast<size_t>(inSamples), true, floatSample };
 
       TranslatableString title;
       if (rmode == MODE_SET) {
@@ -1089,14 +1357,20 @@ ProgressResult ExportMP3::Export(TenacityProject *project,
       InitProgress( pDialog, fName, title );
       auto &progress = *pDialog;
 
-      while (updateResult == ProgressResult::Success) {
-         auto blockLen = mixer->Process(inSamples);
+      if (segmented) {
+         updateResult = EncodeSegments(mixer, configure, channels, rate,
+            frameSize, outFile, fName, progress, t0, t1);
+         exporter.CancelEncoding();
+      }
+
+      while (!segmented && updateResult == ProgressResult::Success) {
+         auto blockLen = mixer.Process();
 
          if (blockLen == 0) {
             break;
          }
 
-         float *mixed = (float *)mixer->GetBuffer();
+         float *mixed = (float *)mixer.GetBuffer();
 
          if ((int)blockLen < inSamples) {
             if (channels > 1) {
@@ -1130,11 +1404,26 @@ ProgressResult ExportMP3::Export(TenacityProject *project,
             break;
          }
 
-         updateResult = progress.Update(mixer->MixGetCurrentTime() - t0, t1 - t0);
+         updateResult = progress.Update(mixer.MixGetCurrentTime() - t0, t1 - t0);
       }
    }
 
-   if ( updateResult == ProgressResult::Success ||
+   if ( segmented && (updateResult == ProgressResult::Success ||
+        updateResult == ProgressResult::Stopped) ) {
+      // Without an info tag, which would describe the encoding as one, and
+      // which lame_mp3_tags_fid() would write over the first frame
+      if (id3len > 0 && endOfFile) {
+         if (id3len > outFile.Write(id3buffer.get(), id3len)) {
+            ShowDiskFullExportErrorDialog(fName);
+            return ProgressResult::Cancelled;
+         }
+      }
+      if (!outFile.Flush() || !outFile.Close()) {
+         ShowDiskFullExportErrorDialog(fName);
+         return ProgressResult::Cancelled;
+      }
+   }
+   else if ( updateResult == ProgressResult::Success ||
         updateResult == ProgressResult::Stopped ) {
       bytes = exporter.FinishStream(buffer.get());
 
@@ -38,9 +38,12 @@
 #include <wx/textctrl.h>
 #include <wx/textdlg.h>
 
+#include <algorithm>
+
 // Tenacity libraries
 #include <lib-files/FileNames.h>
 #include <lib-preferences/Prefs.h>
+#include <lib-utility/ThreadPool.h>
 
 #include "LabelTrack.h"
 #include "Project.h"
@@ -50,6 +53,7 @@
 #include "../SelectionState.h"
 #include "../shuttle/ShuttleGui.h"
 #include "../Tags.h"
+#include "../TaskBatch.h"
 #include "../WaveTrack.h"
 #include "../widgets/HelpSystem.h"
 #include "../widgets/AudacityMessageBox.h"
@@ -57,26 +61,118 @@
 #include "../widgets/ProgressDialog.h"
 
 
-namespace {
 /** \brief A private class used to store the information needed to do an
-    * export.
-    *
-    * We create a set of these during the interactive phase of the export
-    * cycle, then use them when the actual exports are done. */
-   class ExportKit
+ * export.
+ *
+ * We create a set of these during the interactive phase of the export
+ * cycle, then use them when the actual exports are done. */
+class ExportMultipleDialog::ExportKit
+{
+public:
+   Tags filetags; /**< The set of metadata to use for the export */
+   wxFileNameWrapper destfile; /**< The file to export to */
+   double t0;           /**< Start time for the export */
+   double t1;           /**< End time for the export */
+   unsigned channels;   /**< Number of channels */
+};  // end of ExportKit declaration
+
+BoolSetting ConcurrentExport{ L"/FileFormats/ConcurrentExport", true };
+
+namespace {
+using ProgressResult = GenericUI::ProgressResult;
+
+// Where one file of the set is written.  Unless told that the export
+// succeeded, remove the file when destroyed, restoring any backup of
+// the file that was overwritten.
+class ExportTarget
+{
+public:
+   ExportTarget(const wxFileName &inName, bool overwrite)
+   {
+      if (overwrite) {
+         mName = inName;
+         mBackup.Assign(mName);
+
+         int suffix = 0;
+         do {
+            mBackup.SetName(mName.GetName() +
+                              wxString::Format(wxT("%d"), suffix));
+            ++suffix;
+         }
+         while (mBackup.FileExists());
+         ::wxRenameFile(inName.GetFullPath(), mBackup.GetFullPath());
+      }
+      else {
+         mName = inName;
+         int i = 2;
+         wxString base(mName.GetName());
+         while (mName.FileExists()) {
+            mName.SetName(wxString::Format(wxT("%s-%d"), base, i++));
+         }
+      }
+      mFullPath = mName.GetFullPath();
+   }
+
+   ExportTarget(const ExportTarget &) = delete;
+   ExportTarget &operator =(const ExportTarget &) = delete;
+
+   ~ExportTarget()
+   {
+      bool ok = Succeeded();
+      if (mBackup.IsOk()) {
+         if ( ok )
+            // Remove backup
+            ::wxRemoveFile(mBackup.GetFullPath());
+         else {
+            // Restore original
+            ::wxRemoveFile(mFullPath);
+            ::wxRenameFile(mBackup.GetFullPath(), mFullPath);
+         }
+      }
+      else {
+         if ( ! ok )
+            // Remove any new, and only partially written, file.
+            ::wxRemoveFile(mFullPath);
+      }
+   }
+
+   const wxString &GetFullPath() const { return mFullPath; }
+
+   bool Succeeded() const
    {
-   public:
-      Tags filetags; /**< The set of metadata to use for the export */
-      wxFileNameWrapper destfile; /**< The file to export to */
-      double t0;           /**< Start time for the export */
-      double t1;           /**< End time for the export */
-      unsigned channels;   /**< Number of channels for ExportMultipleByTrack */
-   };  // end of ExportKit declaration
-   /* we are going to want an set of these kits, and don't know how many until
-    * runtime. I would dearly like to use a std::vector, but it seems that
-    * this isn't done anywhere else in Audacity, presumably for a reason?, so
-    * I'm stuck with wxArrays, which are much harder, as well as non-standard.
-    */
+      return result == ProgressResult::Stopped ||
+         result == ProgressResult::Success;
+   }
+
+   ProgressResult result{ ProgressResult::Cancelled };
+
+private:
+   wxFileName mName;
+   wxFileName mBackup;
+   wxString mFullPath;
+};
+
+// One of several files exported at once
+struct ConcurrentExportTask
+{
+   // Destroyed after pJob, which may hold the file open
+   std::unique_ptr<ExportTarget> pTarget;
+   // Null if PrepareExport() failed
+   std::unique_ptr<ExportJob> pJob;
+   ProgressResult result{ ProgressResult::Failed };
+   // Number of the task in the batch, if there is a job
+   size_t task{};
+};
+
+bool AskToContinue()
+{
+   AudacityMessageDialog dlgMessage(
+      nullptr,
+      XO("Continue to export remaining files?"),
+      XO("Export"),
+      wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
+   return dlgMessage.ShowModal() == wxID_YES;
+}
 }
 
 /* define our dynamic array of export settings */
@@ -770,6 +866,7 @@ ProgressResult ExportMultipleDialog::ExportMultipleByLabel(bool byName,
    FilePaths otherNames;  // keep track of file names we will use, so we
    // don't duplicate them
    ExportKit setting;   // the current batch of settings
+   setting.channels = channels;
    setting.destfile.SetPath(mDir->GetValue());
    setting.destfile.SetExt(mPlugins[mPluginIndex]->GetExtension(mSubFormatIndex));
    wxLogDebug(wxT("Plug-in index = %d, Sub-format = %d"), mPluginIndex, mSubFormatIndex);
@@ -869,6 +966,9 @@ ProgressResult ExportMultipleDialog::ExportMultipleByLabel(bool byName,
    }
 
    auto ok = ProgressResult::Success;   // did it work?
+   if (ExportConcurrently(exportSettings, false, nullptr, ok))
+      return ok;
+
    int count = 0; // count the number of successful runs
    ExportKit activeSetting;  // pointer to the settings in use for this export
    /* Go round again and do the exporting (so this run is slow but
@@ -885,12 +985,7 @@ ProgressResult ExportMultipleDialog::ExportMultipleByLabel(bool byName,
       ok = DoExport(pDialog, channels, activeSetting.destfile, false,
          activeSetting.t0, activeSetting.t1, activeSetting.filetags);
       if (ok == ProgressResult::Stopped) {
-         AudacityMessageDialog dlgMessage(
-            nullptr,
-            XO("Continue to export remaining files?"),
-            XO("Export"),
-            wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
-         if (dlgMessage.ShowModal() != wxID_YES ) {
+         if (!AskToContinue()) {
             // User decided not to continue - bail out!
             break;
          }
@@ -1012,6 +1107,20 @@ ProgressResult ExportMultipleDialog::ExportMultipleByTrack(bool byName,
    }
    // end of user-interactive data gathering loop, start of export processing
    // loop
+   std::vector<WaveTrack *> leaders;
+   for (auto tr : mTracks->Leaders<WaveTrack>() - 
+      (anySolo ? &WaveTrack::GetNotSolo : &WaveTrack::GetMute))
+      leaders.push_back(tr);
+   // Select only the track of each file, while its mixer is made
+   const auto select = [&]( size_t ii ){
+      for (auto tr : mTracks->Selected<WaveTrack>())
+         tr->SetSelected(false);
+      for (auto channel : TrackList::Channels(leaders[ii]))
+         channel->SetSelected(true);
+   };
+   if (ExportConcurrently(exportSettings, true, select, ok))
+      return ok;
+
    int count = 0; // count the number of successful runs
    ExportKit activeSetting;  // pointer to the settings in use for this export
    std::unique_ptr<ProgressDialog> pDialog;
@@ -1038,12 +1147,7 @@ ProgressResult ExportMultipleDialog::ExportMultipleByTrack(bool byName,
          activeSetting.channels, activeSetting.destfile, true,
          activeSetting.t0, activeSetting.t1, activeSetting.filetags);
       if (ok == ProgressResult::Stopped) {
-         AudacityMessageDialog dlgMessage(
-            nullptr,
-            XO("Continue to export remaining files?"),
-            XO("Export"),
-            wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
-         if (dlgMessage.ShowModal() != wxID_YES ) {
+         if (!AskToContinue()) {
             // User decided not to continue - bail out!
             break;
          }
@@ -1067,8 +1171,6 @@ ProgressResult ExportMultipleDialog::DoExport(std::unique_ptr<ProgressDialog> &p
                               double t1,
                               const Tags &tags)
 {
-   wxFileName name;
-
    wxLogDebug(wxT("Doing multiple Export: File name \"%s\""), (inName.GetFullName()));
    wxLogDebug(wxT("Channels: %i, Start: %lf, End: %lf "), channels, t0, t1);
    if (selectedOnly)
@@ -1076,55 +1178,11 @@ ProgressResult ExportMultipleDialog::DoExport(std::unique_ptr<ProgressDialog> &p
    else
       wxLogDebug(wxT("Whole Project"));
 
-   wxFileName backup;
-   if (mOverwrite->GetValue()) {
-      name = inName;
-      backup.Assign(name);
-
-      int suffix = 0;
-      do {
-         backup.SetName(name.GetName() +
-                           wxString::Format(wxT("%d"), suffix));
-         ++suffix;
-      }
-      while (backup.FileExists());
-      ::wxRenameFile(inName.GetFullPath(), backup.GetFullPath());
-   }
-   else {
-      name = inName;
-      int i = 2;
-      wxString base(name.GetName());
-      while (name.FileExists()) {
-         name.SetName(wxString::Format(wxT("%s-%d"), base, i++));
-      }
-   }
-
-   ProgressResult success = ProgressResult::Cancelled;
-   const wxString fullPath{name.GetFullPath()};
-
-   auto cleanup = finally( [&] {
-      bool ok =
-         success == ProgressResult::Stopped ||
-         success == ProgressResult::Success;
-      if (backup.IsOk()) {
-         if ( ok )
-            // Remove backup
-            ::wxRemoveFile(backup.GetFullPath());
-         else {
-            // Restore original
-            ::wxRemoveFile(fullPath);
-            ::wxRenameFile(backup.GetFullPath(), fullPath);
-         }
-      }
-      else {
-         if ( ! ok )
-            // Remove any new, and only partially written, file.
-            ::wxRemoveFile(fullPath);
-      }
-   } );
+   ExportTarget target{ inName, mOverwrite->GetValue() };
+   const wxString &fullPath = target.GetFullPath();
 
    // Call the format export routine
-   success = mPlugins[mPluginIndex]->Export(mProject,
+   target.result = mPlugins[mPluginIndex]->Export(mProject,
                                             pDialog,
                                                 channels,
                                                 fullPath,
@@ -1134,8 +1192,9 @@ ProgressResult ExportMultipleDialog::DoExport(std::unique_ptr<ProgressDialog> &p
                                                 NULL,
                                                 &tags,
                                                 mSubFormatIndex);
+   const auto success = target.result;
 
-   if (success == ProgressResult::Success || success == ProgressResult::Stopped) {
+   if (target.Succeeded()) {
       mExported.push_back(fullPath);
    }
 
@@ -1145,6 +1204,171 @@ ProgressResult ExportMultipleDialog::DoExport(std::unique_ptr<ProgressDialog> &p
    return success;
 }
 
+bool ExportMultipleDialog::ExportConcurrently(
+   const std::vector<ExportKit> &kits, bool selectedOnly,
+   const std::function<void(size_t)> &select, ProgressResult &ok)
+{
+   auto &pool = ThreadPool::Get();
+   const size_t maxJobs = pool.GetNumThreads();
+   auto pPlugin = mPlugins[mPluginIndex];
+
+   // Bug 1440 fix.
+   std::vector<size_t> indices;
+   for (size_t ii = 0; ii < kits.size(); ++ii)
+      if (!kits[ii].destfile.GetName().empty())
+         indices.push_back(ii);
+   const auto nFiles = indices.size();
+   if (nFiles < 2 || maxJobs == 0 || !ConcurrentExport.Read() ||
+       !pPlugin->SupportsConcurrentExport(mSubFormatIndex))
+      return false;
+
+   ok = ProgressResult::Success;
+
+   // Tasks in [finished, next) are started and not yet finished.
+   // Workers use them only until they are done.  The batch is destroyed
+   // first, and whether returning or throwing, it waits for the workers.
+   std::vector<std::unique_ptr<ConcurrentExportTask>> tasks(nFiles);
+   TaskBatch batch;
+   size_t next = 0, finished = 0;
+   const auto isDone = [&]( size_t ii ){
+      return ii < next &&
+         (!tasks[ii]->pJob || batch.IsDone(tasks[ii]->task));
+   };
+
+   // Keep or remove the file, as DoExport() does
+   const auto finish = [&]( ConcurrentExportTask &task ){
+      if (task.pJob)
+         task.result = batch.GetResult(task.task);
+      // Close the file
+      task.pJob.reset();
+      auto &target = *task.pTarget;
+      target.result = task.result;
+      if (target.Succeeded())
+         mExported.push_back(target.GetFullPath());
+      task.pTarget.reset();
+      return task.result;
+   };
+
+   // After a failure, start no more, and cancel those started later
+   bool failed = false;
+   // After PrepareExport() failed, start no more
+   bool halted = false;
+
+   // Remove the file of a task cancelled only to be started again
+   const auto discard = [&]( ConcurrentExportTask &task ){
+      if (task.pJob)
+         batch.GetResult(task.task);
+      else
+         // Preparation will be tried again
+         halted = false;
+      task.pJob.reset();
+      task.pTarget.reset();
+   };
+
+   // After Stop, only the earliest unfinished file ends where it is, as in
+   // the serial export; those after it are cancelled, and started again from
+   // index restart if the user continues
+   bool stopped = false;
+   size_t restart = nFiles;
+
+   ProgressDialog dialog{
+      XO("Exporting %d Files").Format( static_cast<int>(nFiles) ) };
+   while (finished < nFiles) {
+      if (finished == next) {
+         // Nothing is running
+         if (failed || halted ||
+             batch.GetVerdict() != ProgressResult::Success)
+            break;
+         if (stopped) {
+            if (!AskToContinue())
+               // User decided not to continue - bail out!
+               break;
+            stopped = false;
+            finished = next = std::min(finished, restart);
+            restart = nFiles;
+            dialog.Reinit();
+         }
+      }
+
+      // Start more, preparing each in the main thread, in order
+      while (!failed && !halted && !stopped &&
+             batch.GetVerdict() == ProgressResult::Success &&
+             next < nFiles && next - finished < maxJobs) {
+         const auto index = indices[next];
+         const auto &kit = kits[index];
+         wxLogDebug(wxT("Doing multiple Export: File name \"%s\""),
+            kit.destfile.GetFullName());
+
+         auto pTask = std::make_unique<ConcurrentExportTask>();
+         auto &task = *pTask;
+         task.pTarget =
+            std::make_unique<ExportTarget>(kit.destfile, mOverwrite->GetValue());
+         if (select)
+            select(index);
+         // The mixer captures the selected tracks now
+         task.pJob = pPlugin->PrepareExport(mProject, kit.channels,
+            task.pTarget->GetFullPath(), selectedOnly, kit.t0, kit.t1,
+            nullptr, &kit.filetags, mSubFormatIndex, task.result);
+         if (task.pJob)
+            task.task = batch.Post([&job = *task.pJob](TaskProgress &progress){
+               return job.Run(progress);
+            });
+         else
+            // The user was alerted; the failure counts when its turn comes
+            halted = true;
+         tasks[next++] = std::move(pTask);
+      }
+
+      // Finish files in the given order
+      while (finished < next && isDone(finished)) {
+         if (finished >= restart) {
+            discard(*tasks[finished]);
+            tasks[finished++].reset();
+            continue;
+         }
+         const auto result = finish(*tasks[finished]);
+         tasks[finished++].reset();
+         if (!failed) {
+            ok = result;
+            if (result != ProgressResult::Success &&
+                result != ProgressResult::Stopped) {
+               failed = true;
+               batch.SetVerdict(ProgressResult::Cancelled);
+            }
+         }
+      }
+
+      double fraction = finished;
+      for (auto ii = finished; ii < next; ++ii)
+         if (tasks[ii]->pJob)
+            fraction += batch.GetFraction(tasks[ii]->task);
+      const auto result = dialog.Update( fraction / nFiles,
+         Verbatim( kits[indices[std::min(finished, nFiles - 1)]]
+            .destfile.GetFullName() ) );
+      if (result == ProgressResult::Stopped) {
+         if (!stopped) {
+            stopped = true;
+            restart = finished + 1;
+            for (auto ii = finished; ii < next; ++ii)
+               if (tasks[ii]->pJob)
+                  batch.SetVerdict(tasks[ii]->task, ii < restart
+                     ? ProgressResult::Stopped : ProgressResult::Cancelled);
+         }
+      }
+      else if (result != ProgressResult::Success &&
+          batch.GetVerdict() == ProgressResult::Success)
+         batch.SetVerdict(result);
+
+      batch.Wait(finished < next && tasks[finished]->pJob
+         ? tasks[finished]->task : TaskBatch::NoTask);
+   }
+
+   Refresh();
+   Update();
+
+   return true;
+}
+
 wxString ExportMultipleDialog::MakeFileName(const wxString &input)
 {
    wxString newname = input; // name we are generating
@@ -14,8 +14,11 @@
 #include "Export.h"
 #include "ExportPlugin.h"
 
+#include <functional>
+
 // Tenacity libraries
 #include <lib-files/wxFileNameWrapper.h> // member variable
+#include <lib-preferences/Prefs.h>
 
 class wxButton;
 class wxCheckBox;
@@ -43,6 +46,7 @@ public:
    int ShowModal();
 
 private:
+   class ExportKit;
 
    // Export
    void CanExport();
@@ -83,6 +87,22 @@ private:
                  double t0,
                  double t1,
                  const Tags &tags);
+   /** \brief Export the files of a set several at once, on worker threads
+    *
+    * Does nothing and returns false, if the plug-in can't, or preferences
+    * disallow it, or there is too little to do; then call DoExport() for each
+    * file instead.  Files are finished in the given order, and failure of one
+    * cancels the exports of the later ones.
+    * @param kits Settings of the files; those with empty names are skipped
+    * @param selectedOnly Should we export the selected tracks only?
+    * @param select If not null, called with an index into kits before the
+    * export of that file begins, to select its tracks
+    * @param ok Receives the result, as from the calls of DoExport() it replaces
+    */
+   bool ExportConcurrently(const std::vector<ExportKit> &kits,
+                 bool selectedOnly,
+                 const std::function<void(size_t)> &select,
+                 ProgressResult &ok);
    /** \brief Takes an arbitrary text string and converts it to a form that can
     * be used as a file name, if necessary prompting the user to edit the file
     * name produced */
@@ -170,6 +190,9 @@ private:
 
 };
 
+//! Whether to encode several files of a multiple export at once
+extern TENACITY_DLL_API BoolSetting ConcurrentExport;
+
 class SuccessDialog final : public wxDialogWrapper
 {
 public:
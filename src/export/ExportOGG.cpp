@@ -279,10 +279,13 @@ ProgressResult ExportOGG::Export(TenacityProject *project,
    }
 
    {
-      auto mixer = CreateMixer(tracks, selectionOnly,
-         t0, t1,
-         numChannels, SAMPLES_PER_RUN, false,
-         rate, floatSample, mixerSpec);
+      // Mix the next block while this one is encoded
+      ThreadedMixer mixer{
+         CreateMixer(tracks, selectionOnly,
+            t0, t1,
+            numChannels, SAMPLES_PER_RUN, false,
+            rate, floatSample, mixerSpec),
+         numChannels, SAMPLES_PER_RUN, false, floatSample };
 
       InitProgress( pDialog, fName,
          selectionOnly
@@ -292,7 +295,7 @@ ProgressResult ExportOGG::Export(TenacityProject *project,
 
       while (updateResult == ProgressResult::Success && !eos) {
          float **vorbis_buffer = vorbis_analysis_buffer(&dsp, SAMPLES_PER_RUN);
-         auto samplesThisRun = mixer->Process(SAMPLES_PER_RUN);
+         auto samplesThisRun = mixer.Process();
 
          int err;
          if (samplesThisRun == 0) {
@@ -302,7 +305,7 @@ ProgressResult ExportOGG::Export(TenacityProject *project,
          else {
 
             for (size_t i = 0; i < numChannels; i++) {
-               float *temp = (float *)mixer->GetBuffer(i);
+               const float *temp = (const float *)mixer.GetBuffer(i);
                memcpy(vorbis_buffer[i], temp, sizeof(float)*SAMPLES_PER_RUN);
             }
 
@@ -359,7 +362,7 @@ ProgressResult ExportOGG::Export(TenacityProject *project,
             break;
          }
 
-         updateResult = progress.Update(mixer->MixGetCurrentTime() - t0, t1 - t0);
+         updateResult = progress.Update(mixer.MixGetCurrentTime() - t0, t1 - t0);
       }
    }
 
@@ -380,6 +380,8 @@ void ExportPCMOptions::SendSuffixEvent()
 // ExportPCM Class
 //----------------------------------------------------------------------------
 
+class PCMExportJob;
+
 class ExportPCM final : public ExportPlugin
 {
 public:
@@ -399,12 +401,25 @@ public:
                          MixerSpec *mixerSpec = NULL,
                          const Tags *metadata = NULL,
                          int subformat = 0) override;
+   bool SupportsConcurrentExport(int) override { return true; }
+   std::unique_ptr<ExportJob> PrepareExport(TenacityProject *project,
+                         unsigned channels,
+                         const wxFileNameWrapper &fName,
+                         bool selectedOnly,
+                         double t0,
+                         double t1,
+                         MixerSpec *mixerSpec,
+                         const Tags *metadata,
+                         int subformat,
+                         ProgressResult &result) override;
    // optional
    wxString GetFormat(int index) override;
    FileExtension GetExtension(int index) override;
    unsigned GetMaxChannels(int index) override;
 
 private:
+   friend class PCMExportJob;
+
    void ReportTooBigError(wxWindow * pParent);
    ArrayOf<char> AdjustString(const wxString & wxStr, int sf_format);
    bool AddStrings(TenacityProject *project, SNDFILE *sf, const Tags *tags, int sf_format);
@@ -460,13 +475,58 @@ void ExportPCM::ReportTooBigError(wxWindow * pParent)
 #endif
 }
 
+//! The part of ExportPCM::Export() that may run in a worker thread
+class PCMExportJob final : public ExportJob
+{
+public:
+   PCMExportJob(ExportPCM &plugin, const wxFileNameWrapper &fName,
+      const Tags &metadata, TranslatableString message)
+      : ExportJob{ Verbatim( fName.GetName() ), std::move(message) }
+      , mPlugin{ plugin }
+      , mFileName{ fName }
+      , mMetadata{ metadata }
+   {}
+
+   ProgressResult Run(ExportProgress &progress) override;
+
+   ExportPCM &mPlugin;
+   const wxFileNameWrapper mFileName;
+   // A copy, because the caller's tags need not outlive the job
+   const Tags mMetadata;
+
+   wxFile mFile;  // will be closed when the job is destroyed
+   SFFile mSF;    // wraps mFile
+   SF_INFO mInfo{};
+   int mSFFormat{ 0 };
+   sampleFormat mFormat{ int16Sample };
+   double mT0{ 0 };
+   double mT1{ 0 };
+   std::unique_ptr<Mixer> mMixer;
+
+   static constexpr size_t maxBlockLen = 44100 * 5;
+};
+
+ProgressResult ExportPCM::Export(TenacityProject *project,
+                                 std::unique_ptr<ProgressDialog> &pDialog,
+                                 unsigned numChannels,
+                                 const wxFileNameWrapper &fName,
+                                 bool selectionOnly,
+                                 double t0,
+                                 double t1,
+                                 MixerSpec *mixerSpec,
+                                 const Tags *metadata,
+                                 int subformat)
+{
+   return ExportByJob(project, pDialog, numChannels, fName, selectionOnly,
+      t0, t1, mixerSpec, metadata, subformat);
+}
+
 /**
  *
  * @param subformat Control whether we are doing a "preset" export to a popular
  * file type, or giving the user full control over libsndfile.
  */
-ProgressResult ExportPCM::Export(TenacityProject *project,
-                                 std::unique_ptr<ProgressDialog> &pDialog,
+std::unique_ptr<ExportJob> ExportPCM::PrepareExport(TenacityProject *project,
                                  unsigned numChannels,
                                  const wxFileNameWrapper &fName,
                                  bool selectionOnly,
@@ -474,10 +534,12 @@ ProgressResult ExportPCM::Export(TenacityProject *project,
                                  double t1,
                                  MixerSpec *mixerSpec,
                                  const Tags *metadata,
-                                 int subformat)
+                                 int subformat,
+                                 ProgressResult &result)
 {
    double rate = ProjectRate::Get( *project ).GetRate();
    const auto &tracks = TrackList::Get( *project );
+   result = ProgressResult::Cancelled;
 
    // Set a default in case the settings aren't found
    int sf_format;
@@ -514,202 +576,214 @@ ProgressResult ExportPCM::Export(TenacityProject *project,
    }
 
    int fileFormat = sf_format & SF_FORMAT_TYPEMASK;
-   
-   auto updateResult = ProgressResult::Success;
+
+   //This whole operation should not occur while a file is being loaded on OD,
+   //(we are worried about reading from a file being written to,) so we block.
+   //Furthermore, we need to do this because libsndfile is not threadsafe.
+   wxString formatStr = SFCall<wxString>(sf_header_name, fileFormat);
+
+   // Retrieve tags if not given a set
+   if (metadata == NULL)
+      metadata = &Tags::Get( *project );
+
+   auto pJob = std::make_unique<PCMExportJob>(*this, fName, *metadata,
+      (selectionOnly
+         ? XO("Exporting the selected audio as %s")
+         : XO("Exporting the audio as %s"))
+         .Format( formatStr ) );
+   auto &job = *pJob;
+   auto &info = job.mInfo;
+   auto &sf = job.mSF;
+   job.mSFFormat = sf_format;
+   job.mT0 = t0;
+   job.mT1 = t1;
+
+   // Use libsndfile to export file
+
+   info.samplerate = (unsigned int)(rate + 0.5);
+   info.frames = (unsigned int)((t1 - t0)*rate + 0.5);
+   info.channels = numChannels;
+   info.format = sf_format;
+   info.sections = 1;
+   info.seekable = 0;
+
+   // Bug 46.  Trap here, as sndfile.c does not trap it properly.
+   if( (numChannels != 1) && ((sf_format & SF_FORMAT_SUBMASK) == SF_FORMAT_GSM610) )
    {
-      wxFile f;   // will be closed when it goes out of scope
-      SFFile       sf; // wraps f
+      AudacityMessageBox( XO("GSM 6.10 requires mono") );
+      return nullptr;
+   }
 
-      wxString     formatStr;
-      SF_INFO      info;
-      //int          err;
+   if (sf_format == SF_FORMAT_WAVEX + SF_FORMAT_GSM610) {
+      AudacityMessageBox(
+         XO("WAVEX and GSM 6.10 formats are not compatible") );
+      return nullptr;
+   }
 
-      //This whole operation should not occur while a file is being loaded on OD,
-      //(we are worried about reading from a file being written to,) so we block.
-      //Furthermore, we need to do this because libsndfile is not threadsafe.
-      formatStr = SFCall<wxString>(sf_header_name, fileFormat);
+   // If we can't export exactly the format they requested,
+   // try the default format for that header type...
+   // 
+   // LLL: I don't think this is valid since libsndfile checks
+   // for all allowed subtypes explicitly and doesn't provide
+   // for an unspecified subtype.
+   if (!sf_format_check(&info))
+      info.format = (info.format & SF_FORMAT_TYPEMASK);
+   if (!sf_format_check(&info)) {
+      AudacityMessageBox( XO("Cannot export audio in this format.") );
+      return nullptr;
+   }
+   const auto path = fName.GetFullPath();
+   if (job.mFile.Open(path, wxFile::write)) {
+      // Even though there is an sf_open() that takes a filename, use the one that
+      // takes a file descriptor since wxWidgets can open a file with a Unicode name and
+      // libsndfile can't (under Windows).
+      sf.reset(SFCall<SNDFILE*>(sf_open_fd, job.mFile.fd(), SFM_WRITE, &info, FALSE));
+      //add clipping for integer formats.  We allow floats to clip.
+      sf_command(sf.get(), SFC_SET_CLIPPING, NULL, sf_subtype_is_integer(sf_format)?SF_TRUE:SF_FALSE) ;
+   }
 
-      // Use libsndfile to export file
+   if (!sf) {
+      AudacityMessageBox( XO("Cannot export audio to %s").Format( path ) );
+      return nullptr;
+   }
 
-      info.samplerate = (unsigned int)(rate + 0.5);
-      info.frames = (unsigned int)((t1 - t0)*rate + 0.5);
-      info.channels = numChannels;
-      info.format = sf_format;
-      info.sections = 1;
-      info.seekable = 0;
+   // Install the meta data at the beginning of the file (except for
+   // WAV and WAVEX formats)
+   if (fileFormat != SF_FORMAT_WAV &&
+       fileFormat != SF_FORMAT_WAVEX) {
+      if (!AddStrings(project, sf.get(), &job.mMetadata, sf_format)) {
+         return nullptr;
+      }
+   }
 
-      // Bug 46.  Trap here, as sndfile.c does not trap it properly.
-      if( (numChannels != 1) && ((sf_format & SF_FORMAT_SUBMASK) == SF_FORMAT_GSM610) )
+   if (sf_subtype_more_than_16_bits(info.format))
+      job.mFormat = floatSample;
+   else
+      job.mFormat = int16Sample;
+
+   // Bug 2200
+   // Only trap size limit for file types we know have an upper size limit.
+   // The error message mentions aiff and wav.
+   if( (fileFormat == SF_FORMAT_WAV) ||
+       (fileFormat == SF_FORMAT_WAVEX) ||
+       (fileFormat == SF_FORMAT_AIFF ))
+   {
+      float sampleCount = (float)(t1-t0)*rate*info.channels;
+      float byteCount = sampleCount * sf_subtype_bytes_per_sample( info.format);
+      // Test for 4 Gibibytes, rather than 4 Gigabytes
+      if( byteCount > 4.295e9)
       {
-         AudacityMessageBox( XO("GSM 6.10 requires mono") );
-         return ProgressResult::Cancelled;
+         ReportTooBigError( wxTheApp->GetTopWindow() );
+         result = ProgressResult::Failed;
+         return nullptr;
       }
+   }
 
-      if (sf_format == SF_FORMAT_WAVEX + SF_FORMAT_GSM610) {
-         AudacityMessageBox(
-            XO("WAVEX and GSM 6.10 formats are not compatible") );
-         return ProgressResult::Cancelled;
-      }
+   wxASSERT(info.channels >= 0);
+   job.mMixer = CreateMixer(tracks, selectionOnly,
+                            t0, t1,
+                            info.channels, PCMExportJob::maxBlockLen, true,
+                            rate, job.mFormat, mixerSpec);
 
-      // If we can't export exactly the format they requested,
-      // try the default format for that header type...
-      // 
-      // LLL: I don't think this is valid since libsndfile checks
-      // for all allowed subtypes explicitly and doesn't provide
-      // for an unspecified subtype.
-      if (!sf_format_check(&info))
-         info.format = (info.format & SF_FORMAT_TYPEMASK);
-      if (!sf_format_check(&info)) {
-         AudacityMessageBox( XO("Cannot export audio in this format.") );
-         return ProgressResult::Cancelled;
-      }
-      const auto path = fName.GetFullPath();
-      if (f.Open(path, wxFile::write)) {
-         // Even though there is an sf_open() that takes a filename, use the one that
-         // takes a file descriptor since wxWidgets can open a file with a Unicode name and
-         // libsndfile can't (under Windows).
-         sf.reset(SFCall<SNDFILE*>(sf_open_fd, f.fd(), SFM_WRITE, &info, FALSE));
-         //add clipping for integer formats.  We allow floats to clip.
-         sf_command(sf.get(), SFC_SET_CLIPPING, NULL, sf_subtype_is_integer(sf_format)?SF_TRUE:SF_FALSE) ;
-      }
+   result = ProgressResult::Success;
+   return pJob;
+}
 
-      if (!sf) {
-         AudacityMessageBox( XO("Cannot export audio to %s").Format( path ) );
-         return ProgressResult::Cancelled;
-      }
-      // Retrieve tags if not given a set
-      if (metadata == NULL)
-         metadata = &Tags::Get( *project );
-
-      // Install the meta data at the beginning of the file (except for
-      // WAV and WAVEX formats)
-      if (fileFormat != SF_FORMAT_WAV &&
-          fileFormat != SF_FORMAT_WAVEX) {
-         if (!AddStrings(project, sf.get(), metadata, sf_format)) {
-            return ProgressResult::Cancelled;
-         }
-      }
+auto PCMExportJob::Run(ExportProgress &progress) -> ProgressResult
+{
+   const auto &fName = mFileName;
+   const auto &info = mInfo;
+   const auto format = mFormat;
+   const int fileFormat = mSFFormat & SF_FORMAT_TYPEMASK;
+   auto updateResult = ProgressResult::Success;
 
-      sampleFormat format;
-      if (sf_subtype_more_than_16_bits(info.format))
-         format = floatSample;
-      else
-         format = int16Sample;
-
-      // Bug 2200
-      // Only trap size limit for file types we know have an upper size limit.
-      // The error message mentions aiff and wav.
-      if( (fileFormat == SF_FORMAT_WAV) ||
-          (fileFormat == SF_FORMAT_WAVEX) ||
-          (fileFormat == SF_FORMAT_AIFF ))
-      {
-         float sampleCount = (float)(t1-t0)*rate*info.channels;
-         float byteCount = sampleCount * sf_subtype_bytes_per_sample( info.format);
-         // Test for 4 Gibibytes, rather than 4 Gigabytes
-         if( byteCount > 4.295e9)
-         {
-            ReportTooBigError( wxTheApp->GetTopWindow() );
-            return ProgressResult::Failed;
-         }
+   {
+      std::vector<char> dither;
+      if ((info.format & SF_FORMAT_SUBMASK) == SF_FORMAT_PCM_24) {
+         dither.reserve(maxBlockLen * info.channels * SAMPLE_SIZE(int24Sample));
       }
-      size_t maxBlockLen = 44100 * 5;
 
-      {
-         std::vector<char> dither;
-         if ((info.format & SF_FORMAT_SUBMASK) == SF_FORMAT_PCM_24) {
-            dither.reserve(maxBlockLen * info.channels * SAMPLE_SIZE(int24Sample));
-         }
+      // Mix the next block while this one is written
+      ThreadedMixer mixer{ std::move(mMixer),
+         static_cast<unsigned>(info.channels), maxBlockLen, true, format };
 
-         wxASSERT(info.channels >= 0);
-         auto mixer = CreateMixer(tracks, selectionOnly,
-                                  t0, t1,
-                                  info.channels, maxBlockLen, true,
-                                  rate, format, mixerSpec);
-
-         InitProgress( pDialog, fName,
-            (selectionOnly
-               ? XO("Exporting the selected audio as %s")
-               : XO("Exporting the audio as %s"))
-               .Format( formatStr ) );
-         auto &progress = *pDialog;
-
-         while (updateResult == ProgressResult::Success) {
-            sf_count_t samplesWritten;
-            size_t numSamples = mixer->Process(maxBlockLen);
-
-            if (numSamples == 0)
-               break;
-
-            auto mixed = mixer->GetBuffer();
-
-            // Bug 1572: Not ideal, but it does add the desired dither
-            if ((info.format & SF_FORMAT_SUBMASK) == SF_FORMAT_PCM_24) {
-               for (int c = 0; c < info.channels; ++c) {
-                  CopySamples(
-                     mixed + (c * SAMPLE_SIZE(format)), format,
-                     dither.data() + (c * SAMPLE_SIZE(int24Sample)), int24Sample,
-                     numSamples, gHighQualityDither, info.channels, info.channels
-                  );
-                  // Copy back without dither
-                  CopySamples(
-                     dither.data() + (c * SAMPLE_SIZE(int24Sample)), int24Sample,
-                     const_cast<samplePtr>(mixed) // PRL fix this!
-                        + (c * SAMPLE_SIZE(format)), format,
-                     numSamples, DitherType::none, info.channels, info.channels);
-               }
+      while (updateResult == ProgressResult::Success) {
+         sf_count_t samplesWritten;
+         size_t numSamples = mixer.Process();
+
+         if (numSamples == 0)
+            break;
+
+         auto mixed = mixer.GetBuffer();
+
+         // Bug 1572: Not ideal, but it does add the desired dither
+         if ((info.format & SF_FORMAT_SUBMASK) == SF_FORMAT_PCM_24) {
+            for (int c = 0; c < info.channels; ++c) {
+               CopySamples(
+                  mixed + (c * SAMPLE_SIZE(format)), format,
+                  dither.data() + (c * SAMPLE_SIZE(int24Sample)), int24Sample,
+                  numSamples, gHighQualityDither, info.channels, info.channels
+               );
+               // Copy back without dither
+               CopySamples(
+                  dither.data() + (c * SAMPLE_SIZE(int24Sample)), int24Sample,
+                  const_cast<samplePtr>(mixed) // PRL fix this!
+                     + (c * SAMPLE_SIZE(format)), format,
+                  numSamples, DitherType::none, info.channels, info.channels);
             }
+         }
 
-            if (format == int16Sample)
-               samplesWritten = SFCall<sf_count_t>(sf_writef_short, sf.get(), (const short *)mixed, numSamples);
-            else
-               samplesWritten = SFCall<sf_count_t>(sf_writef_float, sf.get(), (const float *)mixed, numSamples);
+         if (format == int16Sample)
+            samplesWritten = SFCall<sf_count_t>(sf_writef_short, mSF.get(), (const short *)mixed, numSamples);
+         else
+            samplesWritten = SFCall<sf_count_t>(sf_writef_float, mSF.get(), (const float *)mixed, numSamples);
 
-            if (static_cast<size_t>(samplesWritten) != numSamples) {
-               char buffer2[1000];
-               sf_error_str(sf.get(), buffer2, 1000);
-               //Used to give this error message
+         if (static_cast<size_t>(samplesWritten) != numSamples) {
+            char buffer2[1000];
+            sf_error_str(mSF.get(), buffer2, 1000);
+            //Used to give this error message
 #if 0
-               AudacityMessageBox(
-                  XO(
-                  /* i18n-hint: %s will be the error message from libsndfile, which
-                   * is usually something unhelpful (and untranslated) like "system
-                   * error" */
+            AudacityMessageBox(
+               XO(
+               /* i18n-hint: %s will be the error message from libsndfile, which
+                * is usually something unhelpful (and untranslated) like "system
+                * error" */
 "Error while writing %s file (disk full?).\nLibsndfile says \"%s\"")
-                     .Format( formatStr, wxString::FromAscii(buffer2) ));
+                  .Format( formatStr, wxString::FromAscii(buffer2) ));
 #else
-               // But better to give the same error message as for
-               // other cases of disk exhaustion.
-               // The thrown exception doesn't escape but GuardedCall
-               // will enqueue a message.
-               GuardedCall([&fName]{
-                  throw FileException{
-                     FileException::Cause::Write, fName }; });
+            // But better to give the same error message as for
+            // other cases of disk exhaustion.
+            // The thrown exception doesn't escape but GuardedCall
+            // will enqueue a message.
+            GuardedCall([&fName]{
+               throw FileException{
+                  FileException::Cause::Write, fName }; });
 #endif
-               updateResult = ProgressResult::Cancelled;
-               break;
-            }
-            
-            updateResult = progress.Update(mixer->MixGetCurrentTime() - t0, t1 - t0);
+            updateResult = ProgressResult::Cancelled;
+            break;
          }
+
+         updateResult = progress.Update(mixer.MixGetCurrentTime() - mT0, mT1 - mT0);
       }
-      
-      // Install the WAV metata in a "LIST" chunk at the end of the file
-      if (updateResult == ProgressResult::Success ||
-          updateResult == ProgressResult::Stopped) {
-         if (fileFormat == SF_FORMAT_WAV ||
-             fileFormat == SF_FORMAT_WAVEX) {
-            if (!AddStrings(project, sf.get(), metadata, sf_format)) {
-               // TODO: more precise message
-               ShowExportErrorDialog("PCM:675");
-               return ProgressResult::Cancelled;
-            }
-         }
-         if (0 != sf.close()) {
+   }
+
+   // Install the WAV metata in a "LIST" chunk at the end of the file
+   if (updateResult == ProgressResult::Success ||
+       updateResult == ProgressResult::Stopped) {
+      if (fileFormat == SF_FORMAT_WAV ||
+          fileFormat == SF_FORMAT_WAVEX) {
+         if (!mPlugin.AddStrings(nullptr, mSF.get(), &mMetadata, mSFFormat)) {
             // TODO: more precise message
-            ShowExportErrorDialog("PCM:681");
+            progress.OnMainThread([]{ ShowExportErrorDialog("PCM:675"); });
             return ProgressResult::Cancelled;
          }
       }
+      if (0 != mSF.close()) {
+         // TODO: more precise message
+         progress.OnMainThread([]{ ShowExportErrorDialog("PCM:681"); });
+         return ProgressResult::Cancelled;
+      }
+      mFile.Close();
    }
 
    if (updateResult == ProgressResult::Success ||
@@ -717,9 +791,9 @@ ProgressResult ExportPCM::Export(TenacityProject *project,
       if ((fileFormat == SF_FORMAT_AIFF) ||
           (fileFormat == SF_FORMAT_WAV))
          // Note: file has closed, and gets reopened and closed again here:
-         if (!AddID3Chunk(fName, metadata, sf_format) ) {
+         if (!mPlugin.AddID3Chunk(fName, &mMetadata, mSFFormat) ) {
             // TODO: more precise message
-            ShowExportErrorDialog("PCM:694");
+            progress.OnMainThread([]{ ShowExportErrorDialog("PCM:694"); });
             return ProgressResult::Cancelled;
          }
 
@@ -11,6 +11,7 @@
 
 #include "ExportPlugin.h"
 #include "Export.h"
+#include "RenderCache.h"
 
 // Tenacity libraries
 #include <lib-files/wxFileNameWrapper.h>
@@ -18,6 +19,29 @@
 
 #include "../WaveTrack.h"
 
+namespace {
+struct DialogExportProgress final : ExportProgress
+{
+    explicit DialogExportProgress(ProgressDialog &dialog)
+        : mDialog{ dialog }
+    {}
+
+    ProgressResult Update(double fraction) override
+    {
+        return mDialog.Update(fraction, 1.0);
+    }
+
+    ProgressDialog &mDialog;
+};
+}
+
+ExportJob::ExportJob(TranslatableString title, TranslatableString message)
+    : mTitle{ std::move(title) }
+    , mMessage{ std::move(message) }
+{
+}
+
+ExportJob::~ExportJob() = default;
 
 ExportPlugin::ExportPlugin()
 {
@@ -165,6 +189,36 @@ void ExportPlugin::OptionsCreate(ShuttleGui &S, int /* format */)
     S.EndHorizontalLay();
 }
 
+bool ExportPlugin::SupportsConcurrentExport(int /* subformat */)
+{
+    return false;
+}
+
+std::unique_ptr<ExportJob> ExportPlugin::PrepareExport(TenacityProject *,
+    unsigned, const wxFileNameWrapper &, bool, double, double,
+    MixerSpec *, const Tags *, int, ProgressResult &result)
+{
+    result = ProgressResult::Failed;
+    return nullptr;
+}
+
+auto ExportPlugin::ExportByJob(TenacityProject *project,
+    std::unique_ptr<ProgressDialog> &pDialog,
+    unsigned channels, const wxFileNameWrapper &fName, bool selectedOnly,
+    double t0, double t1, MixerSpec *mixerSpec, const Tags *metadata,
+    int subformat) -> ProgressResult
+{
+    auto result = ProgressResult::Failed;
+    auto pJob = PrepareExport(project, channels, fName, selectedOnly,
+        t0, t1, mixerSpec, metadata, subformat, result);
+    if (!pJob)
+        return result;
+
+    InitProgress(pDialog, pJob->GetTitle(), pJob->GetMessage());
+    DialogExportProgress progress{ *pDialog };
+    return pJob->Run(progress);
+}
+
 /// Creates a mixer by computing the time warp factor
 std::unique_ptr<Mixer> ExportPlugin::CreateMixer(const TrackList &tracks,
             bool selectionOnly,
@@ -187,6 +241,11 @@ std::unique_ptr<Mixer> ExportPlugin::CreateMixer(const TrackList &tracks,
         );
     }
 
+    if (auto pMixer = RenderCache::CreateMixer(tracks, inputTracks,
+            startTime, stopTime, numOutChannels, outBufferSize, outInterleaved,
+            outRate, outFormat, mixerSpec))
+        return pMixer;
+
     // MB: the stop time should not be warped, this was a bug.
     return std::make_unique<Mixer>(
         inputTracks,
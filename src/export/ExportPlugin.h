@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -20,6 +21,7 @@ class wxWindow;
 class TenacityProject;
 
 #include "../Tags.h"
+#include "../TaskBatch.h"
 #include "../shuttle/ShuttleGui.h"
 #include "../widgets/ProgressDialog.h"
 
@@ -45,6 +47,36 @@ struct TENACITY_DLL_API FormatInfo
     bool mCanMetaData;
 };
 
+//! Where the loop of ExportJob::Run() reports its progress
+/*! Usually a progress dialog, but when several files are exported
+ concurrently, a share of one dialog polled by the main thread */
+using ExportProgress = TaskProgress;
+
+//! The mixing and encoding of one file, after ExportPlugin::PrepareExport()
+/*! Run() may happen in a thread other than the main.  So it must not use the
+ GUI, the preferences or the project, except through
+ ExportProgress::OnMainThread(), as when reporting errors. */
+class TENACITY_DLL_API ExportJob /* not final */
+{
+public:
+   using ProgressResult = GenericUI::ProgressResult;
+
+   ExportJob(TranslatableString title, TranslatableString message);
+   virtual ~ExportJob();
+
+   //! For a progress dialog of this file alone
+   const TranslatableString &GetTitle() const { return mTitle; }
+   const TranslatableString &GetMessage() const { return mMessage; }
+
+   //! Mix and encode the whole file; may throw
+   /*! @return as for ExportPlugin::Export() */
+   virtual ProgressResult Run(ExportProgress &progress) = 0;
+
+private:
+   const TranslatableString mTitle;
+   const TranslatableString mMessage;
+};
+
 class TENACITY_DLL_API ExportPlugin /* not final */
 {
     public:
@@ -118,7 +150,44 @@ class TENACITY_DLL_API ExportPlugin /* not final */
                                       const Tags *metadata = NULL,
                                       int subformat = 0) = 0;
 
+        //! Whether PrepareExport() is implemented for the sub-format
+        /*! The default is false */
+        virtual bool SupportsConcurrentExport(int subformat);
+
+        //! Do the part of Export() that needs the main thread, deferring the rest
+        /*!
+        * Open the file, read preferences and create the mixer, which captures
+        * the tracks to be mixed as they are now.  Called only if
+        * SupportsConcurrentExport().  Parameters are as for Export().
+        * @param result set to ProgressResult::Failed or
+        * ProgressResult::Cancelled if null is returned, in which case this
+        * function is responsible for alerting the user
+        */
+        virtual std::unique_ptr<ExportJob> PrepareExport(
+                                      TenacityProject *project,
+                                      unsigned channels,
+                                      const wxFileNameWrapper &fName,
+                                      bool selectedOnly,
+                                      double t0,
+                                      double t1,
+                                      MixerSpec *mixerSpec,
+                                      const Tags *metadata,
+                                      int subformat,
+                                      ProgressResult &result);
+
     protected:
+        //! Implements Export() for plug-ins that override PrepareExport()
+        ProgressResult ExportByJob(TenacityProject *project,
+                std::unique_ptr<ProgressDialog> &pDialog,
+                unsigned channels,
+                const wxFileNameWrapper &fName,
+                bool selectedOnly,
+                double t0,
+                double t1,
+                MixerSpec *mixerSpec,
+                const Tags *metadata,
+                int subformat);
+
         std::unique_ptr<Mixer> CreateMixer(const TrackList &tracks,
                 bool selectionOnly,
                 double startTime, double stopTime,
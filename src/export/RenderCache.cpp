@@ -0,0 +1,540 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file RenderCache.cpp
+
+**********************************************************************/
+#include "RenderCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <wx/dir.h>
+#include <wx/file.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+// Tenacity libraries
+#include <lib-files/TempDirectory.h>
+#include <lib-preferences/Prefs.h>
+#include <lib-track/Envelope.h>
+
+#include "Project.h"
+#include "../ProjectFileIO.h"
+#include "../SampleBlock.h"
+#include "../Sequence.h"
+#include "../WaveClip.h"
+#include "../WaveTrack.h"
+
+BoolSetting RenderCacheEnabled{ L"/FileFormats/RenderCache", false };
+IntSetting RenderCacheSize{ L"/FileFormats/RenderCacheSize", 2048 };
+
+namespace {
+
+// Samples in a segment at the rate of the export, about six seconds at
+// 44100 Hz.  Segments begin at multiples of this, counting from time zero,
+// so that exports of different ranges of the project share them.
+constexpr size_t SegmentLength = 1 << 18;
+
+constexpr char FileMagic[4] = { 'T', 'R', 'C', 'S' };
+constexpr std::uint32_t FileVersion = 1;
+
+//! Bytes describing everything that goes into the mix of one segment
+/*! Segments with equal descriptions mix to equal samples */
+class SegmentKey
+{
+public:
+   template<typename T> void Add(const T &value)
+   {
+      static_assert(std::is_arithmetic<T>::value,
+         "only numbers are described by their bytes");
+      mBytes.append(reinterpret_cast<const char *>(&value), sizeof(value));
+   }
+
+   void Add(const wxString &string)
+   {
+      const auto utf8 = string.ToUTF8();
+      Add(utf8.length());
+      mBytes.append(utf8.data(), utf8.length());
+   }
+
+   const std::string &GetBytes() const { return mBytes; }
+
+   //! The name of the file that holds the segment, without the directory
+   wxString GetFileName() const
+   {
+      // FNV-1a
+      unsigned long long hash = 14695981039346656037ULL;
+      for (const auto byte : mBytes) {
+         hash ^= static_cast<unsigned char>(byte);
+         hash *= 1099511628211ULL;
+      }
+      return wxString::Format(wxT("%016llx.seg"), hash);
+   }
+
+private:
+   std::string mBytes;
+};
+
+//! Mixes a segment at a time, into a Mixer of float samples, unless the
+//! segment is in the cache; then converts to the requested format
+class RenderCacheMixer final : public Mixer
+{
+public:
+   RenderCacheMixer(const TrackList &tracks,
+      const SampleTrackConstArray &inputTracks,
+      double startTime, double stopTime,
+      unsigned numOutChannels, size_t outBufferSize, bool outInterleaved,
+      double outRate, sampleFormat outFormat,
+      MixerSpec *mixerSpec, const FilePath &projectPath);
+   ~RenderCacheMixer() override;
+
+   size_t Process(size_t maxSamples) override;
+   void Restart() override;
+   void Reposition(double t, bool bSkipping = false) override;
+   double MixGetCurrentTime() override;
+   constSamplePtr GetBuffer() override;
+   constSamplePtr GetBuffer(int channel) override;
+
+private:
+   //! Continue from the time of the underlying mixer, after it moved
+   void Resync();
+   //! Fill mSegment from mPosition to the end of its segment
+   /*! @return false at the end of the mix */
+   bool NextSegment();
+   //! Mix into mSegment from mPosition
+   /*! @return how many samples there were, fewer than len at the end */
+   size_t MixSegment(size_t len);
+
+   //! @return false if the segment beginning at start can't be cached
+   bool DescribeSegment(SegmentKey &key, sampleCount start) const;
+   bool Load(const SegmentKey &key, const wxString &path);
+   void Save(const SegmentKey &key, const wxString &path, size_t len);
+   //! Remove the least recently used segments, while over the size limit
+   void Trim() const;
+
+   std::vector<const WaveTrack *> mTracks;
+   const MixerSpec *const mSpec;
+   const FilePath mProjectPath;
+   const wxString mDirectory;
+   const long long mSizeLimit;
+   const double mStopTime;
+   const double mOutRate;
+   const unsigned mOutChannels;
+   const size_t mOutBufferSize;
+   const bool mOutInterleaved;
+   const sampleFormat mOutFormat;
+
+   ArrayOf<SampleBuffer> mBuffers;
+   //! Floats of the current segment, from its beginning or from startTime
+   FloatBuffers mSegment;
+   size_t mSegmentLen{ 0 };
+   size_t mSegmentUsed{ 0 };
+   sampleCount mPosition;
+   bool mFinished{ false };
+   bool mSaved{ false };
+};
+
+RenderCacheMixer::RenderCacheMixer(const TrackList &tracks,
+   const SampleTrackConstArray &inputTracks,
+   double startTime, double stopTime,
+   unsigned numOutChannels, size_t outBufferSize, bool outInterleaved,
+   double outRate, sampleFormat outFormat,
+   MixerSpec *mixerSpec, const FilePath &projectPath)
+   // Mix a whole segment at each call, so that where a buffer ends never
+   // depends on the exporter's buffer size
+   : Mixer{ inputTracks, true, Mixer::WarpOptions{ tracks },
+      startTime, stopTime, numOutChannels, SegmentLength, false,
+      outRate, floatSample, true, mixerSpec }
+   , mSpec{ mixerSpec }
+   , mProjectPath{ projectPath }
+   , mDirectory{ TempDirectory::TempDir() + wxFILE_SEP_PATH + wxT("RenderCache") }
+   , mSizeLimit{ std::max(0, RenderCacheSize.Read()) * 1024LL * 1024LL }
+   , mStopTime{ stopTime }
+   , mOutRate{ outRate }
+   , mOutChannels{ numOutChannels }
+   , mOutBufferSize{ outBufferSize }
+   , mOutInterleaved{ outInterleaved }
+   , mOutFormat{ outFormat }
+   , mBuffers{ outInterleaved ? 1 : numOutChannels }
+   , mSegment{ numOutChannels, SegmentLength }
+{
+   for (const auto &pTrack : inputTracks)
+      mTracks.push_back(static_cast<const WaveTrack *>(pTrack.get()));
+   mPosition = mTracks.front()->TimeToLongSamples(startTime);
+
+   const auto size = outBufferSize * (outInterleaved ? numOutChannels : 1);
+   for (unsigned c = 0; c < (outInterleaved ? 1 : numOutChannels); ++c)
+      mBuffers[c].Allocate(size, outFormat);
+}
+
+RenderCacheMixer::~RenderCacheMixer()
+{
+   if (mSaved)
+      Trim();
+}
+
+size_t RenderCacheMixer::Process(size_t maxSamples)
+{
+   maxSamples = std::min(maxSamples, mOutBufferSize);
+   const auto size = SAMPLE_SIZE(mOutFormat);
+   // Fill the buffer across segment boundaries, as Mixer does
+   size_t done = 0;
+   while (done < maxSamples) {
+      if (mSegmentUsed == mSegmentLen && !NextSegment())
+         break;
+      const auto len = std::min(maxSamples - done, mSegmentLen - mSegmentUsed);
+      for (unsigned c = 0; c < mOutChannels; ++c) {
+         const auto dest = mOutInterleaved
+            ? mBuffers[0].ptr() + (done * mOutChannels + c) * size
+            : mBuffers[c].ptr() + done * size;
+         CopySamples(
+            reinterpret_cast<constSamplePtr>(mSegment[c].get() + mSegmentUsed),
+            floatSample, dest, mOutFormat, len, gHighQualityDither,
+            1, mOutInterleaved ? mOutChannels : 1);
+      }
+      done += len;
+      mSegmentUsed += len;
+      mPosition += len;
+   }
+   return done;
+}
+
+void RenderCacheMixer::Restart()
+{
+   Mixer::Restart();
+   Resync();
+}
+
+void RenderCacheMixer::Reposition(double t, bool bSkipping)
+{
+   // The underlying mixer limits t to the mixed range
+   Mixer::Reposition(t, bSkipping);
+   Resync();
+}
+
+void RenderCacheMixer::Resync()
+{
+   mPosition = mTracks.front()->TimeToLongSamples(Mixer::MixGetCurrentTime());
+   // Take the next samples from whichever segment holds them
+   mSegmentLen = 0;
+   mSegmentUsed = 0;
+   mFinished = false;
+}
+
+double RenderCacheMixer::MixGetCurrentTime()
+{
+   return mPosition.as_double() / mOutRate;
+}
+
+constSamplePtr RenderCacheMixer::GetBuffer()
+{
+   return mBuffers[0].ptr();
+}
+
+constSamplePtr RenderCacheMixer::GetBuffer(int channel)
+{
+   return mBuffers[channel].ptr();
+}
+
+bool RenderCacheMixer::NextSegment()
+{
+   if (mFinished)
+      return false;
+
+   const auto position = mPosition.as_long_long();
+   const auto start = position - position % SegmentLength;
+   const auto len = static_cast<size_t>(start + SegmentLength - position);
+   mSegmentUsed = 0;
+
+   // Segments cut short by the ends of the exported range are mixed afresh
+   SegmentKey key;
+   wxString path;
+   if (position == start &&
+       (start + SegmentLength) / mOutRate <= mStopTime &&
+       DescribeSegment(key, mPosition))
+      path = mDirectory + wxFILE_SEP_PATH + key.GetFileName();
+
+   if (path.empty() || !Load(key, path)) {
+      mSegmentLen = MixSegment(len);
+      if (!path.empty() && mSegmentLen > 0)
+         Save(key, path, mSegmentLen);
+   }
+
+   // A short segment holds the ends of all tracks
+   if (mSegmentLen < len)
+      mFinished = true;
+   return mSegmentLen > 0;
+}
+
+size_t RenderCacheMixer::MixSegment(size_t len)
+{
+   // After segments from the cache, the underlying mixer lags behind
+   Mixer::Reposition(mPosition.as_double() / mOutRate);
+   const auto result = Mixer::Process(len);
+   for (unsigned c = 0; c < mOutChannels; ++c)
+      memcpy(mSegment[c].get(), Mixer::GetBuffer(c), result * sizeof(float));
+   return result;
+}
+
+bool RenderCacheMixer::DescribeSegment(
+   SegmentKey &key, sampleCount start) const
+{
+   const double t0 = start.as_double() / mOutRate;
+   const double t1 = (start + SegmentLength).as_double() / mOutRate;
+   // Allow for the rounding of times to samples
+   const double margin = 1.0 / mOutRate;
+
+   key.Add(mProjectPath);
+   key.Add(mOutRate);
+   key.Add(mOutChannels);
+   key.Add(SegmentLength);
+   key.Add(start.as_long_long());
+   key.Add(mTracks.size());
+   key.Add(mSpec != nullptr);
+
+   for (size_t ii = 0; ii < mTracks.size(); ++ii) {
+      const auto track = mTracks[ii];
+      key.Add(static_cast<int>(track->GetChannel()));
+      key.Add(track->GetRate());
+      for (unsigned c = 0; c < mOutChannels; ++c) {
+         key.Add(track->GetChannelGain(c));
+         if (mSpec)
+            key.Add(mSpec->mMap[ii][c]);
+      }
+      // Where the track ends matters only when it ends in the segment
+      key.Add(std::min(track->GetEndTime(), t1));
+
+      std::vector<const WaveClip *> clips;
+      for (const auto &pClip : track->GetClips())
+         if (pClip->GetPlayStartTime() < t1 + margin &&
+             pClip->GetPlayEndTime() > t0 - margin)
+            clips.push_back(pClip.get());
+      std::sort(clips.begin(), clips.end(),
+         [](const WaveClip *a, const WaveClip *b){
+            return a->GetPlayStartTime() < b->GetPlayStartTime(); });
+      key.Add(clips.size());
+
+      for (const auto clip : clips) {
+         // Samples not yet in blocks, as while recording, have no identity
+         if (clip->GetAppendBufferLen() > 0)
+            return false;
+
+         const auto sequenceStart = clip->GetSequenceStartTime();
+         key.Add(clip->GetPlayStartTime());
+         key.Add(clip->GetPlayEndTime());
+         key.Add(sequenceStart);
+         key.Add(clip->GetTrimLeft());
+         key.Add(clip->GetTrimRight());
+         key.Add(clip->GetRate());
+
+         // Blocks are never changed, only replaced by others with new ids;
+         // the summary guards against reuse of ids, as in another project
+         // saved under the same name
+         const auto rate = clip->GetRate();
+         const sampleCount first{ floor((t0 - sequenceStart - margin) * rate) };
+         const sampleCount last{ ceil((t1 - sequenceStart + margin) * rate) };
+         for (const auto &block : clip->GetSequence()->GetBlockArray()) {
+            const auto &sb = *block.sb;
+            const auto count = sb.GetSampleCount();
+            if (block.start + count <= first || block.start >= last)
+               continue;
+            key.Add(block.start.as_long_long());
+            key.Add(sb.GetBlockID());
+            key.Add(count);
+            const auto stats = sb.GetMinMaxRMS(false);
+            key.Add(stats.min);
+            key.Add(stats.max);
+            key.Add(stats.RMS);
+         }
+
+         // The points in the segment, and their neighbours on either side,
+         // determine the envelope there; the value at the start covers an
+         // envelope without points
+         const auto &envelope = *clip->GetEnvelope();
+         const auto offset = envelope.GetOffset();
+         const auto nPoints = envelope.GetNumberOfPoints();
+         size_t begin = 0;
+         while (begin < nPoints &&
+                envelope[begin].GetT() < t0 - offset - margin)
+            ++begin;
+         size_t end = begin;
+         while (end < nPoints && envelope[end].GetT() <= t1 - offset + margin)
+            ++end;
+         begin = (begin > 0) ? begin - 1 : 0;
+         end = std::min(end + 1, nPoints);
+         key.Add(offset);
+         key.Add(envelope.GetExponential());
+         key.Add(envelope.GetValue(t0));
+         key.Add(end - begin);
+         for (auto jj = begin; jj < end; ++jj) {
+            key.Add(envelope[jj].GetT());
+            key.Add(envelope[jj].GetVal());
+         }
+      }
+   }
+   return true;
+}
+
+bool RenderCacheMixer::Load(const SegmentKey &key, const wxString &path)
+{
+   wxLogNull noLog;
+   wxFile file;
+   if (!wxFile::Exists(path) || !file.Open(path))
+      return false;
+
+   const auto read = [&](void *dest, size_t size){
+      return file.Read(dest, size) == static_cast<ssize_t>(size);
+   };
+
+   char magic[sizeof FileMagic];
+   std::uint32_t version{}, keyLength{}, channels{};
+   std::uint64_t samples{};
+   const auto &bytes = key.GetBytes();
+   if (!read(magic, sizeof magic) ||
+       memcmp(magic, FileMagic, sizeof magic) != 0 ||
+       !read(&version, sizeof version) || version != FileVersion ||
+       !read(&keyLength, sizeof keyLength) || keyLength != bytes.size())
+      return false;
+
+   // The file name is only a hash; the whole description must match
+   std::string stored(keyLength, '\0');
+   if (!read(&stored[0], keyLength) || stored != bytes)
+      return false;
+
+   if (!read(&channels, sizeof channels) || channels != mOutChannels ||
+       !read(&samples, sizeof samples) ||
+       samples == 0 || samples > SegmentLength)
+      return false;
+   for (unsigned c = 0; c < mOutChannels; ++c)
+      if (!read(mSegment[c].get(), samples * sizeof(float)))
+         return false;
+
+   mSegmentLen = samples;
+   // Mark the segment as recently used
+   wxFileName{ path }.Touch();
+   return true;
+}
+
+void RenderCacheMixer::Save(
+   const SegmentKey &key, const wxString &path, size_t len)
+{
+   wxLogNull noLog;
+   if (!wxFileName::DirExists(mDirectory) &&
+       !wxFileName::Mkdir(mDirectory, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL))
+      return;
+
+   // Write under another name and then rename, so that other exports
+   // running at the same time never read part of a file
+   wxFile file;
+   const auto temp = wxFileName::CreateTempFileName(path, &file);
+   if (temp.empty())
+      return;
+
+   const auto write = [&](const void *src, size_t size){
+      return file.Write(src, size) == size;
+   };
+
+   const auto &bytes = key.GetBytes();
+   const std::uint32_t version = FileVersion;
+   const std::uint32_t keyLength = bytes.size();
+   const std::uint32_t channels = mOutChannels;
+   const std::uint64_t samples = len;
+   bool ok = write(FileMagic, sizeof FileMagic) &&
+      write(&version, sizeof version) &&
+      write(&keyLength, sizeof keyLength) &&
+      write(bytes.data(), bytes.size()) &&
+      write(&channels, sizeof channels) &&
+      write(&samples, sizeof samples);
+   for (unsigned c = 0; ok && c < mOutChannels; ++c)
+      ok = write(mSegment[c].get(), len * sizeof(float));
+   ok = file.Close() && ok;
+
+   // Failure costs only the reuse of this segment
+   if (!ok || !wxRenameFile(temp, path, true)) {
+      wxRemoveFile(temp);
+      return;
+   }
+   mSaved = true;
+}
+
+void RenderCacheMixer::Trim() const
+{
+   wxLogNull noLog;
+   wxArrayString paths;
+   if (!wxDir::Exists(mDirectory))
+      return;
+   wxDir::GetAllFiles(mDirectory, &paths, wxT("*.seg"), wxDIR_FILES);
+
+   struct Entry {
+      time_t used;
+      long long size;
+      wxString path;
+   };
+   std::vector<Entry> entries;
+   long long total = 0;
+   for (const auto &path : paths) {
+      const auto size = wxFileName::GetSize(path);
+      if (size == wxInvalidSize)
+         continue;
+      const auto bytes = static_cast<long long>(size.GetValue());
+      entries.push_back({ wxFileModificationTime(path), bytes, path });
+      total += bytes;
+   }
+   if (total <= mSizeLimit)
+      return;
+
+   std::sort(entries.begin(), entries.end(),
+      [](const Entry &a, const Entry &b){ return a.used < b.used; });
+   for (const auto &entry : entries) {
+      if (total <= mSizeLimit)
+         break;
+      // Another export may have removed it already
+      if (wxRemoveFile(entry.path))
+         total -= entry.size;
+   }
+}
+
+}
+
+std::unique_ptr<Mixer> RenderCache::CreateMixer(const TrackList &tracks,
+   const SampleTrackConstArray &inputTracks,
+   double startTime, double stopTime,
+   unsigned numOutChannels, size_t outBufferSize, bool outInterleaved,
+   double outRate, sampleFormat outFormat,
+   MixerSpec *mixerSpec)
+{
+   if (!RenderCacheEnabled.Read() || inputTracks.empty() ||
+       startTime < 0 || stopTime <= startTime)
+      return nullptr;
+
+   // A time warp changes the rate continuously, and resampling carries state
+   // from each buffer into the next, so that a segment mixed alone would not
+   // be the same
+   if (Mixer::WarpOptions::DefaultWarp::Call(tracks))
+      return nullptr;
+   for (const auto &pTrack : inputTracks) {
+      const auto pWaveTrack = dynamic_cast<const WaveTrack *>(pTrack.get());
+      if (!pWaveTrack || pWaveTrack->GetRate() != outRate)
+         return nullptr;
+   }
+
+   // Block ids are unique only within a project file
+   const auto pProject = tracks.GetOwner();
+   if (!pProject)
+      return nullptr;
+   const auto &projectPath = ProjectFileIO::Get(*pProject).GetFileName();
+   if (projectPath.empty())
+      return nullptr;
+
+   return std::make_unique<RenderCacheMixer>(tracks, inputTracks,
+      startTime, stopTime, numOutChannels, outBufferSize, outInterleaved,
+      outRate, outFormat, mixerSpec, projectPath);
+}
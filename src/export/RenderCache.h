@@ -0,0 +1,50 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file RenderCache.h
+  @brief Reuse of mixed audio between exports of a project
+
+**********************************************************************/
+#ifndef __TENACITY_RENDER_CACHE__
+#define __TENACITY_RENDER_CACHE__
+
+#include <memory>
+
+// Tenacity libraries
+#include <lib-sample-track/Mix.h>
+
+class BoolSetting;
+class IntSetting;
+class TrackList;
+
+//! Whether exports save their mix in the temporary directory, to reuse it
+extern TENACITY_DLL_API BoolSetting RenderCacheEnabled;
+//! Megabytes of saved mix to keep, dropping the least recently used first
+extern TENACITY_DLL_API IntSetting RenderCacheSize;
+
+namespace RenderCache {
+
+//! A mixer that takes what it can from earlier exports
+/*!
+ The mix is cut into segments at fixed positions on the time line, and each
+ segment is found again by a description of everything that goes into it:
+ sample blocks, envelope points, gains, rates and channel mapping.  Editing
+ one place in a long project so invalidates only the segments around it.
+
+ Only mixes without resampling or time warp are cached, because only these
+ give the same samples when mixed a segment at a time.
+
+ @return null when the cache is disabled or can't serve this mix; the
+ arguments are those of the Mixer constructor
+ */
+TENACITY_DLL_API std::unique_ptr<Mixer> CreateMixer(const TrackList &tracks,
+   const SampleTrackConstArray &inputTracks,
+   double startTime, double stopTime,
+   unsigned numOutChannels, size_t outBufferSize, bool outInterleaved,
+   double outRate, sampleFormat outFormat,
+   MixerSpec *mixerSpec);
+
+}
+
+#endif
@@ -0,0 +1,186 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file ThreadedMixer.cpp
+
+**********************************************************************/
+#include "ThreadedMixer.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+
+// Tenacity libraries
+#include <lib-sample-track/Mix.h>
+#include <lib-utility/MemoryX.h>
+#include <lib-utility/ThreadPool.h>
+
+namespace {
+
+// Enough to absorb the variation of encoding time from buffer to buffer
+constexpr size_t NumMixerSlots = 4;
+
+}
+
+struct ThreadedMixer::Slot
+{
+   ArrayOf<SampleBuffer> buffers;
+   size_t len{ 0 };
+   double time{ 0 };
+};
+
+struct ThreadedMixer::State
+{
+   void Run();
+
+   std::unique_ptr<Mixer> pMixer;
+   unsigned numChannels{ 0 };
+   size_t bufferSize{ 0 };
+   bool interleaved{ false };
+   sampleFormat format{ floatSample };
+
+   Slot slots[NumMixerSlots];
+
+   std::mutex mutex;
+   std::condition_variable condition;
+   // Counts of slots, increasing without bound:  filled by the mixer, taken
+   // by the encoder, and given back to the mixer by the encoder
+   size_t produced{ 0 };
+   size_t taken{ 0 };
+   size_t released{ 0 };
+   std::exception_ptr exception;
+   //! The mixer is in the middle of a buffer
+   bool busy{ false };
+   //! The mixer returned zero samples, or threw
+   bool finished{ false };
+   bool stopping{ false };
+};
+
+void ThreadedMixer::State::Run()
+{
+   std::unique_lock<std::mutex> lock{ mutex };
+   while (true) {
+      condition.wait(lock, [this]{
+         return stopping || produced < released + NumMixerSlots; });
+      if (stopping)
+         return;
+
+      // The encoder holds at most the slot before this one, so the mixer
+      // may fill it outside of the lock
+      auto &slot = slots[produced % NumMixerSlots];
+      busy = true;
+      lock.unlock();
+
+      std::exception_ptr caught;
+      try {
+         const auto len = pMixer->Process(bufferSize);
+         const auto size = SAMPLE_SIZE(format);
+         if (interleaved)
+            memcpy(slot.buffers[0].ptr(), pMixer->GetBuffer(),
+               len * numChannels * size);
+         else
+            for (unsigned ii = 0; ii < numChannels; ++ii)
+               memcpy(slot.buffers[ii].ptr(), pMixer->GetBuffer(ii),
+                  len * size);
+         slot.len = len;
+         slot.time = pMixer->MixGetCurrentTime();
+      }
+      catch (...) {
+         caught = std::current_exception();
+      }
+
+      lock.lock();
+      busy = false;
+      if (caught) {
+         exception = caught;
+         finished = true;
+      }
+      else {
+         ++produced;
+         finished = (slot.len == 0);
+      }
+      condition.notify_all();
+      if (finished)
+         return;
+   }
+}
+
+ThreadedMixer::ThreadedMixer(std::unique_ptr<Mixer> pMixer,
+   unsigned numChannels, size_t bufferSize, bool interleaved,
+   sampleFormat format)
+   : mpState{ std::make_shared<State>() }
+   , mTime{ pMixer->MixGetCurrentTime() }
+{
+   auto &state = *mpState;
+   state.pMixer = std::move(pMixer);
+   state.numChannels = numChannels;
+   state.bufferSize = bufferSize;
+   state.interleaved = interleaved;
+   state.format = format;
+   for (auto &slot : state.slots) {
+      if (interleaved) {
+         slot.buffers.reinit(1);
+         slot.buffers[0].Allocate(bufferSize * numChannels, format);
+      }
+      else {
+         slot.buffers.reinit(numChannels);
+         for (unsigned ii = 0; ii < numChannels; ++ii)
+            slot.buffers[ii].Allocate(bufferSize, format);
+      }
+   }
+
+   // Encoders of a multiple export are tasks of the shared pool, and wait on
+   // their mixers
+   ThreadPool::GetLongRunning().Post([pState = mpState]{ pState->Run(); });
+}
+
+ThreadedMixer::~ThreadedMixer()
+{
+   auto &state = *mpState;
+   std::unique_lock<std::mutex> lock{ state.mutex };
+   state.stopping = true;
+   state.condition.notify_all();
+   // Don't leave the mixer reading tracks after the export returns
+   state.condition.wait(lock, [&]{ return !state.busy; });
+   // The task may outlive this object if it has not yet started, but then it
+   // only finds the stop flag; release the tracks here, not in the pool
+   state.pMixer.reset();
+}
+
+size_t ThreadedMixer::Process()
+{
+   auto &state = *mpState;
+   std::unique_lock<std::mutex> lock{ state.mutex };
+   if (mpCurrent) {
+      mpCurrent = nullptr;
+      ++state.released;
+      state.condition.notify_all();
+   }
+   state.condition.wait(lock, [&]{
+      return state.taken < state.produced || state.finished; });
+   if (state.taken < state.produced) {
+      mpCurrent = &state.slots[state.taken++ % NumMixerSlots];
+      mTime = mpCurrent->time;
+      return mpCurrent->len;
+   }
+   if (state.exception)
+      std::rethrow_exception(state.exception);
+   return 0;
+}
+
+constSamplePtr ThreadedMixer::GetBuffer() const
+{
+   return mpCurrent ? mpCurrent->buffers[0].ptr() : nullptr;
+}
+
+constSamplePtr ThreadedMixer::GetBuffer(int channel) const
+{
+   return mpCurrent ? mpCurrent->buffers[channel].ptr() : nullptr;
+}
+
+double ThreadedMixer::MixGetCurrentTime() const
+{
+   return mTime;
+}
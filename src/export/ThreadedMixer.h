@@ -0,0 +1,71 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file ThreadedMixer.h
+  @brief Mixing for export on a thread of its own
+
+**********************************************************************/
+#ifndef __TENACITY_THREADED_MIXER__
+#define __TENACITY_THREADED_MIXER__
+
+#include <cstddef>
+#include <memory>
+
+// Tenacity libraries
+#include <lib-math/SampleFormat.h>
+
+class Mixer;
+
+//! Runs a Mixer on a thread of its own, a few buffers ahead of an encoder
+/*!
+ An export plug-in that takes mixed buffers from this object, instead of
+ calling Mixer::Process() itself, encodes one buffer while the next is mixed,
+ so that the time for the export approaches the greater, not the sum, of the
+ mixing and the encoding times.
+
+ Each buffer is copied out of the mixer into one of a small ring of slots,
+ and the mixer waits when all of them are full.  Destroying this object
+ stops the mixing, as when the user cancels.
+ */
+class TENACITY_DLL_API ThreadedMixer final
+{
+public:
+   //! Start mixing
+   /*!
+    @param pMixer made with the other arguments, as by ExportPlugin::CreateMixer
+    */
+   ThreadedMixer(std::unique_ptr<Mixer> pMixer, unsigned numChannels,
+      size_t bufferSize, bool interleaved, sampleFormat format);
+   ThreadedMixer(const ThreadedMixer&) = delete;
+   ThreadedMixer &operator=(const ThreadedMixer&) = delete;
+   ~ThreadedMixer();
+
+   //! Wait for the next buffer, as mixed by Mixer::Process(bufferSize)
+   /*!
+    Pointers from the previous GetBuffer() become invalid.
+    @return the number of samples, zero at the end
+    @excsafety{Weak} rethrows an exception from mixing, after the buffers
+    mixed before it
+    */
+   size_t Process();
+
+   //! The current buffer, if interleaved
+   constSamplePtr GetBuffer() const;
+   //! The current buffer of one channel, if not interleaved
+   constSamplePtr GetBuffer(int channel) const;
+
+   //! The mixer's time, as it was after mixing the current buffer
+   double MixGetCurrentTime() const;
+
+   struct State;
+private:
+   struct Slot;
+
+   std::shared_ptr<State> mpState;
+   //! Given to the encoder, not yet to be refilled
+   const Slot *mpCurrent{ nullptr };
+   double mTime{ 0 };
+};
+
+#endif
@@ -451,20 +451,10 @@ std::unique_ptr<ExtImportItem> Importer::CreateDefaultImportItem()
    return new_item;
 }
 
-// returns number of tracks imported
-bool Importer::Import( TenacityProject &project,
-                     const FilePath &fName,
-                     WaveTrackFactory *trackFactory,
-                     TrackHolders &tracks,
-                     Tags *tags,
-                     LabelHolders &labels,
-                     TranslatableString &errorMessage)
+namespace {
+// Returns true, and sets errorMessage, for files that no plugin should try
+bool RefuseFile(const FilePath &fName, TranslatableString &errorMessage)
 {
-   TenacityProject *pProj = &project;
-   auto cleanup = valueRestorer( pProj->mbBusyImporting, true );
-
-   const FileExtension extension{ fName.AfterLast(wxT('.')) };
-
    // Always refuse to import MIDI, even though the FFmpeg plugin pretends to know how (but makes very bad renderings)
 #ifdef USE_MIDI
    // MIDI files must be imported, not opened
@@ -472,7 +462,7 @@ bool Importer::Import( TenacityProject &project,
       errorMessage = XO(
 "\"%s\" \nis a MIDI file, not an audio file. \nTenacity cannot open this type of file for playing, but you can\nedit it by clicking File > Import > MIDI.")
          .Format( fName );
-      return false;
+      return true;
    }
 #endif
 
@@ -481,17 +471,20 @@ bool Importer::Import( TenacityProject &project,
       errorMessage =
          XO("\"%s\" \nis a not an audio file. \nTenacity cannot open this type of file.")
          .Format( fName );
-      return false;
+      return true;
    }
 
-   using ImportPluginPtrs = std::vector< ImportPlugin* >;
+   return false;
+}
+}
+
+auto Importer::OrderPlugins(const FilePath &fName) const -> ImportPluginPtrs
+{
+   const FileExtension extension{ fName.AfterLast(wxT('.')) };
 
    // This list is used to call plugins in correct order
    ImportPluginPtrs importPlugins;
 
-   // This list is used to remember plugins that should have been compatible with the file.
-   ImportPluginPtrs compatiblePlugins;
-
    // Not implemented (yet?)
    wxString mime_type = wxT("*");
 
@@ -603,6 +596,32 @@ bool Importer::Import( TenacityProject &project,
       }
    }
 
+   return importPlugins;
+}
+
+// returns number of tracks imported
+bool Importer::Import( TenacityProject &project,
+                     const FilePath &fName,
+                     WaveTrackFactory *trackFactory,
+                     TrackHolders &tracks,
+                     Tags *tags,
+                     LabelHolders &labels,
+                     TranslatableString &errorMessage)
+{
+   TenacityProject *pProj = &project;
+   auto cleanup = valueRestorer( pProj->mbBusyImporting, true );
+
+   const FileExtension extension{ fName.AfterLast(wxT('.')) };
+
+   if (RefuseFile(fName, errorMessage))
+      return false;
+
+   // This list is used to call plugins in correct order
+   const ImportPluginPtrs importPlugins = OrderPlugins(fName);
+
+   // This list is used to remember plugins that should have been compatible with the file.
+   ImportPluginPtrs compatiblePlugins;
+
    // Try the import plugins, in the permuted sequences just determined
    for (const auto plugin : importPlugins)
    {
@@ -831,6 +850,30 @@ bool Importer::Import( TenacityProject &project,
    return false;
 }
 
+std::unique_ptr<ImportFileHandle> Importer::OpenForConcurrentImport(
+   TenacityProject &project, const FilePath &fName)
+{
+   TranslatableString errorMessage;
+   if (RefuseFile(fName, errorMessage))
+      return nullptr;
+
+   // Take the first plugin that opens the file, as Import() does, but leave
+   // the choice of streams and any fallback to other plugins to Import()
+   for (const auto plugin : OrderPlugins(fName))
+   {
+      auto inFile = plugin->Open(fName, &project);
+      if ( (inFile != NULL) && (inFile->GetStreamCount() > 0) )
+      {
+         if (inFile->GetStreamCount() > 1 ||
+             !inFile->SupportsConcurrentImport())
+            return nullptr;
+         inFile->SetStreamUsage(0,TRUE);
+         return inFile;
+      }
+   }
+   return nullptr;
+}
+
 //-------------------------------------------------------------------------
 // ImportStreamDialog
 //-------------------------------------------------------------------------
@@ -892,3 +935,5 @@ void ImportStreamDialog::OnCancel(wxCommandEvent & /* event */)
 }
 
 BoolSetting NewImportingSession{ L"/NewImportingSession", false };
+
+BoolSetting ConcurrentImport{ L"/FileFormats/ConcurrentImport", true };
@@ -180,7 +180,20 @@ public:
               LabelHolders &labelTracks,
               TranslatableString &errorMessage);
 
+   //! Open a file on the main thread, so that it may be imported on another
+   /*!
+    @return a handle with its one stream chosen, ready for
+    ImportFileHandle::Import(), or null if the file should rather be given to
+    Import() on the main thread, which also explains failures
+    */
+   std::unique_ptr<ImportFileHandle> OpenForConcurrentImport(
+      TenacityProject &project, const FilePath &fName);
+
 private:
+   using ImportPluginPtrs = std::vector< ImportPlugin* >;
+   //! The plugins to try for the file, in order of preference
+   ImportPluginPtrs OrderPlugins(const FilePath &fName) const;
+
    static Importer mInstance;
 
    ExtImportItems mExtImportItems;
@@ -215,4 +228,7 @@ private:
 
 extern TENACITY_DLL_API BoolSetting NewImportingSession;
 
+//! Whether to decode several imported files at once, on worker threads
+extern TENACITY_DLL_API BoolSetting ConcurrentImport;
+
 #endif
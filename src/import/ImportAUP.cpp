@@ -114,8 +114,10 @@ public:
 private:
    struct node
    {
-      wxString parent;
-      wxString tag;
+      // Same type as mParentTag and mCurrentTag, so that pushing and popping
+      // a node for each element does not convert strings
+      std::string parent;
+      std::string tag;
       XMLTagHandler *handler;
    };
    using stack = std::vector<struct node>;
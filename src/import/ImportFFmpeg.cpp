@@ -161,6 +161,7 @@ static const auto exts = {
 #include "../Tags.h"
 #include "../WaveTrack.h"
 #include "ImportPlugin.h"
+#include "ImportPipeline.h"
 
 class FFmpegImportFileHandle;
 
@@ -219,6 +220,7 @@ public:
    ///\return import status (see Import.cpp)
    ProgressResult Import(WaveTrackFactory *trackFactory, TrackHolders &outTracks,
       Tags *tags, LabelHolders &labelTracks) override;
+   bool SupportsConcurrentImport() const override { return true; }
 
    ///! Writes decoded data into WaveTracks.
    ///\param sc - stream context
@@ -280,6 +282,7 @@ private:
                                          //!< First dimension - streams,
                                          //!< After Import(), same size as mStreamContexts;
                                          //!< second - channels of a stream.
+   std::unique_ptr<ImportPipeline> mPipeline; //!< Stores decoded audio; exists only during Import()
 };
 
 
@@ -523,6 +526,9 @@ ProgressResult FFmpegImportFileHandle::Import(WaveTrackFactory *trackFactory,
    // The result of Import() to be returned. It will be something other than zero if user canceled or some error appears.
    auto res = ProgressResult::Success;
 
+   mPipeline = std::make_unique<ImportPipeline>();
+   auto cleanup = finally([&]{ mPipeline.reset(); });
+
    // Read frames.
    for (std::unique_ptr<AVPacketWrapper> packet;
         (packet = mAVFormatContext->ReadNextPacket()) != nullptr &&
@@ -555,6 +561,8 @@ ProgressResult FFmpegImportFileHandle::Import(WaveTrackFactory *trackFactory,
       return res;
    //else if (res == 2), we just stop the decoding as if the file has ended
 
+   mPipeline->Finish();
+
    // Copy audio from mChannels to newly created tracks (destroying mChannels elements in process)
    for (auto &stream : mChannels)
       for(auto &channel : stream)
@@ -601,7 +609,7 @@ ProgressResult FFmpegImportFileHandle::WriteData(StreamContext *sc, const AVPack
       auto iter2 = iter->begin();
       for (size_t chn = 0; chn < nChannels; ++iter2, ++chn)
       {
-         iter2->get()->Append(
+         mPipeline->Append(**iter2,
             reinterpret_cast<samplePtr>(data.data() + chn), sc->SampleFormat,
             samplesPerChannel,
             sc->CodecContext->GetChannels());
@@ -618,7 +626,7 @@ ProgressResult FFmpegImportFileHandle::WriteData(StreamContext *sc, const AVPack
       auto iter2 = iter->begin();
       for (size_t chn = 0; chn < nChannels; ++iter2, ++chn)
       {
-         iter2->get()->Append(
+         mPipeline->Append(**iter2,
             reinterpret_cast<samplePtr>(data.data() + chn), sc->SampleFormat,
             samplesPerChannel, sc->CodecContext->GetChannels());
       }
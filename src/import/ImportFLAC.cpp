@@ -38,6 +38,7 @@
 
 #include "Import.h"
 #include "ImportPlugin.h"
+#include "ImportPipeline.h"
 
 #include "../SelectFile.h"
 #include "../Tags.h"
@@ -145,6 +146,7 @@ public:
    ByteCount GetFileUncompressedBytes() override;
    ProgressResult Import(WaveTrackFactory *trackFactory, TrackHolders &outTracks,
               Tags *tags, LabelHolders &labelTracks) override;
+   bool SupportsConcurrentImport() const override { return true; }
 
    wxInt32 GetStreamCount() override { return 1; }
 
@@ -169,6 +171,8 @@ private:
    bool                  mStreamInfoDone;
    ProgressResult        mUpdateResult;
    NewChannelGroup       mChannels;
+   //! Exists only during Import(), to store frames while the next decodes
+   std::unique_ptr<ImportPipeline> mPipeline;
 };
 
 
@@ -255,12 +259,12 @@ FLAC__StreamDecoderWriteStatus MyFLACFile::write_callback(const FLAC__Frame *fra
                }
             }
 
-            iter->get()->Append((samplePtr)tmp.get(),
+            mFile->mPipeline->Append(**iter, (samplePtr)tmp.get(),
                      int16Sample,
                      frame->header.blocksize);
          }
          else {
-            iter->get()->Append((samplePtr)buffer[chn],
+            mFile->mPipeline->Append(**iter, (samplePtr)buffer[chn],
                      int24Sample,
                      frame->header.blocksize);
          }
@@ -406,9 +410,20 @@ ProgressResult FLACImportFileHandle::Import(WaveTrackFactory *trackFactory,
          *iter = NewWaveTrack(*trackFactory, mFormat, mSampleRate);
    }
 
-   // TODO: Vigilant Sentry: Variable res unused after assignment (error code DA1)
-   //    Should check the result.
-   mFile->process_until_end_of_stream();
+   // In the "edit" mode, the tracks read the samples from the file when they
+   // need them, if libsndfile can also decode it
+   if (!ImportReferences(*trackFactory, mChannels, mUpdateResult)) {
+      mPipeline = std::make_unique<ImportPipeline>();
+      auto cleanup = finally([&]{ mPipeline.reset(); });
+
+      // TODO: Vigilant Sentry: Variable res unused after assignment (error code DA1)
+      //    Should check the result.
+      mFile->process_until_end_of_stream();
+
+      if (mUpdateResult != ProgressResult::Failed &&
+          mUpdateResult != ProgressResult::Cancelled)
+         mPipeline->Finish();
+   }
 
    if (mUpdateResult == ProgressResult::Failed || mUpdateResult == ProgressResult::Cancelled) {
       return mUpdateResult;
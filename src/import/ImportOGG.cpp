@@ -126,6 +126,7 @@ public:
    ByteCount GetFileUncompressedBytes() override;
    ProgressResult Import(WaveTrackFactory *trackFactory, TrackHolders &outTracks,
               Tags *tags, LabelHolders &labelTracks) override;
+   bool SupportsConcurrentImport() const override { return true; }
 
    wxInt32 GetStreamCount() override
    {
@@ -29,6 +29,7 @@
 #include <wx/utils.h>
 #include <wx/intl.h>
 #include <wx/ffile.h>
+#include <wx/file.h>
 #include <wx/sizer.h>
 #include <wx/checkbox.h>
 #include <wx/button.h>
@@ -51,8 +52,18 @@
 #include "../shuttle/ShuttleGui.h"
 #include "../WaveTrack.h"
 #include "ImportPlugin.h"
+#include "ImportPipeline.h"
 
 #include <algorithm>
+#include <cstring>
+
+#if defined(__WXMSW__)
+#include <wx/msw/wrapwin.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #ifdef USE_LIBID3TAG
    #include <id3tag.h>
@@ -85,6 +96,8 @@ public:
 };
 
 
+using NewChannelGroup = std::vector< std::shared_ptr<WaveTrack> >;
+
 class PCMImportFileHandle final : public ImportFileHandle
 {
 public:
@@ -95,6 +108,7 @@ public:
    ByteCount GetFileUncompressedBytes() override;
    ProgressResult Import(WaveTrackFactory *trackFactory, TrackHolders &outTracks,
               Tags *tags, LabelHolders &labelTracks) override;
+   bool SupportsConcurrentImport() const override { return true; }
 
    wxInt32 GetStreamCount() override { return 1; }
 
@@ -108,6 +122,16 @@ public:
    {}
 
 private:
+   //! Append samples from a memory mapping of the file, where its layout allows
+   /*!
+    Returns Success without appending all of the samples if the file is
+    not suitable or its mapping fails, leaving the rest for libsndfile
+    @param framesCompleted counts the frames appended
+    */
+   ProgressResult ImportMapped(ImportPipeline &pipeline,
+      const NewChannelGroup &channels, size_t maxBlock,
+      sampleCount &framesCompleted);
+
    SFFile                mFile;
    const SF_INFO         mInfo;
    sampleFormat          mFormat;
@@ -285,7 +309,351 @@ struct id3_tag_deleter {
 using id3_tag_holder = std::unique_ptr<id3_tag, id3_tag_deleter>;
 #endif
 
-using NewChannelGroup = std::vector< std::shared_ptr<WaveTrack> >;
+namespace {
+
+//! Maps successive read-only windows of a file into memory
+class MappedFile
+{
+public:
+   explicit MappedFile(const FilePath &path);
+   MappedFile(const MappedFile&) = delete;
+   MappedFile &operator=(const MappedFile&) = delete;
+   ~MappedFile();
+
+   wxFile &GetFile() { return mFile; }
+
+   //! Bytes [offset, offset + length) of the file, or null if mapping fails
+   /*! The pointer is good until the next call */
+   const unsigned char *View(wxFileOffset offset, size_t length);
+
+private:
+   // Map more than asked, so most requests reuse the view
+   static constexpr size_t WindowBytes = 64 * 1024 * 1024;
+
+   static wxFileOffset Granularity();
+   void Unmap();
+
+   wxFile mFile;
+   wxFileOffset mLength{ 0 };
+   void *mBase{};
+   wxFileOffset mBaseOffset{ 0 };
+   size_t mBaseLength{ 0 };
+#if defined(__WXMSW__)
+   HANDLE mMapping{};
+#endif
+};
+
+MappedFile::MappedFile(const FilePath &path)
+{
+   if (!mFile.Open(path))
+      return;
+   mLength = mFile.Length();
+#if defined(__WXMSW__)
+   mMapping = CreateFileMapping(
+      reinterpret_cast<HANDLE>(_get_osfhandle(mFile.fd())),
+      nullptr, PAGE_READONLY, 0, 0, nullptr);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+   Unmap();
+#if defined(__WXMSW__)
+   if (mMapping)
+      CloseHandle(mMapping);
+#endif
+}
+
+wxFileOffset MappedFile::Granularity()
+{
+#if defined(__WXMSW__)
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   return info.dwAllocationGranularity;
+#else
+   return sysconf(_SC_PAGESIZE);
+#endif
+}
+
+void MappedFile::Unmap()
+{
+   if (!mBase)
+      return;
+#if defined(__WXMSW__)
+   UnmapViewOfFile(mBase);
+#else
+   munmap(mBase, mBaseLength);
+#endif
+   mBase = nullptr;
+}
+
+const unsigned char *MappedFile::View(wxFileOffset offset, size_t length)
+{
+   const auto end = offset + static_cast<wxFileOffset>(length);
+   if (!(mBase && offset >= mBaseOffset &&
+         end <= mBaseOffset + static_cast<wxFileOffset>(mBaseLength))) {
+      Unmap();
+      if (!mFile.IsOpened() || offset < 0 || end > mLength)
+         return nullptr;
+
+      const auto start = offset - offset % Granularity();
+      const auto viewLength = static_cast<size_t>(std::min(mLength - start,
+         std::max(end - start, static_cast<wxFileOffset>(WindowBytes))));
+#if defined(__WXMSW__)
+      if (!mMapping)
+         return nullptr;
+      mBase = MapViewOfFile(mMapping, FILE_MAP_READ,
+         static_cast<DWORD>(static_cast<wxUint64>(start) >> 32),
+         static_cast<DWORD>(start & 0xFFFFFFFF), viewLength);
+#else
+      auto base = mmap(nullptr, viewLength, PROT_READ, MAP_PRIVATE,
+         mFile.fd(), start);
+      if (base == MAP_FAILED)
+         base = nullptr;
+      else
+         // Let the system read ahead
+         posix_madvise(base, viewLength, POSIX_MADV_SEQUENTIAL);
+      mBase = base;
+#endif
+      if (!mBase)
+         return nullptr;
+      mBaseOffset = start;
+      mBaseLength = viewLength;
+   }
+   return static_cast<const unsigned char *>(mBase) + (offset - mBaseOffset);
+}
+
+//! Where and how the samples of an uncompressed file are stored
+struct SampleLayout
+{
+   wxFileOffset offset{ 0 }; //!< of the first frame
+   wxFileOffset bytes{ 0 };  //!< size of the sample data
+   bool bigEndian{ false };
+   size_t sampleBytes{ 0 };  //!< 2 for 16 bit, 3 for 24, 4 for float
+   //! int16Sample, int24Sample (unpacked to four bytes) or floatSample
+   sampleFormat format{ floatSample };
+};
+
+//! Find the sound data chunk in a WAV, RF64 or AIFF file
+/*! @return false if the file is otherwise, or the samples are not 16 or 24
+ bit integers or 32 bit floats */
+bool FindSampleData(wxFile &file, const SF_INFO &info, SampleLayout &layout)
+{
+   switch (info.format & SF_FORMAT_SUBMASK) {
+   case SF_FORMAT_PCM_16:
+      layout.sampleBytes = 2, layout.format = int16Sample; break;
+   case SF_FORMAT_PCM_24:
+      layout.sampleBytes = 3, layout.format = int24Sample; break;
+   case SF_FORMAT_FLOAT:
+      layout.sampleBytes = 4, layout.format = floatSample; break;
+   default:
+      return false;
+   }
+
+   const auto container = info.format & SF_FORMAT_TYPEMASK;
+   const bool aiff = (container == SF_FORMAT_AIFF);
+   if (!(aiff || container == SF_FORMAT_WAV ||
+         container == SF_FORMAT_WAVEX || container == SF_FORMAT_RF64))
+      return false;
+
+   char header[12];
+   if (file.Seek(0) != 0 || file.Read(header, 12) != 12)
+      return false;
+   // Byte order of chunk sizes, which may differ from that of samples
+   bool bigEndianSizes;
+   bool aifc = false;
+   if (aiff) {
+      if (memcmp(header, "FORM", 4) != 0)
+         return false;
+      aifc = (memcmp(header + 8, "AIFC", 4) == 0);
+      if (!aifc && memcmp(header + 8, "AIFF", 4) != 0)
+         return false;
+      bigEndianSizes = true;
+   }
+   else {
+      if (memcmp(header + 8, "WAVE", 4) != 0)
+         return false;
+      if (memcmp(header, "RIFF", 4) == 0 || memcmp(header, "RF64", 4) == 0)
+         bigEndianSizes = false;
+      else if (memcmp(header, "RIFX", 4) == 0)
+         bigEndianSizes = true;
+      else
+         return false;
+   }
+   layout.bigEndian = bigEndianSizes;
+
+   const auto Size32 = [&](const char *p){
+      wxUint32 value;
+      memcpy(&value, p, 4);
+      return bigEndianSizes
+         ? wxUINT32_SWAP_ON_LE(value) : wxUINT32_SWAP_ON_BE(value);
+   };
+
+   const auto length = file.Length();
+   wxFileOffset rf64DataBytes = 0;
+   // AIFC may put COMM, which gives the byte order of samples, before or
+   // after SSND; the layout is known only when both are found
+   bool foundSound = false;
+   bool foundCompression = !aifc;
+   for (wxFileOffset pos = 12; pos + 8 <= length;) {
+      // The chunk header, and enough of the contents for the fields we need
+      char chunk[8 + 22];
+      if (file.Seek(pos) != pos)
+         return false;
+      const auto got = file.Read(chunk, sizeof(chunk));
+      if (got == wxInvalidOffset || got < 8)
+         return false;
+      const auto available = static_cast<size_t>(got) - 8;
+      const auto data = chunk + 8;
+      const wxFileOffset chunkBytes = Size32(chunk + 4);
+
+      if (!aiff && memcmp(chunk, "ds64", 4) == 0 && available >= 16) {
+         // RF64 puts the true size of the data here
+         wxUint64 value;
+         memcpy(&value, data + 8, 8);
+         rf64DataBytes = wxUINT64_SWAP_ON_BE(value);
+      }
+      else if (aifc && memcmp(chunk, "COMM", 4) == 0 && available >= 22) {
+         // After channels, frames, bits, and the extended float rate
+         if (memcmp(data + 18, "sowt", 4) == 0)
+            layout.bigEndian = false;
+         else if (memcmp(data + 18, "NONE", 4) != 0 &&
+                  memcmp(data + 18, "twos", 4) != 0 &&
+                  memcmp(data + 18, "fl32", 4) != 0 &&
+                  memcmp(data + 18, "FL32", 4) != 0)
+            return false;
+         foundCompression = true;
+         if (foundSound)
+            return true;
+      }
+      else if (aiff && memcmp(chunk, "SSND", 4) == 0 && available >= 8) {
+         const wxFileOffset skip = Size32(data);
+         layout.offset = pos + 16 + skip;
+         layout.bytes = chunkBytes - 8 - skip;
+         foundSound = true;
+         if (foundCompression)
+            return true;
+      }
+      else if (!aiff && memcmp(chunk, "data", 4) == 0) {
+         layout.offset = pos + 8;
+         layout.bytes = (chunkBytes == 0xFFFFFFFF && rf64DataBytes > 0)
+            ? rf64DataBytes : chunkBytes;
+         return true;
+      }
+
+      // Chunks are padded to even lengths
+      pos += 8 + chunkBytes + (chunkBytes & 1);
+   }
+   return false;
+}
+
+//! Copy one channel of interleaved samples in file byte order to dst,
+//! in the byte order of this machine
+/*! Samples of 24 bits become int24Sample, sign-extended to four bytes */
+void Unpack(const unsigned char *src, size_t frameBytes,
+   const SampleLayout &layout, samplePtr dst, size_t len)
+{
+   // Index of the byte of the given significance (0 for least)
+   const auto big = layout.bigEndian;
+   const auto n = layout.sampleBytes;
+   const auto b = [big, n](size_t significance){
+      return big ? n - 1 - significance : significance;
+   };
+   const auto b0 = b(0), b1 = b(1), b2 = b(2), b3 = b(3);
+
+   switch (layout.format) {
+   case int16Sample: {
+      auto d = reinterpret_cast<short *>(dst);
+      for (size_t ii = 0; ii < len; ++ii, src += frameBytes)
+         d[ii] = static_cast<short>(src[b0] | (src[b1] << 8));
+      break;
+   }
+   case int24Sample: {
+      auto d = reinterpret_cast<int *>(dst);
+      for (size_t ii = 0; ii < len; ++ii, src += frameBytes) {
+         // Shift up and arithmetic shift down to extend the sign
+         const auto value = static_cast<wxUint32>(
+            (src[b0] << 8) | (src[b1] << 16) |
+            (static_cast<wxUint32>(src[b2]) << 24));
+         d[ii] = static_cast<int>(value) >> 8;
+      }
+      break;
+   }
+   default: {
+      auto d = reinterpret_cast<float *>(dst);
+      for (size_t ii = 0; ii < len; ++ii, src += frameBytes) {
+         const auto value = static_cast<wxUint32>(src[b0] | (src[b1] << 8) |
+            (src[b2] << 16) | (static_cast<wxUint32>(src[b3]) << 24));
+         memcpy(&d[ii], &value, 4);
+      }
+      break;
+   }
+   }
+}
+
+}
+
+ProgressResult PCMImportFileHandle::ImportMapped(ImportPipeline &pipeline,
+   const NewChannelGroup &channels, size_t maxBlock,
+   sampleCount &framesCompleted)
+{
+   MappedFile file{ mFilename };
+   SampleLayout layout;
+   if (!file.GetFile().IsOpened() || !FindSampleData(file.GetFile(), mInfo, layout))
+      return ProgressResult::Success;
+
+   // Believe libsndfile's count of frames, but only if the data are all there
+   const auto nChannels = static_cast<size_t>(mInfo.channels);
+   const auto frameBytes = nChannels * layout.sampleBytes;
+   const auto totalFrames = static_cast<wxFileOffset>(mInfo.frames);
+   if (layout.offset < 0 ||
+       totalFrames > layout.bytes / static_cast<wxFileOffset>(frameBytes) ||
+       layout.offset + totalFrames * static_cast<wxFileOffset>(frameBytes) >
+          file.GetFile().Length())
+      return ProgressResult::Success;
+
+   // Samples in the byte order and width of this machine, and aligned, can
+   // go to the tracks with no conversion here
+   const bool direct = layout.format != int24Sample &&
+      layout.bigEndian == (wxBYTE_ORDER == wxBIG_ENDIAN) &&
+      layout.offset % layout.sampleBytes == 0;
+   SampleBuffer scratch;
+   if (!direct)
+      scratch.Allocate(maxBlock, layout.format);
+
+   while (framesCompleted < totalFrames) {
+      const auto block =
+         limitSampleBufferSize(maxBlock, totalFrames - framesCompleted);
+      const auto bytes = file.View(
+         layout.offset + framesCompleted.as_long_long() * frameBytes,
+         block * frameBytes);
+      if (!bytes) {
+         wxLogDebug(wxT("Mapping of %s failed at frame %lld"),
+            mFilename, framesCompleted.as_long_long());
+         return ProgressResult::Success;
+      }
+
+      auto iter = channels.begin();
+      for (size_t c = 0; c < nChannels; ++iter, ++c) {
+         const auto src = bytes + c * layout.sampleBytes;
+         if (direct)
+            // The pipeline's copy deinterleaves
+            pipeline.Append(**iter, reinterpret_cast<constSamplePtr>(src),
+               layout.format, block, nChannels);
+         else {
+            Unpack(src, frameBytes, layout, scratch.ptr(), block);
+            pipeline.Append(**iter, scratch.ptr(), layout.format, block);
+         }
+      }
+      framesCompleted += block;
+
+      const auto result = mProgress->Update(
+         framesCompleted.as_long_long(), static_cast<long long>(totalFrames));
+      if (result != ProgressResult::Success)
+         return result;
+   }
+   return ProgressResult::Success;
+}
 
 ProgressResult PCMImportFileHandle::Import(WaveTrackFactory *trackFactory,
                                 TrackHolders &outTracks,
@@ -312,6 +680,9 @@ ProgressResult PCMImportFileHandle::Import(WaveTrackFactory *trackFactory,
    auto maxBlockSize = channels.begin()->get()->GetMaxBlockSize();
    auto updateResult = ProgressResult::Cancelled;
 
+   // In the "edit" mode, the tracks read the samples from the file when they
+   // need them
+   if (!ImportReferences(*trackFactory, channels, updateResult))
    {
       // Otherwise, we're in the "copy" mode, where we read in the actual
       // samples from the file and store our own local copy of the
@@ -328,10 +699,9 @@ ProgressResult PCMImportFileHandle::Import(WaveTrackFactory *trackFactory,
       if (maxBlock < 1)
          return ProgressResult::Failed;
 
-      SampleBuffer srcbuffer, buffer;
+      SampleBuffer srcbuffer;
       wxASSERT(mInfo.channels >= 0);
-      while (NULL == srcbuffer.Allocate(maxBlock * mInfo.channels, mFormat).ptr() ||
-             NULL == buffer.Allocate(maxBlock, mFormat).ptr())
+      while (NULL == srcbuffer.Allocate(maxBlock * mInfo.channels, mFormat).ptr())
       {
          maxBlock /= 2;
          if (maxBlock < 1)
@@ -340,8 +710,23 @@ ProgressResult PCMImportFileHandle::Import(WaveTrackFactory *trackFactory,
 
       decltype(fileTotalFrames) framescompleted = 0;
 
-      long block;
-      do {
+      // Read the next block while the writer stores this one
+      ImportPipeline pipeline;
+
+      // Take the samples straight from the file where its layout allows,
+      // and let libsndfile do the rest
+      updateResult =
+         ImportMapped(pipeline, channels, maxBlock, framescompleted);
+      if (updateResult == ProgressResult::Success &&
+          framescompleted > 0 && framescompleted < fileTotalFrames &&
+          SFCall<sf_count_t>(sf_seek, mFile.get(),
+             framescompleted.as_long_long(), SEEK_SET) < 0)
+         updateResult = ProgressResult::Failed;
+
+      long block = (updateResult == ProgressResult::Success &&
+         (framescompleted == 0 || framescompleted < fileTotalFrames))
+            ? maxBlock : 0;
+      while (block > 0) {
          block = maxBlock;
 
          if (mFormat == int16Sample)
@@ -358,18 +743,12 @@ ProgressResult PCMImportFileHandle::Import(WaveTrackFactory *trackFactory,
          if (block) {
             auto iter = channels.begin();
             for(int c=0; c<mInfo.channels; ++iter, ++c) {
-               if (mFormat==int16Sample) {
-                  for(int j=0; j<block; j++)
-                     ((short *)buffer.ptr())[j] =
-                        ((short *)srcbuffer.ptr())[mInfo.channels*j+c];
-               }
-               else {
-                  for(int j=0; j<block; j++)
-                     ((float *)buffer.ptr())[j] =
-                        ((float *)srcbuffer.ptr())[mInfo.channels*j+c];
-               }
-
-               iter->get()->Append(buffer.ptr(), (mFormat == int16Sample)?int16Sample:floatSample, block);
+               // The pipeline's copy deinterleaves
+               const auto format =
+                  (mFormat == int16Sample) ? int16Sample : floatSample;
+               pipeline.Append(**iter,
+                  srcbuffer.ptr() + c * SAMPLE_SIZE(format), format, block,
+                  mInfo.channels);
             }
             framescompleted += block;
          }
@@ -380,8 +759,11 @@ ProgressResult PCMImportFileHandle::Import(WaveTrackFactory *trackFactory,
          );
          if (updateResult != ProgressResult::Success)
             break;
+      }
 
-      } while (block > 0);
+      if (updateResult != ProgressResult::Failed &&
+          updateResult != ProgressResult::Cancelled)
+         pipeline.Finish();
    }
 
    if (updateResult == ProgressResult::Failed || updateResult == ProgressResult::Cancelled) {
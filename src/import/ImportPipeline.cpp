@@ -0,0 +1,166 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file ImportPipeline.cpp
+
+**********************************************************************/
+#include "ImportPipeline.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include <lib-math/Dither.h>
+#include <lib-utility/ThreadPool.h>
+
+#include "../WaveTrack.h"
+
+namespace {
+
+// Enough for several blocks of each of a few channels
+constexpr size_t MaxQueuedBytes = 16 * 1024 * 1024;
+
+}
+
+struct ImportPipeline::State
+{
+   struct Item {
+      WaveTrack *pTrack{};
+      SampleBuffer buffer;
+      size_t capacity{ 0 }; //!< in bytes
+      size_t bytes{ 0 };
+      sampleFormat format{ floatSample };
+      size_t len{ 0 };
+   };
+
+   void Run();
+
+   std::mutex mutex;
+   std::condition_variable condition;
+   std::deque<Item> queue;
+   //! Buffers already appended, kept to save reallocations
+   std::vector<Item> spare;
+   size_t queuedBytes{ 0 };
+   std::exception_ptr exception;
+   //! The writer is in the middle of an append
+   bool busy{ false };
+   bool stopping{ false };
+};
+
+void ImportPipeline::State::Run()
+{
+   std::unique_lock<std::mutex> lock{ mutex };
+   while (true) {
+      condition.wait(lock, [this]{ return stopping || !queue.empty(); });
+      if (stopping)
+         return;
+
+      auto item = std::move(queue.front());
+      queue.pop_front();
+      busy = true;
+      lock.unlock();
+
+      std::exception_ptr caught;
+      try {
+         item.pTrack->Append(item.buffer.ptr(), item.format, item.len);
+      }
+      catch (...) {
+         caught = std::current_exception();
+      }
+
+      lock.lock();
+      busy = false;
+      queuedBytes -= item.bytes;
+      item.pTrack = nullptr;
+      spare.push_back(std::move(item));
+      if (caught) {
+         // Remaining samples would leave a gap in the track; drop them all,
+         // and let the decoder find out at its next call
+         exception = caught;
+         stopping = true;
+         queue.clear();
+         queuedBytes = 0;
+      }
+      condition.notify_all();
+   }
+}
+
+ImportPipeline::ImportPipeline()
+   : mpState{ std::make_shared<State>() }
+{
+   // Writers wait on their decoders, which may be tasks of the shared pool
+   ThreadPool::GetLongRunning().Post([pState = mpState]{ pState->Run(); });
+}
+
+ImportPipeline::~ImportPipeline()
+{
+   auto &state = *mpState;
+   std::unique_lock<std::mutex> lock{ state.mutex };
+   state.stopping = true;
+   state.queue.clear();
+   state.condition.notify_all();
+   // Don't let the caller destroy a track while it is being appended;
+   // the writer may outlive this object if it has not yet started, but then
+   // it only finds the stop flag in the shared state
+   state.condition.wait(lock, [&]{ return !state.busy; });
+}
+
+void ImportPipeline::Append(WaveTrack &track, constSamplePtr buffer,
+   sampleFormat format, size_t len, unsigned int stride)
+{
+   if (len == 0)
+      return;
+
+   auto &state = *mpState;
+   const auto bytes = len * SAMPLE_SIZE(format);
+
+   State::Item item;
+   {
+      std::unique_lock<std::mutex> lock{ state.mutex };
+      // A single buffer larger than the limit still goes when the queue
+      // empties
+      state.condition.wait(lock, [&]{
+         return state.exception || state.queue.empty() ||
+            state.queuedBytes + bytes <= MaxQueuedBytes;
+      });
+      if (state.exception)
+         std::rethrow_exception(state.exception);
+      if (!state.spare.empty()) {
+         item = std::move(state.spare.back());
+         state.spare.pop_back();
+      }
+   }
+
+   // Copy outside of the lock, so the writer can proceed
+   if (item.capacity < bytes) {
+      item.buffer.Allocate(len, format);
+      item.capacity = bytes;
+   }
+   CopySamples(buffer, format, item.buffer.ptr(), format, len,
+      DitherType::none, stride);
+   item.pTrack = &track;
+   item.bytes = bytes;
+   item.format = format;
+   item.len = len;
+
+   {
+      std::lock_guard<std::mutex> lock{ state.mutex };
+      state.queuedBytes += bytes;
+      state.queue.push_back(std::move(item));
+   }
+   state.condition.notify_all();
+}
+
+void ImportPipeline::Finish()
+{
+   auto &state = *mpState;
+   std::unique_lock<std::mutex> lock{ state.mutex };
+   state.condition.wait(lock, [&]{
+      return state.exception || (state.queue.empty() && !state.busy);
+   });
+   if (state.exception)
+      std::rethrow_exception(state.exception);
+}
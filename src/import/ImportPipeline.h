@@ -0,0 +1,60 @@
+/**********************************************************************
+
+  Tenacity
+
+  @file ImportPipeline.h
+  @brief Overlaps the decoding of imported audio with the storing of it
+
+**********************************************************************/
+#ifndef __TENACITY_IMPORT_PIPELINE__
+#define __TENACITY_IMPORT_PIPELINE__
+
+#include <cstddef>
+#include <memory>
+
+#include <lib-math/SampleFormat.h>
+
+class WaveTrack;
+
+//! Passes decoded samples to WaveTrack::Append on a second thread
+/*!
+ Appending may block on the creation of sample blocks and on database
+ inserts.  An importer that appends through this object may decode its next
+ buffer meanwhile, so that the time for the import approaches the greater,
+ not the sum, of decoding time and storage time.
+
+ The decoder may run ahead of the writer by only a bounded number of bytes.
+
+ Each call to Append copies the samples, so the importer may reuse its
+ buffer at once.  Appends to each track happen in the order of the calls.
+
+ The importer must call Finish() before it calls WaveTrack::Flush or
+ otherwise examines the tracks.  Destroying the pipeline without Finish()
+ discards the samples not yet appended, as when the user cancels.
+ */
+class TENACITY_DLL_API ImportPipeline final
+{
+public:
+   ImportPipeline();
+   ImportPipeline(const ImportPipeline&) = delete;
+   ImportPipeline &operator=(const ImportPipeline&) = delete;
+   ~ImportPipeline();
+
+   //! Queue a copy of the samples, waiting first if too much is queued
+   /*!
+    @param stride as for WaveTrack::Append; the copy is contiguous
+    @excsafety{Weak} rethrows the first exception from an earlier append
+    */
+   void Append(WaveTrack &track, constSamplePtr buffer, sampleFormat format,
+      size_t len, unsigned int stride = 1);
+
+   //! Wait until all queued samples are appended
+   /*! @excsafety{Weak} rethrows the first exception from any append */
+   void Finish();
+
+   struct State;
+private:
+   std::shared_ptr<State> mpState;
+};
+
+#endif
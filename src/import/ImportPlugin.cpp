@@ -11,6 +11,10 @@ Paul Licameli split from Import.cpp
 #include "ImportPlugin.h"
 
 #include <wx/filename.h>
+#include "../FileFormats.h"
+#include "../ReferencedAudioFile.h"
+#include "../SampleBlock.h"
+#include "../WaveClip.h"
 #include "../WaveTrack.h"
 #include "../widgets/ProgressDialog.h"
 #include "QualitySettings.h"
@@ -33,6 +37,23 @@ bool ImportPlugin::SupportsExtension(const FileExtension &extension)
    return mExtensions.Index(extension, false) != wxNOT_FOUND;
 }
 
+namespace {
+struct DialogImportProgress final : ImportProgress
+{
+   DialogImportProgress(
+      const TranslatableString &title, const TranslatableString &message)
+      : mDialog{ title, message }
+   {}
+
+   ProgressResult Update(double fraction) override
+   {
+      return mDialog.Update(fraction);
+   }
+
+   ProgressDialog mDialog;
+};
+}
+
 ImportFileHandle::ImportFileHandle(const FilePath & filename)
 :  mFilename(filename)
 {
@@ -44,11 +65,25 @@ ImportFileHandle::~ImportFileHandle()
 
 void ImportFileHandle::CreateProgress()
 {
+   if (mProgress)
+      return;
+
    wxFileName ff( mFilename );
 
    auto title = XO("Importing %s").Format( GetFileDescription() );
-   mProgress = std::make_unique< ProgressDialog >(
+   mpDialogProgress = std::make_unique< DialogImportProgress >(
       title, Verbatim( ff.GetFullName() ) );
+   mProgress = mpDialogProgress.get();
+}
+
+void ImportFileHandle::SetProgress(ImportProgress &progress)
+{
+   mProgress = &progress;
+}
+
+bool ImportFileHandle::SupportsConcurrentImport() const
+{
+   return false;
 }
 
 sampleFormat ImportFileHandle::ChooseFormat(sampleFormat effectiveFormat)
@@ -69,5 +104,70 @@ sampleFormat ImportFileHandle::ChooseFormat(sampleFormat effectiveFormat)
 std::shared_ptr<WaveTrack> ImportFileHandle::NewWaveTrack(
    WaveTrackFactory &trackFactory, sampleFormat effectiveFormat, double rate)
 {
-   return trackFactory.NewWaveTrack(ChooseFormat(effectiveFormat), rate);
+   std::shared_ptr<WaveTrack> result;
+   // Both the choice of format and the default track name read preferences,
+   // which is not safe in other threads
+   const auto make = [&]{
+      result = trackFactory.NewWaveTrack(ChooseFormat(effectiveFormat), rate);
+   };
+   if (mProgress)
+      mProgress->OnMainThread(make);
+   else
+      make();
+   return result;
+}
+
+bool ImportFileHandle::ImportReferences( WaveTrackFactory &trackFactory,
+   const std::vector< std::shared_ptr<WaveTrack> > &channels,
+   ProgressResult &result)
+{
+   // The preference is not safe to read in other threads
+   bool edit = false;
+   const auto read = [&]{
+      edit = (FileFormatsCopyOrEditSetting.Read() == wxT("edit"));
+   };
+   if (mProgress)
+      mProgress->OnMainThread(read);
+   else
+      read();
+   if (!edit || channels.empty())
+      return false;
+
+   const auto pFile = ReferencedAudioFile::Open(mFilename);
+   if (!pFile || pFile->GetChannels() != channels.size())
+      return false;
+
+   auto &factory = *trackFactory.GetSampleBlockFactory();
+   const auto totalFrames = pFile->GetFrames();
+   const auto maxBlockSize = channels[0]->GetMaxBlockSize();
+   result = ProgressResult::Success;
+   std::vector<std::shared_ptr<SampleBlock>> blocks(channels.size());
+   for (sampleCount start = 0; start < totalFrames;) {
+      const auto len = limitSampleBufferSize(maxBlockSize, totalFrames - start);
+      // Make the blocks of all channels before appending any
+      for (size_t channel = 0; channel < channels.size(); ++channel) {
+         blocks[channel] = factory.CreateReference(pFile, channel, start, len,
+            channels[channel]->GetSampleFormat());
+         if (!blocks[channel]) {
+            // The default factory can't make references; copy instead, into
+            // empty tracks
+            if (start > 0)
+               for (const auto &pTrack : channels)
+                  pTrack->Clear(pTrack->GetStartTime(), pTrack->GetEndTime());
+            return false;
+         }
+      }
+      for (size_t channel = 0; channel < channels.size(); ++channel)
+         channels[channel]->RightmostOrNewClip()
+            ->AppendSharedBlock(blocks[channel]);
+      start += len;
+
+      if (mProgress) {
+         result = mProgress->Update(start.as_long_long(),
+            totalFrames.as_long_long());
+         if (result != ProgressResult::Success)
+            break;
+      }
+   }
+   return true;
 }
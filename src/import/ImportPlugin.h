@@ -45,6 +45,7 @@ but little else.
 #ifndef __AUDACITY_IMPORTER__
 #define __AUDACITY_IMPORTER__
 
+#include <functional>
 #include <memory>
 
 // Tenacity libraries
@@ -53,9 +54,9 @@ but little else.
 #include <lib-strings/Internat.h>
 #include <lib-strings/wxArrayStringEx.h>
 
+#include "../TaskBatch.h"
+
 class TenacityProject;
-class ProgressDialog;
-namespace GenericUI{ enum class ProgressResult : unsigned; }
 class WaveTrackFactory;
 class Track;
 class Tags;
@@ -106,6 +107,11 @@ protected:
 class WaveTrack;
 using TrackHolders = std::vector< std::vector< std::shared_ptr<WaveTrack> > >;
 
+//! Where the loop of ImportFileHandle::Import() reports its progress
+/*! Usually a progress dialog, but when several files are imported
+ concurrently, a share of one dialog polled by the main thread */
+using ImportProgress = TaskProgress;
+
 class TENACITY_DLL_API ImportFileHandle /* not final */
 {
 public:
@@ -116,9 +122,20 @@ public:
    virtual ~ImportFileHandle();
 
    // The importer should call this to create the progress dialog and
-   // identify the filename being imported.
+   // identify the filename being imported.  It does nothing if
+   // SetProgress() was called first.
    void CreateProgress();
 
+   //! Substitute for the dialog that CreateProgress() would make
+   /*! progress must outlive the calls of Import() */
+   void SetProgress(ImportProgress &progress);
+
+   //! Whether Import() may be called in a thread other than the main
+   /*! If so, it must not use the GUI, and it must reach preferences and
+    the project only through the main thread, as NewWaveTrack() does.
+    The default is false. */
+   virtual bool SupportsConcurrentImport() const;
+
    // This is similar to GetPluginFormatDescription, but if possible the
    // importer will return a more specific description of the
    // specific file that is open.
@@ -158,8 +175,23 @@ protected:
    std::shared_ptr<WaveTrack> NewWaveTrack( WaveTrackFactory &trackFactory,
       sampleFormat effectiveFormat, double rate);
 
+   //! Fill new, empty tracks with blocks that read the file only on demand
+   /*!
+    Does nothing and returns false, unless the user prefers to read
+    uncompressed files from their original location, and libsndfile can
+    seek in the file, which has as many channels as there are tracks.
+    Otherwise returns true, and result tells whether all blocks were added.
+    */
+   bool ImportReferences( WaveTrackFactory &trackFactory,
+      const std::vector< std::shared_ptr<WaveTrack> > &channels,
+      ProgressResult &result);
+
    FilePath mFilename;
-   std::unique_ptr<ProgressDialog> mProgress;
+   ImportProgress *mProgress{};
+
+private:
+   //! The dialog made by CreateProgress()
+   std::unique_ptr<ImportProgress> mpDialogProgress;
 };
 
 
@@ -39,7 +39,10 @@ const ReservedCommandFlag
       const auto &selectedRegion = ViewInfo::Get( project ).selectedRegion;
       const auto &test = [&]( const LabelTrack *pTrack ){
          const auto &labels = pTrack->GetLabels();
-         return std::any_of( labels.begin(), labels.end(),
+         const auto range = pTrack->FindLabelsIntersecting(
+            selectedRegion.t0(), selectedRegion.t1() );
+         return std::any_of(
+            labels.begin() + range.first, labels.begin() + range.second,
             [&](const LabelStruct &label){
                return
                   label.getT0() >= selectedRegion.t0()
@@ -23,6 +23,11 @@
 // Tenacity libraries
 #include <lib-preferences/Prefs.h>
 
+#include "../FileFormats.h"
+#include "../export/Export.h"
+#include "../export/ExportMultiple.h"
+#include "../export/RenderCache.h"
+#include "../import/Import.h"
 #include "../shuttle/ShuttleGui.h"
 
 ImportExportPrefs::ImportExportPrefs(wxWindow * parent, wxWindowID winid)
@@ -110,6 +115,45 @@ void ImportExportPrefs::PopulateOrExchange(ShuttleGui & S)
    S.SetBorder(2);
    S.StartScroller();
 
+   S.StartStatic(XO("When importing several audio files"));
+   {
+      S.TieCheckBox(XXO("&Decode them in parallel"), ConcurrentImport);
+   }
+   S.EndStatic();
+
+   S.StartStatic(XO("When importing WAV, AIFF and FLAC files"));
+   {
+      // Bug 2692: Place button group in panel so tabbing will work and,
+      // on the Mac, VoiceOver will announce as radio buttons.
+      S.StartPanel();
+      {
+         S.StartRadioButtonGroup(FileFormatsCopyOrEditSetting);
+         {
+            S.TieRadioButton();
+            S.TieRadioButton();
+         }
+         S.EndRadioButtonGroup();
+      }
+      S.EndPanel();
+   }
+   S.EndStatic();
+
+   S.StartStatic(XO("When saving a project that reads other audio files"));
+   {
+      S.StartPanel();
+      {
+         S.StartRadioButtonGroup(FileFormatsSaveWithDependenciesSetting);
+         {
+            S.TieRadioButton();
+            S.TieRadioButton();
+            S.TieRadioButton();
+         }
+         S.EndRadioButtonGroup();
+      }
+      S.EndPanel();
+   }
+   S.EndStatic();
+
    S.StartStatic(XO("When exporting tracks to an audio file"));
    {
       // Bug 2692: Place button group in panel so tabbing will work and,
@@ -132,6 +176,24 @@ void ImportExportPrefs::PopulateOrExchange(ShuttleGui & S)
       S.TieCheckBox(XXO("&Ignore blank space at the beginning"),
                     {wxT("/AudioFiles/SkipSilenceAtBeginning"),
                      false});
+      S.TieCheckBox(
+         XXO("Encode long FLAC and constant bit rate MP3 files in &parallel chunks"),
+         ChunkedEncoding);
+      S.TieCheckBox(
+         XXO("&Reuse the mix of parts unchanged since earlier exports"),
+         RenderCacheEnabled);
+      S.StartMultiColumn(2);
+      {
+         S.TieIntegerTextBox(
+            XXO("Dis&k space for the reused mix (MB):"), RenderCacheSize, 6);
+      }
+      S.EndMultiColumn();
+   }
+   S.EndStatic();
+
+   S.StartStatic(XO("When exporting multiple files"));
+   {
+      S.TieCheckBox(XXO("E&ncode them in parallel"), ConcurrentExport);
    }
    S.EndStatic();
 
@@ -205,6 +205,7 @@ std::vector<UIHandlePtr> LabelTrackView::DetailedHitTest
 bool LabelTrackView::mbGlyphsReady=false;
 
 wxFont LabelTrackView::msFont;
+unsigned LabelTrackView::msFontGeneration = 0;
 
 /// We have several variants of the icons (highlighting).
 /// The icons are draggable, and you can drag one boundary
@@ -264,6 +265,14 @@ void LabelTrackView::ResetFont()
    wxString facename = gPrefs->Read(wxT("/GUI/LabelFontFacename"), wxT(""));
    int size = gPrefs->Read(wxT("/GUI/LabelFontSize"), DefaultFontSize);
    msFont = GetFont(facename, size);
+   ++msFontGeneration;
+}
+
+std::pair<size_t, size_t>
+LabelTrackView::GetLaidOut(const LabelTrack &track) const
+{
+   const size_t size = track.GetNumLabels();
+   return { std::min(mLaidOut.first, size), std::min(mLaidOut.second, size) };
 }
 
 /// ComputeTextPosition is 'smart' about where to display
@@ -426,7 +435,8 @@ void LabelTrackView::ComputeTextPosition(const wxRect & r, int index) const
 /// ComputeLayout determines which row each label
 /// should be placed on, and reserves space for it.
 /// Function assumes that the labels are sorted.
-void LabelTrackView::ComputeLayout(const wxRect & r, const ZoomInfo &zoomInfo) const
+void LabelTrackView::ComputeLayout(
+   const wxRect & r, const ZoomInfo &zoomInfo, int maxWidth) const
 {
    int xUsed[MAX_NUM_ROWS];
 
@@ -459,7 +469,53 @@ void LabelTrackView::ComputeLayout(const wxRect & r, const ZoomInfo &zoomInfo) c
    const auto pTrack = FindLabelTrack();
    const auto &mLabels = pTrack->GetLabels();
 
-   { int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+   // Lay out only the labels that may be on screen, but begin where no
+   // earlier label reaches the screen or the start of any later label, so
+   // that the rows come out the same as if all labels were laid out.
+   // Allow for glyphs overhanging the ends of labels.
+   const int xSlack = 2 * mIconWidth;
+   auto [begin, end] = pTrack->FindLabelsIntersecting(
+      zoomInfo.PositionToTime(r.x - xSlack, r.x),
+      zoomInfo.PositionToTime(r.x + r.width + xSlack, r.x));
+   while (begin > 0) {
+      const int xLimit = std::min(r.x - xSlack, begin < mLabels.size()
+         ? zoomInfo.TimeToPosition(mLabels[begin].getT0(), r.x)
+         : INT_MAX);
+
+      // Does some label end too late?
+      const auto latest = *pTrack->FindLatestEndingBefore(begin);
+      if (zoomInfo.TimeToPosition(mLabels[latest].getT1(), r.x) >= xLimit) {
+         begin = latest;
+         continue;
+      }
+
+      // Does the text of some label starting shortly before reach too far?
+      // (Compare the xUsed values below.)
+      auto wide = begin;
+      for (auto ii = begin; ii-- > 0;) {
+         const auto &labelStruct = mLabels[ii];
+         const int x = zoomInfo.TimeToPosition(labelStruct.getT0(), r.x);
+         if (x + maxWidth + xExtra < xLimit)
+            break;
+         if (x + labelStruct.width + xExtra >= xLimit) {
+            wide = ii;
+            break;
+         }
+      }
+      if (wide < begin) {
+         begin = wide;
+         continue;
+      }
+
+      // Is the first row reserved past the limit?
+      if (bAvoidName && zoomInfo.TimeToPosition(0.0, r.x) + 200 >= xLimit)
+         begin = 0;
+      break;
+   }
+   mLaidOut = { begin, end };
+
+   for (auto i = begin; i < end; ++i) {
+      const auto &labelStruct = mLabels[i];
       const int x = zoomInfo.TimeToPosition(labelStruct.getT0(), r.x);
       const int x1 = zoomInfo.TimeToPosition(labelStruct.getT1(), r.x);
       int y = r.y;
@@ -512,7 +568,7 @@ void LabelTrackView::ComputeLayout(const wxRect & r, const ZoomInfo &zoomInfo) c
          if( xUsed[iRow] < x1 ) xUsed[iRow]=x1;
          ComputeTextPosition( r, i );
       }
-   }}
+   }
 }
 
 /// Draw vertical lines that go exactly through the position
@@ -807,12 +863,16 @@ void LabelTrackView::Draw
 
    wxCoord textWidth, textHeight;
 
-   // Get the text widths.
-   // TODO: Make more efficient by only re-computing when a
-   // text label title changes.
+   // Get the text widths, measuring again only when a
+   // text label title or the font changes.
+   int maxWidth = 0;
    for (const auto &labelStruct : mLabels) {
-      dc.GetTextExtent(labelStruct.title, &textWidth, &textHeight);
-      labelStruct.width = textWidth;
+      if (labelStruct.widthFont != msFontGeneration) {
+         dc.GetTextExtent(labelStruct.title, &textWidth, &textHeight);
+         labelStruct.width = textWidth;
+         labelStruct.widthFont = msFontGeneration;
+      }
+      maxWidth = std::max(maxWidth, labelStruct.width);
    }
 
    // TODO: And this only needs to be done once, but we
@@ -824,7 +884,13 @@ void LabelTrackView::Draw
    mTextHeight = dc.GetFontMetrics().ascent + dc.GetFontMetrics().descent;
    const int yFrameHeight = mTextHeight + TextFramePadding * 2;
 
-   ComputeLayout( r, zoomInfo );
+   ComputeLayout( r, zoomInfo, maxWidth );
+   // Draw only the labels given positions
+   const auto range = GetLaidOut(*pTrack);
+   const auto begin = range.first, end = range.second;
+   const auto laidOut = [&](int index){
+      return index >= 0 && begin <= (size_t)index && (size_t)index < end;
+   };
    dc.SetTextForeground(theTheme.Colour( clrLabelTrackText));
    dc.SetBackgroundMode(wxTRANSPARENT);
    dc.SetBrush(AColor::labelTextNormalBrush);
@@ -835,11 +901,12 @@ void LabelTrackView::Draw
    // so that the correct things overpaint each other.
 
    // Draw vertical lines that show where the end positions are.
-   for (const auto &labelStruct : mLabels)
-      DrawLines( dc, labelStruct, r );
+   for (auto i = begin; i < end; ++i)
+      DrawLines( dc, mLabels[i], r );
 
    // Draw the end glyphs.
-   { int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+   for (int i = begin; i < (int)end; ++i) {
+      const auto &labelStruct = mLabels[i];
       GlyphLeft=0;
       GlyphRight=1;
       if( pHit && i == pHit->mMouseOverLabelLeft )
@@ -847,7 +914,7 @@ void LabelTrackView::Draw
       if( pHit && i == pHit->mMouseOverLabelRight )
          GlyphRight = (pHit->mEdge & 4) ? 7:4;
       DrawGlyphs( dc, labelStruct, r, GlyphLeft, GlyphRight );
-   }}
+   }
 
    auto &project = *artist->parent->GetProject();
 
@@ -858,7 +925,8 @@ void LabelTrackView::Draw
       auto target = dynamic_cast<LabelTextHandle*>(context.target.get());
       highlightTrack = target && target->GetTrack().get() == this;
 #endif
-      int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+      for (int i = begin; i < (int)end; ++i) {
+         const auto &labelStruct = mLabels[i];
          bool highlight = false;
 #ifdef EXPERIMENTAL_TRACK_PANEL_HIGHLIGHTING
          highlight = highlightTrack && target->GetLabelNum() == i;
@@ -883,7 +951,8 @@ void LabelTrackView::Draw
    }
 
    // Draw highlights
-   if ( (mInitialCursorPos != mCurrentCursorPos) && IsValidIndex(mTextEditIndex, project))
+   if ( (mInitialCursorPos != mCurrentCursorPos) &&
+        IsValidIndex(mTextEditIndex, project) && laidOut(mTextEditIndex))
    {
       int xpos1, xpos2;
       CalcHighlightXs(&xpos1, &xpos2);
@@ -892,16 +961,17 @@ void LabelTrackView::Draw
    }
 
    // Draw the text and the label boxes.
-   { int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+   for (int i = begin; i < (int)end; ++i) {
       if(mTextEditIndex == i )
          dc.SetBrush(AColor::labelTextEditBrush);
-      DrawText( dc, labelStruct, r );
+      DrawText( dc, mLabels[i], r );
       if(mTextEditIndex == i )
          dc.SetBrush(AColor::labelTextNormalBrush);
-   }}
+   }
 
    // Draw the cursor, if there is one.
-   if(mInitialCursorPos == mCurrentCursorPos && IsValidIndex(mTextEditIndex, project))
+   if(mInitialCursorPos == mCurrentCursorPos &&
+      IsValidIndex(mTextEditIndex, project) && laidOut(mTextEditIndex))
    {
       const auto &labelStruct = mLabels[mTextEditIndex];
       int xPos = labelStruct.xText;
@@ -1239,7 +1309,10 @@ void LabelTrackView::OverGlyph(
 
    const auto pTrack = &track;
    const auto &mLabels = pTrack->GetLabels();
-   { int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+   // Only the labels laid out on screen can be hit
+   const auto [begin, end] = Get(track).GetLaidOut(track);
+   for (int i = begin; i < (int)end; ++i) {
+      const auto &labelStruct = mLabels[i];
       // give text box better priority for selecting
       // reset selection state
       if (OverTextBox(&labelStruct, x, y))
@@ -1287,7 +1360,7 @@ void LabelTrackView::OverGlyph(
          hit.mMouseOverLabel = i;
          result = 3;
       }
-   }}
+   }
    hit.mEdge = result;
 }
 
@@ -1295,7 +1368,9 @@ int LabelTrackView::OverATextBox( const LabelTrack &track, int xx, int yy )
 {
    const auto pTrack = &track;
    const auto &mLabels = pTrack->GetLabels();
-   for (int nn = (int)mLabels.size(); nn--;) {
+   // Only the labels laid out on screen can be hit
+   const auto [begin, end] = Get(track).GetLaidOut(track);
+   for (int nn = (int)end; nn-- > (int)begin;) {
       const auto &labelStruct = mLabels[nn];
       if ( OverTextBox( &labelStruct, xx, yy ) )
          return nn;
@@ -2099,6 +2174,13 @@ void LabelTrackView::OnLabelAdded( LabelTrackEvent &e )
    const auto &title = e.mTitle;
    const auto pos = e.mPresentPosition;
 
+   // Keep the laid out range on the same labels, and include the new one,
+   // which has no position yet, like any label before the next layout
+   if (pos < (int)mLaidOut.first)
+      ++mLaidOut.first;
+   if (pos <= (int)mLaidOut.second)
+      ++mLaidOut.second;
+
    mInitialCursorPos = mCurrentCursorPos = title.length();
 
    // restoreFocus is -2 e.g. from Nyquist label creation, when we should not
@@ -2120,6 +2202,12 @@ void LabelTrackView::OnLabelDeleted( LabelTrackEvent &e )
 
    auto index = e.mFormerPosition;
 
+   // Keep the laid out range on the same labels
+   if (index < (int)mLaidOut.first)
+      --mLaidOut.first;
+   if (index < (int)mLaidOut.second)
+      --mLaidOut.second;
+
    // IF we've deleted the selected label
    // THEN set no label selected.
    if (mTextEditIndex == index)
@@ -2150,6 +2238,13 @@ void LabelTrackView::OnLabelPermuted( LabelTrackEvent &e )
    };
    fix(mNavigationIndex);
    fix(mTextEditIndex);
+
+   // The moved label keeps its position, so the laid out range must cover
+   // both places
+   mLaidOut.first = std::min<size_t>(
+      mLaidOut.first, std::min(former, present));
+   mLaidOut.second = std::max<size_t>(
+      mLaidOut.second, std::max(former, present) + 1);
 }
 
 void LabelTrackView::OnSelectionChange( LabelTrackEvent &e )
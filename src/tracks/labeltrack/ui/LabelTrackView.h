@@ -13,6 +13,8 @@ Paul Licameli split from class LabelTrack
 
 #include "../../ui/CommonTrackView.h"
 
+#include <utility>
+
 class LabelGlyphHandle;
 class LabelTextHandle;
 class LabelDefaultClickHandle;
@@ -209,7 +211,8 @@ private:
                                                    /// when done editing
 
    void ComputeTextPosition(const wxRect & r, int index) const;
-   void ComputeLayout(const wxRect & r, const ZoomInfo &zoomInfo) const;
+   void ComputeLayout(
+      const wxRect & r, const ZoomInfo &zoomInfo, int maxWidth) const;
    static void DrawLines( wxDC & dc, const LabelStruct &ls, const wxRect & r);
    static void DrawGlyphs( wxDC & dc, const LabelStruct &ls, const wxRect & r,
       int GlyphLeft, int GlyphRight);
@@ -262,6 +265,12 @@ private:
    std::weak_ptr<LabelTextHandle> mTextHandle;
 
    static wxFont msFont;
+   //! Changes with msFont, to invalidate the text widths of labels
+   static unsigned msFontGeneration;
+
+   //! Indices of the labels given positions by the last layout
+   mutable std::pair<size_t, size_t> mLaidOut{ 0, 0 };
+   std::pair<size_t, size_t> GetLaidOut(const LabelTrack &track) const;
 
    // Bug #2571: See explanation in ShowContextMenu()
    int mEditIndex;
@@ -14,6 +14,7 @@
 #include <cmath>
 #include <float.h>
 #include <wx/debug.h>
+#include <lib-math/SampleSummary.h>
 #include "SampleBlock.h"
 #include "SampleCount.h"
 #include "Sequence.h"
@@ -24,33 +25,27 @@ struct MinMaxSumsq
 {
    MinMaxSumsq(const float *pv, int count, int divisor)
    {
+      if (divisor != 256 && divisor != 65536) {
+         // array holds samples
+         const auto stats = GetSampleStats(
+            reinterpret_cast<constSamplePtr>(pv), floatSample,
+            std::max(0, count));
+         min = stats.min, max = stats.max, sumsq = stats.sumsq;
+         return;
+      }
+
       min = FLT_MAX, max = -FLT_MAX, sumsq = 0.0f;
       while (count--) {
+         // array holds triples of min, max, and rms values
          float v;
-         switch (divisor) {
-         default:
-         case 1:
-            // array holds samples
-            v = *pv++;
-            if (v < min)
-               min = v;
-            if (v > max)
-               max = v;
-            sumsq += v * v;
-            break;
-         case 256:
-         case 65536:
-            // array holds triples of min, max, and rms values
-            v = *pv++;
-            if (v < min)
-               min = v;
-            v = *pv++;
-            if (v > max)
-               max = v;
-            v = *pv++;
-            sumsq += v * v;
-            break;
-         }
+         v = *pv++;
+         if (v < min)
+            min = v;
+         v = *pv++;
+         if (v > max)
+            max = v;
+         v = *pv++;
+         sumsq += v * v;
       }
    }
 
@@ -259,3 +254,39 @@ bool GetWaveDisplay(const Sequence &sequence,
 
    return true;
 }
+
+void GetCoarseWaveDisplay(const Sequence &sequence,
+   float *min, float *max, float *rms,
+   size_t len, const sampleCount *where)
+{
+   const auto &blocks = sequence.GetBlockArray();
+   const auto numSamples = sequence.GetNumSamples();
+   const size_t nBlocks = blocks.size();
+
+   for (size_t pixel = 0; pixel < len; ++pixel) {
+      const auto s0 = std::max(sampleCount(0), where[pixel]);
+      const auto s1 = std::min(numSamples, std::max(s0 + 1, where[pixel + 1]));
+      float theMin = 0, theMax = 0, theRms = 0;
+      if (s0 < numSamples) {
+         theMin = FLT_MAX, theMax = -FLT_MAX;
+         double sumsq = 0, count = 0;
+         for (size_t b = sequence.FindBlock(s0);
+              b < nBlocks && blocks[b].start < s1; ++b) {
+            const auto &sb = *blocks[b].sb;
+            const auto results = sb.GetMinMaxRMS(false);
+            const double n = sb.GetSampleCount();
+            theMin = std::min(theMin, results.min);
+            theMax = std::max(theMax, results.max);
+            sumsq += results.RMS * results.RMS * n;
+            count += n;
+         }
+         if (count > 0)
+            theRms = sqrt(sumsq / count);
+         else
+            theMin = theMax = 0;
+      }
+      min[pixel] = theMin;
+      max[pixel] = theMax;
+      rms[pixel] = theRms;
+   }
+}
@@ -26,4 +26,12 @@ bool GetWaveDisplay(const Sequence &sequence,
    float *min, float *max, float *rms,
    size_t len, const sampleCount *where);
 
+// Like GetWaveDisplay, but without reading samples or summaries, using only
+// the totals for whole blocks, which are kept in memory.  Each column gets
+// the extremes of all the blocks it touches, which is a coarse approximation
+// when blocks span many columns.
+void GetCoarseWaveDisplay(const Sequence &sequence,
+   float *min, float *max, float *rms,
+   size_t len, const sampleCount *where);
+
 #endif
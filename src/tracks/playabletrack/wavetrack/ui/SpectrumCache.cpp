@@ -10,7 +10,13 @@
 
 #include "SpectrumCache.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+
+// Tenacity libraries
+#include <lib-utility/ThreadPool.h>
+
 #include "RealFFTf.h"
 #include "SampleTrackCache.h"
 #include "../../../../prefs/SpectrogramSettings.h"
@@ -101,7 +107,8 @@ bool SpecCache::CalculateOneSpectrum
     double offset, double rate, double pixelsPerSecond,
     int lowerBoundX, int upperBoundX,
     const std::vector<float> &gainFactors,
-    float* __restrict scratch, float* __restrict out) const
+    float* __restrict scratch, float* __restrict out,
+    Deferred *pDeferred, int ownBeginX, int ownEndX) const
 {
    bool result = false;
    const bool reassignment =
@@ -283,13 +290,12 @@ bool SpecCache::CalculateOneSpectrum
 
                   // This is non-negative, because bin and correctedX are
                   auto ind = (int)nBins * correctedX + bin;
-#ifdef _OPENMP
-                  // This assignment can race if index reaches into another thread's bins.
-                  // The probability of a race very low, so this carries little overhead,
-                  // about 5% slower vs allowing it to race.
-                  #pragma omp atomic update
-#endif
-                  out[ind] += power;
+                  if (pDeferred &&
+                      (correctedX < ownBeginX || correctedX >= ownEndX))
+                     // Another thread may be adding into that column
+                     pDeferred->emplace_back(ind, power);
+                  else
+                     out[ind] += power;
                }
             }
          }
@@ -368,47 +374,44 @@ void SpecCache::Populate
    if (!autocorrelation)
       ComputeSpectrogramGainFactors(fftLen, rate, frequencyGainSetting, gainFactors);
 
+   auto &pool = ThreadPool::Get();
+
    // Loop over the ranges before and after the copied portion and compute anew.
    // One of the ranges may be empty.
    for (int jj = 0; jj < 2; ++jj) {
       const int lowerBoundX = jj == 0 ? 0 : copyEnd;
       const int upperBoundX = jj == 0 ? copyBegin : numPixels;
 
-#ifdef _OPENMP
-      // Storage for mutable per-thread data.
-      // private clause ensures one copy per thread
-      struct ThreadLocalStorage {
-         ThreadLocalStorage()  { }
-         ~ThreadLocalStorage() { }
-
-         void init(SampleTrackCache &waveTrackCache, size_t scratchSize) {
-            if (!cache) {
-               cache = std::make_unique<SampleTrackCache>(waveTrackCache.GetTrack());
-               scratch.resize(scratchSize);
-            }
-         }
-         std::unique_ptr<SampleTrackCache> cache;
-         std::vector<float> scratch;
-      } tls;
-
-      #pragma omp parallel for private(tls)
-#endif
-      for (auto xx = lowerBoundX; xx < upperBoundX; ++xx)
-      {
-#ifdef _OPENMP
-         tls.init(waveTrackCache, scratchSize);
-         SampleTrackCache& cache = *tls.cache;
-         float* buffer = &tls.scratch[0];
-#else
-         SampleTrackCache& cache = waveTrackCache;
-         float* buffer = &scratch[0];
-#endif
-         CalculateOneSpectrum(
-            settings, cache, xx, numSamples,
-            offset, rate, pixelsPerSecond,
-            lowerBoundX, upperBoundX,
-            gainFactors, buffer, &freq[0]);
-      }
+      // Divide the columns among tasks, a few for each thread, so that the
+      // load balances.  Each task has its own cache of samples and its own
+      // scratch space.
+      const int nColumns = std::max(0, upperBoundX - lowerBoundX);
+      const size_t nTasks =
+         std::min<size_t>(nColumns, 4 * (pool.GetNumThreads() + 1));
+      const auto taskBound = [&](size_t task) {
+         return lowerBoundX + (int)(task * nColumns / nTasks);
+      };
+      std::vector<Deferred> deferred(reassignment ? nTasks : 0);
+
+      pool.ParallelFor(0, nTasks, [&](size_t task) {
+         const int beginX = taskBound(task), endX = taskBound(task + 1);
+         SampleTrackCache cache{ waveTrackCache.GetTrack() };
+         std::vector<float> buffer(scratchSize);
+         const auto pDeferred = reassignment ? &deferred[task] : nullptr;
+         for (auto xx = beginX; xx < endX; ++xx)
+            CalculateOneSpectrum(
+               settings, cache, xx, numSamples,
+               offset, rate, pixelsPerSecond,
+               lowerBoundX, upperBoundX,
+               gainFactors, &buffer[0], &freq[0],
+               pDeferred, beginX, endX);
+      });
+
+      // Add the reassignments that crossed between tasks, in a fixed order,
+      // so that results do not depend on the timing of threads
+      for (const auto &contributions : deferred)
+         for (const auto &pair : contributions)
+            freq[pair.first] += pair.second;
 
       if (reassignment) {
          // Need to look beyond the edges of the range to accumulate more
@@ -444,24 +447,24 @@ void SpecCache::Populate
 
          // Now Convert to dB terms.  Do this only after accumulating
          // power values, which may cross columns with the time correction.
-#ifdef _OPENMP
-         #pragma omp parallel for
-#endif
-         for (xx = lowerBoundX; xx < upperBoundX; ++xx) {
-            float *const results = &freq[nBins * xx];
-            for (size_t ii = 0; ii < nBins; ++ii) {
-               float &power = results[ii];
-               if (power <= 0)
-                  power = -160.0;
-               else
-                  power = 10.0*log10f(power);
-            }
-            if (!gainFactors.empty()) {
-               // Apply a frequency-dependent gain factor
-               for (size_t ii = 0; ii < nBins; ++ii)
-                  results[ii] += gainFactors[ii];
+         pool.ParallelFor(0, nTasks, [&](size_t task) {
+            const int endX = taskBound(task + 1);
+            for (auto xx = taskBound(task); xx < endX; ++xx) {
+               float *const results = &freq[nBins * xx];
+               for (size_t ii = 0; ii < nBins; ++ii) {
+                  float &power = results[ii];
+                  if (power <= 0)
+                     power = -160.0;
+                  else
+                     power = 10.0*log10f(power);
+               }
+               if (!gainFactors.empty()) {
+                  // Apply a frequency-dependent gain factor
+                  for (size_t ii = 0; ii < nBins; ++ii)
+                     results[ii] += gainFactors[ii];
+               }
             }
-         }
+         });
       }
    }
 }
@@ -596,6 +599,7 @@ WaveClipSpectrumCache::WaveClipSpectrumCache()
 
 WaveClipSpectrumCache::~WaveClipSpectrumCache()
 {
+   ClearRecentSpecPxCaches();
 }
 
 static WaveClip::Caches::RegisteredFactory sKeyS{ []( WaveClip& ){
@@ -611,10 +615,66 @@ WaveClipSpectrumCache &WaveClipSpectrumCache::Get( const WaveClip &clip )
 void WaveClipSpectrumCache::MarkChanged()
 {
    ++mDirty;
+   // The recent caches are stale now
+   ClearRecentSpecPxCaches();
 }
 
 void WaveClipSpectrumCache::Invalidate()
 {
    // Invalidate the spectrum display cache
    mSpecCache = std::make_unique<SpecCache>();
+   ClearRecentSpecPxCaches();
+}
+
+namespace {
+// Bytes of the recent pixel caches of all clips
+std::atomic<size_t> sRecentSpecPxBytes{ 0 };
+
+size_t SpecPxCacheBytes(const SpecPxCache &cache)
+{
+   return cache.len * sizeof(float) + cache.where.size() * sizeof(sampleCount);
+}
+}
+
+void WaveClipSpectrumCache::PushSpecPxCache(
+   std::unique_ptr<SpecPxCache> pCache)
+{
+   if (mSpecPxCache && mSpecPxCache->valid) {
+      auto &recent = mRecentSpecPxCaches;
+      const auto bytes = SpecPxCacheBytes(*mSpecPxCache);
+      // Make room among this clip's caches, oldest first; those of other
+      // clips are freed when those clips change or go away
+      while (!recent.empty() && (recent.size() >= MaxRecentSpecPxCaches ||
+             sRecentSpecPxBytes + bytes > MaxRecentSpecPxBytes)) {
+         sRecentSpecPxBytes -= SpecPxCacheBytes(*recent.back());
+         recent.pop_back();
+      }
+      if (sRecentSpecPxBytes + bytes <= MaxRecentSpecPxBytes) {
+         sRecentSpecPxBytes += bytes;
+         recent.insert(recent.begin(), std::move(mSpecPxCache));
+      }
+   }
+   mSpecPxCache = std::move(pCache);
+}
+
+bool WaveClipSpectrumCache::ReuseSpecPxCache(
+   const std::function<bool(const SpecPxCache&)> &pred)
+{
+   auto &recent = mRecentSpecPxCaches;
+   auto iter = std::find_if(recent.begin(), recent.end(),
+      [&](const auto &pCache){ return pred(*pCache); });
+   if (iter == recent.end())
+      return false;
+   auto pCache = std::move(*iter);
+   recent.erase(iter);
+   sRecentSpecPxBytes -= SpecPxCacheBytes(*pCache);
+   PushSpecPxCache(std::move(pCache));
+   return true;
+}
+
+void WaveClipSpectrumCache::ClearRecentSpecPxCaches()
+{
+   for (const auto &pCache : mRecentSpecPxCaches)
+      sRecentSpecPxBytes -= SpecPxCacheBytes(*pCache);
+   mRecentSpecPxCaches.clear();
 }
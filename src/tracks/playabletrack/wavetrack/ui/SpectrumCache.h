@@ -15,6 +15,8 @@ class sampleCount;
 class SpectrogramSettings;
 class SampleTrackCache;
 
+#include <functional>
+#include <utility>
 #include <vector>
 #include "MemoryX.h"
 #include "WaveClip.h" // to inherit WaveClipListener
@@ -42,7 +44,13 @@ public:
    bool Matches(int dirty_, double pixelsPerSecond,
       const SpectrogramSettings &settings, double rate) const;
 
+   // Contributions of reassignment to columns that another thread computes,
+   // as pairs of index into freq and power, to be added afterward
+   using Deferred = std::vector< std::pair<size_t, float> >;
+
    // Calculate one column of the spectrum
+   // If pDeferred is not null, then reassignment adds into out only for
+   // columns in [ownBeginX, ownEndX), and defers the other contributions
    bool CalculateOneSpectrum
       (const SpectrogramSettings &settings,
        SampleTrackCache &waveTrackCache,
@@ -51,7 +59,9 @@ public:
        int lowerBoundX, int upperBoundX,
        const std::vector<float> &gainFactors,
        float* __restrict scratch,
-       float* __restrict out) const;
+       float* __restrict out,
+       Deferred *pDeferred = nullptr,
+       int ownBeginX = 0, int ownEndX = 0) const;
 
    // Grow the cache while preserving the (possibly now invalid!) contents
    void Grow(size_t len_, const SpectrogramSettings& settings,
@@ -99,8 +109,23 @@ public:
    int scaleType;
    int range;
    int gain;
-   int minFreq;
-   int maxFreq;
+   // Not rounded, so that a fractional change of the bounds is noticed
+   double minFreq;
+   double maxFreq;
+
+   // What else determines the values: the dimensions, and the spectrum
+   // data, identified as in SpecCache
+   int width{ 0 };
+   int height{ 0 };
+   int dirty{ -1 };
+   double pps{ -1.0 };
+   int algorithm{ -1 };
+   int windowType{ -1 };
+   size_t windowSize{ 0 };
+   unsigned zeroPaddingFactor{ 0 };
+   int frequencyGain{ -1 };
+   // Sample positions of the columns, and one past the end
+   std::vector<sampleCount> where;
 };
 
 struct WaveClipSpectrumCache final : WaveClipListener
@@ -110,6 +135,12 @@ struct WaveClipSpectrumCache final : WaveClipListener
 
    // Cache of values to colour pixels of Spectrogram - used by TrackArtist
    std::unique_ptr<SpecPxCache> mSpecPxCache;
+   // Caches that were current before, most recent first, so that returning
+   // to a previous zoom, or scrolling, need not colour everything again
+   std::vector<std::unique_ptr<SpecPxCache>> mRecentSpecPxCaches;
+   static constexpr size_t MaxRecentSpecPxCaches = 3;
+   // Limit on the bytes of the recent caches of all clips together
+   static constexpr size_t MaxRecentSpecPxBytes = 64 * 1024 * 1024;
    std::unique_ptr<SpecCache> mSpecCache;
    int mDirty { 0 };
 
@@ -118,6 +149,13 @@ struct WaveClipSpectrumCache final : WaveClipListener
    void MarkChanged() override; // NOFAIL-GUARANTEE
    void Invalidate() override; // NOFAIL-GUARANTEE
 
+   //! Make pCache current, remembering the previous current cache as recent
+   void PushSpecPxCache(std::unique_ptr<SpecPxCache> pCache);
+   //! Make current the first of the recent caches satisfying pred, if any
+   bool ReuseSpecPxCache(
+      const std::function<bool(const SpecPxCache&)> &pred);
+   void ClearRecentSpecPxCaches();
+
    /** Getting high-level data for screen display */
    bool GetSpectrogram(const WaveClip &clip, SampleTrackCache &cache,
                        const float *& spectrogram,
@@ -37,6 +37,8 @@ Paul Licameli split from WaveTrackView.cpp
 #include <wx/dcmemory.h>
 #include <wx/graphics.h>
 
+#include <algorithm>
+
 static WaveTrackSubView::Type sType{
    WaveTrackViewConstants::Spectrum,
    { wxT("Spectrogram"), XXO("&Spectrogram") }
@@ -274,14 +276,11 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
    const double binUnit = rate / (2 * half);
    const float *freq = 0;
    const sampleCount *where = 0;
-   bool updated;
-   {
-      const double pps = averagePixelsPerSample * rate;
-      updated = WaveClipSpectrumCache::Get( *clip ).GetSpectrogram( *clip,
-         waveTrackCache, freq, where,
-         (size_t)mid.width,
-         t0, pps);
-   }
+   const double pps = averagePixelsPerSample * rate;
+   WaveClipSpectrumCache::Get( *clip ).GetSpectrogram( *clip,
+      waveTrackCache, freq, where,
+      (size_t)mid.width,
+      t0, pps);
    auto nBins = settings.NBins();
 
    float minFreq, maxFreq;
@@ -330,35 +329,116 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
 #endif //EXPERIMENTAL_FFT_Y_GRID
 
    auto &clipCache = WaveClipSpectrumCache::Get( *clip );
-   if (!updated && clipCache.mSpecPxCache->valid &&
-      ((int)clipCache.mSpecPxCache->len == mid.height * mid.width)
-      && scaleType == clipCache.mSpecPxCache->scaleType
-      && gain == clipCache.mSpecPxCache->gain
-      && range == clipCache.mSpecPxCache->range
-      && minFreq == clipCache.mSpecPxCache->minFreq
-      && maxFreq == clipCache.mSpecPxCache->maxFreq
+
+   // Whether a pixel cache was coloured from the same spectra in the same
+   // way, though perhaps for other columns
+   const auto sameColoring = [&](const SpecPxCache &cache) {
+      return cache.valid
+         && cache.height == mid.height
+         && cache.dirty == clipCache.mDirty
+         && cache.pps == pps
+         && cache.scaleType == scaleType
+         && cache.gain == gain
+         && cache.range == range
+         && cache.minFreq == minFreq
+         && cache.maxFreq == maxFreq
+         && cache.algorithm == settings.algorithm
+         && cache.windowType == settings.windowType
+         && cache.windowSize == settings.WindowSize()
+         && cache.zeroPaddingFactor == settings.ZeroPaddingFactor()
+         && cache.frequencyGain == settings.frequencyGain
 #ifdef EXPERIMENTAL_FFT_Y_GRID
-   && fftYGrid==fftYGridOld
+         && fftYGrid==fftYGridOld
 #endif //EXPERIMENTAL_FFT_Y_GRID
 #ifdef EXPERIMENTAL_FIND_NOTES
-   && fftFindNotes == artist->fftFindNotesOld
-   && findNotesMinA == artist->findNotesMinAOld
-   && numberOfMaxima == artist->findNotesNOld
-   && findNotesQuantize == artist->findNotesQuantizeOld
+         && fftFindNotes == artist->fftFindNotesOld
+         && findNotesMinA == artist->findNotesMinAOld
+         && numberOfMaxima == artist->findNotesNOld
+         && findNotesQuantize == artist->findNotesQuantizeOld
 #endif
-   ) {
+         ;
+   };
+   // Whether a pixel cache has exactly the columns to draw now
+   const auto sameColumns = [&](const SpecPxCache &cache) {
+      return sameColoring(cache)
+         && cache.width == mid.width
+         && std::equal(where, where + mid.width + 1,
+            cache.where.begin(), cache.where.end());
+   };
+
+   if (sameColumns(*clipCache.mSpecPxCache) ||
+       clipCache.ReuseSpecPxCache(sameColumns)) {
       // Wave clip's spectrum cache is up to date,
-      // and so is the spectrum pixel cache
+      // and so is the spectrum pixel cache, or one that was current before,
+      // as when zooming back to a previous level
    }
    else {
       // Update the spectrum pixel cache
-      clipCache.mSpecPxCache = std::make_unique<SpecPxCache>(mid.width * mid.height);
-      clipCache.mSpecPxCache->valid = true;
-      clipCache.mSpecPxCache->scaleType = scaleType;
-      clipCache.mSpecPxCache->gain = gain;
-      clipCache.mSpecPxCache->range = range;
-      clipCache.mSpecPxCache->minFreq = minFreq;
-      clipCache.mSpecPxCache->maxFreq = maxFreq;
+      auto pNewCache = std::make_unique<SpecPxCache>(mid.width * mid.height);
+      auto &newCache = *pNewCache;
+      newCache.valid = true;
+      newCache.scaleType = scaleType;
+      newCache.gain = gain;
+      newCache.range = range;
+      newCache.minFreq = minFreq;
+      newCache.maxFreq = maxFreq;
+      newCache.width = mid.width;
+      newCache.height = mid.height;
+      newCache.dirty = clipCache.mDirty;
+      newCache.pps = pps;
+      newCache.algorithm = settings.algorithm;
+      newCache.windowType = settings.windowType;
+      newCache.windowSize = settings.WindowSize();
+      newCache.zeroPaddingFactor = settings.ZeroPaddingFactor();
+      newCache.frequencyGain = settings.frequencyGain;
+      newCache.where.assign(where, where + mid.width + 1);
+
+      // When only scrolling, some columns were coloured already, perhaps
+      // shifted; find them in the current or a recent cache and copy them.
+      // Columns are identified by their sample positions, which for the same
+      // pps are the same wherever the scroll position is.
+      int reuseBegin = 0, reuseEnd = 0;
+      {
+         const SpecPxCache *pDonor = nullptr;
+         if (sameColoring(*clipCache.mSpecPxCache))
+            pDonor = clipCache.mSpecPxCache.get();
+         else for (auto &pCache : clipCache.mRecentSpecPxCaches)
+            if (sameColoring(*pCache)) {
+               pDonor = pCache.get();
+               break;
+            }
+         if (pDonor && pDonor->width > 0) {
+            const auto &oldWhere = pDonor->where;
+            // Offset of the donor's columns relative to the new ones
+            int shift = 0;
+            bool found = false;
+            auto iter = std::find(
+               oldWhere.begin(), oldWhere.end() - 1, where[0]);
+            if (iter != oldWhere.end() - 1)
+               shift = iter - oldWhere.begin(), found = true;
+            else {
+               auto iter2 = std::find(where, where + mid.width, oldWhere[0]);
+               if (iter2 != where + mid.width)
+                  shift = -(iter2 - where), found = true;
+            }
+            if (found) {
+               reuseBegin = std::max(0, -shift);
+               reuseEnd = std::min(mid.width, pDonor->width - shift);
+               // Both edges of each column must agree
+               if (reuseEnd <= reuseBegin ||
+                   !std::equal(where + reuseBegin, where + reuseEnd + 1,
+                      oldWhere.begin() + (reuseBegin + shift)))
+                  reuseBegin = reuseEnd = 0;
+               else
+                  std::copy(
+                     pDonor->values.get() + (reuseBegin + shift) * mid.height,
+                     pDonor->values.get() + (reuseEnd + shift) * mid.height,
+                     newCache.values.get() + reuseBegin * mid.height);
+            }
+         }
+      }
+
+      clipCache.PushSpecPxCache(std::move(pNewCache));
 #ifdef EXPERIMENTAL_FIND_NOTES
       artist->fftFindNotesOld = fftFindNotes;
       artist->findNotesMinAOld = findNotesMinA;
@@ -390,6 +470,8 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
 #pragma omp parallel for
 #endif
       for (int xx = 0; xx < mid.width; ++xx) {
+         if (xx >= reuseBegin && xx < reuseEnd)
+            continue;
 #ifdef EXPERIMENTAL_FIND_NOTES
          int maximas = 0;
          const int x0 = nBins * xx;
@@ -10,7 +10,20 @@
 
 #include "WaveformCache.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+
+// Tenacity libraries
+#include <lib-basic-ui/BasicUI.h>
+#include <lib-math/SampleSummary.h>
+#include <lib-utility/ThreadPool.h>
+
 #include "Sequence.h"
 #include "GetWaveDisplay.h"
 #include "WaveClipUtilities.h"
@@ -55,6 +68,165 @@ public:
    std::vector<float> min;
    std::vector<float> max;
    std::vector<float> rms;
+
+   // Columns that are only approximated, until a job computes them
+   size_t pendingBegin{ 0 };
+   size_t pendingEnd{ 0 };
+
+   // Samples in the clip when the columns were computed; later columns may
+   // need recomputation if the clip grew since
+   sampleCount numSamples{ 0 };
+};
+
+struct WaveDisplayJob {
+   // The owner sets cancelled, and the worker sets reading, only while
+   // holding the mutex; so the owner can wait for the piece being read, if
+   // any, and know that no more will be read
+   std::mutex mutex;
+   std::condition_variable condition;
+   std::atomic<bool> cancelled{ false };
+   bool reading{ false };
+   std::atomic<bool> finished{ false };
+
+   // Shares the blocks of the clip's sequence as they were when the job was
+   // started, so that edits in the meantime do not matter.  Reset, holding
+   // the mutex, by the worker when done and by the owner when it dies, so
+   // that the job never holds blocks after the clip is gone.
+   std::unique_ptr<Sequence> pSequence;
+
+   // Columns of the cache to compute
+   size_t begin{ 0 };
+   size_t end{ 0 };
+   std::vector<sampleCount> where;
+   std::vector<float> min;
+   std::vector<float> max;
+   std::vector<float> rms;
+   bool succeeded{ false };
+
+   std::function<void()> onReady;
+};
+
+// Minimum, maximum, and sum of squares of groups of appended samples, at two
+// granularities, like the summaries of sample blocks; the sample values
+// themselves are not kept.  Written by the recording thread, read by the
+// main thread.  When the small groups become too many, adjacent groups are
+// merged, so memory stays bounded however long the recording.
+struct WaveClipWaveformCache::AppendSummary {
+   struct Entry {
+      float min{ FLT_MAX };
+      float max{ -FLT_MAX };
+      double sumsq{ 0 };
+
+      void Fold(const Entry &other)
+      {
+         min = std::min(min, other.min);
+         max = std::max(max, other.max);
+         sumsq += other.sumsq;
+      }
+   };
+   static constexpr size_t Small = 256;
+   static constexpr size_t Ratio = 256;
+   // 1 MB of small groups, about six minutes at 48 kHz before the first merge
+   static constexpr size_t MaxSmallGroups = 1 << 16;
+
+   std::mutex mutex;
+   bool valid{ false };
+   sampleCount start{ 0 }; // first sample summarized
+   sampleCount end{ 0 };   // one past the last
+   size_t groupSize{ Small }; // samples per small group; Small times 2^n
+
+   // deque, not vector, so that growth does not copy hours of summaries
+   std::deque<Entry> small; // complete groups of groupSize samples
+   std::deque<Entry> large; // complete groups of Ratio small groups
+   Entry partialSmall, partialLarge;
+
+   void Reset()
+   {
+      valid = false;
+      start = end = 0;
+      groupSize = Small;
+      small.clear();
+      large.clear();
+      partialSmall = partialLarge = {};
+   }
+
+   size_t PartialCount() const
+   {
+      return ((end - start).as_long_long() % groupSize);
+   }
+
+   // Replace each pair of groups with one group of twice the size; an odd
+   // group left over is not complete any more
+   static void Merge(std::deque<Entry> &groups, Entry &partial)
+   {
+      const auto nPairs = groups.size() / 2;
+      if (groups.size() % 2)
+         partial.Fold(groups.back());
+      for (size_t ii = 0; ii < nPairs; ++ii) {
+         groups[ii] = groups[2 * ii];
+         groups[ii].Fold(groups[2 * ii + 1]);
+      }
+      groups.resize(nPairs);
+   }
+
+   void Add(const float *samples, size_t len)
+   {
+      while (len > 0) {
+         const auto count = PartialCount();
+         const auto n = std::min(len, groupSize - count);
+         auto &entry = partialSmall;
+         for (size_t ii = 0; ii < n; ++ii) {
+            const float value = samples[ii];
+            entry.min = std::min(entry.min, value);
+            entry.max = std::max(entry.max, value);
+            entry.sumsq += value * value;
+         }
+         samples += n, len -= n, end += n;
+         if (count + n == groupSize) {
+            small.push_back(partialSmall);
+            partialLarge.Fold(partialSmall);
+            partialSmall = {};
+            if (small.size() % Ratio == 0) {
+               large.push_back(partialLarge);
+               partialLarge = {};
+            }
+            if (small.size() >= MaxSmallGroups) {
+               // Ratio is even, so the groups merged into partialLarge are
+               // exactly those after the last complete large group
+               Merge(small, partialSmall);
+               Merge(large, partialLarge);
+               groupSize *= 2;
+            }
+         }
+      }
+   }
+
+   // Summarize the small groups [g0, g1), of which the last may be partial;
+   // return also the count of samples
+   std::pair<Entry, size_t> Summarize(size_t g0, size_t g1) const
+   {
+      Entry result;
+      size_t count = 0;
+      const auto nComplete = small.size();
+      if (g1 > nComplete) {
+         const auto partialCount = PartialCount();
+         if (partialCount > 0 && g0 <= nComplete) {
+            result.Fold(partialSmall);
+            count += partialCount;
+         }
+         g1 = nComplete;
+      }
+      auto ii = g0;
+      for (; ii < g1 && ii % Ratio != 0; ++ii)
+         result.Fold(small[ii]);
+      for (; ii + Ratio <= g1; ii += Ratio)
+         result.Fold(large[ii / Ratio]);
+      for (; ii < g1; ++ii)
+         result.Fold(small[ii]);
+      if (g1 > g0)
+         count += (g1 - g0) * groupSize;
+      return { result, count };
+   }
 };
 
 //
@@ -64,8 +236,10 @@ public:
 
 bool WaveClipWaveformCache::GetWaveDisplay(
    const WaveClip &clip, WaveDisplay &display, double t0,
-   double pixelsPerSecond )
+   double pixelsPerSecond, const std::function<void()> &onReady )
 {
+   ApplyJob();
+
    t0 += clip.GetTrimLeft();
 
    const bool allocated = (display.where != 0);
@@ -79,6 +253,8 @@ bool WaveClipWaveformCache::GetWaveDisplay(
    float *max;
    float *rms;
    std::vector<sampleCount> *pWhere;
+   // Whether only some columns of the present cache are updated
+   bool inPlace = false;
 
    if (allocated) {
       // assume ownWhere is filled.
@@ -113,55 +289,104 @@ bool WaveClipWaveformCache::GetWaveDisplay(
          display.max = &mWaveCache->max[0];
          display.rms = &mWaveCache->rms[0];
          display.where = &mWaveCache->where[0];
-         return true;
-      }
 
-      std::unique_ptr<WaveCache> oldCache(std::move(mWaveCache));
-
-      int oldX0 = 0;
-      double correction = 0.0;
-      size_t copyBegin = 0, copyEnd = 0;
-      if (match) {
-         findCorrection(oldCache->where, oldCache->len, numPixels,
-            t0, rate, samplesPerPixel,
-            oldX0, correction);
-         // Remember our first pixel maps to oldX0 in the old cache,
-         // possibly out of bounds.
-         // For what range of pixels can data be copied?
-         copyBegin = std::min<size_t>(numPixels, std::max(0, -oldX0));
-         copyEnd = std::min<size_t>(numPixels, std::max(0,
-            (int)oldCache->len - oldX0
-         ));
+         // ... except for columns of samples appended since, as when
+         // recording; but wait for any job to finish first
+         const auto numSamples = GetNumSamples(clip);
+         if (mpJob || numSamples <= mWaveCache->numSamples)
+            return true;
+
+         auto &where = mWaveCache->where;
+         const auto begin = where.begin();
+         p0 = std::upper_bound(begin + 1, begin + numPixels + 1,
+            mWaveCache->numSamples) - begin - 1;
+         p1 = std::lower_bound(begin, begin + numPixels,
+            numSamples) - begin;
+         mWaveCache->numSamples = numSamples;
+         if (p1 <= p0)
+            return true;
+
+         inPlace = true;
+         min = &mWaveCache->min[0];
+         max = &mWaveCache->max[0];
+         rms = &mWaveCache->rms[0];
+         pWhere = &where;
       }
-      if (!(copyEnd > copyBegin))
-         oldCache.reset(0);
-
-      mWaveCache = std::make_unique<WaveCache>(numPixels, pixelsPerSecond, rate, t0, mDirty);
-      min = &mWaveCache->min[0];
-      max = &mWaveCache->max[0];
-      rms = &mWaveCache->rms[0];
-      pWhere = &mWaveCache->where;
-
-      fillWhere(*pWhere, numPixels, 0.0, correction,
-         t0, rate, samplesPerPixel);
-
-      // The range of pixels we must fetch from the Sequence:
-      p0 = (copyBegin > 0) ? 0 : copyEnd;
-      p1 = (copyEnd >= numPixels) ? copyBegin : numPixels;
-
-      // Optimization: if the old cache is good and overlaps
-      // with the current one, re-use as much of the cache as
-      // possible
-
-      if (oldCache) {
-
-         // Copy what we can from the old cache.
-         const int length = copyEnd - copyBegin;
-         const size_t sizeFloats = length * sizeof(float);
-         const int srcIdx = (int)copyBegin + oldX0;
-         memcpy(&min[copyBegin], &oldCache->min[srcIdx], sizeFloats);
-         memcpy(&max[copyBegin], &oldCache->max[srcIdx], sizeFloats);
-         memcpy(&rms[copyBegin], &oldCache->rms[srcIdx], sizeFloats);
+      else {
+         const auto numSamples = GetNumSamples(clip);
+
+         std::unique_ptr<WaveCache> oldCache(std::move(mWaveCache));
+         CancelJob();
+
+         int oldX0 = 0;
+         double correction = 0.0;
+         size_t copyBegin = 0, copyEnd = 0;
+         if (match) {
+            findCorrection(oldCache->where, oldCache->len, numPixels,
+               t0, rate, samplesPerPixel,
+               oldX0, correction);
+            // Remember our first pixel maps to oldX0 in the old cache,
+            // possibly out of bounds.
+            // For what range of pixels can data be copied?
+            copyBegin = std::min<size_t>(numPixels, std::max(0, -oldX0));
+            copyEnd = std::min<size_t>(numPixels, std::max(0,
+               (int)oldCache->len - oldX0
+            ));
+
+            // Don't copy columns that lacked samples appended since
+            const auto &oldWhere = oldCache->where;
+            const int nComplete = std::upper_bound(
+               oldWhere.begin() + 1, oldWhere.begin() + oldCache->len + 1,
+               oldCache->numSamples) - oldWhere.begin() - 1;
+            copyEnd = std::min<size_t>(copyEnd,
+               std::max(0, nComplete - oldX0));
+
+            // Don't copy approximations that the cancelled job won't correct;
+            // keep the longer of the pieces on either side of them
+            if (oldCache->pendingEnd > oldCache->pendingBegin) {
+               const int pendingBegin = (int)oldCache->pendingBegin - oldX0;
+               const int pendingEnd = (int)oldCache->pendingEnd - oldX0;
+               const int b = std::max((int)copyBegin, pendingBegin);
+               const int e = std::min((int)copyEnd, pendingEnd);
+               if (e > b) {
+                  if (b - (int)copyBegin >= (int)copyEnd - e)
+                     copyEnd = b;
+                  else
+                     copyBegin = e;
+               }
+            }
+         }
+         if (!(copyEnd > copyBegin))
+            oldCache.reset(0);
+
+         mWaveCache = std::make_unique<WaveCache>(numPixels, pixelsPerSecond, rate, t0, mDirty);
+         mWaveCache->numSamples = numSamples;
+         min = &mWaveCache->min[0];
+         max = &mWaveCache->max[0];
+         rms = &mWaveCache->rms[0];
+         pWhere = &mWaveCache->where;
+
+         fillWhere(*pWhere, numPixels, 0.0, correction,
+            t0, rate, samplesPerPixel);
+
+         // The range of pixels we must fetch from the Sequence:
+         p0 = (copyBegin > 0) ? 0 : copyEnd;
+         p1 = (copyEnd >= numPixels) ? copyBegin : numPixels;
+
+         // Optimization: if the old cache is good and overlaps
+         // with the current one, re-use as much of the cache as
+         // possible
+
+         if (oldCache) {
+
+            // Copy what we can from the old cache.
+            const int length = copyEnd - copyBegin;
+            const size_t sizeFloats = length * sizeof(float);
+            const int srcIdx = (int)copyBegin + oldX0;
+            memcpy(&min[copyBegin], &oldCache->min[srcIdx], sizeFloats);
+            memcpy(&max[copyBegin], &oldCache->max[srcIdx], sizeFloats);
+            memcpy(&rms[copyBegin], &oldCache->rms[srcIdx], sizeFloats);
+         }
       }
    }
 
@@ -169,6 +394,9 @@ bool WaveClipWaveformCache::GetWaveDisplay(
       // Cache was not used or did not satisfy the whole request
       std::vector<sampleCount> &where = *pWhere;
 
+      /* handle values summarized as they were appended */
+      p1 = SummarizeAppended(where, min, max, rms, p0, p1);
+
       /* handle values in the append buffer */
 
       const auto sequence = clip.GetSequence();
@@ -198,39 +426,18 @@ bool WaveClipWaveformCache::GetWaveDisplay(
             //wxCriticalSectionLocker locker(mAppendCriticalSection);
 
             if (right > left) {
-               Floats b;
-               const float *pb{};
                // left is nonnegative and at most mAppendBufferLen:
                auto sLeft = left.as_size_t();
                // The difference is at most mAppendBufferLen:
                size_t len = ( right - left ).as_size_t();
 
-               if (seqFormat == floatSample)
-                  pb = &((const float *)appendBuffer.ptr())[sLeft];
-               else {
-                  b.reinit(len);
-                  pb = b.get();
-                  SamplesToFloats(
-                     appendBuffer.ptr() + sLeft * SAMPLE_SIZE(seqFormat),
-                     seqFormat, b.get(), len);
-               }
-
-               float theMax, theMin, sumsq;
-               {
-                  const float val = pb[0];
-                  theMax = theMin = val;
-                  sumsq = val * val;
-               }
-               for(decltype(len) j = 1; j < len; j++) {
-                  const float val = pb[j];
-                  theMax = std::max(theMax, val);
-                  theMin = std::min(theMin, val);
-                  sumsq += val * val;
-               }
+               const auto stats = GetSampleStats(
+                  appendBuffer.ptr() + sLeft * SAMPLE_SIZE(seqFormat),
+                  seqFormat, len);
 
-               min[i] = theMin;
-               max[i] = theMax;
-               rms[i] = (float)sqrt(sumsq / len);
+               min[i] = stats.min;
+               max[i] = stats.max;
+               rms[i] = (float)sqrt(stats.sumsq / len);
 
                didUpdate=true;
             }
@@ -243,7 +450,14 @@ bool WaveClipWaveformCache::GetWaveDisplay(
 
       // Done with append buffer, now fetch the rest of the cache miss
       // from the sequence
-      if (p1 > p0) {
+      if (p1 > p0 && !allocated && !inPlace &&
+          onReady && ThreadPool::Get().GetNumThreads() > 0) {
+         // Show block totals for now, and read the rest in the background
+         GetCoarseWaveDisplay(*sequence,
+            &min[p0], &max[p0], &rms[p0], p1 - p0, &where[p0]);
+         StartJob(clip, p0, p1, onReady);
+      }
+      else if (p1 > p0) {
          if (!::GetWaveDisplay(*sequence, &min[p0],
                                         &max[p0],
                                         &rms[p0],
@@ -268,11 +482,172 @@ bool WaveClipWaveformCache::GetWaveDisplay(
 
 WaveClipWaveformCache::WaveClipWaveformCache()
 : mWaveCache{ std::make_unique<WaveCache>() }
+, mpAppendSummary{ std::make_unique<AppendSummary>() }
 {
 }
 
 WaveClipWaveformCache::~WaveClipWaveformCache()
 {
+   CancelJob();
+   // The database connection of the project might be closed next, so wait
+   // for any piece of the sequence being read now, then release the blocks
+   // here, lest the last references to them go with the job, after the
+   // connection.  Jobs still queued in the pool will read nothing, and are
+   // left to it.
+   for (auto &pJob : mCancelledJobs) {
+      std::unique_lock<std::mutex> lock{ pJob->mutex };
+      pJob->condition.wait(lock, [&]{ return !pJob->reading; });
+      pJob->pSequence.reset();
+   }
+}
+
+sampleCount WaveClipWaveformCache::GetNumSamples(const WaveClip &clip) const
+{
+   auto &summary = *mpAppendSummary;
+   {
+      std::lock_guard<std::mutex> lock{ summary.mutex };
+      if (summary.valid)
+         // The clip is being appended to by another thread; this count is
+         // consistent with the summary
+         return summary.end;
+   }
+   return clip.GetSequence()->GetNumSamples() + clip.GetAppendBufferLen();
+}
+
+size_t WaveClipWaveformCache::SummarizeAppended(
+   const std::vector<sampleCount> &where,
+   float *min, float *max, float *rms, size_t p0, size_t p1)
+{
+   auto &summary = *mpAppendSummary;
+   std::lock_guard<std::mutex> lock{ summary.mutex };
+   if (!summary.valid)
+      return p1;
+
+   // Assign each group of the summary to the column containing its first
+   // sample.  So when zoomed in so far that a column is narrower than a
+   // group, the summary is of no use, and the sequence is read.
+   const auto groupSize = (long long)summary.groupSize;
+   const auto toGroup = [&](sampleCount s) -> size_t {
+      const auto offset = (s - summary.start).as_long_long();
+      return (offset + groupSize - 1) / groupSize;
+   };
+   for (; p1 > p0; --p1) {
+      const auto left = where[p1 - 1], right = where[p1];
+      if (left < summary.start ||
+          (right - left).as_long_long() < groupSize)
+         break;
+      if (left >= summary.end)
+         // Nothing appended there yet
+         continue;
+      const auto result =
+         summary.Summarize(toGroup(left), toGroup(right));
+      const auto count = result.second;
+      if (count == 0)
+         continue;
+      const auto &entry = result.first;
+      const auto ii = p1 - 1;
+      min[ii] = entry.min;
+      max[ii] = entry.max;
+      rms[ii] = (float)sqrt(entry.sumsq / count);
+   }
+   return p1;
+}
+
+void WaveClipWaveformCache::StartJob(const WaveClip &clip,
+   size_t p0, size_t p1, const std::function<void()> &onReady)
+{
+   const auto &sequence = *clip.GetSequence();
+   auto pJob = std::make_shared<WaveDisplayJob>();
+   auto &job = *pJob;
+   job.pSequence =
+      std::make_unique<Sequence>(sequence, sequence.GetFactory());
+   job.begin = p0;
+   job.end = p1;
+   job.where.assign(
+      mWaveCache->where.begin() + p0, mWaveCache->where.begin() + p1 + 1);
+   job.min.resize(p1 - p0);
+   job.max.resize(p1 - p0);
+   job.rms.resize(p1 - p0);
+   job.onReady = onReady;
+
+   mWaveCache->pendingBegin = p0;
+   mWaveCache->pendingEnd = p1;
+   mpJob = pJob;
+
+   ThreadPool::Get().Post([pJob]() mutable {
+      auto &job = *pJob;
+      const auto len = job.end - job.begin;
+      // Work in pieces, so that cancellation takes effect soon
+      static constexpr size_t chunk = 256;
+      bool succeeded = true;
+      for (size_t ii = 0; succeeded && ii < len; ii += chunk) {
+         {
+            std::lock_guard<std::mutex> lock{ job.mutex };
+            if (job.cancelled)
+               break;
+            job.reading = true;
+         }
+         try {
+            succeeded = ::GetWaveDisplay(*job.pSequence,
+               &job.min[ii], &job.max[ii], &job.rms[ii],
+               std::min(chunk, len - ii), &job.where[ii]);
+         }
+         catch (...) {
+            succeeded = false;
+         }
+         {
+            std::lock_guard<std::mutex> lock{ job.mutex };
+            job.reading = false;
+         }
+         job.condition.notify_all();
+      }
+      job.succeeded = succeeded && !job.cancelled;
+      {
+         std::lock_guard<std::mutex> lock{ job.mutex };
+         job.pSequence.reset();
+      }
+      job.finished = true;
+
+      // Move, don't copy, this task's reference into the callback:  the
+      // task is destroyed in this thread, maybe after the callback ran
+      BasicUI::CallAfter([pJob = std::move(pJob)]{
+         if (pJob->succeeded && !pJob->cancelled && pJob->onReady)
+            pJob->onReady();
+      });
+   });
+}
+
+void WaveClipWaveformCache::ApplyJob()
+{
+   mCancelledJobs.erase(
+      std::remove_if(mCancelledJobs.begin(), mCancelledJobs.end(),
+         [](const auto &pJob){ return pJob->finished.load(); }),
+      mCancelledJobs.end());
+
+   if (!mpJob || !mpJob->finished)
+      return;
+
+   auto pJob = std::move(mpJob);
+   auto &cache = *mWaveCache;
+   if (pJob->succeeded) {
+      const auto begin = pJob->begin;
+      std::copy(pJob->min.begin(), pJob->min.end(), &cache.min[begin]);
+      std::copy(pJob->max.begin(), pJob->max.end(), &cache.max[begin]);
+      std::copy(pJob->rms.begin(), pJob->rms.end(), &cache.rms[begin]);
+   }
+   // Else leave the approximations, rather than draw nothing
+   cache.pendingBegin = cache.pendingEnd = 0;
+}
+
+void WaveClipWaveformCache::CancelJob()
+{
+   if (mpJob) {
+      {
+         std::lock_guard<std::mutex> lock{ mpJob->mutex };
+         mpJob->cancelled = true;
+      }
+      mCancelledJobs.push_back(std::move(mpJob));
+   }
 }
 
 static WaveClip::Caches::RegisteredFactory sKeyW{ []( WaveClip& ){
@@ -287,11 +662,68 @@ WaveClipWaveformCache &WaveClipWaveformCache::Get( const WaveClip &clip )
 
 void WaveClipWaveformCache::MarkChanged()
 {
+   {
+      auto &summary = *mpAppendSummary;
+      std::lock_guard<std::mutex> lock{ summary.mutex };
+      summary.Reset();
+   }
    ++mDirty;
 }
 
 void WaveClipWaveformCache::Invalidate()
 {
    // Invalidate wave display cache
+   CancelJob();
    mWaveCache = std::make_unique<WaveCache>();
+   auto &summary = *mpAppendSummary;
+   std::lock_guard<std::mutex> lock{ summary.mutex };
+   summary.Reset();
+}
+
+void WaveClipWaveformCache::MarkFlushed()
+{
+   // The columns computed from the summary remain correct, as the samples
+   // are the same
+   auto &summary = *mpAppendSummary;
+   std::lock_guard<std::mutex> lock{ summary.mutex };
+   summary.Reset();
+}
+
+void WaveClipWaveformCache::MarkAppended(sampleCount start,
+   constSamplePtr buffer, sampleFormat format, size_t len,
+   unsigned int stride)
+{
+   auto &summary = *mpAppendSummary;
+   bool changed = false;
+   {
+      std::lock_guard<std::mutex> lock{ summary.mutex };
+      if (summary.valid && summary.end != start) {
+         // Something else happened to the clip in the meantime
+         summary.Reset();
+         changed = true;
+      }
+      if (!summary.valid) {
+         summary.valid = true;
+         summary.start = summary.end = start;
+      }
+
+      try {
+         // Convert to float in pieces, so no allocation is needed here
+         float floats[1024];
+         const auto size = SAMPLE_SIZE(format) * stride;
+         while (len > 0) {
+            const auto n = std::min(len, std::size(floats));
+            SamplesToFloats(buffer, format, floats, n, stride);
+            summary.Add(floats, n);
+            buffer += n * size, len -= n;
+         }
+      }
+      catch (...) {
+         // Out of memory for the summary; give up on it
+         summary.Reset();
+         changed = true;
+      }
+   }
+   if (changed)
+      ++mDirty;
 }
@@ -13,7 +13,13 @@
 
 #include "WaveClip.h"
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
 class WaveCache;
+struct WaveDisplayJob;
 
 struct WaveClipWaveformCache final : WaveClipListener
 {
@@ -22,19 +28,60 @@ struct WaveClipWaveformCache final : WaveClipListener
 
    // Cache of values for drawing the waveform
    std::unique_ptr<WaveCache> mWaveCache;
-   int mDirty { 0 };
+   //! Atomic, because MarkAppended may increment it in the recording thread
+   std::atomic<int> mDirty { 0 };
 
    static WaveClipWaveformCache &Get( const WaveClip &clip );
 
    void MarkChanged() override; // NOFAIL-GUARANTEE
    void Invalidate() override; // NOFAIL-GUARANTEE
+   //! Summarizes the appended samples, as they come from recording, instead
+   //! of invalidating the cache
+   void MarkAppended(sampleCount start,
+      constSamplePtr buffer, sampleFormat format, size_t len,
+      unsigned int stride) override; // NOFAIL-GUARANTEE
+   //! Discards the summary of appended samples
+   void MarkFlushed() override; // NOFAIL-GUARANTEE
 
    ///Delete the wave cache - force redraw.  Thread-safe
    void Clear();
 
    /** Getting high-level data for screen display */
+   /*! If onReady is not empty, then columns needing reads of the sequence
+    are approximated for now, and computed exactly by a worker thread; then
+    onReady is called in the main thread, so that the display can be redrawn
+    with the next call.  That work is abandoned if the next call asks for
+    other columns. */
    bool GetWaveDisplay(const WaveClip &clip, WaveDisplay &display,
-                       double t0, double pixelsPerSecond);
+                       double t0, double pixelsPerSecond,
+                       const std::function<void()> &onReady = {});
+
+private:
+   struct AppendSummary;
+
+   //! Samples in the clip, including the append buffer
+   sampleCount GetNumSamples(const WaveClip &clip) const;
+
+   //! Fill columns from the right end of [p0, p1) from the summary of
+   //! appended samples, while it covers them; return the new p1
+   size_t SummarizeAppended(const std::vector<sampleCount> &where,
+      float *min, float *max, float *rms, size_t p0, size_t p1);
+
+   void StartJob(const WaveClip &clip, size_t p0, size_t p1,
+      const std::function<void()> &onReady);
+   //! Copy the results of a finished job into the cache
+   void ApplyJob();
+   void CancelJob();
+
+   //! Computing columns of mWaveCache
+   std::shared_ptr<WaveDisplayJob> mpJob;
+   //! Jobs that may still be reading the sequence
+   std::vector<std::shared_ptr<WaveDisplayJob>> mCancelledJobs;
+
+   //! Summary of the samples appended since this was created or the clip
+   //! otherwise changed, so that the growing clip of a recording can be drawn
+   //! without reading the sequence back
+   const std::unique_ptr<AppendSummary> mpAppendSummary;
 };
 
 #endif
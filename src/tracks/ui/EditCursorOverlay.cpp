@@ -76,6 +76,13 @@ std::pair<wxRect, bool> EditCursorOverlay::DoGetRectangle(wxSize size)
    );
 }
 
+wxRect EditCursorOverlay::DoGetNextRectangle(wxSize size)
+{
+   // mNewCursorX was just updated by DoGetRectangle
+   return mNewCursorX == -1
+      ? wxRect()
+      : wxRect(mNewCursorX, 0, 1, size.GetHeight());
+}
 
 void EditCursorOverlay::Draw(OverlayPanel &panel, wxDC &dc)
 {
@@ -28,6 +28,7 @@ public:
 private:
    unsigned SequenceNumber() const override;
    std::pair<wxRect, bool> DoGetRectangle(wxSize size) override;
+   wxRect DoGetNextRectangle(wxSize size) override;
    void Draw(OverlayPanel &panel, wxDC &dc) override;
 
    TenacityProject *mProject;
@@ -56,9 +56,9 @@ unsigned PlayIndicatorOverlayBase::SequenceNumber() const
    return 10;
 }
 
-std::pair<wxRect, bool> PlayIndicatorOverlayBase::DoGetRectangle(wxSize size)
+wxRect PlayIndicatorOverlayBase::IndicatorRectangle(int xx, wxSize size)
 {
-   wxCoord width = 1, xx = mLastIndicatorX;
+   wxCoord width = 1;
 
    if ( !mIsMaster ) {
       auto &ruler = AdornedRulerPanel::Get( *mProject );
@@ -70,14 +70,23 @@ std::pair<wxRect, bool> PlayIndicatorOverlayBase::DoGetRectangle(wxSize size)
    }
 
    // May be excessive height, but little matter
-   wxRect rect( xx, 0, width, size.GetHeight());
+   return { xx, 0, width, size.GetHeight() };
+}
+
+std::pair<wxRect, bool> PlayIndicatorOverlayBase::DoGetRectangle(wxSize size)
+{
    return {
-      rect,
+      IndicatorRectangle(mLastIndicatorX, size),
       (mLastIndicatorX != mNewIndicatorX
        || mLastIsCapturing != mNewIsCapturing)
    };
 }
 
+wxRect PlayIndicatorOverlayBase::DoGetNextRectangle(wxSize size)
+{
+   return IndicatorRectangle(mNewIndicatorX, size);
+}
+
 
 void PlayIndicatorOverlayBase::Draw(OverlayPanel &panel, wxDC &dc)
 {
@@ -33,6 +33,8 @@ public:
 private:
    unsigned SequenceNumber() const override;
    std::pair<wxRect, bool> DoGetRectangle(wxSize size) override;
+   wxRect DoGetNextRectangle(wxSize size) override;
+   wxRect IndicatorRectangle(int xx, wxSize size);
    void Draw(OverlayPanel &panel, wxDC &dc) override;
 
 protected:
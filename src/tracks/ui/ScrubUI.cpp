@@ -37,6 +37,7 @@ public:
 private:
    unsigned SequenceNumber() const override;
    std::pair<wxRect, bool> DoGetRectangle(wxSize size) override;
+   wxRect DoGetNextRectangle(wxSize size) override;
    void Draw(OverlayPanel &panel, wxDC &dc) override;
 
    void OnTimer(Observer::Message);
@@ -80,6 +81,11 @@ std::pair<wxRect, bool> ScrubbingOverlay::DoGetRectangle(wxSize)
    );
 }
 
+wxRect ScrubbingOverlay::DoGetNextRectangle(wxSize)
+{
+   return mNextScrubRect;
+}
+
 void ScrubbingOverlay::Draw(OverlayPanel &, wxDC &dc)
 {
    mLastScrubRect = mNextScrubRect;
@@ -58,6 +58,12 @@
 
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define METER_USE_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../AudioIO.h"
 #include "../AColor.h"
 #include "../ImageManipulation.h"
@@ -188,14 +194,14 @@ wxString MeterUpdateMsg::toStringIfClipped()
 //
 // The MeterPanel passes itself messages via this queue so that it can
 // communicate between the audio thread and the GUI thread.
-// This class is as simple as possible in order to be thread-safe
-// without needing mutexes.
+// Each index is written by one side only, and published with release
+// semantics, so neither side ever waits for a lock, and the realtime
+// thread never blocks.
 //
 
 MeterUpdateQueue::MeterUpdateQueue(size_t maxLen):
    mBufferSize(maxLen)
 {
-   Clear();
 }
 
 // destructor
@@ -205,27 +211,27 @@ MeterUpdateQueue::~MeterUpdateQueue()
 
 void MeterUpdateQueue::Clear()
 {
-   mStart = 0;
-   mEnd = 0;
+   // Don't store mEnd, which belongs to the producer; just catch up with it
+   mStart.store(mEnd.load(std::memory_order_acquire),
+      std::memory_order_release);
 }
 
 // Add a message to the end of the queue.  Return false if the
 // queue was full.
 bool MeterUpdateQueue::Put(MeterUpdateMsg &msg)
 {
-   // mStart can be greater than mEnd because it is all mod mBufferSize
-   wxASSERT( (mEnd + mBufferSize - mStart) >= 0 );
-   int len = (mEnd + mBufferSize - mStart) % mBufferSize;
+   const auto end = mEnd.load(std::memory_order_relaxed);
+   const auto next = (end + 1) % mBufferSize;
 
    // Never completely fill the queue, because then the
    // state is ambiguous (mStart==mEnd)
-   if (len + 1 >= (int)(mBufferSize))
+   if (next == mStart.load(std::memory_order_acquire))
       return false;
 
    //wxLogDebug(wxT("Put: %s"), msg.toString());
 
-   mBuffer[mEnd] = msg;
-   mEnd = (mEnd+1)%mBufferSize;
+   mBuffer[end] = msg;
+   mEnd.store(next, std::memory_order_release);
 
    return true;
 }
@@ -234,13 +240,13 @@ bool MeterUpdateQueue::Put(MeterUpdateMsg &msg)
 // Return false if the queue was empty.
 bool MeterUpdateQueue::Get(MeterUpdateMsg &msg)
 {
-   int len = (mEnd + mBufferSize - mStart) % mBufferSize;
+   const auto start = mStart.load(std::memory_order_relaxed);
 
-   if (len == 0)
+   if (start == mEnd.load(std::memory_order_acquire))
       return false;
 
-   msg = mBuffer[mStart];
-   mStart = (mStart+1)%mBufferSize;
+   msg = mBuffer[start];
+   mStart.store((start + 1) % mBufferSize, std::memory_order_release);
 
    return true;
 }
@@ -461,7 +467,7 @@ void MeterPanel::OnPaint(wxPaintEvent & /* event */)
    wxColour clrText = theTheme.Colour( clrTrackPanelText );
    wxColour clrBoxFill = theTheme.Colour( clrMedium );
 
-   if (mLayoutValid == false || (mStyle == MixerTrackCluster ))
+   if (mLayoutValid == false)
    {
       // Create a NEW one using current size and select into the DC
       mBitmap = std::make_unique<wxBitmap>();
@@ -645,13 +651,26 @@ void MeterPanel::OnPaint(wxPaintEvent & /* event */)
       dc.SelectObject(wxNullBitmap);
    }
 
+   // When RepaintBarsNow() invalidated only parts of the bars, DrawMeterBar()
+   // covers all of the damage, and the predrawn bitmap need not be copied
+   const auto &update = GetUpdateRegion();
+   bool barsOnly = !update.IsEmpty();
+   for (wxRegionIterator iter{ update }; barsOnly && iter; ++iter) {
+      const auto rect = iter.GetRect();
+      barsOnly = std::any_of(mBar, mBar + mNumBars,
+         [&](const MeterBar &bar){ return bar.r.Contains(rect); });
+   }
+
    // Copy predrawn bitmap to the dest DC
-   destDC.DrawBitmap(*mBitmap, 0, 0);
+   if (!barsOnly)
+      destDC.DrawBitmap(*mBitmap, 0, 0);
 
    // Go draw the meter bars, Left & Right channels using current levels
    for (unsigned int i = 0; i < mNumBars; i++)
    {
-      DrawMeterBar(destDC, &mBar[i]);
+      if (update.Contains(mBar[i].b) != wxOutRegion ||
+          update.Contains(mBar[i].rClip) != wxOutRegion)
+         DrawMeterBar(destDC, &mBar[i]);
    }
 
    destDC.SetTextForeground( clrText );
@@ -739,6 +758,15 @@ void MeterPanel::OnPaint(wxPaintEvent & /* event */)
    }
 }
 
+bool MeterPanel::SetBackgroundColour(const wxColour &colour)
+{
+   // The predrawn bitmap is filled with the background
+   if (!MeterPanelBase::SetBackgroundColour(colour))
+      return false;
+   mLayoutValid = false;
+   return true;
+}
+
 void MeterPanel::OnSize(wxSizeEvent & /* event */)
 {
    GetClientSize(&mWidth, &mHeight);
@@ -983,26 +1011,75 @@ static float ToDB(float v, float range)
    return ClipZeroToOne((db + range) / range);
 }
 
+//! Accumulate peak magnitudes and sums of squares of interleaved samples
+/*! Only the first numBars of the channels are measured.  This runs in the
+ audio callback, once for each meter, so the usual layouts of one or two
+ channels are reduced four samples at a time. */
+static void MeasureLevels(unsigned numChannels, unsigned numBars,
+   int numFrames, const float *sampleData, float *peak, float *sumsq)
+{
+   int i = 0;
+#ifdef METER_USE_SSE
+   if (numChannels > 0 && 4 % numChannels == 0) {
+      // Lane k of each vector always holds channel k % numChannels
+      const auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+      auto vPeak = _mm_setzero_ps();
+      auto vSum = _mm_setzero_ps();
+      const int framesPerVector = 4 / numChannels;
+      const int numVectors = numFrames / framesPerVector;
+      auto sptr = sampleData;
+      for (int v = 0; v < numVectors; ++v, sptr += 4) {
+         const auto x = _mm_loadu_ps(sptr);
+         vPeak = _mm_max_ps(vPeak, _mm_and_ps(x, absMask));
+         vSum = _mm_add_ps(vSum, _mm_mul_ps(x, x));
+      }
+      float lanePeak[4], laneSum[4];
+      _mm_storeu_ps(lanePeak, vPeak);
+      _mm_storeu_ps(laneSum, vSum);
+      for (unsigned k = 0; k < 4; ++k) {
+         const auto j = k % numChannels;
+         if (j < numBars) {
+            peak[j] = std::max(peak[j], lanePeak[k]);
+            sumsq[j] += laneSum[k];
+         }
+      }
+      i = numVectors * framesPerVector;
+   }
+#endif
+
+   // The remainder, or everything if there are many channels
+   for (auto sptr = sampleData + i * numChannels; i < numFrames;
+        ++i, sptr += numChannels) {
+      for (unsigned j = 0; j < numBars; ++j) {
+         peak[j] = std::max(peak[j], std::abs(sptr[j]));
+         sumsq[j] += sptr[j] * sptr[j];
+      }
+   }
+}
+
 void MeterPanel::UpdateDisplay(
    unsigned numChannels, int numFrames, const float *sampleData)
 {
-   auto sptr = sampleData;
    auto num = std::min(numChannels, mNumBars);
    MeterUpdateMsg msg;
 
    memset(&msg, 0, sizeof(msg));
    msg.numFrames = numFrames;
 
-   for(int i=0; i<numFrames; i++) {
-      for(unsigned int j=0; j<num; j++) {
-         msg.peak[j] = floatMax(msg.peak[j], fabs(sptr[j]));
-         msg.rms[j] += sptr[j]*sptr[j];
+   MeasureLevels(numChannels, num, numFrames, sampleData, msg.peak, msg.rms);
+
+   for(unsigned int j=0; j<num; j++) {
+      // Without a full-scale sample there is no run to count
+      if (msg.peak[j] < MAX_AUDIO)
+         continue;
 
-         // In addition to looking for mNumPeakSamplesToClip peaked
-         // samples in a row, also send the number of peaked samples
-         // at the head and tail, in case there's a run of peaked samples
-         // that crosses block boundaries
-         if (fabs(sptr[j])>=MAX_AUDIO) {
+      // In addition to looking for mNumPeakSamplesToClip peaked
+      // samples in a row, also send the number of peaked samples
+      // at the head and tail, in case there's a run of peaked samples
+      // that crosses block boundaries
+      auto sptr = sampleData + j;
+      for(int i=0; i<numFrames; i++, sptr += numChannels) {
+         if (fabs(*sptr)>=MAX_AUDIO) {
             if (msg.headPeakCount[j]==i)
                msg.headPeakCount[j]++;
             msg.tailPeakCount[j]++;
@@ -1012,7 +1089,6 @@ void MeterPanel::UpdateDisplay(
          else
             msg.tailPeakCount[j] = 0;
       }
-      sptr += numChannels;
    }
    for(unsigned int j=0; j<mNumBars; j++)
       msg.rms[j] = sqrt(msg.rms[j]/numFrames);
@@ -1575,14 +1651,69 @@ void MeterPanel::HandleLayout(wxDC &dc)
    mLayoutValid = true;
 }
 
+MeterBar::Painted MeterPanel::PaintedLevels(const MeterBar &bar) const
+{
+   // Same rounding as in DrawMeterBar()
+   // (len - 1) corresponds to the mRuler.SetBounds() in HandleLayout()
+   const int len = bar.vert ? bar.r.GetHeight() : bar.r.GetWidth();
+   const auto offset = [&](float value){
+      return (int)(value * (len - 1) + 0.5);
+   };
+   return { offset(bar.peak), offset(bar.rms),
+      offset(bar.peakHold), offset(bar.peakPeakHold), bar.clipping };
+}
+
 void MeterPanel::RepaintBarsNow()
 {
    if (mLayoutValid)
    {
-      // Invalidate the bars so they get redrawn
+      // The prompt to start monitoring is drawn across the bars
+      if (mIsInput && !mActive) {
+         Refresh(false);
+         Update();
+         return;
+      }
+
+      // Invalidate only the changed extents of the bars so they get redrawn;
+      // with many meters on the mixer board, most of each one is unchanged
       for (unsigned int i = 0; i < mNumBars; i++)
       {
-         Refresh(false);
+         auto &bar = mBar[i];
+         const auto now = PaintedLevels(bar);
+         if (!bar.painted) {
+            Refresh(false, &bar.b);
+            if (mClip)
+               Refresh(false, &bar.rClip);
+            continue;
+         }
+
+         const auto &then = *bar.painted;
+         auto lo = std::min({ now.peak, then.peak, now.rms, then.rms,
+            now.peakHold, then.peakHold, now.peakPeakHold, then.peakPeakHold });
+         auto hi = std::max({ now.peak, then.peak, now.rms, then.rms,
+            now.peakHold, then.peakHold, now.peakPeakHold, then.peakPeakHold });
+         bool levelsChanged = now.peak != then.peak || now.rms != then.rms ||
+            now.peakHold != then.peakHold ||
+            now.peakPeakHold != then.peakPeakHold;
+         if (levelsChanged) {
+            // Allow for the two pixel hold lines on either side
+            wxRect rect = bar.r;
+            if (bar.vert) {
+               const auto bottom = bar.r.GetBottom();
+               rect.SetTop(bottom - hi - 2);
+               rect.SetBottom(bottom - lo + 1);
+            }
+            else {
+               const auto left = bar.r.GetLeft();
+               rect.SetLeft(left + lo - 2);
+               rect.SetRight(left + hi + 2);
+            }
+            rect.Intersect(bar.r);
+            if (!rect.IsEmpty())
+               Refresh(false, &rect);
+         }
+         if (mClip && now.clipping != then.clipping)
+            Refresh(false, &bar.rClip);
       }
 
       // Immediate redraw (using wxPaintDC)
@@ -1594,6 +1725,8 @@ void MeterPanel::RepaintBarsNow()
 
 void MeterPanel::DrawMeterBar(wxDC &dc, MeterBar *bar)
 {
+   bar->painted = PaintedLevels(*bar);
+
    // Cache some metrics
    wxCoord x = bar->r.GetLeft();
    wxCoord y = bar->r.GetTop();
@@ -21,6 +21,9 @@
 #include <wx/defs.h>
 #include <wx/timer.h> // member variable
 
+#include <atomic>
+#include <optional>
+
 // Tenacity libraries
 #include <lib-math/SampleFormat.h>
 #include <lib-preferences/Prefs.h>
@@ -49,6 +52,17 @@ struct MeterBar {
    bool   isclipping; //ANSWER-ME: What's the diff between these bools?! "clipping" vs "isclipping" is not clear.
    int    tailPeakCount;
    float  peakPeakHold;
+
+   // Pixel offsets of the levels along r, and the clip indicator, as they
+   // were last painted; RepaintBarsNow() invalidates only what differs
+   struct Painted {
+      int  peak;
+      int  rms;
+      int  peakHold;
+      int  peakPeakHold;
+      bool clipping;
+   };
+   std::optional<Painted> painted;
 };
 
 class MeterUpdateMsg
@@ -71,7 +85,8 @@ class MeterUpdateMsg
    wxString toStringIfClipped();
 };
 
-// Thread-safe queue of update messages
+// Wait-free queue of update messages, for exactly one producer thread
+// (the audio callback) and one consumer thread (the GUI)
 class MeterUpdateQueue
 {
  public:
@@ -81,11 +96,13 @@ class MeterUpdateQueue
    bool Put(MeterUpdateMsg &msg);
    bool Get(MeterUpdateMsg &msg);
 
+   //! Discard everything; call only from the consumer thread
    void Clear();
 
  private:
-   int              mStart;
-   int              mEnd;
+   // Only Put() stores mEnd, and only Get() and Clear() store mStart
+   std::atomic<size_t> mStart{ 0 };
+   std::atomic<size_t> mEnd{ 0 };
    size_t           mBufferSize;
    ArrayOf<MeterUpdateMsg> mBuffer{mBufferSize};
 };
@@ -122,6 +139,8 @@ class TENACITY_DLL_API MeterPanel final
 
    void SetFocusFromKbd() override;
 
+   bool SetBackgroundColour(const wxColour &colour) override;
+
    void Clear() override;
 
    Style GetStyle() const { return mStyle; }
@@ -215,6 +234,7 @@ class TENACITY_DLL_API MeterPanel final
    void SetActiveStyle(Style style);
    void SetBarAndClip(int iBar, bool vert);
    void DrawMeterBar(wxDC &dc, MeterBar *meterBar);
+   MeterBar::Painted PaintedLevels(const MeterBar &bar) const;
    void ResetBar(MeterBar *bar, bool resetClipping);
    void RepaintBarsNow();
    wxFont GetFont() const;
@@ -26,6 +26,21 @@ std::pair<wxRect, bool> Overlay::GetRectangle(wxSize size)
    return result;
 }
 
+wxRect Overlay::GetNextRectangle(wxSize size)
+{
+   auto result = DoGetNextRectangle(size);
+#ifdef __WXMAC__
+   // See GetRectangle
+   result.Inflate(1, 0);
+#endif
+   return result;
+}
+
+wxRect Overlay::DoGetNextRectangle(wxSize size)
+{
+   return { wxPoint{}, size };
+}
+
 void Overlay::Erase(wxDC &dc, wxDC &src)
 {
    wxRect rect(dc.GetSize());
@@ -110,6 +110,13 @@ public:
    // Second member of pair indicates whether the overlay is out of date
    virtual std::pair<wxRect, bool> DoGetRectangle(wxSize size) = 0;
 
+   // nonvirtual wrapper
+   wxRect GetNextRectangle(wxSize size);
+
+   // The rectangle that the next Draw will cover, when out of date
+   // Default implementation is all of size, which is always sufficient
+   virtual wxRect DoGetNextRectangle(wxSize size);
+
    // Default implementation blits from backing store over GetRectangle().first
    virtual void Erase(wxDC &dc, wxDC &src);
 
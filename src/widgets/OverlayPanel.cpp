@@ -43,48 +43,23 @@ void OverlayPanel::ClearOverlays()
    mOverlays.clear();
 }
 
-void OverlayPanel::DrawOverlays(bool repaint_all, wxDC& dc)
+auto OverlayPanel::FindOutdated(wxSize size) -> std::vector< Pair >
 {
-   if ( !IsShownOnScreen() )
-      return;
-
    size_t n_pairs = mOverlays.size();
 
-   using Pair = std::pair<wxRect, bool /*out of date?*/>;
    std::vector< Pair > pairs;
    pairs.reserve(n_pairs);
 
-   // First...
-   Compress();
-   // ... then assume pointers are not expired
-
    // Find out the rectangles and outdatedness for each overlay
-   wxSize size(GetBackingDC().GetSize());
    for (const auto pOverlay : mOverlays)
       pairs.push_back( pOverlay.lock()->GetRectangle(size) );
 
-   // See what requires redrawing.  If repainting, all.
-   // If not, then whatever is outdated, and whatever will be damaged by
-   // undrawing.
+   // See what requires redrawing:  whatever is outdated, and whatever will
+   // be damaged by undrawing.
    // By redrawing only what needs it, we avoid flashing things like
    // the cursor that are drawn with invert, and also avoid
    // unnecessary work.
-
-   // But first, a quick exit test.
-   bool some_overlays_need_repainting =
-      repaint_all ||
-      std::any_of( pairs.begin(), pairs.end(),
-         []( const Pair &pair ){ return pair.second; } );
-
-   if (!some_overlays_need_repainting) {
-     // This function (OverlayPanel::DrawOverlays()) is called at
-     // fairly high frequency through a timer in TrackPanel. In case
-     // there is nothing to do, we exit early because creating the
-     // wxClientDC below is expensive, at least on Linux.
-     return;
-   }
-
-   if (!repaint_all) {
+   if (n_pairs > 1) {
       // For each overlay that needs update, any other overlay whose
       // rectangle intersects it will also need update.
       bool done;
@@ -102,6 +77,35 @@ void OverlayPanel::DrawOverlays(bool repaint_all, wxDC& dc)
       } while (!done);
    }
 
+   return pairs;
+}
+
+void OverlayPanel::DrawOverlays(bool repaint_all, wxDC& dc)
+{
+   if ( !IsShownOnScreen() )
+      return;
+
+   // First...
+   Compress();
+   // ... then assume pointers are not expired
+
+   // If repainting, all.  If not, then see FindOutdated().
+   const auto pairs = FindOutdated(GetBackingDC().GetSize());
+
+   // But first, a quick exit test.
+   bool some_overlays_need_repainting =
+      repaint_all ||
+      std::any_of( pairs.begin(), pairs.end(),
+         []( const Pair &pair ){ return pair.second; } );
+
+   if (!some_overlays_need_repainting) {
+     // This function (OverlayPanel::DrawOverlays()) is called at
+     // fairly high frequency through a timer in TrackPanel. In case
+     // there is nothing to do, we exit early because creating the
+     // wxClientDC below is expensive, at least on Linux.
+     return;
+   }
+
    // Erase
    auto it2 = pairs.begin();
    for (auto pOverlay : mOverlays) {
@@ -123,6 +127,28 @@ void OverlayPanel::DrawOverlays(bool repaint_all, wxDC& dc)
    }
 }
 
+void OverlayPanel::RefreshOverlays()
+{
+   if ( !IsShownOnScreen() )
+      return;
+
+   Compress();
+
+   const wxSize size(GetBackingDC().GetSize());
+   const auto pairs = FindOutdated(size);
+   auto it2 = pairs.begin();
+   for (auto pOverlay : mOverlays) {
+      if (it2->second) {
+         auto rect = it2->first;
+         rect.Union(pOverlay.lock()->GetNextRectangle(size));
+         rect.Intersect(wxRect{ wxPoint{}, size });
+         if (!rect.IsEmpty())
+            Refresh(false, &rect);
+      }
+      ++it2;
+   }
+}
+
 void OverlayPanel::Compress()
 {
    // remove any expired pointers
@@ -39,8 +39,20 @@ public:
    // wxClientDC internally when necessary.
    void DrawOverlays(bool repaint_all, wxDC& dc);
 
+   // Invalidates, without erasing, only the areas of the overlays that
+   // DrawOverlays(false, ...) would redraw, where they are now and where they
+   // will be drawn next.  The backing bitmap can then repair everything else,
+   // so the cost of the repaint does not depend on what is drawn beneath.
+   void RefreshOverlays();
+
 private:
    using OverlayPtr = std::weak_ptr<Overlay>;
+   using Pair = std::pair<wxRect, bool /*out of date?*/>;
+
+   // Rectangles of the overlays, and whether each needs redrawing, either
+   // because it is outdated or intersects another that is.  Assumes
+   // Compress() was called.
+   std::vector< Pair > FindOutdated(wxSize size);
 
    void Compress();
    std::vector< OverlayPtr > mOverlays;
@@ -60,6 +60,9 @@ array of Ruler::Label.
 #include <wx/dcclient.h>
 #include <wx/dcscreen.h>
 
+#include <algorithm>
+#include <unordered_map>
+
 // Tenacity libraries
 #include <lib-screen-geometry/NumberScale.h>
 #include <lib-screen-geometry/ViewInfo.h>
@@ -746,7 +749,7 @@ TranslatableString LabelString(
 
 auto Ruler::MakeTick(
    Label lab,
-   wxDC &dc, wxFont font,
+   wxSize textExtent,
    std::vector<bool> &bits,
    int left, int top, int spacing, int lead,
    bool flip, int orientation )
@@ -758,13 +761,10 @@ auto Ruler::MakeTick(
    auto length = bits.size() - 1;
    auto pos = lab.pos;
 
-   dc.SetFont( font );
-
-   wxCoord strW, strH, strD, strL;
+   const wxCoord strW = textExtent.GetWidth(), strH = textExtent.GetHeight();
    auto str = lab.text;
    // Do not put the text into results until we are sure it does not overlap
    lab.text = {};
-   dc.GetTextExtent(str.Translation(), &strW, &strH, &strD, &strL);
 
    int strPos, strLen, strLeft, strTop;
    if ( orientation == wxHORIZONTAL ) {
@@ -868,7 +868,13 @@ struct Ruler::Updater {
    const NumberScale mNumberScale = mRuler.mNumberScale;
 
    struct TickOutputs;
-   
+
+   // These consult the ruler's TextCache, which does not change the results
+   const TranslatableString &LabelString(
+      const TickSizes &tickSizes, double d ) const;
+   wxSize TextExtent(
+      wxDC &dc, const wxFont &font, const TranslatableString &text ) const;
+
    bool Tick( wxDC &dc,
       int pos, double d, const TickSizes &tickSizes, wxFont font,
       TickOutputs outputs
@@ -903,6 +909,103 @@ struct Ruler::Cache {
    wxRect mRect;
 };
 
+struct Ruler::TextCache {
+   // Bound the growth while scrolling through ever new values
+   static constexpr size_t MaxEntries = 4096;
+
+   struct Extents {
+      wxFont font;
+      wxSize ppi;
+      std::unordered_map< wxString, wxSize > sizes;
+   };
+   std::vector< Extents > mExtents;
+
+   // Label strings depend on the format and on the tick sizes, which depend
+   // on the zoom, but not on the scroll offset
+   RulerFormat mFormat{ IntFormat };
+   TranslatableString mUnits;
+   double mMajor{ 0 }, mMinor{ 0 };
+   int mDigits{ -1 };
+   std::unordered_map< double, TranslatableString > mStrings[2];
+
+   const TranslatableString &GetLabelString( const TickSizes &tickSizes,
+      double d, RulerFormat format, const TranslatableString &units );
+   wxSize GetTextExtent(
+      wxDC &dc, const wxFont &font, const wxString &text );
+};
+
+auto Ruler::TextCache::GetLabelString( const TickSizes &tickSizes,
+   double d, RulerFormat format, const TranslatableString &units )
+   -> const TranslatableString &
+{
+   if ( format != mFormat || !( units == mUnits ) ||
+        tickSizes.mMajor != mMajor || tickSizes.mMinor != mMinor ||
+        tickSizes.mDigits != mDigits ) {
+      mFormat = format;
+      mUnits = units;
+      mMajor = tickSizes.mMajor;
+      mMinor = tickSizes.mMinor;
+      mDigits = tickSizes.mDigits;
+      for ( auto &strings : mStrings )
+         strings.clear();
+   }
+
+   auto &strings = mStrings[ tickSizes.useMajor ? 1 : 0 ];
+   auto iter = strings.find( d );
+   if ( iter == strings.end() ) {
+      if ( strings.size() >= MaxEntries )
+         strings.clear();
+      iter = strings.emplace(
+         d, tickSizes.LabelString( d, format, units ) ).first;
+   }
+   return iter->second;
+}
+
+wxSize Ruler::TextCache::GetTextExtent(
+   wxDC &dc, const wxFont &font, const wxString &text )
+{
+   // Measurements differ for printers
+   const auto ppi = dc.GetPPI();
+   auto pExtents = std::find_if( mExtents.begin(), mExtents.end(),
+      [&]( const Extents &extents ){
+         return extents.font == font && extents.ppi == ppi; } );
+   if ( pExtents == mExtents.end() )
+      pExtents =
+         mExtents.insert( mExtents.end(), Extents{ font, ppi, {} } );
+
+   auto &sizes = pExtents->sizes;
+   auto iter = sizes.find( text );
+   if ( iter == sizes.end() ) {
+      if ( sizes.size() >= MaxEntries )
+         sizes.clear();
+      dc.SetFont( font );
+      wxCoord strW, strH;
+      dc.GetTextExtent( text, &strW, &strH );
+      iter = sizes.emplace( text, wxSize{ strW, strH } ).first;
+   }
+   return iter->second;
+}
+
+auto Ruler::GetTextCache() const -> TextCache &
+{
+   if ( !mpTextCache )
+      mpTextCache = std::make_unique< TextCache >();
+   return *mpTextCache;
+}
+
+const TranslatableString &Ruler::Updater::LabelString(
+   const TickSizes &tickSizes, double d ) const
+{
+   return mRuler.GetTextCache()
+      .GetLabelString( tickSizes, d, mFormat, mUnits );
+}
+
+wxSize Ruler::Updater::TextExtent(
+   wxDC &dc, const wxFont &font, const TranslatableString &text ) const
+{
+   return mRuler.GetTextCache().GetTextExtent( dc, font, text.Translation() );
+}
+
 struct Ruler::Updater::TickOutputs{ Labels &labels; Bits &bits; wxRect &box; };
 struct Ruler::Updater::UpdateOutputs {
    Labels &majorLabels, &minorLabels, &minorMinorLabels;
@@ -927,11 +1030,11 @@ bool Ruler::Updater::Tick( wxDC &dc,
    Label lab;
    lab.value = d;
    lab.pos = pos;
-   lab.text = tickSizes.LabelString( d, mFormat, mUnits );
+   lab.text = LabelString( tickSizes, d );
 
    const auto result = MakeTick(
       lab,
-      dc, font,
+      TextExtent( dc, font, lab.text ),
       outputs.bits,
       mLeft, mTop, mSpacing, mFonts.lead,
       mFlip,
@@ -960,7 +1063,7 @@ bool Ruler::Updater::TickCustom( wxDC &dc, int labelIdx, wxFont font,
    const auto result = MakeTick(
       lab,
 
-      dc, font,
+      TextExtent( dc, font, lab.text ),
       outputs.bits,
       mLeft, mTop, mSpacing, mFonts.lead,
       mFlip,
@@ -186,7 +186,7 @@ private:
 
    static std::pair< wxRect, Label > MakeTick(
       Label lab,
-      wxDC &dc, wxFont font,
+      wxSize textExtent,
       std::vector<bool> &bits,
       int left, int top, int spacing, int lead,
       bool flip, int orientation );
@@ -194,6 +194,12 @@ private:
    struct Cache;
    mutable std::unique_ptr<Cache> mpCache;
 
+   // Survives Invalidate(), so that scrolling does not format and measure
+   // the same label texts again
+   struct TextCache;
+   mutable std::unique_ptr<TextCache> mpTextCache;
+   TextCache &GetTextCache() const;
+
    // Returns 'zero' label coordinate (for grid drawing)
    int FindZero( const Labels &labels ) const;
 
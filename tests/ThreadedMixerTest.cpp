@@ -0,0 +1,219 @@
+
+#include "export/ThreadedMixer.h"
+#include <lib-sample-track/Mix.h>
+#include <lib-math/SampleFormat.h>
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+// A mixer of no tracks, producing a ramp of floats that counts samples from
+// zero, so that any lost, repeated or reordered buffer shows
+class StubMixer final : public Mixer
+{
+public:
+   StubMixer(unsigned numChannels, size_t bufferSize, bool interleaved,
+             size_t nBuffers, size_t throwAfter, std::atomic<size_t> &calls)
+      : Mixer({}, true, Mixer::WarpOptions{ 0.0, 0.0 }, 0.0, 0.0,
+              numChannels, bufferSize, interleaved, 1.0, floatSample, false)
+      , mNumChannels{ numChannels }
+      , mInterleaved{ interleaved }
+      , mNBuffers{ nBuffers }
+      , mThrowAfter{ throwAfter }
+      , mCalls{ calls }
+      , mBuffer(numChannels * bufferSize)
+   {
+   }
+
+   size_t Process(size_t maxSamples) override
+   {
+      ++mCalls;
+      if (mCount == mThrowAfter)
+         throw std::runtime_error{ "stub mixer failed" };
+      if (mCount == mNBuffers)
+         return 0;
+      // The last buffer is short
+      const auto len = (mCount + 1 == mNBuffers) ? maxSamples / 2 : maxSamples;
+      for (size_t ii = 0; ii < len; ++ii)
+         for (unsigned cc = 0; cc < mNumChannels; ++cc) {
+            const auto index = mInterleaved
+               ? ii * mNumChannels + cc
+               : cc * maxSamples + ii;
+            mBuffer[index] = mSample + ii + cc * 0.5f;
+         }
+      mSample += len;
+      mMaxSamples = maxSamples;
+      ++mCount;
+      return len;
+   }
+
+   double MixGetCurrentTime() override
+   {
+      return mSample;
+   }
+
+   constSamplePtr GetBuffer() override
+   {
+      return reinterpret_cast<constSamplePtr>(mBuffer.data());
+   }
+
+   constSamplePtr GetBuffer(int channel) override
+   {
+      return reinterpret_cast<constSamplePtr>(
+         mBuffer.data() + channel * mMaxSamples);
+   }
+
+private:
+   const unsigned mNumChannels;
+   const bool mInterleaved;
+   const size_t mNBuffers;
+   const size_t mThrowAfter;
+   std::atomic<size_t> &mCalls;
+   std::vector<float> mBuffer;
+   size_t mMaxSamples{ 0 };
+   size_t mCount{ 0 };
+   size_t mSample{ 0 };
+};
+
+class ThreadedMixerTest
+{
+private:
+   static constexpr unsigned NumChannels = 2;
+   static constexpr size_t BufferSize = 64;
+   static constexpr size_t NoThrow = static_cast<size_t>(-1);
+
+   std::atomic<size_t> mCalls{ 0 };
+
+   std::unique_ptr<ThreadedMixer> Make(bool interleaved, size_t nBuffers,
+      size_t throwAfter = NoThrow)
+   {
+      mCalls = 0;
+      return std::make_unique<ThreadedMixer>(
+         std::make_unique<StubMixer>(NumChannels, BufferSize, interleaved,
+            nBuffers, throwAfter, mCalls),
+         NumChannels, BufferSize, interleaved, floatSample);
+   }
+
+   // Check one buffer against the ramp; return false on a mismatch
+   static bool Check(const ThreadedMixer &mixer, size_t len, bool interleaved,
+                     size_t first)
+   {
+      for (size_t ii = 0; ii < len; ++ii)
+         for (unsigned cc = 0; cc < NumChannels; ++cc) {
+            auto buffer = reinterpret_cast<const float*>(interleaved
+               ? mixer.GetBuffer()
+               : mixer.GetBuffer(cc));
+            const auto index = interleaved ? ii * NumChannels + cc : ii;
+            if (buffer[index] != first + ii + cc * 0.5f)
+               return false;
+         }
+      return mixer.MixGetCurrentTime() == first + len;
+   }
+
+   static void Report(bool ok)
+   {
+      std::cout << (ok ? "ok\n" : "FAILED\n");
+      if (!ok)
+         exit(1);
+   }
+
+public:
+   ThreadedMixerTest()
+   {
+      std::cout << "==> Testing ThreadedMixer\n";
+   }
+
+   void TestOrdering(bool interleaved)
+   {
+      std::cout << "\tbuffers should come in order, "
+         << (interleaved ? "interleaved" : "not interleaved")
+         << ", each as mixed..." << std::flush;
+
+      // More buffers than slots, so the mixer must wait for the encoder
+      constexpr size_t nBuffers = 50;
+      auto pMixer = Make(interleaved, nBuffers);
+      bool ok = pMixer->MixGetCurrentTime() == 0;
+      size_t sample = 0;
+      for (size_t ii = 0; ok && ii < nBuffers; ++ii) {
+         const auto len = pMixer->Process();
+         const auto expected = (ii + 1 == nBuffers) ? BufferSize / 2 : BufferSize;
+         ok = (len == expected) && Check(*pMixer, len, interleaved, sample);
+         sample += len;
+      }
+      Report(ok);
+   }
+
+   void TestEndOfStream()
+   {
+      std::cout << "\tafter the last buffer, Process() should keep returning zero..." << std::flush;
+
+      constexpr size_t nBuffers = 3;
+      auto pMixer = Make(true, nBuffers);
+      bool ok = true;
+      for (size_t ii = 0; ii < nBuffers; ++ii)
+         ok = ok && pMixer->Process() > 0;
+      for (size_t ii = 0; ii < 3; ++ii)
+         ok = ok && pMixer->Process() == 0;
+      // The mixer stops asking after the first empty buffer
+      ok = ok && mCalls == nBuffers + 1;
+      Report(ok);
+   }
+
+   void TestException()
+   {
+      std::cout << "\tan exception from mixing should come after the buffers mixed before it..." << std::flush;
+
+      constexpr size_t throwAfter = 5;
+      auto pMixer = Make(false, 100, throwAfter);
+      bool ok = true;
+      size_t sample = 0;
+      for (size_t ii = 0; ok && ii < throwAfter; ++ii) {
+         size_t len = 0;
+         try {
+            len = pMixer->Process();
+         }
+         catch (...) {
+            ok = false;
+            break;
+         }
+         ok = len == BufferSize && Check(*pMixer, len, false, sample);
+         sample += len;
+      }
+      for (size_t ii = 0; ok && ii < 2; ++ii) {
+         try {
+            pMixer->Process();
+            ok = false;
+         }
+         catch (const std::runtime_error &) {
+         }
+      }
+      ok = ok && mCalls == throwAfter + 1;
+      Report(ok);
+   }
+
+   void TestStop()
+   {
+      std::cout << "\tdestroying the ThreadedMixer should stop the mixing..." << std::flush;
+
+      auto pMixer = Make(true, 1000);
+      bool ok = pMixer->Process() == BufferSize;
+      pMixer.reset();
+      // The mixer may have filled the ring, but no more
+      const size_t calls = mCalls;
+      ok = ok && calls <= 4;
+      Report(ok);
+   }
+};
+
+int main()
+{
+   ThreadedMixerTest tester;
+
+   tester.TestOrdering(true);
+   tester.TestOrdering(false);
+   tester.TestEndOfStream();
+   tester.TestException();
+   tester.TestStop();
+
+   return 0;
+}